@@ -2,7 +2,8 @@
 #define TINY_ALPACA_SERVER_EXAMPLES_AM_WEATHERBOX_SRC_AM_WEATHER_BOX_H_
 
 // The AMWeatherBox class presents the AstroMakers WeatherBox device as an ASCOM
-// Alpaca ObservingConditions device
+// Alpaca ObservingConditions device. The sensors are read in the background
+// by SampledObservingConditionsAdapter.
 //
 // Author: james.synge@gmail.com
 
@@ -10,28 +11,20 @@
 
 namespace astro_makers {
 
-class AMWeatherBox : public alpaca::ObservingConditionsAdapter {
+class AMWeatherBox : public alpaca::SampledObservingConditionsAdapter {
  public:
   explicit AMWeatherBox(const alpaca::DeviceInfo& device_info);
 
   void Initialize() override;
 
-  void MaintainDevice() override;
-
-  alpaca::StatusOr<double> GetAveragePeriod() override;
-  alpaca::StatusOr<double> GetRainRate() override;
-  alpaca::StatusOr<double> GetSkyTemperature() override;
-  alpaca::StatusOr<double> GetTemperature() override;
+  alpaca::StatusOr<double> ReadSensor(alpaca::ESensorName sensor_name) override;
   alpaca::StatusOr<alpaca::Literal> GetSensorDescription(
       alpaca::ESensorName sensor_name) override;
-  alpaca::Status SetAveragePeriod(double hours) override;
-  alpaca::Status Refresh() override;
 
  private:
   bool DoReadIrTemps();
 
   bool ir_therm_ready_;
-  uint32_t last_read_time_;
 };
 
 }  // namespace astro_makers
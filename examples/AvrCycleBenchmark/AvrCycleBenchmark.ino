@@ -0,0 +1,317 @@
+// Measures the number of CPU cycles taken by the request decoder, the JSON
+// encoder and WriteResponse on an AVR (i.e. with PROGMEM reads, 8-bit
+// arithmetic and no cache), for a small corpus of scripted requests.
+//
+// This is meant to be run under simavr (i.e. without any hardware), using
+// extras/dev_tools/avr_cycle_benchmark.py, which compiles the sketch, runs it
+// and summarizes the results. It can also be run on an Arduino Mega, in which
+// case the results are printed to Serial, though the sketch then halts.
+//
+// Timer/Counter 1 counts system clock cycles, with an interrupt counting the
+// overflows. The millis() interrupt (Timer/Counter 0) is disabled while
+// measuring, and Serial is flushed before each measurement, so that the only
+// interrupt during a measurement is the rare overflow of Timer/Counter 1.
+// Each operation is measured kRepetitions times, and the minimum is reported,
+// less the cost of measuring an empty operation.
+//
+// The output consists of lines like these (tab separated):
+//
+//   BENCH_OVERHEAD  <cycles>
+//   BENCH  <case>  <component>  <cycles>
+//   BENCH_DONE
+//
+// Author: james.synge@gmail.com
+
+#include <Arduino.h>
+#include <TinyAlpacaServer.h>
+
+#ifdef ARDUINO_ARCH_AVR
+#include <avr/sleep.h>
+#endif  // ARDUINO_ARCH_AVR
+
+// Number of times that Timer/Counter 1 has overflowed since StartCycleCounter.
+volatile uint16_t timer1_overflows = 0;  // NOLINT
+
+ISR(TIMER1_OVF_vect) { ++timer1_overflows; }
+
+namespace {
+
+using ::alpaca::AlpacaRequest;
+using ::alpaca::AnyPrintable;
+using ::alpaca::EDeviceMethod;
+using ::alpaca::EHttpStatusCode;
+using ::alpaca::JsonMethodResponse;
+using ::alpaca::JsonObjectEncoder;
+using ::alpaca::Literal;
+using ::alpaca::Literals;
+using ::alpaca::PrintNoOp;
+using ::alpaca::RequestDecoder;
+using ::alpaca::StringView;
+using ::alpaca::WriteResponse;
+
+constexpr uint8_t kRepetitions = 5;
+
+////////////////////////////////////////////////////////////////////////////////
+// Cycle counting.
+
+void StartCycleCounter() {
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  timer1_overflows = 0;
+  TIFR1 = _BV(TOV1);  // Clear any pending overflow.
+  TIMSK1 = _BV(TOIE1);
+  TCCR1B = _BV(CS10);  // Normal mode, no prescaling.
+  interrupts();
+}
+
+uint32_t ReadCycleCounter() {
+  noInterrupts();
+  const uint16_t ticks = TCNT1;
+  uint16_t overflows = timer1_overflows;
+  // If the counter has overflowed since interrupts were disabled, the
+  // interrupt handler hasn't yet counted it.
+  if ((TIFR1 & _BV(TOV1)) != 0 && ticks < 0x8000) {
+    ++overflows;
+  }
+  interrupts();
+  return (static_cast<uint32_t>(overflows) << 16) | ticks;
+}
+
+uint32_t measurement_overhead = 0;  // NOLINT
+
+template <typename Func>
+uint32_t MeasureCycles(Func func) {
+  uint32_t best = UINT32_MAX;
+  for (uint8_t rep = 0; rep < kRepetitions; ++rep) {
+    Serial.flush();
+    const uint32_t start = ReadCycleCounter();
+    func();
+    const uint32_t elapsed = ReadCycleCounter() - start;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best > measurement_overhead ? best - measurement_overhead : 0;
+}
+
+void PrintResult(const Literal& case_name, const Literal& component,
+                 uint32_t cycles) {
+  Serial.print(TAS_FLASHSTR("BENCH\t"));
+  case_name.printTo(Serial);
+  Serial.print('\t');
+  component.printTo(Serial);
+  Serial.print('\t');
+  Serial.println(cycles);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The corpus of requests.
+
+TAS_DEFINE_LITERAL(GetTemperatureName, "get_temperature");
+TAS_DEFINE_LITERAL(GetTemperatureRequest,
+                   "GET /api/v1/observingconditions/0/temperature"
+                   "?ClientID=1&ClientTransactionID=123 HTTP/1.1\r\n"
+                   "Host: 192.168.1.2\r\n"
+                   "Accept: application/json\r\n"
+                   "\r\n");
+
+TAS_DEFINE_LITERAL(PutConnectedName, "put_connected");
+TAS_DEFINE_LITERAL(PutConnectedRequest,
+                   "PUT /api/v1/safetymonitor/0/connected HTTP/1.1\r\n"
+                   "Host: 192.168.1.2\r\n"
+                   "Content-Type: application/x-www-form-urlencoded\r\n"
+                   "Content-Length: 49\r\n"
+                   "\r\n"
+                   "Connected=true&ClientID=1&ClientTransactionID=124");
+
+TAS_DEFINE_LITERAL(GetDescriptionName, "get_description");
+TAS_DEFINE_LITERAL(GetDescriptionRequest,
+                   "GET /management/v1/description?ClientTransactionID=125 "
+                   "HTTP/1.1\r\n"
+                   "\r\n");
+
+TAS_DEFINE_LITERAL(BadPathName, "bad_path");
+TAS_DEFINE_LITERAL(BadPathRequest,
+                   "GET /api/v1/telescope/0/bogus HTTP/1.1\r\n"
+                   "\r\n");
+
+TAS_DEFINE_LITERAL(LiteralsName, "literals");
+TAS_DEFINE_LITERAL(NumbersName, "numbers");
+
+TAS_DEFINE_LITERAL(DecodeComponent, "decode");
+TAS_DEFINE_LITERAL(JsonComponent, "json");
+TAS_DEFINE_LITERAL(ResponseComponent, "response");
+TAS_DEFINE_LITERAL(PrintComponent, "print");
+TAS_DEFINE_LITERAL(MatchComponent, "match");
+TAS_DEFINE_LITERAL(ToDoubleComponent, "to_double");
+TAS_DEFINE_LITERAL(ToUint32Component, "to_uint32");
+
+enum class EResponseKind : uint8_t { kDouble, kStatus, kLiteral, kHttpError };
+
+struct BenchmarkCase {
+  Literal name;
+  Literal request;
+  EResponseKind response;
+};
+
+const BenchmarkCase kCases[] = {
+    {GetTemperatureName(), GetTemperatureRequest(), EResponseKind::kDouble},
+    {PutConnectedName(), PutConnectedRequest(), EResponseKind::kStatus},
+    {GetDescriptionName(), GetDescriptionRequest(), EResponseKind::kLiteral},
+    {BadPathName(), BadPathRequest(), EResponseKind::kHttpError},
+};
+
+char request_buffer[Literal::kMaxSize];  // NOLINT
+
+void WriteBenchmarkResponse(EResponseKind kind, EHttpStatusCode decode_status,
+                            const AlpacaRequest& request, Print& out) {
+  switch (kind) {
+    case EResponseKind::kDouble:
+      WriteResponse::DoubleResponse(request, 12.5, out);
+      break;
+    case EResponseKind::kStatus:
+      WriteResponse::StatusResponse(request, alpaca::OkStatus(), out);
+      break;
+    case EResponseKind::kLiteral:
+      WriteResponse::AnyPrintableStringResponse(
+          request, AnyPrintable(Literals::TinyAlpacaServer()), out);
+      break;
+    case EResponseKind::kHttpError:
+      WriteResponse::HttpErrorResponse(
+          decode_status, AnyPrintable(Literals::HttpBadRequest()), out);
+      break;
+  }
+}
+
+void RunCase(const BenchmarkCase& benchmark_case) {
+  const auto size = benchmark_case.request.size();
+  Literal(benchmark_case.request).copyTo(request_buffer, sizeof request_buffer);
+
+  AlpacaRequest request;
+  RequestDecoder decoder(request);
+  EHttpStatusCode decode_status = EHttpStatusCode::kHttpOk;
+  const uint32_t decode_cycles = MeasureCycles([&] {
+    StringView view(request_buffer, size);
+    decoder.Reset();
+    decode_status = decoder.DecodeBuffer(view, /*buffer_is_full=*/false,
+                                         /*at_end_of_input=*/false);
+  });
+  PrintResult(benchmark_case.name, DecodeComponent(), decode_cycles);
+
+  PrintNoOp out;
+  if (benchmark_case.response != EResponseKind::kHttpError) {
+    const uint32_t json_cycles = MeasureCycles([&] {
+      JsonMethodResponse source(request);
+      JsonObjectEncoder::Encode(source, out);
+    });
+    PrintResult(benchmark_case.name, JsonComponent(), json_cycles);
+  }
+
+  const uint32_t response_cycles = MeasureCycles([&] {
+    WriteBenchmarkResponse(benchmark_case.response, decode_status, request,
+                           out);
+  });
+  PrintResult(benchmark_case.name, ResponseComponent(), response_cycles);
+}
+
+// Printing of literals used in responses, and matching of tokens against the
+// literals, in isolation.
+void RunLiterals() {
+  PrintNoOp out;
+  const uint32_t print_cycles = MeasureCycles([&] {
+    Literals::HttpVersion().printTo(out);
+    Literals::HttpServerHeader().printTo(out);
+    Literals::HttpContentType().printTo(out);
+    Literals::MimeTypeJson().printTo(out);
+    Literals::ClientTransactionID().printTo(out);
+    Literals::ErrorNotConnected().printTo(out);
+  });
+  PrintResult(LiteralsName(), PrintComponent(), print_cycles);
+
+  char temperature[] = "temperature";
+  char supportedactions[] = "supportedactions";
+  char bogus[] = "bogus";
+  const uint32_t match_cycles = MeasureCycles([&] {
+    EDeviceMethod method;
+    alpaca::MatchDeviceMethod(alpaca::EApiGroup::kDevice,
+                              alpaca::EDeviceType::kObservingConditions,
+                              StringView(temperature), method);
+    alpaca::MatchDeviceMethod(alpaca::EApiGroup::kDevice,
+                              alpaca::EDeviceType::kObservingConditions,
+                              StringView(supportedactions), method);
+    alpaca::MatchDeviceMethod(alpaca::EApiGroup::kDevice,
+                              alpaca::EDeviceType::kObservingConditions,
+                              StringView(bogus), method);
+  });
+  PrintResult(LiteralsName(), MatchComponent(), match_cycles);
+}
+
+// Parsing of typical numeric parameter values (e.g. ClientID, device number,
+// ClientTransactionID, Switch "Value" and ObservingConditions "AveragePeriod").
+void RunNumbers() {
+  char client_id[] = "1";
+  char device_number[] = "0";
+  char transaction_id[] = "3141592653";
+  const uint32_t to_uint32_cycles = MeasureCycles([&] {
+    uint32_t out;
+    StringView(client_id).to_uint32(out);
+    StringView(device_number).to_uint32(out);
+    StringView(transaction_id).to_uint32(out);
+  });
+  PrintResult(NumbersName(), ToUint32Component(), to_uint32_cycles);
+
+  char value[] = "0.5";
+  char temperature[] = "-273.15";
+  char pressure[] = "1013.25";
+  char period[] = "1e-3";
+  const uint32_t to_double_cycles = MeasureCycles([&] {
+    double out;
+    StringView(value).to_double(out);
+    StringView(temperature).to_double(out);
+    StringView(pressure).to_double(out);
+    StringView(period).to_double(out);
+  });
+  PrintResult(NumbersName(), ToDoubleComponent(), to_double_cycles);
+}
+
+void Halt() {
+#ifdef ARDUINO_ARCH_AVR
+  // simavr exits when the CPU sleeps with interrupts disabled.
+  cli();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  sleep_cpu();
+#endif  // ARDUINO_ARCH_AVR
+}
+
+}  // namespace
+
+void setup() {
+  Serial.begin(57600);
+  while (!Serial) {
+  }
+
+#ifdef ARDUINO_ARCH_AVR
+  // Disable the millis() interrupt.
+  TIMSK0 &= ~_BV(TOIE0);
+#endif  // ARDUINO_ARCH_AVR
+
+  StartCycleCounter();
+  measurement_overhead = MeasureCycles([] {});
+  Serial.print(TAS_FLASHSTR("BENCH_OVERHEAD\t"));
+  Serial.println(measurement_overhead);
+
+  for (const auto& benchmark_case : kCases) {
+    RunCase(benchmark_case);
+  }
+  RunLiterals();
+  RunNumbers();
+
+  Serial.println(TAS_FLASHSTR("BENCH_DONE"));
+  Serial.flush();
+  Halt();
+}
+
+void loop() {}
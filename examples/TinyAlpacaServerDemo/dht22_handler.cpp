@@ -2,13 +2,23 @@
 
 #include "pretend_devices.h"
 
+using ::alpaca::ESensorName;
 using ::alpaca::Literal;
-using ::alpaca::ObservingConditionsAdapter;
+using ::alpaca::SampledObservingConditionsAdapter;
+using ::alpaca::SampledSensor;
 using ::alpaca::StatusOr;
 
 // Just one simple device, used to report Observing Conditions.
 static Dht22Device dht22;
 
+// A DHT22 can't be read more often than every 2 seconds.
+constexpr uint32_t kDht22ReadIntervalMillis = 2000;
+
+static SampledSensor dht22_sensors[] = {
+    {ESensorName::kHumidity, kDht22ReadIntervalMillis},
+    {ESensorName::kTemperature, kDht22ReadIntervalMillis},
+};
+
 // Define some literals, which get stored in PROGMEM (in the case of AVR chips).
 TAS_DEFINE_LITERAL(DHT22Name, "DHT22");
 TAS_DEFINE_LITERAL(DHT22Description, "DHT22 Humidity and Temperature Sensor");
@@ -31,14 +41,17 @@ const alpaca::DeviceInfo kDht22DeviceInfo{
     .interface_version = 1,
 };
 
-Dht22Handler::Dht22Handler() : ObservingConditionsAdapter(kDht22DeviceInfo) {}
+Dht22Handler::Dht22Handler()
+    : SampledObservingConditionsAdapter(
+          kDht22DeviceInfo, alpaca::ArrayView<SampledSensor>(dht22_sensors)) {}
 
-StatusOr<double> Dht22Handler::GetHumidity() {
-  return dht22.get_relative_humidity();
-}
-
-StatusOr<double> Dht22Handler::GetTemperature() {
-  return dht22.get_temperature();
+StatusOr<double> Dht22Handler::ReadSensor(ESensorName sensor_name) {
+  if (sensor_name == ESensorName::kHumidity) {
+    return dht22.get_relative_humidity();
+  } else if (sensor_name == ESensorName::kTemperature) {
+    return dht22.get_temperature();
+  }
+  return alpaca::ErrorCodes::NotImplemented();
 }
 
 StatusOr<bool> Dht22Handler::GetConnected() {
@@ -46,9 +59,9 @@ StatusOr<bool> Dht22Handler::GetConnected() {
 }
 
 StatusOr<Literal> Dht22Handler::GetSensorDescription(
-    alpaca::ESensorName sensor_name) {
-  if (sensor_name == alpaca::ESensorName::kHumidity ||
-      sensor_name == alpaca::ESensorName::kTemperature) {
+    ESensorName sensor_name) {
+  if (sensor_name == ESensorName::kHumidity ||
+      sensor_name == ESensorName::kTemperature) {
     return DHT22Description();
   }
   return alpaca::ErrorCodes::InvalidValue();
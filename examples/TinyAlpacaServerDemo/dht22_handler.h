@@ -2,18 +2,18 @@
 #define TINY_ALPACA_SERVER_EXAMPLES_TINYALPACASERVERDEMO_DHT22_HANDLER_H_
 
 // Dht22Handler represents a DHT22 humidity and sensor as an ASCOM Alpaca
-// Observing Conditions device.
+// Observing Conditions device. The sensor is read every couple of seconds (the
+// fastest that a DHT22 supports) by SampledObservingConditionsAdapter.
 //
 // Author: james.synge@gmail.com
 
 #include <TinyAlpacaServer.h>
 
-class Dht22Handler : public alpaca::ObservingConditionsAdapter {
+class Dht22Handler : public alpaca::SampledObservingConditionsAdapter {
  public:
   Dht22Handler();
 
-  alpaca::StatusOr<double> GetHumidity() override;
-  alpaca::StatusOr<double> GetTemperature() override;
+  alpaca::StatusOr<double> ReadSensor(alpaca::ESensorName sensor_name) override;
   alpaca::StatusOr<bool> GetConnected() override;
   alpaca::StatusOr<alpaca::Literal> GetSensorDescription(
       alpaca::ESensorName sensor_name) override;
@@ -0,0 +1,313 @@
+// Microbenchmark of encoding an Alpaca JSON response on host.
+//
+// A response is encoded twice: once to compute the Content-Length (i.e.
+// SizeOfPrintable(PrintableJsonObject)), then again to send it. This compares
+// JsonObjectEncoder with the previous implementation (copied here as the
+// baseline), which wrapped the output in a CountingPrint for each pass (two
+// when computing the size, which also wrapped a PrintNoOp), and escaped strings
+// by printing them one char at a time through another Print.
+//
+// Reported per response are the number of calls to Print::write (each of which
+// is a virtual, i.e. indirect, call), and the time taken. Each Print in the
+// baseline counts the calls it receives, except for the escaping Print, whose
+// calls come from the strings being printed, which count them. That is also
+// how the calls to JsonObjectEncoder's own escaping Print are counted, and the
+// output is written to a counting PrintNoOp, so both are counted the same way.
+//
+// Example:
+//
+//   json_encoder_benchmark --iterations=100000
+//
+// Author: james.synge@gmail.com
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "base/init_google.h"
+#include "utils/any_printable.h"
+#include "utils/counting_print.h"
+#include "utils/json_encoder.h"
+#include "utils/json_encoder_helpers.h"
+#include "utils/platform.h"
+#include "utils/string_view.h"
+
+ABSL_FLAG(int, iterations, 100000, "Number of times the response is encoded.");
+
+namespace alpaca {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t write_calls = 0;
+
+// Counts the calls to write, and optionally records the output.
+class CallCountingNoOp final : public Print {
+ public:
+  size_t write(uint8_t b) override {
+    ++write_calls;
+    if (record_) {
+      output_.push_back(static_cast<char>(b));
+    }
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    ++write_calls;
+    if (record_) {
+      output_.append(reinterpret_cast<const char*>(buffer), size);
+    }
+    return size;
+  }
+  using Print::write;
+
+  void StartRecording() {
+    record_ = true;
+    output_.clear();
+  }
+  const std::string& output() const { return output_; }
+
+ private:
+  bool record_ = false;
+  std::string output_;
+};
+
+// A string which counts the calls it makes to write when printed; like
+// StringView::printTo, it prints itself with a single call.
+class CountedString : public Printable {
+ public:
+  template <size_t N>
+  explicit CountedString(const char (&str)[N]) : view_(str) {}
+
+  size_t printTo(Print& out) const override {
+    ++write_calls;
+    return out.write(view_.data(), view_.size());
+  }
+
+ private:
+  StringView view_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// The baseline: the previous implementation, trimmed to what the response
+// needs.
+
+size_t BaselinePrintCharJsonEscaped(Print& out, const char c) {
+  size_t total = 0;
+  if (isPrintable(c)) {
+    if (c == '"') {
+      total += out.print('\\');
+      total += out.print('"');
+    } else if (c == '\\') {
+      total += out.print('\\');
+      total += out.print('\\');
+    } else {
+      total += out.print(c);
+    }
+  } else if (c == '\n') {
+    total += out.print('\\');
+    total += out.print('n');
+  } else if (c == '\r') {
+    total += out.print('\\');
+    total += out.print('r');
+  }
+  return total;
+}
+
+class BaselinePrintJsonEscaped : public Print {
+ public:
+  explicit BaselinePrintJsonEscaped(Print& wrapped) : wrapped_(wrapped) {}
+
+  size_t write(uint8_t b) override {
+    return BaselinePrintCharJsonEscaped(wrapped_, static_cast<char>(b));
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    size_t count = 0;
+    for (size_t ndx = 0; ndx < size; ++ndx) {
+      count += BaselinePrintCharJsonEscaped(wrapped_,
+                                            static_cast<char>(buffer[ndx]));
+    }
+    return count;
+  }
+
+  using Print::write;
+
+ private:
+  Print& wrapped_;
+};
+
+class BaselineCountingPrint : public Print {
+ public:
+  explicit BaselineCountingPrint(Print& out) : out_(out), count_(0) {}
+
+  size_t write(uint8_t value) override {
+    ++write_calls;
+    auto result = out_.write(value);
+    count_ += result;
+    return result;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    ++write_calls;
+    auto result = out_.write(buffer, size);
+    count_ += result;
+    return result;
+  }
+
+  using Print::write;
+
+  uint32_t count() const { return count_; }
+
+ private:
+  Print& out_;
+  uint32_t count_;
+};
+
+class BaselineObjectEncoder {
+ public:
+  explicit BaselineObjectEncoder(Print& out) : out_(out), first_(true) {
+    out_.print('{');
+  }
+  ~BaselineObjectEncoder() { out_.print('}'); }
+
+  void AddIntProperty(const AnyPrintable& name, int32_t value) {
+    StartProperty(name);
+    out_.print(value);
+  }
+  void AddUIntProperty(const AnyPrintable& name, uint32_t value) {
+    StartProperty(name);
+    out_.print(value);
+  }
+  void AddStringProperty(const AnyPrintable& name, const Printable& value) {
+    StartProperty(name);
+    PrintString(value);
+  }
+
+ private:
+  void StartProperty(const AnyPrintable& name) {
+    if (first_) {
+      first_ = false;
+    } else {
+      out_.print(',');
+      out_.print(' ');
+    }
+    PrintString(name);
+    out_.print(':');
+    out_.print(' ');
+  }
+
+  void PrintString(const Printable& value) {
+    BaselinePrintJsonEscaped escaped(out_);
+    out_.print('"');
+    value.printTo(escaped);
+    out_.print('"');
+  }
+
+  Print& out_;
+  bool first_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The properties of a typical response to a GET request with a string value.
+struct Response {
+  CountedString value_name{"Value"};
+  CountedString value{"Cover \"east\" is moving\r\n"};
+  CountedString client_transaction_id_name{"ClientTransactionID"};
+  CountedString server_transaction_id_name{"ServerTransactionID"};
+  CountedString error_number_name{"ErrorNumber"};
+  CountedString error_message_name{"ErrorMessage"};
+  CountedString error_message{""};
+
+  template <class Encoder>
+  void AddTo(Encoder& encoder) const {
+    encoder.AddStringProperty(AnyPrintable(value_name), value);
+    encoder.AddUIntProperty(AnyPrintable(client_transaction_id_name), 123);
+    encoder.AddUIntProperty(AnyPrintable(server_transaction_id_name), 45678);
+    encoder.AddIntProperty(AnyPrintable(error_number_name), 0);
+    encoder.AddStringProperty(AnyPrintable(error_message_name), error_message);
+  }
+};
+
+void EncodeBaseline(const Response& response, CallCountingNoOp& sink) {
+  {
+    // SizeOfPrintable wrapped a PrintNoOp in a CountingPrint, and
+    // PrintableJsonObject::printTo wrapped that in another.
+    BaselineCountingPrint size_counter(sink);
+    BaselineCountingPrint counter(size_counter);
+    BaselineObjectEncoder encoder(counter);
+    response.AddTo(encoder);
+  }
+  {
+    BaselineCountingPrint counter(sink);
+    BaselineObjectEncoder encoder(counter);
+    response.AddTo(encoder);
+  }
+}
+
+void EncodeCurrent(const Response& response, CallCountingNoOp& sink) {
+  JsonPropertySourceAdapter<Response> source(response);
+  PrintableJsonObject printable(source);
+  {
+    // As SizeOfPrintable does, but with a sink that counts the calls made to
+    // the CountingSink (its calls to the sink are direct).
+    CountingSink<CallCountingNoOp> counter(sink);
+    printable.printTo(counter);
+  }
+  printable.printTo(sink);
+}
+
+template <typename Func>
+void Measure(const char* name, const Response& response, Func func) {
+  CallCountingNoOp sink;
+  write_calls = 0;
+  func(response, sink);
+  const uint64_t calls_per_response = write_calls;
+
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  const auto start = Clock::now();
+  for (int n = 0; n < iterations; ++n) {
+    func(response, sink);
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      Clock::now() - start;
+  std::printf("%-10s %12llu %12.1f\n", name,
+              static_cast<unsigned long long>(calls_per_response),  // NOLINT
+              elapsed.count() / iterations);
+}
+
+int RunBenchmark() {
+  const Response response;
+
+  // Confirm that both produce the same output.
+  CallCountingNoOp baseline_sink, current_sink;
+  baseline_sink.StartRecording();
+  EncodeBaseline(response, baseline_sink);
+  current_sink.StartRecording();
+  EncodeCurrent(response, current_sink);
+  if (baseline_sink.output() != current_sink.output()) {
+    std::printf("Output differs:\n%s\n%s\n", baseline_sink.output().c_str(),
+                current_sink.output().c_str());
+    return 1;
+  }
+  std::printf("Response (%zu bytes, encoded twice): %s\n\n",
+              current_sink.output().size() / 2,
+              current_sink.output()
+                  .substr(0, current_sink.output().size() / 2)
+                  .c_str());
+
+  std::printf("%-10s %12s %12s\n", "encoder", "write calls", "ns/response");
+  Measure("baseline", response, EncodeBaseline);
+  Measure("current", response, EncodeCurrent);
+  return 0;
+}
+
+}  // namespace
+}  // namespace alpaca
+
+int main(int argc, char* argv[]) {
+  InitGoogle(argv[0], &argc, &argv, /*remove_flags=*/true);
+  return alpaca::RunBenchmark();
+}
@@ -0,0 +1,195 @@
+// Microbenchmark of printing and comparing Literals on host.
+//
+// Compares Literal::printTo and Literal::operator==, which copy the string from
+// PROGMEM in chunks, with the char at a time loops which they replaced (copied
+// here as the baseline). The literals are those used in responses and when
+// matching request tokens, so the mix of lengths is realistic. Printing is to a
+// PrintNoOp, so what is measured is the cost of the calls to Print::write, not
+// of the network stack.
+//
+// Example:
+//
+//   literal_benchmark --iterations=1000000
+//
+// Author: james.synge@gmail.com
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "base/init_google.h"
+#include "literals.h"
+#include "utils/counting_print.h"
+#include "utils/literal.h"
+#include "utils/platform.h"
+#include "utils/string_compare.h"
+#include "utils/string_view.h"
+
+ABSL_FLAG(int, iterations, 200000,
+          "Number of times each operation is applied to each literal.");
+
+namespace alpaca {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The implementation of Literal::printTo before it copied in chunks.
+size_t PrintCharAtATime(const Literal& literal, Print& out) {
+  size_t total = 0;
+  for (Literal::size_type offset = 0; offset < literal.size(); ++offset) {
+    total += out.print(literal.at(offset));
+  }
+  return total;
+}
+
+// The implementation of Literal::operator== before it compared in chunks.
+bool EqualCharAtATime(const Literal& a, const Literal& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (Literal::size_type offset = 0; offset < a.size(); ++offset) {
+    if (a.at(offset) != b.at(offset)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<Literal> BenchmarkLiterals() {
+  return {
+      Literals::GET(),
+      Literals::api(),
+      Literals::temperature(),
+      Literals::ClientTransactionID(),
+      Literals::HttpContentType(),
+      Literals::MimeTypeJson(),
+      Literals::HttpServerHeader(),
+      Literals::MimeTypeWwwFormUrlEncoded(),
+      Literals::ErrorNotConnected(),
+      Literals::InvalidOperation(),
+  };
+}
+
+template <typename Func>
+double MeasureNanosPerOp(const std::vector<Literal>& literals, Func func) {
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  const auto start = Clock::now();
+  for (int n = 0; n < iterations; ++n) {
+    for (const auto& literal : literals) {
+      func(literal);
+    }
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      Clock::now() - start;
+  return elapsed.count() / (static_cast<double>(iterations) * literals.size());
+}
+
+void Report(const char* name, double baseline_ns, double chunked_ns) {
+  std::printf("%-24s %10.2f %10.2f %8.2fx\n", name, baseline_ns, chunked_ns,
+              baseline_ns / chunked_ns);
+}
+
+int RunBenchmark() {
+  const auto literals = BenchmarkLiterals();
+
+  // Copies of the literals in different storage, so that operator== can't
+  // shortcut by comparing pointers, and with the last char different, so that
+  // the entire string must be compared to find the difference.
+  std::vector<std::string> same_strings, different_strings;
+  for (const auto& literal : literals) {
+    std::string str(literal.size(), '\0');
+    for (Literal::size_type ndx = 0; ndx < literal.size(); ++ndx) {
+      str[ndx] = literal.at(ndx);
+    }
+    same_strings.push_back(str);
+    str.back() ^= 1;
+    different_strings.push_back(str);
+  }
+  std::vector<Literal> same, different;
+  for (size_t ndx = 0; ndx < literals.size(); ++ndx) {
+    same.emplace_back(same_strings[ndx].data(), same_strings[ndx].size());
+    different.emplace_back(different_strings[ndx].data(),
+                           different_strings[ndx].size());
+  }
+
+  PrintNoOp out;
+  volatile size_t sink = 0;
+
+  std::printf("%-24s %10s %10s %9s\n", "operation (ns/op)", "char", "chunked",
+              "speedup");
+
+  const double print_baseline = MeasureNanosPerOp(
+      literals, [&](const Literal& literal) {
+        sink = sink + PrintCharAtATime(literal, out);
+      });
+  const double print_chunked = MeasureNanosPerOp(
+      literals,
+      [&](const Literal& literal) { sink = sink + literal.printTo(out); });
+  Report("printTo", print_baseline, print_chunked);
+
+  size_t ndx = 0;
+  auto next = [&](const std::vector<Literal>& others) -> const Literal& {
+    const auto& other = others[ndx];
+    ndx = (ndx + 1) % others.size();
+    return other;
+  };
+
+  const double equal_baseline = MeasureNanosPerOp(
+      literals, [&](const Literal& literal) {
+        sink = sink + EqualCharAtATime(literal, next(same));
+      });
+  ndx = 0;
+  const double equal_chunked =
+      MeasureNanosPerOp(literals, [&](const Literal& literal) {
+        sink = sink + (literal == next(same));
+      });
+  Report("operator== (equal)", equal_baseline, equal_chunked);
+
+  ndx = 0;
+  const double differ_baseline = MeasureNanosPerOp(
+      literals, [&](const Literal& literal) {
+        sink = sink + EqualCharAtATime(literal, next(different));
+      });
+  ndx = 0;
+  const double differ_chunked =
+      MeasureNanosPerOp(literals, [&](const Literal& literal) {
+        sink = sink + (literal == next(different));
+      });
+  Report("operator== (last char)", differ_baseline, differ_chunked);
+
+  // For reference: comparison with a StringView, which was already done with
+  // memcmp_P and strncasecmp_P.
+  ndx = 0;
+  const double view_equal = MeasureNanosPerOp(
+      literals, [&](const Literal& literal) {
+        const auto& other = next(same);
+        sink = sink + (literal == StringView(static_cast<const char*>(
+                                                 other.prog_data_for_tests()),
+                                             other.size()));
+      });
+  ndx = 0;
+  const double view_case_equal = MeasureNanosPerOp(
+      literals, [&](const Literal& literal) {
+        const auto& other = next(same);
+        sink = sink + CaseEqual(literal,
+                                StringView(static_cast<const char*>(
+                                               other.prog_data_for_tests()),
+                                           other.size()));
+      });
+  std::printf("%-24s %10s %10.2f\n", "== StringView", "", view_equal);
+  std::printf("%-24s %10s %10.2f\n", "CaseEqual StringView", "",
+              view_case_equal);
+
+  return 0;
+}
+
+}  // namespace
+}  // namespace alpaca
+
+int main(int argc, char* argv[]) {
+  InitGoogle(argv[0], &argc, &argv, /*remove_flags=*/true);
+  return alpaca::RunBenchmark();
+}
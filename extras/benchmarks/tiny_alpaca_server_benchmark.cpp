@@ -0,0 +1,401 @@
+// Loopback end-to-end benchmark of TinyAlpacaServer on host.
+//
+// Runs TinyAlpacaServer (with the pretend devices of TinyAlpacaServerDemo) on
+// one thread, using the host emulation of Ethernet3 to serve real TCP
+// connections, and drives it from one or more client threads, each with its own
+// connection. Each client sends a mix of device GET and PUT requests and
+// management API requests; some requests are sent on a new connection which is
+// closed after the response is received, the rest on a keep-alive connection.
+// Reports the request rate and latency percentiles, where latency is measured
+// from just before the request is sent (or the connection is opened, for
+// requests on a new connection) until the entire response has been received.
+// Also reports the stack used by the server (see utils/memory_usage.h).
+//
+// With --capture_file, the bytes received by the server are recorded by
+// RequestCapture, for replaying with extras/tools/replay_requests.
+//
+// Example:
+//
+//   tiny_alpaca_server_benchmark --seconds=10 --connections=2 \
+//       --close_fraction=0.1 --get_weight=6 --put_weight=2 \
+//       --management_weight=2
+//
+// Author: james.synge@gmail.com
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "base/init_google.h"
+#include "examples/TinyAlpacaServerDemo/dht22_handler.h"
+#include "extras/host/ethernet3/host_platform_ethernet.h"
+#include "extras/tools/request_capture_file.h"
+#include "logging.h"
+#include "request_capture.h"
+#include "request_timing.h"
+#include "tiny_alpaca_server.h"
+#include "utils/memory_usage.h"
+#include "utils/platform_ethernet.h"
+
+ABSL_FLAG(int, port, 18080, "TCP port on which the server listens.");
+ABSL_FLAG(double, seconds, 5, "Duration of the measurement, in seconds.");
+ABSL_FLAG(double, warmup_seconds, 1,
+          "Duration of the warmup, before measuring, in seconds.");
+ABSL_FLAG(int, connections, 2,
+          "Number of client threads, each with its own connection. More than "
+          "TAS_NUM_SERVER_CONNECTIONS will leave some clients waiting. If 0, "
+          "the server just runs for the warmup and measurement period, for "
+          "use with an external load generator (e.g. alpaca_load_generator).");
+ABSL_FLAG(double, close_fraction, 0.1,
+          "Fraction of requests sent on a new connection, which is closed "
+          "after the response is received.");
+ABSL_FLAG(int, get_weight, 6, "Relative weight of device GET requests.");
+ABSL_FLAG(int, put_weight, 2, "Relative weight of device PUT requests.");
+ABSL_FLAG(int, management_weight, 2,
+          "Relative weight of management API requests.");
+ABSL_FLAG(std::string, capture_file, "",
+          "If set, the bytes received by the server (including during the "
+          "warmup) are recorded in this file by RequestCapture.");
+
+namespace alpaca {
+namespace {
+
+TAS_DEFINE_LITERAL(ServerName, "Tiny Alpaca Server Benchmark");
+TAS_DEFINE_LITERAL(Manufacturer, "Tiny Alpaca Server");
+TAS_DEFINE_LITERAL(ManufacturerVersion, "0.1");
+TAS_DEFINE_LITERAL(DeviceLocation, "localhost");
+
+const ServerDescription kServerDescription{
+    .server_name = ServerName(),
+    .manufacturer = Manufacturer(),
+    .manufacturer_version = ManufacturerVersion(),
+    .location = DeviceLocation(),
+};
+
+using Clock = std::chrono::steady_clock;
+
+enum class ERequestKind { kGet, kPut, kManagement };
+
+std::string MakeRequest(ERequestKind kind, int client_id,
+                        uint32_t transaction_id, std::mt19937& rng) {
+  const std::string ids = absl::StrCat("ClientID=", client_id,
+                                       "&ClientTransactionID=", transaction_id);
+  switch (kind) {
+    case ERequestKind::kGet: {
+      const char* const kMethods[] = {"temperature", "humidity", "connected",
+                                      "name", "description"};
+      const auto* method = kMethods[rng() % (sizeof kMethods / sizeof *kMethods)];
+      return absl::StrCat("GET /api/v1/observingconditions/1/", method, "?",
+                          ids, " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    }
+    case ERequestKind::kPut: {
+      const std::string body = absl::StrCat("Connected=true&", ids);
+      return absl::StrCat(
+          "PUT /api/v1/observingconditions/1/connected HTTP/1.1\r\n"
+          "Host: localhost\r\n"
+          "Content-Type: application/x-www-form-urlencoded\r\n"
+          "Content-Length: ",
+          body.size(), "\r\n\r\n", body);
+    }
+    case ERequestKind::kManagement: {
+      const char* const kPaths[] = {"/management/apiversions",
+                                    "/management/v1/description",
+                                    "/management/v1/configureddevices"};
+      const auto* path = kPaths[rng() % (sizeof kPaths / sizeof *kPaths)];
+      return absl::StrCat("GET ", path, "?", ids,
+                          " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    }
+  }
+  return "";
+}
+
+int OpenConnection(int port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  CHECK_GE(fd, 0) << std::strerror(errno);
+  int value = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof value);
+  // Don't wait forever for a response (e.g. if there are more clients than
+  // server connections, and all of the clients are using keep-alive).
+  timeval timeout{2, 0};
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof addr);
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0) {
+    const auto error_number = errno;
+    VLOG(1) << "connect failed: " << std::strerror(error_number);
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool SendAll(int fd, const std::string& data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    auto ret = ::send(fd, data.data() + offset, data.size() - offset,
+                      MSG_NOSIGNAL);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    } else if (ret <= 0) {
+      return false;
+    }
+    offset += ret;
+  }
+  return true;
+}
+
+// Reads one HTTP response, which must have a Content-Length header. Returns
+// the status code, or -1 if unable to read a complete response.
+int ReadResponse(int fd) {
+  std::string response;
+  size_t header_end = std::string::npos;
+  size_t content_length = 0;
+  char buffer[2048];
+  while (true) {
+    if (header_end == std::string::npos) {
+      header_end = response.find("\r\n\r\n");
+      if (header_end != std::string::npos) {
+        header_end += 4;
+        std::string headers = response.substr(0, header_end);
+        std::transform(headers.begin(), headers.end(), headers.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        auto pos = headers.find("\r\ncontent-length:");
+        if (pos == std::string::npos) {
+          LOG(ERROR) << "Response has no Content-Length:\n" << response;
+          return -1;
+        }
+        pos += 17;
+        auto eol = headers.find("\r\n", pos);
+        std::string value = headers.substr(pos, eol - pos);
+        value.erase(0, value.find_first_not_of(' '));
+        if (!absl::SimpleAtoi(value, &content_length)) {
+          LOG(ERROR) << "Invalid Content-Length: " << value;
+          return -1;
+        }
+      }
+    }
+    if (header_end != std::string::npos &&
+        response.size() >= header_end + content_length) {
+      break;
+    }
+    auto ret = ::recv(fd, buffer, sizeof buffer, 0);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    } else if (ret <= 0) {
+      VLOG(1) << "Connection closed before response complete: " << response;
+      return -1;
+    }
+    response.append(buffer, ret);
+  }
+  int status = -1;
+  if (response.size() < 12 || response.compare(0, 9, "HTTP/1.1 ") != 0 ||
+      !absl::SimpleAtoi(response.substr(9, 3), &status)) {
+    LOG(ERROR) << "Invalid response status line: " << response;
+    return -1;
+  }
+  return status;
+}
+
+struct ClientResults {
+  std::vector<int64_t> latencies_us;
+  int64_t errors = 0;
+};
+
+void RunClient(int client_id, const std::atomic<bool>& measuring,
+               const std::atomic<bool>& stopping, ClientResults& results) {
+  const int port = absl::GetFlag(FLAGS_port);
+  const double close_fraction = absl::GetFlag(FLAGS_close_fraction);
+  const int get_weight = absl::GetFlag(FLAGS_get_weight);
+  const int put_weight = absl::GetFlag(FLAGS_put_weight);
+  const int total_weight =
+      get_weight + put_weight + absl::GetFlag(FLAGS_management_weight);
+  CHECK_GT(total_weight, 0);
+
+  std::mt19937 rng(client_id);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  uint32_t transaction_id = 0;
+  int fd = -1;
+  while (!stopping.load()) {
+    const bool close_after = uniform(rng) < close_fraction;
+    const int pick = rng() % total_weight;
+    const ERequestKind kind =
+        pick < get_weight ? ERequestKind::kGet
+        : pick < get_weight + put_weight ? ERequestKind::kPut
+                                         : ERequestKind::kManagement;
+    const std::string request =
+        MakeRequest(kind, client_id, ++transaction_id, rng);
+
+    const auto start = Clock::now();
+    if (close_after && fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+    if (fd < 0) {
+      fd = OpenConnection(port);
+    }
+    int status = -1;
+    if (fd >= 0 && SendAll(fd, request)) {
+      status = ReadResponse(fd);
+    }
+    const auto end = Clock::now();
+
+    if (measuring.load()) {
+      if (status == 200) {
+        results.latencies_us.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+                .count());
+      } else {
+        ++results.errors;
+      }
+    }
+    if (close_after || status < 0) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+      fd = -1;
+    }
+  }
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted, double fraction) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t ndx = static_cast<size_t>(fraction * sorted.size());
+  return sorted[std::min(ndx, sorted.size() - 1)];
+}
+
+int RunBenchmark() {
+  HostPlatformEthernet platform_ethernet;
+  PlatformEthernet::SetPlatformEthernetImplementation(&platform_ethernet);
+
+  Dht22Handler dht_handler;
+  DeviceInterface* devices[] = {&dht_handler};
+  TinyAlpacaServer server(absl::GetFlag(FLAGS_port), kServerDescription,
+                          devices);
+  // The discovery server can't initialize on host, which we ignore.
+  server.Initialize();
+
+  std::atomic<bool> measuring(false);
+  std::atomic<bool> stopping(false);
+  std::atomic<bool> server_stopping(false);
+
+  // RequestCapture is called only from the server thread, which is started
+  // after capturing starts, and joined before capturing stops.
+  FILE* capture_file = nullptr;
+  std::unique_ptr<FilePrint> capture_print;
+  const std::string capture_path = absl::GetFlag(FLAGS_capture_file);
+  if (!capture_path.empty()) {
+    capture_file = std::fopen(capture_path.c_str(), "wb");
+    CHECK(capture_file != nullptr)
+        << "Unable to create " << capture_path << ": " << std::strerror(errno);
+    capture_print = std::make_unique<FilePrint>(capture_file);
+    RequestCapture::StartCapture(*capture_print);
+  }
+
+  std::thread server_thread([&]() {
+    // Measure the stack used by PerformIO and the calls it makes.
+    ResetMemoryUsage();
+    while (!server_stopping.load()) {
+      server.PerformIO();
+      // Give the client threads a chance to run if there are fewer cores than
+      // threads.
+      std::this_thread::yield();
+    }
+  });
+
+  const int num_clients = std::max(0, absl::GetFlag(FLAGS_connections));
+  std::vector<ClientResults> results(num_clients);
+  std::vector<std::thread> clients;
+  for (int ndx = 0; ndx < num_clients; ++ndx) {
+    clients.emplace_back(RunClient, ndx + 1, std::cref(measuring),
+                         std::cref(stopping), std::ref(results[ndx]));
+  }
+
+  std::this_thread::sleep_for(
+      std::chrono::duration<double>(absl::GetFlag(FLAGS_warmup_seconds)));
+  measuring.store(true);
+  const auto start = Clock::now();
+  std::this_thread::sleep_for(
+      std::chrono::duration<double>(absl::GetFlag(FLAGS_seconds)));
+  measuring.store(false);
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  stopping.store(true);
+  for (auto& client : clients) {
+    client.join();
+  }
+  server_stopping.store(true);
+  server_thread.join();
+  if (capture_file != nullptr) {
+    RequestCapture::StopCapture();
+    std::fclose(capture_file);
+  }
+  if (num_clients == 0) {
+    return EXIT_SUCCESS;
+  }
+
+  std::vector<int64_t> latencies;
+  int64_t errors = 0;
+  for (const auto& result : results) {
+    latencies.insert(latencies.end(), result.latencies_us.begin(),
+                     result.latencies_us.end());
+    errors += result.errors;
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  std::printf("requests: %zu\n", latencies.size());
+  std::printf("errors: %lld\n", static_cast<long long>(errors));  // NOLINT
+  std::printf("requests_per_second: %.1f\n", latencies.size() / elapsed);
+  std::printf("latency_us_p50: %lld\n",
+              static_cast<long long>(Percentile(latencies, 0.5)));  // NOLINT
+  std::printf("latency_us_p99: %lld\n",
+              static_cast<long long>(Percentile(latencies, 0.99)));  // NOLINT
+  std::printf("latency_us_p999: %lld\n",
+              static_cast<long long>(Percentile(latencies, 0.999)));  // NOLINT
+  std::printf("latency_us_max: %lld\n",
+              static_cast<long long>(  // NOLINT
+                  latencies.empty() ? 0 : latencies.back()));
+  std::printf("stack_max_used_bytes: %zu\n", MaxStackUsed());
+#if TAS_ENABLE_REQUEST_TIMING
+  // Server side timings, including the warmup period; the buckets are powers of
+  // two, in units of 2^kMicrosShift microseconds.
+  std::fflush(stdout);
+  RequestTimingHistograms::PrintTo(Serial);
+  Serial.flush();
+#endif  // TAS_ENABLE_REQUEST_TIMING
+  return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace
+}  // namespace alpaca
+
+int main(int argc, char* argv[]) {
+  InitGoogle(argv[0], &argc, &argv, /*remove_flags=*/true);
+  return alpaca::RunBenchmark();
+}
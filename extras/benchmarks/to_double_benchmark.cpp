@@ -0,0 +1,140 @@
+// Microbenchmark of StringView::to_double on host.
+//
+// Compares StringView::to_double, which builds an integer mantissa and decimal
+// exponent and then (usually) needs just one floating point multiplication or
+// division, with the digit at a time loop which it replaced (copied here as the
+// baseline), and with strtod (which needs a NUL terminated copy). The inputs
+// are typical of the values of Alpaca request parameters (e.g. Switch "Value"
+// and ObservingConditions "AveragePeriod"), plus a few which need the slow
+// path. Note that on AVR the difference is larger, as double arithmetic is
+// done in software; see examples/AvrCycleBenchmark.
+//
+// Example:
+//
+//   to_double_benchmark --iterations=1000000
+//
+// Author: james.synge@gmail.com
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "base/init_google.h"
+#include "utils/string_view.h"
+
+ABSL_FLAG(int, iterations, 200000,
+          "Number of times each input is converted by each method.");
+
+namespace alpaca {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The implementation of StringView::to_double before it built an integer
+// mantissa; it didn't support exponents, and was not correctly rounded.
+bool DigitAtATimeToDouble(StringView view, double& out) {
+  bool negative = view.match_and_consume('-');
+  if (view.empty()) {
+    return false;
+  }
+  bool decoding_fraction = false;
+  double value = 0;
+  double divisor = 1;
+  for (const char c : view) {
+    if (c == '.') {
+      if (decoding_fraction || view.size() == 1) {
+        return false;
+      }
+      decoding_fraction = true;
+    } else if ('0' <= c && c <= '9') {
+      value = value * 10 + (c - '0');
+      if (decoding_fraction) {
+        divisor *= 10;
+      }
+    } else {
+      return false;
+    }
+  }
+  if (divisor > 1) {
+    value /= divisor;
+  }
+  out = negative ? -value : value;
+  return true;
+}
+
+bool StrtodToDouble(StringView view, double& out) {
+  char buffer[StringView::kMaxSize + 1];
+  std::memcpy(buffer, view.data(), view.size());
+  buffer[view.size()] = '\0';
+  char* end = nullptr;
+  out = std::strtod(buffer, &end);
+  return end == buffer + view.size();
+}
+
+const std::vector<std::string>& FastPathInputs() {
+  static const auto* const kInputs = new std::vector<std::string>({
+      "0", "1", "0.5", "0.25", "12.25", "-273.15", "300", "1013.25", "0.0001",
+      "65535", "99.9",
+  });
+  return *kInputs;
+}
+
+const std::vector<std::string>& SlowPathInputs() {
+  static const auto* const kInputs = new std::vector<std::string>({
+      "987654321.123456789",
+      "3.14159265358979323846",
+      "0.000000000000000000000000000123",
+  });
+  return *kInputs;
+}
+
+template <typename Func>
+double MeasureNanosPerOp(const std::vector<std::string>& inputs, Func func) {
+  std::vector<StringView> views;
+  for (const auto& input : inputs) {
+    views.emplace_back(input.data(), input.size());
+  }
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  volatile double sink = 0;
+  const auto start = Clock::now();
+  for (int n = 0; n < iterations; ++n) {
+    for (const auto& view : views) {
+      double value = 0;
+      func(view, value);
+      sink = sink + value;
+    }
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      Clock::now() - start;
+  return elapsed.count() / (static_cast<double>(iterations) * views.size());
+}
+
+void Report(const char* name, const std::vector<std::string>& inputs) {
+  const double baseline = MeasureNanosPerOp(inputs, DigitAtATimeToDouble);
+  const double to_double = MeasureNanosPerOp(
+      inputs, [](StringView view, double& out) { view.to_double(out); });
+  const double strtod = MeasureNanosPerOp(inputs, StrtodToDouble);
+  std::printf("%-16s %10.2f %10.2f %10.2f\n", name, baseline, to_double,
+              strtod);
+}
+
+int RunBenchmark() {
+  std::printf("%-16s %10s %10s %10s\n", "inputs (ns/op)", "digitwise",
+              "to_double", "strtod");
+  Report("fast path", FastPathInputs());
+  Report("slow path", SlowPathInputs());
+  return 0;
+}
+
+}  // namespace
+}  // namespace alpaca
+
+int main(int argc, char* argv[]) {
+  InitGoogle(argv[0], &argc, &argv, /*remove_flags=*/true);
+  return alpaca::RunBenchmark();
+}
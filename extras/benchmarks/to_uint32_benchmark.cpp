@@ -0,0 +1,109 @@
+// Microbenchmark of StringView::to_uint32 on host.
+//
+// Compares the two implementations of to_uint32 (see internal::ParseUInt32Swar
+// and internal::ParseUInt32In16BitHalves in utils/string_view.h) with the
+// char at a time loop which they replaced (copied here as the baseline), for
+// values typical of ClientID, device numbers and ClientTransactionID (which
+// some clients send as 9 or 10 digit numbers). On host, to_uint32 uses the
+// SWAR implementation; the 16-bit implementation is for AVR, where it is
+// measured by examples/AvrCycleBenchmark.
+//
+// Example:
+//
+//   to_uint32_benchmark --iterations=1000000
+//
+// Author: james.synge@gmail.com
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/flags/flag.h"
+#include "base/init_google.h"
+#include "utils/string_view.h"
+
+ABSL_FLAG(int, iterations, 200000,
+          "Number of times each input is converted by each method.");
+
+namespace alpaca {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The implementation of StringView::to_uint32 before it converted several
+// digits at a time. Not inlined, so that it is called in the same way as the
+// others.
+ABSL_ATTRIBUTE_NOINLINE bool CharAtATime(const StringView& view,
+                                         uint32_t& out) {
+  constexpr uint32_t kMaxUInt = 0xFFFFFFFF;
+  constexpr uint32_t kMaxUIntDiv10 = kMaxUInt / 10;
+  if (view.empty()) {
+    return false;
+  }
+  uint32_t value = 0;
+  for (const char c : view) {
+    if (!('0' <= c && c <= '9')) {
+      return false;
+    }
+    if (value > kMaxUIntDiv10) {
+      return false;
+    }
+    uint32_t digit = static_cast<uint32_t>(c - '0');
+    value *= 10;
+    if (value > kMaxUInt - digit) {
+      return false;
+    }
+    value += digit;
+  }
+  out = value;
+  return true;
+}
+
+template <typename Func>
+double MeasureNanosPerOp(const std::vector<std::string>& inputs, Func func) {
+  std::vector<StringView> views;
+  for (const auto& input : inputs) {
+    views.emplace_back(input.data(), input.size());
+  }
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  volatile uint32_t sink = 0;
+  const auto start = Clock::now();
+  for (int n = 0; n < iterations; ++n) {
+    for (const auto& view : views) {
+      uint32_t value = 0;
+      func(view, value);
+      sink = sink + value;
+    }
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      Clock::now() - start;
+  return elapsed.count() / (static_cast<double>(iterations) * views.size());
+}
+
+void Report(const char* name, const std::vector<std::string>& inputs) {
+  std::printf("%-16s %10.2f %10.2f %10.2f\n", name,
+              MeasureNanosPerOp(inputs, CharAtATime),
+              MeasureNanosPerOp(inputs, internal::ParseUInt32Swar),
+              MeasureNanosPerOp(inputs, internal::ParseUInt32In16BitHalves));
+}
+
+int RunBenchmark() {
+  std::printf("%-16s %10s %10s %10s\n", "inputs (ns/op)", "char", "swar",
+              "16-bit");
+  Report("1-2 digits", {"0", "1", "7", "12", "42"});
+  Report("3-6 digits", {"123", "4567", "12345", "654321"});
+  Report("9-10 digits", {"123456789", "987654321", "1234567890",
+                         "4294967295"});
+  return 0;
+}
+
+}  // namespace
+}  // namespace alpaca
+
+int main(int argc, char* argv[]) {
+  InitGoogle(argv[0], &argc, &argv, /*remove_flags=*/true);
+  return alpaca::RunBenchmark();
+}
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Runs examples/AvrCycleBenchmark under simavr, and reports the cycle counts.
+
+Usage:
+
+  avr_cycle_benchmark.py [--elf=FILE] [--fqbn=arduino:avr:mega]
+                         [--simavr=simavr] [--mcu=atmega2560]
+                         [--frequency=16000000] [--timeout=300]
+
+Unless --elf is specified, the sketch is first compiled with arduino-cli, with
+this repository as an additional library; arduino-cli must already have the
+core for the board (e.g. `arduino-cli core install arduino:avr`). The firmware
+is then run by simavr, which needs neither hardware nor a network, and which
+prints the output of the sketch's serial port (UART0). The sketch halts by
+sleeping with interrupts disabled, which causes simavr to exit.
+
+The report shows, for each request of the corpus, the cycles taken to decode
+the request, to encode the JSON body, and to write the entire response, along
+with the equivalent time at the simulated clock frequency.
+"""
+
+import argparse
+import collections
+import dataclasses
+import os
+import subprocess
+import sys
+import tempfile
+from typing import Dict, List, Optional, Sequence
+
+SKETCH_NAME = 'AvrCycleBenchmark'
+
+
+@dataclasses.dataclass()
+class BenchmarkResults:
+  overhead: Optional[int] = None
+  # Cycles by case name, then by component name, in the order reported.
+  cycles: Dict[str, Dict[str, int]] = dataclasses.field(
+      default_factory=collections.OrderedDict)
+  done: bool = False
+
+
+def repo_root() -> str:
+  return os.path.dirname(
+      os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+
+def parse_output(output: str) -> BenchmarkResults:
+  """Parses the lines written by the sketch, ignoring any other output."""
+  results = BenchmarkResults()
+  for line in output.splitlines():
+    # simavr may prefix the UART output (e.g. with "..").
+    fields = line.strip().lstrip('.').split('\t')
+    if fields[0] == 'BENCH_OVERHEAD' and len(fields) == 2:
+      results.overhead = int(fields[1])
+    elif fields[0] == 'BENCH' and len(fields) == 4:
+      case_name, component, cycles = fields[1:]
+      results.cycles.setdefault(case_name, collections.OrderedDict())
+      results.cycles[case_name][component] = int(cycles)
+    elif fields[0] == 'BENCH_DONE':
+      results.done = True
+  return results
+
+
+def format_report(results: BenchmarkResults, frequency: int) -> str:
+  """Returns a table of the results, one row per case and component."""
+  lines = []
+  if results.overhead is not None:
+    lines.append(f'Measurement overhead (subtracted): {results.overhead} '
+                 'cycles')
+  lines.append(f'{"case":<18} {"component":<10} {"cycles":>10} {"usec":>10}')
+  for case_name, components in results.cycles.items():
+    for component, cycles in components.items():
+      usec = cycles * 1e6 / frequency
+      lines.append(
+          f'{case_name:<18} {component:<10} {cycles:>10} {usec:>10.1f}')
+  if not results.done:
+    lines.append('WARNING: BENCH_DONE not found; the output is incomplete.')
+  return '\n'.join(lines)
+
+
+def compile_sketch(fqbn: str, output_dir: str) -> str:
+  """Compiles the sketch with arduino-cli, returning the path of the ELF."""
+  root = repo_root()
+  sketch_dir = os.path.join(root, 'examples', SKETCH_NAME)
+  subprocess.run([
+      'arduino-cli', 'compile', '--fqbn', fqbn, '--library', root,
+      '--output-dir', output_dir, sketch_dir
+  ],
+                 check=True)
+  return os.path.join(output_dir, SKETCH_NAME + '.ino.elf')
+
+
+def run_simavr(simavr: str, mcu: str, frequency: int, elf: str,
+               timeout: float) -> str:
+  completed = subprocess.run(
+      [simavr, '-m', mcu, '-f', str(frequency), elf],
+      stdout=subprocess.PIPE,
+      stderr=subprocess.STDOUT,
+      universal_newlines=True,
+      timeout=timeout,
+      check=False)
+  return completed.stdout
+
+
+def main(argv: Sequence[str]) -> int:
+  parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+  parser.add_argument('--elf', help='Firmware to run, instead of compiling.')
+  parser.add_argument('--fqbn', default='arduino:avr:mega')
+  parser.add_argument('--simavr', default='simavr')
+  parser.add_argument('--mcu', default='atmega2560')
+  parser.add_argument('--frequency', type=int, default=16000000)
+  parser.add_argument(
+      '--timeout',
+      type=float,
+      default=300,
+      help='Seconds to allow simavr to run before giving up.')
+  args = parser.parse_args(argv[1:])
+
+  with tempfile.TemporaryDirectory() as output_dir:
+    elf = args.elf or compile_sketch(args.fqbn, output_dir)
+    output = run_simavr(args.simavr, args.mcu, args.frequency, elf,
+                        args.timeout)
+  results = parse_output(output)
+  if not results.cycles:
+    print(output)
+    print('No results found in the output of simavr', file=sys.stderr)
+    return 1
+  print(format_report(results, args.frequency))
+  return 0 if results.done else 1
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv))
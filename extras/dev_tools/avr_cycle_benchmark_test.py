@@ -0,0 +1,63 @@
+"""Tests for avr_cycle_benchmark."""
+
+from absl import flags
+
+import avr_cycle_benchmark
+import absltest
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string(
+    name='vmodule',
+    required=False,
+    default='',
+    help='Ignored; defined just to be ignored if provided to all tests.')
+
+OUTPUT = '''Loaded 12345 bytes of Flash data at 0
+BENCH_OVERHEAD\t20
+BENCH\tget_temperature\tdecode\t16000
+BENCH\tget_temperature\tjson\t8000
+..BENCH\tget_temperature\tresponse\t32000
+BENCH\tliterals\tprint\t1600
+BENCH\tmalformed
+BENCH_DONE
+simavr: sleeping with interrupts off, quitting gracefully
+'''
+
+
+class AvrCycleBenchmarkTest(absltest.TestCase):
+
+  def test_parse_output(self):
+    results = avr_cycle_benchmark.parse_output(OUTPUT)
+    self.assertEqual(results.overhead, 20)
+    self.assertTrue(results.done)
+    self.assertEqual(list(results.cycles), ['get_temperature', 'literals'])
+    self.assertEqual(
+        dict(results.cycles['get_temperature']), {
+            'decode': 16000,
+            'json': 8000,
+            'response': 32000,
+        })
+    self.assertEqual(dict(results.cycles['literals']), {'print': 1600})
+
+  def test_incomplete_output(self):
+    results = avr_cycle_benchmark.parse_output('BENCH\ta\tdecode\t1\n')
+    self.assertFalse(results.done)
+    self.assertIsNone(results.overhead)
+    report = avr_cycle_benchmark.format_report(results, 16000000)
+    self.assertIn('incomplete', report)
+
+  def test_format_report(self):
+    results = avr_cycle_benchmark.parse_output(OUTPUT)
+    report = avr_cycle_benchmark.format_report(results, 16000000)
+    lines = report.splitlines()
+    self.assertIn('20 cycles', lines[0])
+    self.assertEqual(lines[2].split(),
+                     ['get_temperature', 'decode', '16000', '1000.0'])
+    self.assertEqual(lines[4].split(),
+                     ['get_temperature', 'response', '32000', '2000.0'])
+    self.assertNotIn('incomplete', report)
+
+
+if __name__ == '__main__':
+  absltest.main()
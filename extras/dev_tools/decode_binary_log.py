@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""Decode the output of TAS_VLOG when TAS_ENABLE_BINARY_LOGGING is non-zero.
+
+Usage:
+
+  decode_binary_log.py LOG_FILE SOURCE_FILE_OR_DIR...
+
+LOG_FILE is the captured output of the device (e.g. from the serial port), or
+'-' for stdin. The source files (or directories, searched recursively for C++
+source files) must be those from which the firmware was built, else the
+decoded messages will be misleading.
+
+The record format is described in src/utils/binary_log_sink.h. Bytes outside
+of records (e.g. the text of TAS_CHECK failures) are copied to the output
+unchanged.
+"""
+
+import ast
+import dataclasses
+import os
+import struct
+import sys
+from typing import BinaryIO, Dict, Generator, List, Optional, Sequence, Tuple, Union
+
+import add_flashstr
+import tokenize_cpp
+
+EToken = tokenize_cpp.EToken
+Group = tokenize_cpp.Group
+Token = tokenize_cpp.Token
+TokenOrGroup = Union[Token, Group]
+
+# These values must match those in binary_log_sink.h.
+RECORD_START = 0x1E
+RECORD_END = 0x00
+FIELD_UNSIGNED = 1
+FIELD_SIGNED = 2
+FIELD_CHAR = 3
+FIELD_FLOAT = 4
+FIELD_FLASH_STRING = 5
+FIELD_POINTER = 6
+FIELD_TEXT = 7
+FIELD_BASE = 8
+
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+CPP_SOURCE_EXTENSIONS = ('.c', '.cc', '.cpp', '.h', '.hpp', '.ino')
+
+
+def file_id(path: str) -> int:
+  """Returns the id of the file, matching binary_log::FileId."""
+  h = FNV_OFFSET_BASIS
+  for b in os.path.basename(path).encode('utf-8'):
+    h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+  return (h >> 16) ^ (h & 0xFFFF)
+
+
+@dataclasses.dataclass()
+class LogStatement:
+  """A TAS_VLOG statement found in a source file."""
+  basename: str
+  line_number: int
+  # For each operand of operator<<, the text of the string literal if the
+  # operand is a (possibly TAS_FLASHSTR wrapped) string literal, else None.
+  literals: List[Optional[str]]
+
+
+StatementTable = Dict[Tuple[int, int], LogStatement]
+
+
+def split_operands(
+    grouped_tokens: List[TokenOrGroup]) -> List[List[TokenOrGroup]]:
+  """Splits the tokens after TAS_VLOG(level) at the top-level << operators."""
+  operands: List[List[TokenOrGroup]] = []
+  for elem in grouped_tokens:
+    if isinstance(elem, Token) and elem.kind == EToken.SEMICOLON:
+      break
+    if isinstance(elem, Token) and elem.kind == EToken.OP_SHIFT_LEFT:
+      operands.append([])
+    elif operands:
+      operands[-1].append(elem)
+  return operands
+
+
+def string_literal_text(operand: List[TokenOrGroup]) -> Optional[str]:
+  """Returns the text of the operand if it is a string literal, else None."""
+  if (len(operand) == 2 and isinstance(operand[0], Token) and
+      operand[0].kind == EToken.IDENTIFIER and
+      operand[0].src in ('TAS_FLASHSTR', 'FLASHSTR', 'F') and
+      isinstance(operand[1], Group)):
+    operand = operand[1].nested
+  if not operand:
+    return None
+  parts = []
+  for elem in operand:
+    # Adjacent string literals are concatenated by the compiler.
+    if not isinstance(elem, Token) or elem.kind != EToken.STRING:
+      return None
+    try:
+      parts.append(ast.literal_eval(elem.src))
+    except (SyntaxError, ValueError):
+      return None
+  return ''.join(parts)
+
+
+def find_log_statements(file_path: str,
+                        raw_source: str = '') -> Generator[LogStatement, None,
+                                                           None]:
+  """Yields the TAS_VLOG statements in the file."""
+  cpp_source = tokenize_cpp.CppSource(
+      file_path=file_path, raw_source=raw_source)
+  basename = os.path.basename(file_path)
+  for lst in add_flashstr.find_tas_stream_statements(
+      cpp_source.grouped_cpp_tokens):
+    keyword = lst[0]
+    if keyword.src != 'TAS_VLOG' or len(lst) < 2 or not isinstance(
+        lst[1], Group):
+      continue
+    # __LINE__ in the expansion of TAS_VLOG is that of the macro name.
+    line_number = cpp_source.raw_source.count('\n', 0, keyword.raw_start) + 1
+    literals = [string_literal_text(op) for op in split_operands(lst[2:])]
+    yield LogStatement(
+        basename=basename, line_number=line_number, literals=literals)
+
+
+def generate_source_files(paths: Sequence[str]) -> Generator[str, None, None]:
+  for path in paths:
+    if not os.path.isdir(path):
+      yield path
+      continue
+    for dir_path, _, file_names in os.walk(path):
+      for file_name in sorted(file_names):
+        if file_name.endswith(CPP_SOURCE_EXTENSIONS):
+          yield os.path.join(dir_path, file_name)
+
+
+def make_statement_table(paths: Sequence[str]) -> StatementTable:
+  """Returns a map from (file id, line number) to the statement there."""
+  table: StatementTable = {}
+  for file_path in generate_source_files(paths):
+    for statement in find_log_statements(file_path):
+      key = (file_id(statement.basename), statement.line_number)
+      if key in table and table[key].basename != statement.basename:
+        print(
+            f'Warning: {statement.basename} and {table[key].basename} have the '
+            'same file id',
+            file=sys.stderr)
+      table[key] = statement
+  return table
+
+
+class RecordReader(object):
+  """Reads the fields of a record from a bytes object."""
+
+  def __init__(self, data: bytes, pos: int):
+    self.data = data
+    self.pos = pos
+
+  def byte(self) -> int:
+    if self.pos >= len(self.data):
+      raise EOFError()
+    b = self.data[self.pos]
+    self.pos += 1
+    return b
+
+  def uint16(self) -> int:
+    lo = self.byte()
+    return lo | (self.byte() << 8)
+
+  def varint(self) -> int:
+    value = 0
+    shift = 0
+    while True:
+      b = self.byte()
+      value |= (b & 0x7F) << shift
+      shift += 7
+      if b < 0x80:
+        return value
+
+  def zigzag(self) -> int:
+    v = self.varint()
+    return (v >> 1) ^ -(v & 1)
+
+  def float32(self) -> float:
+    raw = bytes(self.byte() for _ in range(4))
+    return struct.unpack('<f', raw)[0]
+
+  def text(self) -> str:
+    end = self.data.find(b'\0', self.pos)
+    if end < 0:
+      raise EOFError()
+    s = self.data[self.pos:end].decode('utf-8', errors='backslashreplace')
+    self.pos = end + 1
+    return s
+
+
+def format_integer(value: int, base: int) -> str:
+  """Formats value as OPrintStream does."""
+  if base == 16:
+    return f'0x{value & 0xFFFFFFFF:X}'
+  if base == 2:
+    return f'0b{value & 0xFFFFFFFF:b}'
+  return str(value)
+
+
+def decode_record(reader: RecordReader, table: StatementTable) -> str:
+  """Returns the text of the record whose header starts at reader.pos."""
+  fid = reader.uint16()
+  line_number = reader.uint16()
+  statement = table.get((fid, line_number))
+  if statement:
+    parts = [f'{statement.basename}:{line_number}] ']
+  else:
+    parts = [f'<unknown file 0x{fid:04X}>:{line_number}] ']
+  base = 10
+  operand_ndx = 0
+  while True:
+    tag = reader.byte()
+    if tag == RECORD_END:
+      break
+    if tag == FIELD_UNSIGNED:
+      parts.append(format_integer(reader.varint(), base))
+    elif tag == FIELD_SIGNED:
+      parts.append(format_integer(reader.zigzag(), base))
+    elif tag == FIELD_CHAR:
+      parts.append(chr(reader.byte()))
+    elif tag == FIELD_FLOAT:
+      parts.append(f'{reader.float32():.2f}')
+    elif tag == FIELD_FLASH_STRING:
+      address = reader.varint()
+      literal = None
+      if statement and operand_ndx < len(statement.literals):
+        literal = statement.literals[operand_ndx]
+      parts.append(literal if literal is not None else f'<flash@0x{address:X}>')
+    elif tag == FIELD_POINTER:
+      parts.append(f'0x{reader.varint():X}')
+    elif tag == FIELD_TEXT:
+      parts.append(reader.text())
+    elif tag == FIELD_BASE:
+      base = reader.byte()
+    else:
+      raise ValueError(f'Unknown field tag {tag} at offset {reader.pos - 1}')
+    operand_ndx += 1
+  return ''.join(parts)
+
+
+def decode_log(data: bytes, table: StatementTable) -> str:
+  """Returns the text of the log, with the records decoded."""
+  parts: List[str] = []
+  pos = 0
+  while pos < len(data):
+    start = data.find(bytes([RECORD_START]), pos)
+    if start < 0:
+      start = len(data)
+    if pos < start:
+      parts.append(data[pos:start].decode('utf-8', errors='backslashreplace'))
+    if start >= len(data):
+      break
+    reader = RecordReader(data, start + 1)
+    try:
+      parts.append(decode_record(reader, table))
+      parts.append('\n')
+      pos = reader.pos
+    except EOFError:
+      parts.append('<truncated record>\n')
+      break
+    except ValueError as e:
+      # Probably not a record; skip the start byte and keep going.
+      parts.append(f'<{e}>\n')
+      pos = start + 1
+  return ''.join(parts)
+
+
+def read_log(path: str) -> bytes:
+  if path == '-':
+    stdin: BinaryIO = sys.stdin.buffer
+    return stdin.read()
+  with open(path, mode='rb') as f:
+    return f.read()
+
+
+def main(argv: Sequence[str]) -> None:
+  if len(argv) < 3:
+    print(__doc__, file=sys.stderr)
+    sys.exit(1)
+  table = make_statement_table(argv[2:])
+  sys.stdout.write(decode_log(read_log(argv[1]), table))
+
+
+if __name__ == '__main__':
+  main(sys.argv)
+  sys.stdout.flush()
@@ -0,0 +1,90 @@
+"""Tests for decode_binary_log."""
+
+from absl import flags
+
+import decode_binary_log
+import absltest
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string(
+    name='vmodule',
+    required=False,
+    default='',
+    help='Ignored; defined just to be ignored if provided to all tests.')
+
+SOURCE = r'''
+void Foo(int a) {
+  TAS_VLOG(1) << TAS_FLASHSTR("a=") << a << TAS_FLASHSTR(", ") << BaseHex
+              << a;
+  TAS_CHECK(a > 0) << TAS_FLASHSTR("a is ") << a;
+  TAS_VLOG(2) << "text" << name << TAS_FLASHSTR("b" "c")
+              << 'x' << this;
+}
+'''
+
+
+def make_table():
+  table = {}
+  for statement in decode_binary_log.find_log_statements(
+      'some/dir/foo.cpp', raw_source=SOURCE):
+    table[(decode_binary_log.file_id(statement.basename),
+           statement.line_number)] = statement
+  return table
+
+
+def record(line_number: int, fields: bytes) -> bytes:
+  fid = decode_binary_log.file_id('foo.cpp')
+  return (bytes([0x1E, fid & 0xFF, fid >> 8, line_number & 0xFF,
+                 line_number >> 8]) + fields + b'\0')
+
+
+class DecodeBinaryLogTest(absltest.TestCase):
+
+  def test_file_id(self):
+    # Must match the values in binary_log_sink_test.cc.
+    self.assertEqual(decode_binary_log.file_id('foo.cpp'), 0x5050)
+    self.assertEqual(decode_binary_log.file_id('/a/b/c/foo.cpp'), 0x5050)
+    self.assertNotEqual(decode_binary_log.file_id('bar.cpp'), 0x5050)
+
+  def test_find_log_statements(self):
+    statements = list(
+        decode_binary_log.find_log_statements(
+            'some/dir/foo.cpp', raw_source=SOURCE))
+    self.assertLen(statements, 2)
+    self.assertEqual(statements[0].basename, 'foo.cpp')
+    self.assertEqual(statements[0].line_number, 3)
+    self.assertEqual(statements[0].literals, ['a=', None, ', ', None, None])
+    self.assertEqual(statements[1].line_number, 6)
+    self.assertEqual(statements[1].literals, ['text', None, 'bc', None, None])
+
+  def test_decode_log(self):
+    table = make_table()
+    data = (
+        b'before\n' +
+        record(3, b'\x05\x10' + b'\x02\x01' + b'\x05\x20' + b'\x08\x10' +
+               b'\x02\xAC\x02') +
+        record(6, b'\x07text\0' + b'\x07Bob\0' + b'\x05\x80\x01' + b'\x03x' +
+               b'\x06\xFF\x01') + b'after\n')
+    self.assertEqual(
+        decode_binary_log.decode_log(data, table), 'before\n'
+        'foo.cpp:3] a=-1, 0x96\n'
+        'foo.cpp:6] textBobbcx0xFF\n'
+        'after\n')
+
+  def test_unknown_statement(self):
+    data = record(99, b'\x05\x10\x01\x07\x04\x00\x00\x80\x3F')
+    fid = decode_binary_log.file_id('foo.cpp')
+    self.assertEqual(
+        decode_binary_log.decode_log(data, {}),
+        f'<unknown file 0x{fid:04X}>:99] <flash@0x10>71.00\n')
+
+  def test_truncated_record(self):
+    data = record(3, b'\x05\x10')[:-2]
+    self.assertEqual(
+        decode_binary_log.decode_log(data, make_table()),
+        '<truncated record>\n')
+
+
+if __name__ == '__main__':
+  absltest.main()
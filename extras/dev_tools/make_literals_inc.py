@@ -1,53 +1,267 @@
 #!/usr/bin/env python3
-"""Update literals.inc with literals defined in other files.
+"""Generates literals_pool.inc from literals.inc.
 
-And determine which literals are actually in use, flag for removal.
+Usage:
 
-NOT YET IMPLEMENTED AS DESCRIBED ABOVE.
+  make_literals_inc.py [LITERALS_INC [LITERALS_POOL_INC]]
+
+The defaults are src/literals.inc and src/literals_pool.inc, relative to the
+root of the repository.
+
+literals.inc remains the list of built-in literals to be edited by hand. This
+program packs the strings of those literals into a single string (the pool),
+in which each literal is stored only once, and in which a literal that is a
+substring of another (e.g. "action" in "supportedactions", or "HTTP/1.1" in
+"HTTP/1.1 200 OK") is not stored separately at all. Where no such containment
+exists, the literals are ordered so that the end of one overlaps the start of
+the next as much as possible (i.e. a greedy approximation of the shortest
+common superstring). The output looks like this:
+
+  TAS_LITERALS_POOL("..."
+                    "...")
+  TAS_LITERALS_POOL_ENTRY(action, 1234, 6)
+  ...
+
+There is one entry per literal, in the order of literals.inc, giving the
+offset and length of the literal in the pool; literals.h and literals.cpp
+define those macros to produce the ELiteral enum and a table indexed by it.
+The static_asserts in literals.cpp fail if literals.inc has changed since
+literals_pool.inc was generated.
 """
 
+import ast
+import dataclasses
+import os
+import re
 import sys
-import typing
-from typing import Generator, List, Union
-
-import tokenize_cpp
-
-EToken = tokenize_cpp.EToken
-Group = tokenize_cpp.Group
-Replacement = tokenize_cpp.Replacement
-Token = tokenize_cpp.Token
-TokenOrGroup = Union[Token, Group]
-
-
-def process_source_file(file_path: str) -> None:
-  """Reads a C++ source file and prints its logging statements."""
-  print()
-  print('#' * 80)
-  print('Finding TAS logging statements in file', file_path, flush=True)
-  print()
-
-  all_replacements = []
-  cpp_source = tokenize_cpp.CppSource(file_path=file_path)
-  # for lst in find_tas_stream_statements(cpp_source.grouped_cpp_tokens):
-  #   replacements = list(generate_add_flashstr(lst))
-  #   if not replacements:
-  #     continue
-  #   tokenize_cpp.dump_grouped_tokens(lst)
-  #   print()
-  #   print(tokenize_cpp.stringify_token_groups(lst))
-  #   print()
-  #   print(replacements)
-  #   all_replacements.extend(replacements)
-  #   print(flush=True)
-  # if all_replacements:
-  #   print(f'Applying {len(all_replacements)} replacements')
-  #   cpp_source.edit_raw_source(all_replacements)
-  #   cpp_source.update_file()
-
-
-def main(argv: List[str]):
-  for arg in argv[1:]:
-    process_source_file(arg)
+from typing import Dict, List, Sequence, Tuple
+
+# Matches the tokens of literals.inc that we care about. Comments and
+# preprocessor lines (including their continuation lines) are matched so that
+# they can be skipped.
+TOKEN_RE = re.compile(
+    r'''
+    (?P<comment>//[^\n]*|/\*.*?\*/)
+  | (?P<directive>^[ \t]*\#(?:[^\n\\]|\\.)*)
+  | (?P<string>"(?:[^"\\\n]|\\.)*")
+  | (?P<literal1>\bTAS_DEFINE_BUILTIN_LITERAL1\b)
+  | (?P<literal>\bTAS_DEFINE_BUILTIN_LITERAL\b)
+  | (?P<identifier>\b[A-Za-z_][A-Za-z_0-9]*\b)
+  | (?P<punct>[(),])
+  | (?P<space>\s+)
+  | (?P<other>.)
+    ''', re.VERBOSE | re.MULTILINE | re.DOTALL)
+
+# Maximum length of a Literal (see Literal::kMaxSize).
+MAX_LITERAL_SIZE = 255
+
+# Maximum offset that can be stored in the uint16_t offset field.
+MAX_POOL_SIZE = 65535
+
+# Maximum width of the lines of the string literal of the pool.
+POOL_LINE_WIDTH = 72
+
+
+@dataclasses.dataclass()
+class LiteralDefinition:
+  name: str
+  value: str
+
+
+@dataclasses.dataclass()
+class LiteralsPool:
+  text: str
+  # Offset and length of each literal, in the order of the definitions.
+  entries: List[Tuple[str, int, int]]
+
+
+def parse_literals_inc(source: str) -> List[LiteralDefinition]:
+  """Returns the literals defined by the source of literals.inc."""
+  tokens: List[Tuple[str, str]] = []
+  for m in TOKEN_RE.finditer(source):
+    kind = m.lastgroup
+    if kind in ('comment', 'directive', 'space'):
+      continue
+    tokens.append((kind, m.group()))
+
+  result: List[LiteralDefinition] = []
+  ndx = 0
+
+  def expect(kind: str, text: str = '') -> str:
+    nonlocal ndx
+    if ndx >= len(tokens):
+      raise ValueError(f'Expected {kind} {text}, found end of input')
+    actual_kind, actual_text = tokens[ndx]
+    if actual_kind != kind or (text and actual_text != text):
+      raise ValueError(f'Expected {kind} {text}, found {actual_text!r}')
+    ndx += 1
+    return actual_text
+
+  while ndx < len(tokens):
+    kind, _ = tokens[ndx]
+    ndx += 1
+    if kind == 'literal1':
+      expect('punct', '(')
+      name = expect('identifier')
+      expect('punct', ')')
+      result.append(LiteralDefinition(name=name, value=name))
+    elif kind == 'literal':
+      expect('punct', '(')
+      name = expect('identifier')
+      expect('punct', ',')
+      value = ''
+      # Adjacent string literals are concatenated.
+      value += ast.literal_eval(expect('string'))
+      while ndx < len(tokens) and tokens[ndx][0] == 'string':
+        value += ast.literal_eval(expect('string'))
+      expect('punct', ')')
+      result.append(LiteralDefinition(name=name, value=value))
+
+  names = set()
+  for definition in result:
+    if definition.name in names:
+      raise ValueError(f'Literal {definition.name} is defined more than once')
+    names.add(definition.name)
+    if len(definition.value) > MAX_LITERAL_SIZE:
+      raise ValueError(f'Literal {definition.name} is too long')
+  return result
+
+
+def overlap(a: str, b: str) -> int:
+  """Returns the length of the longest suffix of a that is a prefix of b."""
+  for length in range(min(len(a), len(b)) - 1, 0, -1):
+    if a.endswith(b[:length]):
+      return length
+  return 0
+
+
+def make_superstring(values: Sequence[str]) -> str:
+  """Returns a string which contains all of the values as substrings."""
+  # Remove duplicates and values contained by other values, keeping the order
+  # of the first appearance so that the output is deterministic.
+  unique: List[str] = []
+  for value in values:
+    if value and value not in unique:
+      unique.append(value)
+  kept = [
+      a for a in unique
+      if not any(a != b and a in b for b in unique)
+  ]
+
+  # Greedily join the pairs of strings with the largest overlap, where a
+  # string may be followed by at most one string, and preceded by at most one,
+  # and where the joins do not form a cycle.
+  pairs = []
+  for i, a in enumerate(kept):
+    for j, b in enumerate(kept):
+      if i != j:
+        length = overlap(a, b)
+        if length:
+          pairs.append((-length, i, j))
+  pairs.sort()
+
+  successor: Dict[int, Tuple[int, int]] = {}
+  has_predecessor = set()
+  chain_head = list(range(len(kept)))
+
+  def find_head(i: int) -> int:
+    while chain_head[i] != i:
+      i = chain_head[i]
+    return i
+
+  for negative_length, i, j in pairs:
+    if i in successor or j in has_predecessor:
+      continue
+    if find_head(i) == find_head(j):
+      continue  # Would form a cycle.
+    successor[i] = (j, -negative_length)
+    has_predecessor.add(j)
+    chain_head[j] = find_head(i)
+
+  parts: List[str] = []
+  for i in range(len(kept)):
+    if i in has_predecessor:
+      continue
+    parts.append(kept[i])
+    while i in successor:
+      i, length = successor[i]
+      parts.append(kept[i][length:])
+  return ''.join(parts)
+
+
+def make_pool(definitions: Sequence[LiteralDefinition]) -> LiteralsPool:
+  text = make_superstring([d.value for d in definitions])
+  if len(text) > MAX_POOL_SIZE:
+    raise ValueError(f'The pool is too large ({len(text)} bytes)')
+  entries = []
+  for d in definitions:
+    entries.append((d.name, text.index(d.value), len(d.value)))
+  return LiteralsPool(text=text, entries=entries)
+
+
+def escape_char(c: str) -> str:
+  if c in ('"', '\\'):
+    return '\\' + c
+  if c == '\n':
+    return '\\n'
+  if c == '\r':
+    return '\\r'
+  if c == '\t':
+    return '\\t'
+  if ' ' <= c <= '~':
+    return c
+  # Use octal rather than hex because a hex escape would swallow any following
+  # hex digits.
+  return '\\%03o' % ord(c)
+
+
+def format_pool_inc(pool: LiteralsPool, source_name: str) -> str:
+  """Returns the contents of literals_pool.inc."""
+  total = sum(length for _, _, length in pool.entries)
+  lines = [
+      f'// GENERATED FILE; DO NOT EDIT. Generated from {source_name} by',
+      '// extras/dev_tools/make_literals_inc.py.',
+      '//',
+      f'// {len(pool.entries)} literals with a total of {total} characters are '
+      f'packed',
+      f'// into a pool of {len(pool.text)} characters.',
+      '',
+  ]
+  prefix = 'TAS_LITERALS_POOL('
+  indent = ' ' * len(prefix)
+  current = ''
+  pool_lines = []
+  for c in pool.text:
+    escaped = escape_char(c)
+    if len(current) + len(escaped) + len(indent) + 3 > POOL_LINE_WIDTH:
+      pool_lines.append(current)
+      current = ''
+    current += escaped
+  pool_lines.append(current)
+  for n, text in enumerate(pool_lines):
+    start = prefix if n == 0 else indent
+    end = ')' if n == len(pool_lines) - 1 else ''
+    lines.append(f'{start}"{text}"{end}')
+  lines.append('')
+  for name, offset, length in pool.entries:
+    lines.append(f'TAS_LITERALS_POOL_ENTRY({name}, {offset}, {length})')
+  return '\n'.join(lines) + '\n'
+
+
+def main(argv: List[str]) -> None:
+  root = os.path.dirname(os.path.dirname(os.path.dirname(
+      os.path.abspath(__file__))))
+  input_path = argv[1] if len(argv) > 1 else os.path.join(
+      root, 'src', 'literals.inc')
+  output_path = argv[2] if len(argv) > 2 else os.path.join(
+      os.path.dirname(input_path), 'literals_pool.inc')
+  with open(input_path, 'r') as f:
+    definitions = parse_literals_inc(f.read())
+  pool = make_pool(definitions)
+  with open(output_path, 'w') as f:
+    f.write(format_pool_inc(pool, os.path.basename(input_path)))
+  print(f'Wrote {len(pool.entries)} literals in {len(pool.text)} bytes to',
+        output_path)
 
 
 if __name__ == '__main__':
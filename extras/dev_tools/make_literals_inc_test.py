@@ -0,0 +1,85 @@
+"""Tests for make_literals_inc."""
+
+from absl import flags
+
+import make_literals_inc
+import absltest
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string(
+    name='vmodule',
+    required=False,
+    default='',
+    help='Ignored; defined just to be ignored if provided to all tests.')
+
+SOURCE = r'''
+#define TAS_DEFINE_BUILTIN_LITERAL1(symbol) \
+  TAS_DEFINE_BUILTIN_LITERAL(symbol, #symbol)
+
+TAS_DEFINE_BUILTIN_LITERAL1(action)
+TAS_DEFINE_BUILTIN_LITERAL1(supportedactions)  // Comment (with parens).
+// TAS_DEFINE_BUILTIN_LITERAL1(commented)
+TAS_DEFINE_BUILTIN_LITERAL(HttpEndOfLine, "\r\n")
+TAS_DEFINE_BUILTIN_LITERAL(Joined,
+                           "abc"
+                           "def")
+TAS_DEFINE_BUILTIN_LITERAL(Quoted, "say \"hi\"")
+'''
+
+
+class MakeLiteralsIncTest(absltest.TestCase):
+
+  def test_parse(self):
+    definitions = make_literals_inc.parse_literals_inc(SOURCE)
+    self.assertEqual([(d.name, d.value) for d in definitions], [
+        ('action', 'action'),
+        ('supportedactions', 'supportedactions'),
+        ('HttpEndOfLine', '\r\n'),
+        ('Joined', 'abcdef'),
+        ('Quoted', 'say "hi"'),
+    ])
+
+  def test_parse_rejects_duplicates(self):
+    with self.assertRaises(ValueError):
+      make_literals_inc.parse_literals_inc(
+          'TAS_DEFINE_BUILTIN_LITERAL1(a)\nTAS_DEFINE_BUILTIN_LITERAL(a, "b")')
+
+  def test_overlap(self):
+    self.assertEqual(make_literals_inc.overlap('camera', 'rainrate'), 2)
+    self.assertEqual(make_literals_inc.overlap('abc', 'xyz'), 0)
+    # A string doesn't entirely overlap another.
+    self.assertEqual(make_literals_inc.overlap('abc', 'abc'), 0)
+
+  def test_superstring_shares_substrings_and_overlaps(self):
+    values = ['action', 'supportedactions', 'camera', 'rainrate', 'camera']
+    text = make_literals_inc.make_superstring(values)
+    for value in values:
+      self.assertIn(value, text)
+    self.assertEqual(len(text), len('supportedactions') + len('camerainrate'))
+
+  def test_make_pool(self):
+    definitions = make_literals_inc.parse_literals_inc(SOURCE)
+    pool = make_literals_inc.make_pool(definitions)
+    for definition, (name, offset, length) in zip(definitions, pool.entries):
+      self.assertEqual(definition.name, name)
+      self.assertEqual(pool.text[offset:offset + length], definition.value)
+    action = pool.entries[0]
+    supportedactions = pool.entries[1]
+    self.assertGreaterEqual(action[1], supportedactions[1])
+    self.assertLessEqual(action[1] + action[2],
+                         supportedactions[1] + supportedactions[2])
+
+  def test_format_pool_inc(self):
+    definitions = make_literals_inc.parse_literals_inc(SOURCE)
+    pool = make_literals_inc.make_pool(definitions)
+    output = make_literals_inc.format_pool_inc(pool, 'literals.inc')
+    self.assertIn('TAS_LITERALS_POOL("', output)
+    self.assertIn('\\r\\n', output)
+    self.assertIn('\\"hi\\"', output)
+    self.assertIn('TAS_LITERALS_POOL_ENTRY(Quoted, ', output)
+    self.assertEqual(output.count('TAS_LITERALS_POOL_ENTRY('), 5)
+
+
+if __name__ == '__main__':
+  absltest.main()
@@ -1,5 +1,7 @@
 #include "extras/host/arduino/arduino.h"
 
+#include <chrono>  // NOLINT
+
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 
@@ -7,17 +9,22 @@
 // main() executing, but we don't otherwise have a very tidy means of finding
 // the time this process started. For more interesting approaches, see
 // https://stackoverflow.com/a/2598284.
-static const absl::Time start_time = absl::Now();  // NOLINT
+// We use a steady clock, as on Arduino the time never jumps backwards (other
+// than wrapping around), and so that measurements of durations are not skewed
+// by adjustments to the wall clock.
+static const auto start_time = std::chrono::steady_clock::now();  // NOLINT
 
 uint32_t millis() {
-  auto elapsed = absl::Now() - start_time;
-  auto elapsed_ms = absl::ToInt64Milliseconds(elapsed);
+  auto elapsed = std::chrono::steady_clock::now() - start_time;
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
   return static_cast<uint32_t>(elapsed_ms);
 }
 
 uint32_t micros() {
-  auto elapsed = absl::Now() - start_time;
-  auto elapsed_us = absl::ToInt64Microseconds(elapsed);
+  auto elapsed = std::chrono::steady_clock::now() - start_time;
+  auto elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
   return static_cast<uint32_t>(elapsed_us);
 }
 
@@ -8,6 +8,8 @@
 
 uint8_t pgm_read_byte(const uint8_t* ptr) { return *ptr; }
 
+uint16_t pgm_read_word(const uint16_t* ptr) { return *ptr; }
+
 uint32_t pgm_read_dword_far(const uint32_t* ptr) { return *ptr; }
 
 int memcmp_P(const void* lhs, const void* rhs, size_t count) {
@@ -22,6 +22,7 @@
 #define PSTR(s) ((const PROGMEM char*)(s))
 
 uint8_t pgm_read_byte(const uint8_t* ptr);
+uint16_t pgm_read_word(const uint16_t* ptr);
 uint32_t pgm_read_dword_far(const uint32_t* ptr);
 int memcmp_P(const void* lhs, const void* rhs, size_t count);
 int strncasecmp_P(const char* s1, const char* s2, size_t n);
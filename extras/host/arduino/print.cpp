@@ -51,7 +51,7 @@ size_t printIntegerWithBaseTo(T value, const int base, Print& out) {
 
 Printable::~Printable() {}
 
-Print::Print() {}
+Print::Print() : write_error_(0) {}
 Print::~Print() {}
 
 size_t Print::write(const char* str) {
@@ -15,13 +15,25 @@ uint8_t EthernetClient::status() {
 }
 
 // Write a byte to the stream, returns the number written.
-size_t EthernetClient::write(uint8_t) { return 0; }
+size_t EthernetClient::write(uint8_t b) { return write(&b, 1); }
 
 // Write 'size' bytes from the buffer to the stream, returns the number
 // written. Note that Ethernet3 takes a blocking approach, looping until there
 // are 'size' bytes in the TX buffers available (with 'size' capped to the
 // maximum send size allowed).
-size_t EthernetClient::write(const uint8_t *buf, size_t size) { return 0; }
+size_t EthernetClient::write(const uint8_t *buf, size_t size) {
+  size_t result = 0;
+  while (size > 0) {
+    auto appended = alpaca::HostSockets::AppendToTxBuffer(sock_, buf, size);
+    if (!alpaca::HostSockets::SendTxBuffer(sock_) || appended == 0) {
+      break;
+    }
+    result += appended;
+    buf += appended;
+    size -= appended;
+  }
+  return result;
+}
 
 // Returns the number of bytes available for reading. It may not be possible
 // to read that many bytes in one call to read.
@@ -30,13 +42,21 @@ int EthernetClient::available() {
 }
 
 // Read one byte from the stream.
-int EthernetClient::read() { return 0; }
+int EthernetClient::read() {
+  uint8_t c;
+  if (alpaca::HostSockets::ReadBytes(sock_, &c, 1) == 1) {
+    return c;
+  }
+  return -1;
+}
 
 // Read up to 'size' bytes from the stream, returns the number read.
-int EthernetClient::read(uint8_t *buf, size_t size) { return 0; }
+int EthernetClient::read(uint8_t *buf, size_t size) {
+  return alpaca::HostSockets::ReadBytes(sock_, buf, size);
+}
 
 // Returns the next available byte/
-int EthernetClient::peek() { return 0; }
+int EthernetClient::peek() { return alpaca::HostSockets::PeekByte(sock_); }
 
 void EthernetClient::flush() {}
 void EthernetClient::stop() {}
@@ -0,0 +1,109 @@
+#include "extras/host/ethernet3/host_platform_ethernet.h"
+
+#include "extras/host/ethernet3/ethernet_class.h"
+#include "extras/host/ethernet3/host_sockets.h"
+#include "extras/host/ethernet3/w5500.h"
+
+namespace alpaca {
+
+uint8_t HostPlatformEthernet::SocketStatus(uint8_t sock_num) {
+  return HostSockets::SocketStatus(sock_num);
+}
+
+int HostPlatformEthernet::FindUnusedSocket() {
+  for (int sock_num = 0; sock_num < MAX_SOCK_NUM; ++sock_num) {
+    if (HostSockets::SocketIsClosed(sock_num)) {
+      return sock_num;
+    }
+  }
+  return -1;
+}
+
+bool HostPlatformEthernet::InitializeTcpListenerSocket(uint8_t sock_num,
+                                                       uint16_t tcp_port) {
+  if (HostSockets::InitializeTcpListenerSocket(sock_num, tcp_port)) {
+    EthernetClass::_server_port[sock_num] = tcp_port;
+    return true;
+  }
+  return false;
+}
+
+bool HostPlatformEthernet::SocketIsInTcpConnectionLifecycle(uint8_t sock_num) {
+  switch (SocketStatus(sock_num)) {
+    case SnSR::SYNRECV:
+    case SnSR::ESTABLISHED:
+    case SnSR::CLOSE_WAIT:
+    case SnSR::FIN_WAIT:
+    case SnSR::CLOSING:
+    case SnSR::TIME_WAIT:
+    case SnSR::LAST_ACK:
+    case SnSR::INIT:
+    case SnSR::SYNSENT:
+      return true;
+  }
+  return false;
+}
+
+bool HostPlatformEthernet::SocketIsTcpListener(uint8_t sock_num,
+                                               uint16_t tcp_port) {
+  return HostSockets::IsTcpListener(sock_num, tcp_port);
+}
+
+bool HostPlatformEthernet::SocketIsConnected(uint8_t sock_num) {
+  return HostSockets::IsConnected(sock_num);
+}
+
+bool HostPlatformEthernet::DisconnectSocket(uint8_t sock_num) {
+  return HostSockets::Disconnect(sock_num);
+}
+
+bool HostPlatformEthernet::CloseSocket(uint8_t sock_num) {
+  return HostSockets::CloseSocket(sock_num);
+}
+
+size_t HostPlatformEthernet::AppendToTxBuffer(uint8_t sock_num,
+                                              const uint8_t* buf,
+                                              size_t size) {
+  return HostSockets::AppendToTxBuffer(sock_num, buf, size);
+}
+
+size_t HostPlatformEthernet::TxBufferFreeSize(uint8_t sock_num) {
+  return HostSockets::TxBufferFreeSize(sock_num);
+}
+
+bool HostPlatformEthernet::SendTxBuffer(uint8_t sock_num) {
+  return HostSockets::SendTxBuffer(sock_num);
+}
+
+bool HostPlatformEthernet::IsClientDone(uint8_t sock_num) {
+  return HostSockets::IsClientDone(sock_num);
+}
+
+bool HostPlatformEthernet::IsOpenForWriting(uint8_t sock_num) {
+  return HostSockets::IsOpenForWriting(sock_num);
+}
+
+bool HostPlatformEthernet::SocketIsClosed(uint8_t sock_num) {
+  return HostSockets::SocketIsClosed(sock_num);
+}
+
+bool HostPlatformEthernet::StatusIsOpen(uint8_t status) {
+  return status == SnSR::ESTABLISHED || status == SnSR::CLOSE_WAIT;
+}
+
+bool HostPlatformEthernet::StatusIsHalfOpen(uint8_t status) {
+  return status == SnSR::CLOSE_WAIT;
+}
+
+bool HostPlatformEthernet::StatusIsClosing(uint8_t status) {
+  switch (status) {
+    case SnSR::FIN_WAIT:
+    case SnSR::CLOSING:
+    case SnSR::TIME_WAIT:
+    case SnSR::LAST_ACK:
+      return true;
+  }
+  return false;
+}
+
+}  // namespace alpaca
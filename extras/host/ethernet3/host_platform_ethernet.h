@@ -0,0 +1,42 @@
+#ifndef TINY_ALPACA_SERVER_EXTRAS_HOST_ETHERNET3_HOST_PLATFORM_ETHERNET_H_
+#define TINY_ALPACA_SERVER_EXTRAS_HOST_ETHERNET3_HOST_PLATFORM_ETHERNET_H_
+
+// HostPlatformEthernet implements PlatformEthernetInterface using HostSockets,
+// i.e. the *nix socket API, so that Tiny Alpaca Server can serve real TCP
+// connections when running on a host. To use it:
+//
+//   HostPlatformEthernet platform_ethernet;
+//   PlatformEthernet::SetPlatformEthernetImplementation(&platform_ethernet);
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform_ethernet.h"
+
+namespace alpaca {
+
+class HostPlatformEthernet : public PlatformEthernetInterface {
+ public:
+  uint8_t SocketStatus(uint8_t sock_num) override;
+  int FindUnusedSocket() override;
+  bool InitializeTcpListenerSocket(uint8_t sock_num,
+                                   uint16_t tcp_port) override;
+  bool SocketIsInTcpConnectionLifecycle(uint8_t sock_num) override;
+  bool SocketIsTcpListener(uint8_t sock_num, uint16_t tcp_port) override;
+  bool SocketIsConnected(uint8_t sock_num) override;
+  bool DisconnectSocket(uint8_t sock_num) override;
+  bool CloseSocket(uint8_t sock_num) override;
+  size_t AppendToTxBuffer(uint8_t sock_num, const uint8_t* buf,
+                          size_t size) override;
+  size_t TxBufferFreeSize(uint8_t sock_num) override;
+  bool SendTxBuffer(uint8_t sock_num) override;
+  bool IsClientDone(uint8_t sock_num) override;
+  bool IsOpenForWriting(uint8_t sock_num) override;
+  bool SocketIsClosed(uint8_t sock_num) override;
+  bool StatusIsOpen(uint8_t status) override;
+  bool StatusIsHalfOpen(uint8_t status) override;
+  bool StatusIsClosing(uint8_t status) override;
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_EXTRAS_HOST_ETHERNET3_HOST_PLATFORM_ETHERNET_H_
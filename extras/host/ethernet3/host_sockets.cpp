@@ -5,6 +5,8 @@
 #include <asm-generic/ioctls.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -16,6 +18,7 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <string>
 
 #include "extras/host/ethernet3/w5500.h"
 #include "logging.h"
@@ -25,6 +28,10 @@ namespace alpaca {
 
 namespace {
 
+// The size of each socket's TX buffer when the W5500's 16KB of TX memory is
+// evenly divided amongst its 8 sockets.
+constexpr size_t kTxBufferSize = 2048;
+
 bool set_non_blocking(int fd) {
   int fcntl_return = fcntl(fd, F_GETFL, 0);
   if (fcntl_return < 0) {
@@ -46,6 +53,56 @@ bool set_non_blocking(int fd) {
   return true;
 }
 
+// Returns a listening socket for tcp_port, shared by all of the HostSocketInfo
+// instances listening for connections to that port, or -1 if unable to create
+// one. Sharing the listener means that closing an emulated socket (which the
+// W5500 does when it accepts a connection) doesn't reset connections that the
+// kernel has queued but not yet handed out. The listener is left open for the
+// life of the process.
+int GetSharedListenerSocket(uint16_t tcp_port) {
+  static auto* listeners = new std::map<uint16_t, int>();
+  auto iter = listeners->find(tcp_port);
+  if (iter != listeners->end()) {
+    return iter->second;
+  }
+  int listener_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (listener_socket < 0) {
+    LOG(ERROR) << "Unable to create listener for port " << tcp_port;
+    return -1;
+  }
+  int value = 1;
+  socklen_t len = sizeof(value);
+  if (::setsockopt(listener_socket, SOL_SOCKET, SO_REUSEADDR, &value, len) <
+      0) {
+    LOG(ERROR) << "Unable to set REUSEADDR for port " << tcp_port;
+    ::close(listener_socket);
+    return -1;
+  }
+  sockaddr_in addr;
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(tcp_port);
+  if (::bind(listener_socket, reinterpret_cast<sockaddr*>(&addr),
+             sizeof addr) < 0) {
+    auto error_number = errno;
+    LOG(ERROR) << "Unable to bind listener to INADDR_ANY:" << tcp_port
+               << ", error message: " << std::strerror(error_number);
+    ::close(listener_socket);
+    return -1;
+  }
+  if (!set_non_blocking(listener_socket)) {
+    LOG(ERROR) << "Unable to make listener non-blocking for port " << tcp_port;
+    ::close(listener_socket);
+    return -1;
+  }
+  if (::listen(listener_socket, 64) < 0) {
+    ::close(listener_socket);
+    return -1;
+  }
+  (*listeners)[tcp_port] = listener_socket;
+  return listener_socket;
+}
+
 struct HostSocketInfo {
   explicit HostSocketInfo(int socket_number) : sock_num(socket_number) {
     VLOG(1) << "Create HostSocketInfo for socket " << sock_num;
@@ -55,6 +112,10 @@ struct HostSocketInfo {
     if (connection_socket >= 0) {
       VLOG(1) << "Disconnecting connection (" << connection_socket
               << ") for socket " << sock_num;
+      // Even if shutdown fails (e.g. because the peer has reset the
+      // connection), we're done with the connection, as is the W5500 after a
+      // DISCON command.
+      is_disconnecting = true;
       if (::shutdown(connection_socket, SHUT_WR) == 0) {
         return true;
       }
@@ -62,7 +123,34 @@ struct HostSocketInfo {
     return false;
   }
 
+  // After DisconnectConnectionSocket, the W5500 waits for the peer to close
+  // its end of the connection (FIN_WAIT), discarding any data received
+  // meanwhile. Returns true once the peer has closed the connection (or reset
+  // it), at which point the connection socket has been closed.
+  bool FinishDisconnect() {
+    DCHECK(is_disconnecting);
+    uint8_t discard[256];
+    while (true) {
+      const auto ret = recv(connection_socket, discard, sizeof discard,
+                            MSG_DONTWAIT);
+      const auto error_number = errno;
+      if (ret > 0) {
+        continue;
+      } else if (ret < 0 && error_number == EINTR) {
+        continue;
+      } else if (ret < 0 &&
+                 (error_number == EAGAIN || error_number == EWOULDBLOCK)) {
+        return false;
+      }
+      // Either the peer has closed its end, or there was an error.
+      CloseConnectionSocket();
+      return true;
+    }
+  }
+
   void CloseConnectionSocket() {
+    tx_buffer.clear();
+    is_disconnecting = false;
     if (connection_socket >= 0) {
       VLOG(1) << "Closing connection (" << connection_socket << ") for socket "
               << sock_num;
@@ -71,11 +159,11 @@ struct HostSocketInfo {
     connection_socket = -1;
   }
 
+  // The listener is shared with other sockets, so we just stop using it.
   void CloseListenerSocket() {
     if (listener_socket >= 0) {
-      VLOG(1) << "Closing listener (" << connection_socket << ") for socket "
+      VLOG(1) << "Closing listener (" << listener_socket << ") for socket "
               << sock_num;
-      ::close(listener_socket);
     }
     listener_socket = -1;
     tcp_port = 0;
@@ -93,42 +181,14 @@ struct HostSocketInfo {
       }
       CloseListenerSocket();
     }
-    listener_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    listener_socket = GetSharedListenerSocket(new_tcp_port);
     if (listener_socket < 0) {
-      LOG(ERROR) << "Unable to create listener for socket " << sock_num;
-      return false;
-    }
-    int value = 1;
-    socklen_t len = sizeof(value);
-    if (::setsockopt(listener_socket, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT,
-                     &value, len) < 0) {
-      LOG(ERROR) << "Unable to set REUSEADDR for socket " << sock_num;
-      CloseListenerSocket();
-      return false;
-    }
-    sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(new_tcp_port);
-    if (::bind(listener_socket, reinterpret_cast<sockaddr*>(&addr),
-               sizeof addr) < 0) {
-      auto error_number = errno;
-      LOG(ERROR) << "Unable to set bind socket " << sock_num
-                 << " to INADDR_ANY:" << new_tcp_port
-                 << ", error message: " << std::strerror(error_number);
-      CloseListenerSocket();
-      return false;
-    }
-    if (!set_non_blocking(listener_socket)) {
-      LOG(ERROR) << "Unable to make listener non-blocking for socket "
-                 << sock_num;
-      return false;
-    }
-    if (::listen(listener_socket, 9) < 0) {
-      CloseListenerSocket();
+      LOG(ERROR) << "Unable to listen to port " << new_tcp_port
+                 << " for socket " << sock_num;
       return false;
     }
     tcp_port = new_tcp_port;
+    is_new_listener = true;
     VLOG(1) << "Socket " << sock_num << " (fd " << listener_socket
             << ") is now listening for connections to port " << tcp_port;
     return true;
@@ -145,10 +205,17 @@ struct HostSocketInfo {
       if (connection_socket >= 0) {
         VLOG(1) << "Accepted a connection for socket " << sock_num
                 << " with fd " << connection_socket;
-        if (!set_non_blocking(listener_socket)) {
+        if (!set_non_blocking(connection_socket)) {
           LOG(WARNING) << "Unable to make connection non-blocking for socket "
                        << sock_num;
         }
+        // The W5500 sends a segment as soon as it gets a SEND command, so
+        // disable Nagle's algorithm to match.
+        int value = 1;
+        if (::setsockopt(connection_socket, IPPROTO_TCP, TCP_NODELAY, &value,
+                         sizeof value) < 0) {
+          LOG(WARNING) << "Unable to set TCP_NODELAY for socket " << sock_num;
+        }
         // The W5500 doesn't keep track of that fact that the socket used to be
         // listening, so to be a better emulation of its behavior, we now close
         // the listener socket, and will re-open it later if requested.
@@ -211,12 +278,20 @@ struct HostSocketInfo {
     } else {
       // See if we can peek at the next byte.
       char c;
-      return 0 == recv(connection_socket, &c, 1, MSG_PEEK);
+      return 0 == recv(connection_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
     }
   }
 
   bool IsConnected() { return connection_socket >= 0; }
 
+  bool IsOpenForWriting() {
+    return connection_socket >= 0 && !is_disconnecting;
+  }
+
+  bool IsTcpListener(uint16_t port) {
+    return listener_socket >= 0 && connection_socket < 0 && tcp_port == port;
+  }
+
   bool IsClosed() { return listener_socket < 0 && connection_socket < 0; }
 
   bool IsUnused() {
@@ -237,10 +312,109 @@ struct HostSocketInfo {
     return 0;
   }
 
+  int ReceiveBytes(uint8_t* buf, size_t size, int flags) {
+    if (connection_socket < 0 || size == 0) {
+      return -1;
+    }
+    while (true) {
+      const auto ret =
+          recv(connection_socket, buf, size, flags | MSG_DONTWAIT);
+      const auto error_number = errno;
+      DVLOG(1) << "recv(" << size << ") -> " << ret;
+      if (ret > 0) {
+        return ret;
+      } else if (ret < 0 && error_number == EINTR) {
+        // We were interrupted, so try again.
+        continue;
+      } else if (ret < 0 && error_number != EAGAIN &&
+                 error_number != EWOULDBLOCK) {
+        LOG(WARNING) << "ReceiveBytes: got errno " << error_number
+                     << " from recv, " << std::strerror(error_number);
+      }
+      // Either there is no data available now (EAGAIN), or the peer has
+      // shutdown the connection for writing (ret == 0), or there was some
+      // other error.
+      return -1;
+    }
+  }
+
+  size_t AppendToTxBuffer(const uint8_t* buf, size_t size) {
+    if (connection_socket < 0) {
+      return 0;
+    }
+    size = std::min(size, kTxBufferSize - tx_buffer.size());
+    tx_buffer.append(reinterpret_cast<const char*>(buf), size);
+    return size;
+  }
+
+  size_t TxBufferFreeSize() {
+    if (connection_socket < 0) {
+      return 0;
+    }
+    size_t free_size = kTxBufferSize - tx_buffer.size();
+    int send_buffer_size = 0;
+    socklen_t option_len = sizeof send_buffer_size;
+    int queued = 0;
+    if (getsockopt(connection_socket, SOL_SOCKET, SO_SNDBUF, &send_buffer_size,
+                   &option_len) == 0 &&
+        ioctl(connection_socket, TIOCOUTQ, &queued) == 0) {
+      // Note that the kernel doubles the requested SO_SNDBUF size to allow for
+      // bookkeeping overhead, so this is an overestimate; that is OK as the
+      // emulated TX buffer is much smaller.
+      const size_t kernel_free =
+          send_buffer_size > queued ? send_buffer_size - queued : 0;
+      free_size = std::min(free_size, kernel_free);
+    }
+    return free_size;
+  }
+
+  bool SendTxBuffer() {
+    if (connection_socket < 0) {
+      tx_buffer.clear();
+      return false;
+    }
+    size_t offset = 0;
+    while (offset < tx_buffer.size()) {
+      const auto ret =
+          send(connection_socket, tx_buffer.data() + offset,
+               tx_buffer.size() - offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+      const auto error_number = errno;
+      DVLOG(1) << "send(" << (tx_buffer.size() - offset) << ") -> " << ret;
+      if (ret > 0) {
+        offset += ret;
+      } else if (ret < 0 &&
+                 (error_number == EAGAIN || error_number == EWOULDBLOCK)) {
+        // The kernel's buffer is full, so wait for room, as the W5500 would
+        // wait for the peer to acknowledge the data.
+        pollfd pfd{connection_socket, POLLOUT, 0};
+        ::poll(&pfd, 1, 100);
+      } else if (ret < 0 && error_number == EINTR) {
+        continue;
+      } else {
+        LOG(WARNING) << "SendTxBuffer: got errno " << error_number
+                     << " from send, " << std::strerror(error_number);
+        tx_buffer.clear();
+        return false;
+      }
+    }
+    tx_buffer.clear();
+    return true;
+  }
+
   const int sock_num;
   int listener_socket = -1;
   int connection_socket = -1;
   uint16_t tcp_port = 0;
+
+  // True after DisconnectConnectionSocket, until the connection is closed.
+  bool is_disconnecting = false;
+
+  // True after InitializeTcpListener, until the next status check.
+  bool is_new_listener = false;
+
+  // Emulates the socket's TX buffer in the W5500, i.e. data which has been
+  // written by the application but not yet sent.
+  std::string tx_buffer;
 };
 
 HostSocketInfo* GetHostSocketInfo(int sock_num) {
@@ -323,7 +497,25 @@ bool HostSockets::IsClientDone(int sock_num) {
 bool HostSockets::IsOpenForWriting(int sock_num) {
   auto* info = GetHostSocketInfo(sock_num);
   if (info != nullptr) {
-    return info->IsConnectionHalfClosed();
+    return info->IsOpenForWriting();
+  }
+  return false;
+}
+
+bool HostSockets::IsTcpListener(int sock_num, uint16_t tcp_port) {
+  auto* info = GetHostSocketInfo(sock_num);
+  if (info != nullptr) {
+    return info->IsTcpListener(tcp_port);
+  }
+  return false;
+}
+
+bool HostSockets::CloseSocket(int sock_num) {
+  auto* info = GetHostSocketInfo(sock_num);
+  if (info != nullptr) {
+    info->CloseConnectionSocket();
+    info->CloseListenerSocket();
+    return true;
   }
   return false;
 }
@@ -340,7 +532,10 @@ uint8_t HostSockets::SocketStatus(int sock_num) {
   auto* info = GetHostSocketInfo(sock_num);
   if (info != nullptr && !info->IsUnused()) {
     if (info->connection_socket >= 0) {
-      if (info->CanReadFromConnection()) {
+      if (info->is_disconnecting) {
+        // We skip the W5500's brief TIME_WAIT and LAST_ACK states.
+        return info->FinishDisconnect() ? SnSR::CLOSED : SnSR::FIN_WAIT;
+      } else if (info->CanReadFromConnection()) {
         VLOG(1) << "CanReadFromConnection -> true";
         return SnSR::ESTABLISHED;
       } else if (info->IsConnectionHalfClosed()) {
@@ -348,7 +543,12 @@ uint8_t HostSockets::SocketStatus(int sock_num) {
         return SnSR::CLOSE_WAIT;
       }
     } else if (info->listener_socket >= 0) {
-      if (info->AcceptConnection()) {
+      if (info->is_new_listener) {
+        // The W5500 can't have received a SYN in the instant since it was told
+        // to listen, and ServerSocket::BeginListening relies on this.
+        info->is_new_listener = false;
+        return SnSR::LISTEN;
+      } else if (info->AcceptConnection()) {
         return SnSR::ESTABLISHED;
       } else {
         return SnSR::LISTEN;
@@ -369,4 +569,52 @@ int HostSockets::AvailableBytes(int sock_num) {
   }
 }
 
+int HostSockets::ReadBytes(int sock_num, uint8_t* buf, size_t size) {
+  auto* info = GetHostSocketInfo(sock_num);
+  if (info != nullptr) {
+    return info->ReceiveBytes(buf, size, 0);
+  } else {
+    return -1;
+  }
+}
+
+int HostSockets::PeekByte(int sock_num) {
+  auto* info = GetHostSocketInfo(sock_num);
+  if (info != nullptr) {
+    uint8_t c;
+    if (info->ReceiveBytes(&c, 1, MSG_PEEK) == 1) {
+      return c;
+    }
+  }
+  return -1;
+}
+
+size_t HostSockets::AppendToTxBuffer(int sock_num, const uint8_t* buf,
+                                     size_t size) {
+  auto* info = GetHostSocketInfo(sock_num);
+  if (info != nullptr) {
+    return info->AppendToTxBuffer(buf, size);
+  } else {
+    return 0;
+  }
+}
+
+size_t HostSockets::TxBufferFreeSize(int sock_num) {
+  auto* info = GetHostSocketInfo(sock_num);
+  if (info != nullptr) {
+    return info->TxBufferFreeSize();
+  } else {
+    return 0;
+  }
+}
+
+bool HostSockets::SendTxBuffer(int sock_num) {
+  auto* info = GetHostSocketInfo(sock_num);
+  if (info != nullptr) {
+    return info->SendTxBuffer();
+  } else {
+    return false;
+  }
+}
+
 }  // namespace alpaca
@@ -11,6 +11,8 @@
 // by EthernetClient, then using Ethernet3/src/EthernetClient.* (approximately)
 // as is.
 
+#include <stddef.h>
+
 #include "extras/host/ethernet3/ethernet_config.h"
 
 namespace alpaca {
@@ -33,9 +35,18 @@ struct HostSockets {
   // Returns true if socket 'sock_num' is connected to a peer.
   static bool IsConnected(int sock_num);
 
-  // Tell the peer that we're done writing to the connection.
+  // Returns true if socket 'sock_num' is listening for connections to
+  // 'tcp_port', and isn't connected to a peer.
+  static bool IsTcpListener(int sock_num, uint16_t tcp_port);
+
+  // Tell the peer that we're done writing to the connection. The socket status
+  // is FIN_WAIT until the peer closes the connection, and then CLOSED.
   static bool Disconnect(int sock_num);
 
+  // Closes the connection (if any), without waiting for the peer, and stops
+  // listening for connections.
+  static bool CloseSocket(int sock_num);
+
   // SnSR::CLOSE_WAIT && no data available to read.
   static bool IsClientDone(int sock_num);
 
@@ -53,6 +64,32 @@ struct HostSockets {
   // Returns the number of bytes available for reading, or 0 if there is an
   // error reading that info.
   static int AvailableBytes(int sock_num);
+
+  // Reads up to 'size' bytes that are already available for reading, without
+  // blocking. Returns the number of bytes read, or -1 if there were none
+  // available (or there was an error reading). This is the host equivalent of
+  // a single burst transfer from the W5500's RX buffer.
+  static int ReadBytes(int sock_num, uint8_t* buf, size_t size);
+
+  // Returns the next byte available for reading, without consuming it, or -1 if
+  // there is none.
+  static int PeekByte(int sock_num);
+
+  // Appends up to 'size' bytes to the emulated TX buffer of the socket, limited
+  // by the free space in that buffer. Returns the number of bytes appended.
+  // Nothing is sent to the peer until SendTxBuffer is called.
+  static size_t AppendToTxBuffer(int sock_num, const uint8_t* buf, size_t size);
+
+  // Returns the number of bytes that can be appended to the emulated TX buffer
+  // and then sent without waiting, i.e. limited by the free space in both the
+  // emulated TX buffer and the kernel's send buffer.
+  static size_t TxBufferFreeSize(int sock_num);
+
+  // Sends the contents of the emulated TX buffer to the peer with a single
+  // write (i.e. so that a small response becomes a single TCP segment),
+  // waiting until all of it has been accepted by the kernel. Returns false if
+  // unable to send all of it.
+  static bool SendTxBuffer(int sock_num);
 };
 }  // namespace alpaca
 
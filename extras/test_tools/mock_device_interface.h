@@ -16,6 +16,9 @@ class MockDeviceInterface : public DeviceInterface {
 
   MOCK_METHOD(uint32_t, device_number, (), (const, override));
 
+  MOCK_METHOD(void, SetTaskScheduler, (class alpaca::TaskScheduler &),
+              (override));
+
   MOCK_METHOD(void, Initialize, (), (override));
 
   MOCK_METHOD(void, MaintainDevice, (), (override));
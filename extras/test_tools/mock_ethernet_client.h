@@ -6,6 +6,8 @@
 
 class MockEthernetClient : public EthernetClient {
  public:
+  MockEthernetClient() : EthernetClient(0) {}
+
   MOCK_METHOD(int, connect, (class IPAddress, uint16_t), (override));
 
   MOCK_METHOD(int, connect, (const char *, uint16_t), (override));
@@ -11,6 +11,10 @@ class MockSocketListener : public SocketListener {
  public:
   MOCK_METHOD(void, OnCanRead, (class alpaca::Connection &), (override));
 
+  MOCK_METHOD(void, OnCanWrite, (class alpaca::Connection &), (override));
+
+  MOCK_METHOD(bool, HasPendingOutput, (), (override));
+
   MOCK_METHOD(void, OnHalfClosed, (class alpaca::Connection &), (override));
 
   MOCK_METHOD(void, OnDisconnect, (), (override));
@@ -20,6 +24,10 @@ class MockServerSocketListener : public ServerSocketListener {
  public:
   MOCK_METHOD(void, OnCanRead, (class alpaca::Connection &), (override));
 
+  MOCK_METHOD(void, OnCanWrite, (class alpaca::Connection &), (override));
+
+  MOCK_METHOD(bool, HasPendingOutput, (), (override));
+
   MOCK_METHOD(void, OnHalfClosed, (class alpaca::Connection &), (override));
 
   MOCK_METHOD(void, OnDisconnect, (), (override));
@@ -0,0 +1,43 @@
+#ifndef TINY_ALPACA_SERVER_EXTRAS_TEST_TOOLS_MOCK_SWITCH_INTERFACE_H_
+#define TINY_ALPACA_SERVER_EXTRAS_TEST_TOOLS_MOCK_SWITCH_INTERFACE_H_
+
+// Mock of a single switch, i.e. of SwitchInterface.
+
+#include "device_types/switch/switch_interface.h"
+#include "googletest/gmock.h"
+
+namespace alpaca {
+namespace test {
+
+class MockSwitchInterface : public SwitchInterface {
+ public:
+  MOCK_METHOD(bool, HandleGetSwitchDescription,
+              (const struct AlpacaRequest &, class Print &), (override));
+
+  MOCK_METHOD(bool, HandleGetSwitchName,
+              (const struct AlpacaRequest &, class Print &), (override));
+
+  MOCK_METHOD(bool, HandleSetSwitchName,
+              (const struct AlpacaRequest &, class Print &), (override));
+
+  MOCK_METHOD(bool, GetCanWrite, (), (override));
+
+  MOCK_METHOD(StatusOr<bool>, GetSwitch, (), (override));
+
+  MOCK_METHOD(StatusOr<double>, GetSwitchValue, (), (override));
+
+  MOCK_METHOD(double, GetMinSwitchValue, (), (override));
+
+  MOCK_METHOD(double, GetMaxSwitchValue, (), (override));
+
+  MOCK_METHOD(double, GetSwitchStep, (), (override));
+
+  MOCK_METHOD(class Status, SetSwitch, (bool), (override));
+
+  MOCK_METHOD(class Status, SetSwitchValue, (double), (override));
+};
+
+}  // namespace test
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_EXTRAS_TEST_TOOLS_MOCK_SWITCH_INTERFACE_H_
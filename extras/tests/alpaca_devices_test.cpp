@@ -16,6 +16,7 @@ namespace {
 
 using ::testing::EndsWith;
 using ::testing::HasSubstr;
+using ::testing::InSequence;
 using ::testing::IsEmpty;
 using ::testing::NiceMock;
 using ::testing::Not;
@@ -145,6 +146,20 @@ TEST_F(AlpacaDevicesTest, Initialize) {
   EXPECT_TRUE(alpaca_devices_.Initialize());
 }
 
+TEST_F(AlpacaDevicesTest, InitializeProvidesTaskScheduler) {
+  InSequence seq;
+  EXPECT_CALL(mock_camera0_,
+              SetTaskScheduler(Ref(alpaca_devices_.task_scheduler())));
+  EXPECT_CALL(mock_camera0_, Initialize);
+  EXPECT_CALL(mock_camera22_,
+              SetTaskScheduler(Ref(alpaca_devices_.task_scheduler())));
+  EXPECT_CALL(mock_camera22_, Initialize);
+  EXPECT_CALL(mock_observing_conditions1_,
+              SetTaskScheduler(Ref(alpaca_devices_.task_scheduler())));
+  EXPECT_CALL(mock_observing_conditions1_, Initialize);
+  EXPECT_TRUE(alpaca_devices_.Initialize());
+}
+
 TEST_F(AlpacaDevicesTest, MaintainDevices) {
   EXPECT_CALL(mock_camera0_, MaintainDevice);
   EXPECT_CALL(mock_camera22_, MaintainDevice);
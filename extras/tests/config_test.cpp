@@ -17,6 +17,7 @@ TEST(ConfigTest, LogInfo) {
   LOG_MACRO(TAS_ENABLE_EXTRA_REQUEST_PARAMETERS);
   LOG_MACRO(TAS_MAX_EXTRA_REQUEST_PARAMETERS);
   LOG_MACRO(TAS_MAX_EXTRA_REQUEST_PARAMETER_LENGTH);
+  LOG_MACRO(TAS_ENABLE_REQUEST_CAPTURE);
 
 #ifdef TAS_ENABLED_VLOG_LEVEL
   LOG_MACRO(TAS_ENABLED_VLOG_LEVEL);
@@ -0,0 +1,129 @@
+#include "device_types/async_operation.h"
+
+#include <deque>
+
+#include "ascom_error_codes.h"
+#include "googletest/gtest.h"
+#include "utils/status.h"
+#include "utils/status_or.h"
+#include "utils/task_scheduler.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+// Returns the queued step results in order, then kFinished.
+class FakeOperation : public AsyncOperation {
+ public:
+  StatusOr<uint32_t> Step(uint32_t now_millis) override {
+    ++steps;
+    if (results.empty()) {
+      return kFinished;
+    }
+    auto result = results.front();
+    results.pop_front();
+    return result;
+  }
+
+  void OnCancel() override { ++cancels; }
+
+  std::deque<StatusOr<uint32_t>> results;
+  int steps = 0;
+  int cancels = 0;
+};
+
+TEST(AsyncOperationTest, InitiallyIdle) {
+  FakeOperation operation;
+  TaskScheduler scheduler;
+  EXPECT_EQ(operation.state(), EAsyncOperationState::kIdle);
+  EXPECT_FALSE(operation.is_running());
+  EXPECT_FALSE(operation.Cancel(scheduler));
+  EXPECT_EQ(operation.cancels, 0);
+}
+
+TEST(AsyncOperationTest, StepsUntilFinished) {
+  FakeOperation operation;
+  operation.results = {100, 50};
+  TaskScheduler scheduler;
+
+  EXPECT_TRUE(operation.Start(scheduler, 1000).ok());
+  EXPECT_EQ(operation.steps, 1);
+  EXPECT_TRUE(operation.is_running());
+  EXPECT_EQ(scheduler.MillisUntilNextTask(1000), 100);
+
+  scheduler.RunDueTasks(1099);
+  EXPECT_EQ(operation.steps, 1);
+  scheduler.RunDueTasks(1100);
+  EXPECT_EQ(operation.steps, 2);
+  EXPECT_EQ(scheduler.MillisUntilNextTask(1100), 50);
+  scheduler.RunDueTasks(1150);
+  EXPECT_EQ(operation.steps, 3);
+  EXPECT_EQ(operation.state(), EAsyncOperationState::kSucceeded);
+  EXPECT_TRUE(operation.status().ok());
+  EXPECT_FALSE(operation.is_scheduled());
+}
+
+TEST(AsyncOperationTest, FinishesInFirstStep) {
+  FakeOperation operation;
+  TaskScheduler scheduler;
+  EXPECT_TRUE(operation.Start(scheduler, 0).ok());
+  EXPECT_EQ(operation.state(), EAsyncOperationState::kSucceeded);
+  EXPECT_FALSE(operation.is_scheduled());
+}
+
+TEST(AsyncOperationTest, FailsInFirstStep) {
+  FakeOperation operation;
+  operation.results = {ErrorCodes::NotConnected()};
+  TaskScheduler scheduler;
+  EXPECT_EQ(operation.Start(scheduler, 0).code(), ErrorCodes::kNotConnected);
+  EXPECT_TRUE(operation.has_failed());
+  EXPECT_EQ(operation.status().code(), ErrorCodes::kNotConnected);
+  EXPECT_FALSE(operation.is_scheduled());
+}
+
+TEST(AsyncOperationTest, FailsInLaterStep) {
+  FakeOperation operation;
+  operation.results = {10, ErrorCodes::InvalidOperation()};
+  TaskScheduler scheduler;
+  EXPECT_TRUE(operation.Start(scheduler, 0).ok());
+  scheduler.RunDueTasks(10);
+  EXPECT_TRUE(operation.has_failed());
+  EXPECT_EQ(operation.status().code(), ErrorCodes::kInvalidOperation);
+  EXPECT_FALSE(operation.is_scheduled());
+
+  // Starting again clears the error.
+  EXPECT_TRUE(operation.Start(scheduler, 20).ok());
+  EXPECT_EQ(operation.state(), EAsyncOperationState::kSucceeded);
+  EXPECT_TRUE(operation.status().ok());
+}
+
+TEST(AsyncOperationTest, Cancel) {
+  FakeOperation operation;
+  operation.results = {10, 10, 10};
+  TaskScheduler scheduler;
+  EXPECT_TRUE(operation.Start(scheduler, 0).ok());
+  EXPECT_TRUE(operation.Cancel(scheduler));
+  EXPECT_EQ(operation.cancels, 1);
+  EXPECT_EQ(operation.state(), EAsyncOperationState::kCancelled);
+  EXPECT_FALSE(operation.is_scheduled());
+  EXPECT_FALSE(operation.Cancel(scheduler));
+  EXPECT_EQ(operation.cancels, 1);
+  EXPECT_EQ(scheduler.RunDueTasks(100), 0);
+  EXPECT_EQ(operation.steps, 1);
+}
+
+TEST(AsyncOperationTest, RestartCancelsRunningOperation) {
+  FakeOperation operation;
+  operation.results = {10, 10, 10};
+  TaskScheduler scheduler;
+  EXPECT_TRUE(operation.Start(scheduler, 0).ok());
+  EXPECT_TRUE(operation.Start(scheduler, 5).ok());
+  EXPECT_EQ(operation.cancels, 1);
+  EXPECT_EQ(operation.steps, 2);
+  EXPECT_TRUE(operation.is_running());
+  EXPECT_EQ(operation.deadline_millis(), 15);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,283 @@
+#include "device_types/cover_calibrator/cover_calibrator_adapter.h"
+
+#include <string>
+
+#include "alpaca_request.h"
+#include "ascom_error_codes.h"
+#include "constants.h"
+#include "device_info.h"
+#include "device_types/async_operation.h"
+#include "device_types/cover_calibrator/cover_calibrator_constants.h"
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+#include "utils/status.h"
+#include "utils/status_or.h"
+#include "utils/task_scheduler.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+using ::testing::ContainsRegex;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr uint32_t kDeviceNumber = 7;
+constexpr uint32_t kStepMillis = 100;
+
+// Moves the cover 25% per step, towards the target position.
+class FakeCoverMotion : public AsyncOperation {
+ public:
+  StatusOr<uint32_t> Step(uint32_t now_millis) override {
+    if (!fail_status.ok()) {
+      return fail_status;
+    } else if (position == target) {
+      return kFinished;
+    }
+    position += target > position ? 25 : -25;
+    return kStepMillis;
+  }
+
+  void OnCancel() override { ++cancels; }
+
+  int position = 0;
+  int target = 0;
+  int cancels = 0;
+  Status fail_status;
+};
+
+// Increases the brightness by 10 per step, up to the target brightness.
+class FakeCalibratorRamp : public AsyncOperation {
+ public:
+  StatusOr<uint32_t> Step(uint32_t now_millis) override {
+    if (brightness >= target) {
+      brightness = target;
+      return kFinished;
+    }
+    brightness += 10;
+    return kStepMillis;
+  }
+
+  uint32_t brightness = 0;
+  uint32_t target = 0;
+};
+
+class FakeCoverCalibrator : public CoverCalibratorAdapter {
+ public:
+  explicit FakeCoverCalibrator(const DeviceInfo& device_info)
+      : CoverCalibratorAdapter(device_info) {
+    set_cover_operation(&motion_);
+    set_calibrator_operation(&ramp_);
+  }
+
+  StatusOr<int32_t> GetBrightness() override { return ramp_.brightness; }
+  StatusOr<int32_t> GetMaxBrightness() override { return 100; }
+
+  StatusOr<ECalibratorStatus> GetCalibratorState() override {
+    return ramp_.brightness == 0 ? ECalibratorStatus::kOff
+                                 : ECalibratorStatus::kReady;
+  }
+
+  StatusOr<ECoverStatus> GetCoverState() override {
+    if (motion_.position == 0) {
+      return ECoverStatus::kClosed;
+    } else if (motion_.position == 100) {
+      return ECoverStatus::kOpen;
+    }
+    return ECoverStatus::kUnknown;
+  }
+
+  Status SetCalibratorBrightness(uint32_t brightness) override {
+    ramp_.target = brightness;
+    return StartAsyncOperation(ramp_);
+  }
+
+  Status SetCalibratorOff() override {
+    ramp_.brightness = 0;
+    return OkStatus();
+  }
+
+  Status MoveCover(bool open) override {
+    motion_.target = open ? 100 : 0;
+    return StartAsyncOperation(motion_);
+  }
+
+  FakeCoverMotion motion_;
+  FakeCalibratorRamp ramp_;
+};
+
+class CoverCalibratorAdapterTest : public testing::Test {
+ protected:
+  CoverCalibratorAdapterTest() : device_(device_info_) {}
+
+  void SetUp() override {
+    device_.SetTaskScheduler(scheduler_);
+    device_.Initialize();
+  }
+
+  std::string HandleRequest(EHttpMethod http_method,
+                            EDeviceMethod device_method) {
+    AlpacaRequest request;
+    request.Reset();
+    request.http_method = http_method;
+    request.api_group = EApiGroup::kDevice;
+    request.api = EAlpacaApi::kDeviceApi;
+    request.device_type = EDeviceType::kCoverCalibrator;
+    request.device_number = kDeviceNumber;
+    request.device_method = device_method;
+    if (device_method == EDeviceMethod::kCalibratorOn) {
+      request.set_brightness(brightness_);
+    }
+    PrintToStdString out;
+    device_.HandleDeviceApiRequest(request, out);
+    return out.str();
+  }
+
+  std::string Put(EDeviceMethod device_method) {
+    return HandleRequest(EHttpMethod::PUT, device_method);
+  }
+
+  std::string Get(EDeviceMethod device_method) {
+    return HandleRequest(EHttpMethod::GET, device_method);
+  }
+
+  // Performs the scheduled steps, advancing time as needed, until no more
+  // steps are scheduled.
+  void RunToCompletion() {
+    uint32_t now = millis();
+    while (true) {
+      const uint32_t delay = scheduler_.MillisUntilNextTask(now);
+      if (delay == ScheduledTask::kDontReschedule) {
+        return;
+      }
+      now += delay;
+      scheduler_.RunDueTasks(now);
+    }
+  }
+
+  const DeviceInfo device_info_{
+      .device_type = EDeviceType::kCoverCalibrator,
+      .device_number = kDeviceNumber,
+      .name = TASLIT("CoverCalibrator Name"),
+      .unique_id = TASLIT("CoverCalibrator Unique Id"),
+      .description = TASLIT("CoverCalibrator Description"),
+      .driver_info = TASLIT("CoverCalibrator Driver Info"),
+      .driver_version = TASLIT("CoverCalibrator Driver Version"),
+      .supported_actions = {},
+      .interface_version = 1,
+  };
+
+  TaskScheduler scheduler_;
+  FakeCoverCalibrator device_;
+  int32_t brightness_ = 0;
+};
+
+MATCHER_P(HasValue, value, "") {
+  return testing::ExplainMatchResult(
+      ContainsRegex(std::string(R"("Value":\s*)") + std::to_string(value) +
+                    R"([^0-9])"),
+      arg, result_listener);
+}
+
+MATCHER(HasNoError, "") {
+  return testing::ExplainMatchResult(Not(HasSubstr(R"("ErrorNumber":)")), arg,
+                                     result_listener);
+}
+
+TEST_F(CoverCalibratorAdapterTest, OpenCoverReturnsBeforeMoving) {
+  EXPECT_THAT(Get(EDeviceMethod::kCoverState),
+              HasValue(static_cast<int>(ECoverStatus::kClosed)));
+
+  EXPECT_THAT(Put(EDeviceMethod::kOpenCover), HasNoError());
+  // Only the first step has been performed.
+  EXPECT_EQ(device_.motion_.position, 25);
+  EXPECT_THAT(Get(EDeviceMethod::kCoverState),
+              HasValue(static_cast<int>(ECoverStatus::kMoving)));
+
+  RunToCompletion();
+  EXPECT_EQ(device_.motion_.position, 100);
+  EXPECT_THAT(Get(EDeviceMethod::kCoverState),
+              HasValue(static_cast<int>(ECoverStatus::kOpen)));
+}
+
+TEST_F(CoverCalibratorAdapterTest, HaltCoverCancelsMotion) {
+  EXPECT_THAT(Put(EDeviceMethod::kOpenCover), HasNoError());
+  EXPECT_THAT(Put(EDeviceMethod::kHaltCover), HasNoError());
+  EXPECT_EQ(device_.motion_.cancels, 1);
+  RunToCompletion();
+  EXPECT_EQ(device_.motion_.position, 25);
+  EXPECT_THAT(Get(EDeviceMethod::kCoverState),
+              HasValue(static_cast<int>(ECoverStatus::kUnknown)));
+
+  // Halting when not moving is not an error.
+  EXPECT_THAT(Put(EDeviceMethod::kHaltCover), HasNoError());
+  EXPECT_EQ(device_.motion_.cancels, 1);
+}
+
+TEST_F(CoverCalibratorAdapterTest, ReversingTheCover) {
+  EXPECT_THAT(Put(EDeviceMethod::kOpenCover), HasNoError());
+  EXPECT_THAT(Put(EDeviceMethod::kCloseCover), HasNoError());
+  EXPECT_EQ(device_.motion_.position, 0);
+  RunToCompletion();
+  EXPECT_THAT(Get(EDeviceMethod::kCoverState),
+              HasValue(static_cast<int>(ECoverStatus::kClosed)));
+}
+
+TEST_F(CoverCalibratorAdapterTest, FailedMotionIsReported) {
+  EXPECT_THAT(Put(EDeviceMethod::kOpenCover), HasNoError());
+  device_.motion_.fail_status = ErrorCodes::NotConnected();
+  RunToCompletion();
+  EXPECT_THAT(Get(EDeviceMethod::kCoverState),
+              HasValue(static_cast<int>(ECoverStatus::kError)));
+
+  // An error in the first step is returned to the client.
+  EXPECT_THAT(Put(EDeviceMethod::kCloseCover),
+              HasSubstr(R"("ErrorNumber": 1031)"));
+}
+
+TEST_F(CoverCalibratorAdapterTest, CalibratorRampsUp) {
+  EXPECT_THAT(Get(EDeviceMethod::kCalibratorState),
+              HasValue(static_cast<int>(ECalibratorStatus::kOff)));
+  brightness_ = 45;
+  EXPECT_THAT(Put(EDeviceMethod::kCalibratorOn), HasNoError());
+  EXPECT_THAT(Get(EDeviceMethod::kCalibratorState),
+              HasValue(static_cast<int>(ECalibratorStatus::kNotReady)));
+  EXPECT_THAT(Get(EDeviceMethod::kBrightness), HasValue(10));
+
+  RunToCompletion();
+  EXPECT_THAT(Get(EDeviceMethod::kCalibratorState),
+              HasValue(static_cast<int>(ECalibratorStatus::kReady)));
+  EXPECT_THAT(Get(EDeviceMethod::kBrightness), HasValue(45));
+}
+
+TEST_F(CoverCalibratorAdapterTest, CalibratorOffCancelsRamp) {
+  brightness_ = 100;
+  EXPECT_THAT(Put(EDeviceMethod::kCalibratorOn), HasNoError());
+  EXPECT_THAT(Put(EDeviceMethod::kCalibratorOff), HasNoError());
+  RunToCompletion();
+  EXPECT_THAT(Get(EDeviceMethod::kCalibratorState),
+              HasValue(static_cast<int>(ECalibratorStatus::kOff)));
+  EXPECT_THAT(Get(EDeviceMethod::kBrightness), HasValue(0));
+}
+
+TEST(CoverCalibratorAdapterNoSchedulerTest, OperationsRequireScheduler) {
+  const DeviceInfo device_info{
+      .device_type = EDeviceType::kCoverCalibrator,
+      .device_number = kDeviceNumber,
+      .name = TASLIT("CoverCalibrator Name"),
+      .unique_id = TASLIT("CoverCalibrator Unique Id"),
+      .description = TASLIT("CoverCalibrator Description"),
+      .driver_info = TASLIT("CoverCalibrator Driver Info"),
+      .driver_version = TASLIT("CoverCalibrator Driver Version"),
+      .supported_actions = {},
+      .interface_version = 1,
+  };
+  FakeCoverCalibrator device(device_info);
+  EXPECT_EQ(device.MoveCover(true).code(), ErrorCodes::kInvalidOperation);
+  EXPECT_FALSE(device.motion_.is_running());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,250 @@
+#include "device_types/switch/multi_switch_adapter.h"
+
+#include <string>
+
+#include "alpaca_request.h"
+#include "ascom_error_codes.h"
+#include "constants.h"
+#include "device_info.h"
+#include "device_types/switch/switch_interface.h"
+#include "device_types/switch/switch_state_store.h"
+#include "extras/test_tools/mock_switch_interface.h"
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+#include "utils/array_view.h"
+#include "utils/platform.h"
+#include "utils/settings_store.h"
+#include "utils/status.h"
+#include "utils/string_view.h"
+#include "utils/task_scheduler.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+using ::testing::_;
+using ::testing::ContainsRegex;
+using ::testing::HasSubstr;
+using ::testing::Mock;
+using ::testing::Not;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+class MultiSwitchAdapterTest : public testing::Test {
+ protected:
+  MultiSwitchAdapterTest()
+      : switch_pointers_{&toggle_, &dimmer_, &heater_},
+        switches_(switch_pointers_) {
+    // A toggle switch, which can be stored.
+    ON_CALL(toggle_, GetCanWrite).WillByDefault(Return(true));
+    ON_CALL(toggle_, GetSwitch).WillByDefault(Return(false));
+    ON_CALL(toggle_, GetSwitchValue).WillByDefault(Return(0));
+    ON_CALL(toggle_, GetMinSwitchValue).WillByDefault(Return(0));
+    ON_CALL(toggle_, GetMaxSwitchValue).WillByDefault(Return(1));
+    ON_CALL(toggle_, GetSwitchStep).WillByDefault(Return(1));
+    // A multi-state switch with values 0 to 100, which can be stored.
+    ON_CALL(dimmer_, GetCanWrite).WillByDefault(Return(false));
+    ON_CALL(dimmer_, GetSwitch).WillByDefault(Return(true));
+    ON_CALL(dimmer_, GetSwitchValue).WillByDefault(Return(40));
+    ON_CALL(dimmer_, GetMinSwitchValue).WillByDefault(Return(0));
+    ON_CALL(dimmer_, GetMaxSwitchValue).WillByDefault(Return(100));
+    ON_CALL(dimmer_, GetSwitchStep).WillByDefault(Return(1));
+    // A multi-state switch with fractional values, which can't be stored.
+    ON_CALL(heater_, GetCanWrite).WillByDefault(Return(true));
+    ON_CALL(heater_, GetSwitch).WillByDefault(Return(true));
+    ON_CALL(heater_, GetSwitchValue).WillByDefault(Return(0.5));
+    ON_CALL(heater_, GetMinSwitchValue).WillByDefault(Return(0));
+    ON_CALL(heater_, GetMaxSwitchValue).WillByDefault(Return(1));
+    ON_CALL(heater_, GetSwitchStep).WillByDefault(Return(0.25));
+  }
+
+  const DeviceInfo device_info_{
+      .device_type = EDeviceType::kSwitch,
+      .device_number = 0,
+      .name = TASLIT("Switches"),
+      .unique_id = TASLIT("Switches Unique Id"),
+      .description = TASLIT("Switches Description"),
+      .driver_info = TASLIT("Switches Driver Info"),
+      .driver_version = TASLIT("Switches Driver Version"),
+      .supported_actions = {},
+      .interface_version = 1,
+  };
+
+  NiceMock<MockSwitchInterface> toggle_;
+  NiceMock<MockSwitchInterface> dimmer_;
+  NiceMock<MockSwitchInterface> heater_;
+  SwitchInterface* switch_pointers_[3];
+  ArrayView<SwitchInterface*> switches_;
+};
+
+TEST_F(MultiSwitchAdapterTest, WithoutStoreReadsTheSwitches) {
+  MultiSwitchAdapter adapter(device_info_, switches_);
+  adapter.Initialize();
+  EXPECT_EQ(adapter.state_store(), nullptr);
+
+  EXPECT_CALL(dimmer_, GetSwitchValue).WillOnce(Return(41));
+  EXPECT_EQ(adapter.GetSwitchValue(1).value(), 41);
+  EXPECT_CALL(dimmer_, GetCanWrite).WillOnce(Return(false));
+  EXPECT_FALSE(adapter.GetCanWrite(1));
+  adapter.MaintainDevice();
+}
+
+TEST_F(MultiSwitchAdapterTest, ReadsStoredSwitchesFromTheStore) {
+  SwitchStateStore<4> store;
+  MultiSwitchAdapter adapter(device_info_, switches_, &store);
+  adapter.Initialize();
+  EXPECT_EQ(adapter.state_store(), &store);
+  EXPECT_TRUE(store.IsKnown(0));
+  EXPECT_TRUE(store.IsKnown(1));
+  EXPECT_FALSE(store.IsKnown(2));
+
+  for (auto* stored : {&toggle_, &dimmer_}) {
+    EXPECT_CALL(*stored, GetCanWrite).Times(0);
+    EXPECT_CALL(*stored, GetSwitch).Times(0);
+    EXPECT_CALL(*stored, GetSwitchValue).Times(0);
+  }
+  EXPECT_TRUE(adapter.GetCanWrite(0));
+  EXPECT_FALSE(adapter.GetSwitch(0).value());
+  EXPECT_EQ(adapter.GetSwitchValue(0).value(), 0);
+  EXPECT_FALSE(adapter.GetCanWrite(1));
+  EXPECT_TRUE(adapter.GetSwitch(1).value());
+  EXPECT_EQ(adapter.GetSwitchValue(1).value(), 40);
+  Mock::VerifyAndClearExpectations(&toggle_);
+  Mock::VerifyAndClearExpectations(&dimmer_);
+
+  // The switch that can't be stored is read each time.
+  EXPECT_CALL(heater_, GetSwitchValue).WillOnce(Return(0.75));
+  EXPECT_EQ(adapter.GetSwitchValue(2).value(), 0.75);
+}
+
+TEST_F(MultiSwitchAdapterTest, SettingUpdatesTheStore) {
+  SwitchStateStore<3> store;
+  MultiSwitchAdapter adapter(device_info_, switches_, &store);
+  adapter.Initialize();
+  const uint16_t generation = store.generation();
+
+  EXPECT_CALL(toggle_, SetSwitch(true)).WillOnce(Return(OkStatus()));
+  EXPECT_CALL(toggle_, GetSwitch).WillOnce(Return(true));
+  EXPECT_CALL(toggle_, GetSwitchValue).WillOnce(Return(1));
+  EXPECT_TRUE(adapter.SetSwitch(0, true).ok());
+  EXPECT_TRUE(adapter.GetSwitch(0).value());
+  EXPECT_EQ(adapter.GetSwitchValue(0).value(), 1);
+  EXPECT_TRUE(store.HasChangedSince(0, generation));
+  EXPECT_FALSE(store.HasChangedSince(1, generation));
+
+  // A failure is reported, and the switch is re-read anyway.
+  EXPECT_CALL(toggle_, SetSwitchValue(0))
+      .WillOnce(Return(ErrorCodes::NotConnected()));
+  EXPECT_CALL(toggle_, GetSwitch)
+      .WillOnce(Return(ErrorCodes::NotConnected()));
+  EXPECT_FALSE(adapter.SetSwitchValue(0, 0).ok());
+  EXPECT_FALSE(store.IsKnown(0));
+  EXPECT_CALL(toggle_, GetSwitch).WillOnce(Return(true));
+  EXPECT_TRUE(adapter.GetSwitch(0).value());
+}
+
+TEST_F(MultiSwitchAdapterTest, MaintainDeviceRefreshesOneSwitchPerCall) {
+  SwitchStateStore<3> store;
+  MultiSwitchAdapter adapter(device_info_, switches_, &store);
+  adapter.Initialize();
+  const uint16_t generation = store.generation();
+
+  // The dimmer is changed outside of the server.
+  ON_CALL(dimmer_, GetSwitchValue).WillByDefault(Return(75));
+  EXPECT_CALL(toggle_, GetSwitch).Times(1);
+  EXPECT_CALL(dimmer_, GetSwitch).Times(0);
+  adapter.MaintainDevice();
+  Mock::VerifyAndClearExpectations(&toggle_);
+  Mock::VerifyAndClearExpectations(&dimmer_);
+  EXPECT_EQ(adapter.GetSwitchValue(1).value(), 40);
+
+  EXPECT_CALL(toggle_, GetSwitch).Times(0);
+  EXPECT_CALL(dimmer_, GetSwitch).Times(1);
+  adapter.MaintainDevice();
+  Mock::VerifyAndClearExpectations(&toggle_);
+  Mock::VerifyAndClearExpectations(&dimmer_);
+  EXPECT_EQ(adapter.GetSwitchValue(1).value(), 75);
+  EXPECT_FALSE(store.HasChangedSince(0, generation));
+  EXPECT_TRUE(store.HasChangedSince(1, generation));
+
+  // After the last switch, it starts again from the first.
+  adapter.MaintainDevice();
+  EXPECT_CALL(toggle_, GetSwitch).Times(1);
+  adapter.MaintainDevice();
+}
+
+TEST_F(MultiSwitchAdapterTest, SetSwitchNameUsesTheSettingsStore) {
+  constexpr int kEepromAddress = 768;
+  constexpr uint16_t kEepromSize = 128;
+  for (int ndx = 0; ndx < kEepromSize; ++ndx) {
+    EEPROM.write(kEepromAddress + ndx, 0xFF);
+  }
+  SettingsStore<3, 16> name_store(kEepromAddress, kEepromSize);
+  name_store.Initialize();
+  TaskScheduler scheduler;
+  MultiSwitchAdapter adapter(device_info_, switches_);
+  adapter.set_switch_name_store(&name_store, 100);
+  adapter.SetTaskScheduler(scheduler);
+  adapter.Initialize();
+
+  AlpacaRequest request;
+  request.Reset();
+  request.http_method = EHttpMethod::PUT;
+  request.api_group = EApiGroup::kDevice;
+  request.api = EAlpacaApi::kDeviceApi;
+  request.device_type = EDeviceType::kSwitch;
+  request.device_method = EDeviceMethod::kSetSwitchName;
+
+  // The Name parameter is required.
+  EXPECT_CALL(dimmer_, HandleSetSwitchName).Times(0);
+  {
+    PrintToStdString out;
+    EXPECT_FALSE(adapter.HandleSetSwitchName(request, 1, out));
+    EXPECT_THAT(out.str(), HasSubstr("Name"));
+  }
+
+  ASSERT_EQ(request.extra_parameters.insert(EParameter::kName,
+                                            StringView("Fan")),
+            ExtraParameterValueMap::kInserted);
+  {
+    PrintToStdString out;
+    EXPECT_TRUE(adapter.HandleSetSwitchName(request, 1, out));
+    EXPECT_THAT(out.str(), Not(HasSubstr("\"ErrorNumber\":")));
+  }
+  StringView name = name_store.GetString(101);
+  EXPECT_EQ(std::string(name.data(), name.size()), "Fan");
+  // The name is written to the EEPROM by the scheduler.
+  EXPECT_TRUE(name_store.is_scheduled());
+  while (name_store.HasPendingWrites()) {
+    scheduler.RunDueTasks(millis());
+  }
+
+  // The stored name is returned without asking the switch.
+  EXPECT_CALL(dimmer_, HandleGetSwitchName).Times(0);
+  {
+    request.http_method = EHttpMethod::GET;
+    request.device_method = EDeviceMethod::kGetSwitchName;
+    PrintToStdString out;
+    EXPECT_TRUE(adapter.HandleGetSwitchName(request, 1, out));
+    EXPECT_THAT(out.str(), ContainsRegex(R"("Value":\s*"Fan")"));
+  }
+  Mock::VerifyAndClearExpectations(&dimmer_);
+
+  // A switch that hasn't been renamed is asked for its name.
+  EXPECT_CALL(toggle_, HandleGetSwitchName(_, _)).WillOnce(Return(true));
+  {
+    PrintToStdString out;
+    EXPECT_TRUE(adapter.HandleGetSwitchName(request, 0, out));
+  }
+
+  // The name survives a restart.
+  SettingsStore<3, 16> name_store2(kEepromAddress, kEepromSize);
+  name_store2.Initialize();
+  name = name_store2.GetString(101);
+  EXPECT_EQ(std::string(name.data(), name.size()), "Fan");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
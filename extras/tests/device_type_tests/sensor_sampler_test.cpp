@@ -0,0 +1,294 @@
+#include "device_types/observing_conditions/sensor_sampler.h"
+
+#include <atomic>
+#include <map>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "ascom_error_codes.h"
+#include "constants.h"
+#include "googletest/gtest.h"
+#include "utils/array_view.h"
+#include "utils/status.h"
+#include "utils/task_scheduler.h"
+#include "utils/windowed_statistics.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+constexpr uint32_t kMillisPerHour = 3600000;
+
+// Returns the value stored for each sensor, or NotConnected if there is none,
+// and counts the reads.
+class FakeSensorReader : public SensorSampler::SensorReader {
+ public:
+  StatusOr<double> ReadSensor(ESensorName sensor_name) override {
+    ++read_counts[sensor_name];
+    auto iter = values.find(sensor_name);
+    if (iter == values.end()) {
+      return ErrorCodes::NotConnected();
+    }
+    return iter->second;
+  }
+
+  std::map<ESensorName, double> values;
+  std::map<ESensorName, int> read_counts;
+};
+
+TEST(SensorSamplerTest, NoValueBeforeFirstSample) {
+  FakeSensorReader reader;
+  SampledSensor sensors[] = {{ESensorName::kHumidity, 1000}};
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+
+  EXPECT_TRUE(sampler.HasSensor(ESensorName::kHumidity));
+  EXPECT_EQ(sampler.GetValue(ESensorName::kHumidity).status().code(),
+            ErrorCodes::kValueNotSet);
+  EXPECT_EQ(sampler.GetTimeSinceLastUpdate(ESensorName::kHumidity, 0)
+                .status()
+                .code(),
+            ErrorCodes::kValueNotSet);
+}
+
+TEST(SensorSamplerTest, UnsampledSensorsAreNotImplemented) {
+  FakeSensorReader reader;
+  SampledSensor sensors[] = {{ESensorName::kHumidity, 1000}};
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+
+  for (auto sensor_name :
+       {ESensorName::kUnknown, ESensorName::kTemperature,
+        ESensorName::kWindSpeed, static_cast<ESensorName>(200)}) {
+    EXPECT_FALSE(sampler.HasSensor(sensor_name));
+    EXPECT_EQ(sampler.GetValue(sensor_name).status().code(),
+              ErrorCodes::kNotImplemented);
+    EXPECT_EQ(sampler.GetTimeSinceLastUpdate(sensor_name, 0).status().code(),
+              ErrorCodes::kNotImplemented);
+  }
+  sampler.SampleDueSensors(0);
+  EXPECT_EQ(reader.read_counts.size(), 1);
+}
+
+TEST(SensorSamplerTest, EachSensorIsReadOnItsOwnPeriod) {
+  FakeSensorReader reader;
+  reader.values[ESensorName::kRainRate] = 0;
+  reader.values[ESensorName::kSkyTemperature] = -10;
+  SampledSensor sensors[] = {
+      {ESensorName::kRainRate, 1000},
+      {ESensorName::kSkyTemperature, 10000},
+  };
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+
+  // Every sensor is read the first time.
+  const uint32_t start = 12345;
+  sampler.SampleDueSensors(start);
+  EXPECT_EQ(reader.read_counts[ESensorName::kRainRate], 1);
+  EXPECT_EQ(reader.read_counts[ESensorName::kSkyTemperature], 1);
+
+  reader.values[ESensorName::kRainRate] = 10;
+  reader.values[ESensorName::kSkyTemperature] = -11;
+  for (uint32_t now = start; now < start + 10000; now += 100) {
+    sampler.SampleDueSensors(now);
+  }
+  EXPECT_EQ(reader.read_counts[ESensorName::kRainRate], 10);
+  EXPECT_EQ(reader.read_counts[ESensorName::kSkyTemperature], 1);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kRainRate).value(), 10);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kSkyTemperature).value(), -10);
+
+  sampler.SampleDueSensors(start + 10000);
+  EXPECT_EQ(reader.read_counts[ESensorName::kRainRate], 11);
+  EXPECT_EQ(reader.read_counts[ESensorName::kSkyTemperature], 2);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kSkyTemperature).value(), -11);
+}
+
+TEST(SensorSamplerTest, PeriodsSpanMillisWrapAround) {
+  FakeSensorReader reader;
+  reader.values[ESensorName::kPressure] = 1000;
+  SampledSensor sensors[] = {{ESensorName::kPressure, 1000}};
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+
+  const uint32_t start = 0xFFFFFF00;
+  sampler.SampleDueSensors(start);
+  sampler.SampleDueSensors(start + 999);
+  EXPECT_EQ(reader.read_counts[ESensorName::kPressure], 1);
+  sampler.SampleDueSensors(start + 1000);
+  EXPECT_EQ(reader.read_counts[ESensorName::kPressure], 2);
+  EXPECT_DOUBLE_EQ(
+      sampler.GetTimeSinceLastUpdate(ESensorName::kPressure, start + 1360)
+          .value(),
+      0.0001);
+}
+
+TEST(SensorSamplerTest, MillisUntilNextSample) {
+  FakeSensorReader reader;
+  reader.values[ESensorName::kRainRate] = 0;
+  reader.values[ESensorName::kSkyTemperature] = -10;
+  SampledSensor sensors[] = {
+      {ESensorName::kRainRate, 1000},
+      {ESensorName::kSkyTemperature, 10000},
+  };
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+  EXPECT_EQ(sampler.MillisUntilNextSample(0), 0);
+
+  sampler.SampleDueSensors(100);
+  EXPECT_EQ(sampler.MillisUntilNextSample(100), 1000);
+  EXPECT_EQ(sampler.MillisUntilNextSample(1099), 1);
+  EXPECT_EQ(sampler.MillisUntilNextSample(1100), 0);
+  EXPECT_EQ(sampler.MillisUntilNextSample(5000), 0);
+
+  sampler.SampleDueSensors(1100);
+  EXPECT_EQ(sampler.MillisUntilNextSample(1100), 1000);
+
+  SensorSampler no_sensors(reader, ArrayView<SampledSensor>());
+  EXPECT_EQ(no_sensors.MillisUntilNextSample(0),
+            ScheduledTask::kDontReschedule);
+}
+
+TEST(SensorSamplerTest, SamplesWhenRunByTaskScheduler) {
+  FakeSensorReader reader;
+  reader.values[ESensorName::kRainRate] = 0;
+  reader.values[ESensorName::kSkyTemperature] = -10;
+  SampledSensor sensors[] = {
+      {ESensorName::kRainRate, 1000},
+      {ESensorName::kSkyTemperature, 10000},
+  };
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+  TaskScheduler scheduler;
+  scheduler.ScheduleAt(sampler, 0);
+
+  uint32_t task_runs = 0;
+  for (uint32_t now = 0; now < 10000; now += 100) {
+    task_runs += scheduler.RunDueTasks(now);
+  }
+  EXPECT_EQ(task_runs, 10);
+  EXPECT_EQ(reader.read_counts[ESensorName::kRainRate], 10);
+  EXPECT_EQ(reader.read_counts[ESensorName::kSkyTemperature], 1);
+  EXPECT_EQ(scheduler.MillisUntilNextTask(9900), 100);
+  scheduler.Cancel(sampler);
+}
+
+TEST(SensorSamplerTest, FailedReadsAreRetriedAfterThePeriod) {
+  FakeSensorReader reader;
+  SampledSensor sensors[] = {{ESensorName::kSkyQuality, 1000}};
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+
+  sampler.SampleDueSensors(0);
+  sampler.SampleDueSensors(500);
+  EXPECT_EQ(reader.read_counts[ESensorName::kSkyQuality], 1);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kSkyQuality).status().code(),
+            ErrorCodes::kValueNotSet);
+
+  reader.values[ESensorName::kSkyQuality] = 21.5;
+  sampler.SampleDueSensors(1000);
+  EXPECT_EQ(reader.read_counts[ESensorName::kSkyQuality], 2);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kSkyQuality).value(), 21.5);
+
+  // A failed read leaves the previous value in place.
+  reader.values.clear();
+  sampler.SampleDueSensors(2000);
+  EXPECT_EQ(reader.read_counts[ESensorName::kSkyQuality], 3);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kSkyQuality).value(), 21.5);
+  EXPECT_DOUBLE_EQ(
+      sampler.GetTimeSinceLastUpdate(ESensorName::kSkyQuality, 2000).value(),
+      1000.0 / kMillisPerHour);
+}
+
+TEST(SensorSamplerTest, SampleAllReadsEverySensor) {
+  FakeSensorReader reader;
+  reader.values[ESensorName::kDewPoint] = 3;
+  SampledSensor sensors[] = {
+      {ESensorName::kDewPoint, 60000},
+      {ESensorName::kCloudCover, 60000},
+  };
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+
+  EXPECT_EQ(sampler.SampleAll(0).code(), ErrorCodes::kNotConnected);
+  reader.values[ESensorName::kCloudCover] = 50;
+  EXPECT_TRUE(sampler.SampleAll(1).ok());
+  EXPECT_EQ(reader.read_counts[ESensorName::kDewPoint], 2);
+  EXPECT_EQ(reader.read_counts[ESensorName::kCloudCover], 2);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kCloudCover).value(), 50);
+
+  // The periods are restarted.
+  sampler.SampleDueSensors(60000);
+  EXPECT_EQ(reader.read_counts[ESensorName::kDewPoint], 2);
+  sampler.SampleDueSensors(60001);
+  EXPECT_EQ(reader.read_counts[ESensorName::kDewPoint], 3);
+}
+
+TEST(SensorSamplerTest, ReportsAverageOverTheAveragePeriod) {
+  FakeSensorReader reader;
+  WindowedStatistics<4> statistics;
+  SampledSensor sensors[] = {
+      {ESensorName::kTemperature, 1000, &statistics},
+      {ESensorName::kHumidity, 1000},
+  };
+  SensorSampler sampler(reader, ArrayView<SampledSensor>(sensors));
+  sampler.set_average_period_millis(4000);
+  EXPECT_EQ(statistics.window_duration(), 4000);
+
+  reader.values[ESensorName::kTemperature] = 10;
+  reader.values[ESensorName::kHumidity] = 10;
+  sampler.SampleDueSensors(1000);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kTemperature).value(), 10);
+
+  reader.values[ESensorName::kTemperature] = 20;
+  reader.values[ESensorName::kHumidity] = 20;
+  sampler.SampleDueSensors(2000);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kTemperature).value(), 15);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kHumidity).value(), 20);
+
+  // The first reading leaves the window after the average period.
+  sampler.SampleDueSensors(3000);
+  sampler.SampleDueSensors(4000);
+  EXPECT_EQ(statistics.count(), 4);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kTemperature).value(), 17.5);
+  sampler.SampleDueSensors(5000);
+  EXPECT_EQ(statistics.count(), 4);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kTemperature).value(), 20);
+
+  // Without an average period, the latest reading is reported.
+  sampler.set_average_period_millis(0);
+  EXPECT_FALSE(statistics.has_value());
+  reader.values[ESensorName::kTemperature] = 30;
+  sampler.SampleDueSensors(6000);
+  EXPECT_EQ(sampler.GetValue(ESensorName::kTemperature).value(), 30);
+}
+
+// Readers on other threads must always see a value and time written together,
+// never a mix of two writes.
+TEST(SensorSnapshotTest, ConcurrentReadsAreConsistent) {
+  SensorSnapshot snapshot;
+  std::atomic<bool> done(false);
+  std::atomic<int> inconsistent(0);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        double value;
+        uint32_t time_millis;
+        if (snapshot.Read(value, time_millis) &&
+            value != time_millis * 0.5) {
+          ++inconsistent;
+        }
+      }
+    });
+  }
+  for (uint32_t time_millis = 1; time_millis <= 1000000; ++time_millis) {
+    snapshot.Write(time_millis * 0.5, time_millis);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(inconsistent.load(), 0);
+
+  double value;
+  uint32_t time_millis;
+  ASSERT_TRUE(snapshot.Read(value, time_millis));
+  EXPECT_EQ(time_millis, 1000000);
+  EXPECT_EQ(value, 500000);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -4,6 +4,8 @@
 #include <string>
 
 #include "absl/strings/str_cat.h"
+#include "ascom_error_codes.h"
+#include "config.h"
 #include "constants.h"
 #include "extras/test_tools/mock_device_interface.h"
 #include "extras/test_tools/mock_switch_group.h"
@@ -11,6 +13,7 @@
 #include "googletest/gmock.h"
 #include "googletest/gtest.h"
 #include "utils/status.h"
+#include "utils/string_view.h"
 
 namespace alpaca {
 namespace test {
@@ -437,6 +440,174 @@ TEST_F(SwitchGroupTest, SetSwitchValue) {
   EXPECT_THAT(response, Not(HasSubstr(R"("Value":)")));
 }
 
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+
+TEST_F(SwitchGroupTest, SupportedActionsIncludesBatchActions) {
+  request_.device_method = EDeviceMethod::kSupportedActions;
+
+  PrintToStdString out;
+  EXPECT_TRUE(switch_group_.HandleGetRequest(request_, out));
+  const std::string response = out.str();
+  VerifyResponseIsGood(response);
+  EXPECT_THAT(response, ContainsRegex(R"("Value":\s*\[\s*"GetSwitchStates",)"
+                                      R"(\s*"SetSwitchValues"\s*\])"));
+}
+
+TEST_F(SwitchGroupTest, UnknownAction) {
+  request_.http_method = EHttpMethod::PUT;
+  request_.device_method = EDeviceMethod::kAction;
+  request_.extra_parameters.insert(EParameter::kAction, StringView("Foo"));
+
+  PrintToStdString out;
+  switch_group_.HandlePutRequest(request_, out);
+  const std::string response = out.str();
+  VerifyResponseHasError(response);
+  EXPECT_THAT(response, HasSubstr(absl::StrCat(
+                            R"("ErrorNumber": )",
+                            ErrorCodes::kActionNotImplemented)));
+}
+
+TEST_F(SwitchGroupTest, GetSwitchStates) {
+  EXPECT_CALL(switch_group_, GetMaxSwitch).WillRepeatedly(Return(2));
+  EXPECT_CALL(switch_group_, GetCanWrite(0)).WillRepeatedly(Return(true));
+  EXPECT_CALL(switch_group_, GetCanWrite(1)).WillRepeatedly(Return(false));
+  EXPECT_CALL(switch_group_, GetSwitch(0)).WillRepeatedly(Return(true));
+  EXPECT_CALL(switch_group_, GetSwitch(1))
+      .WillRepeatedly(Return(ErrorCodes::NotConnected()));
+  EXPECT_CALL(switch_group_, GetSwitchValue(0)).WillRepeatedly(Return(1));
+  EXPECT_CALL(switch_group_, GetSwitchValue(1))
+      .WillRepeatedly(Return(ErrorCodes::NotConnected()));
+  EXPECT_CALL(switch_group_, GetMinSwitchValue).WillRepeatedly(Return(0));
+  EXPECT_CALL(switch_group_, GetMaxSwitchValue).WillRepeatedly(Return(1));
+  EXPECT_CALL(switch_group_, GetSwitchStep).WillRepeatedly(Return(1));
+
+  request_.http_method = EHttpMethod::PUT;
+  request_.device_method = EDeviceMethod::kAction;
+  request_.extra_parameters.insert(EParameter::kAction,
+                                   StringView("getswitchstates"));
+
+  PrintToStdString out;
+  EXPECT_TRUE(switch_group_.HandlePutRequest(request_, out));
+  const std::string response = out.str();
+  VerifyResponseIsGood(response);
+  EXPECT_THAT(response,
+              HasSubstr(R"("Value": [{"Id": 0, "CanWrite": true, )"
+                        R"("State": true, "Value": 1.00, "Minimum": 0.00, )"
+                        R"("Maximum": 1.00, "Step": 1.00}, )"
+                        R"({"Id": 1, "CanWrite": false, "Minimum": 0.00, )"
+                        R"("Maximum": 1.00, "Step": 1.00}])"));
+}
+
+TEST_F(SwitchGroupTest, SetSwitchValues_MissingParameters) {
+  request_.http_method = EHttpMethod::PUT;
+  request_.device_method = EDeviceMethod::kAction;
+  request_.extra_parameters.insert(EParameter::kAction,
+                                   StringView("SetSwitchValues"));
+
+  PrintToStdString out;
+  switch_group_.HandlePutRequest(request_, out);
+  const std::string response = out.str();
+  VerifyResponseHasError(response);
+  EXPECT_THAT(response,
+              HasSubstr(R"("ErrorMessage": "Missing parameter: Parameters")"));
+}
+
+TEST_F(SwitchGroupTest, SetSwitchValues_InvalidParameters) {
+  EXPECT_CALL(switch_group_, GetMaxSwitch).WillRepeatedly(Return(4));
+  EXPECT_CALL(switch_group_, GetCanWrite).WillRepeatedly(Return(true));
+  EXPECT_CALL(switch_group_, GetMinSwitchValue).WillRepeatedly(Return(0));
+  EXPECT_CALL(switch_group_, GetMaxSwitchValue).WillRepeatedly(Return(1));
+  EXPECT_CALL(switch_group_, SetSwitchValue).Times(0);
+
+  request_.http_method = EHttpMethod::PUT;
+  request_.device_method = EDeviceMethod::kAction;
+  request_.extra_parameters.insert(EParameter::kAction,
+                                   StringView("SetSwitchValues"));
+
+  for (const std::string parameters : {
+           "",         // No switches.
+           "0",        // No value.
+           "0_",       // Empty value.
+           "_1",       // Empty id.
+           "x_1",      // Malformed id.
+           "0_y",      // Malformed value.
+           "4_1",      // Id too high.
+           "0_1_3_2",  // Value too high (later switches are validated too).
+           "0_-0.5",   // Value too low.
+       }) {
+    request_.extra_parameters.clear();
+    request_.extra_parameters.insert(EParameter::kAction,
+                                     StringView("SetSwitchValues"));
+    request_.extra_parameters.insert(
+        EParameter::kParameters,
+        StringView(parameters.data(), parameters.size()));
+
+    PrintToStdString out;
+    switch_group_.HandlePutRequest(request_, out);
+    const std::string response = out.str();
+    VerifyResponseHasError(response);
+    EXPECT_THAT(response,
+                HasSubstr(R"("ErrorMessage": "Invalid parameter: Parameters")"))
+        << "parameters: " << parameters;
+  }
+}
+
+TEST_F(SwitchGroupTest, SetSwitchValues_ReadOnlySwitch) {
+  EXPECT_CALL(switch_group_, GetMaxSwitch).WillRepeatedly(Return(4));
+  EXPECT_CALL(switch_group_, GetCanWrite(0)).WillRepeatedly(Return(true));
+  EXPECT_CALL(switch_group_, GetCanWrite(3)).WillRepeatedly(Return(false));
+  EXPECT_CALL(switch_group_, GetMinSwitchValue).WillRepeatedly(Return(0));
+  EXPECT_CALL(switch_group_, GetMaxSwitchValue).WillRepeatedly(Return(1));
+  EXPECT_CALL(switch_group_, SetSwitchValue).Times(0);
+
+  request_.http_method = EHttpMethod::PUT;
+  request_.device_method = EDeviceMethod::kAction;
+  request_.extra_parameters.insert(EParameter::kAction,
+                                   StringView("SetSwitchValues"));
+  request_.extra_parameters.insert(EParameter::kParameters,
+                                   StringView("0_1_3_0"));
+
+  PrintToStdString out;
+  switch_group_.HandlePutRequest(request_, out);
+  const std::string response = out.str();
+  VerifyResponseHasError(response);
+  EXPECT_THAT(response, HasSubstr(absl::StrCat(R"("ErrorNumber": )",
+                                               ErrorCodes::kNotImplemented)));
+}
+
+TEST_F(SwitchGroupTest, SetSwitchValues) {
+  EXPECT_CALL(switch_group_, GetMaxSwitch).WillRepeatedly(Return(4));
+  EXPECT_CALL(switch_group_, GetCanWrite).WillRepeatedly(Return(true));
+  EXPECT_CALL(switch_group_, GetSwitch).WillRepeatedly(Return(false));
+  EXPECT_CALL(switch_group_, GetSwitchValue).WillRepeatedly(Return(0));
+  EXPECT_CALL(switch_group_, GetMinSwitchValue).WillRepeatedly(Return(0));
+  EXPECT_CALL(switch_group_, GetMaxSwitchValue).WillRepeatedly(Return(1));
+  EXPECT_CALL(switch_group_, GetSwitchStep).WillRepeatedly(Return(0.5));
+  {
+    testing::InSequence seq;
+    EXPECT_CALL(switch_group_, SetSwitchValue(0, 1))
+        .WillOnce(Return(OkStatus()));
+    EXPECT_CALL(switch_group_, SetSwitchValue(3, 0.5))
+        .WillOnce(Return(OkStatus()));
+  }
+
+  request_.http_method = EHttpMethod::PUT;
+  request_.device_method = EDeviceMethod::kAction;
+  request_.extra_parameters.insert(EParameter::kAction,
+                                   StringView("SetSwitchValues"));
+  request_.extra_parameters.insert(EParameter::kParameters,
+                                   StringView("0_1_3_0.5"));
+
+  PrintToStdString out;
+  EXPECT_TRUE(switch_group_.HandlePutRequest(request_, out));
+  const std::string response = out.str();
+  VerifyResponseIsGood(response);
+  EXPECT_THAT(response, HasSubstr(R"("Value": [{"Id": 0, )"));
+  EXPECT_THAT(response, HasSubstr(R"({"Id": 3, )"));
+}
+
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+
 }  // namespace
 }  // namespace test
 }  // namespace alpaca
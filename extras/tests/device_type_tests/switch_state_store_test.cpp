@@ -0,0 +1,115 @@
+#include "device_types/switch/switch_state_store.h"
+
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+TEST(SwitchStateStoreTest, InitiallyUnknown) {
+  SwitchStateStore<10> store;
+  EXPECT_EQ(store.max_switches(), 10);
+  const uint16_t generation = store.generation();
+  for (uint8_t switch_id = 0; switch_id < 10; ++switch_id) {
+    EXPECT_FALSE(store.IsKnown(switch_id));
+    EXPECT_FALSE(store.HasChangedSince(switch_id, generation));
+  }
+  EXPECT_FALSE(store.IsKnown(10));
+}
+
+TEST(SwitchStateStoreTest, StoresEachSwitchSeparately) {
+  SwitchStateStore<17> store;
+  for (uint8_t switch_id = 0; switch_id < 17; ++switch_id) {
+    store.Update(switch_id, switch_id % 2 == 0, switch_id % 3 == 0,
+                 switch_id * 10);
+  }
+  for (uint8_t switch_id = 0; switch_id < 17; ++switch_id) {
+    ASSERT_TRUE(store.IsKnown(switch_id));
+    EXPECT_EQ(store.GetCanWrite(switch_id), switch_id % 2 == 0);
+    EXPECT_EQ(store.GetState(switch_id), switch_id % 3 == 0);
+    EXPECT_EQ(store.GetStepIndex(switch_id), switch_id * 10);
+  }
+  const uint16_t generation = store.generation();
+  store.MarkUnknown(16);
+  EXPECT_FALSE(store.IsKnown(16));
+  EXPECT_TRUE(store.IsKnown(15));
+  EXPECT_EQ(store.generation(), generation + 1);
+}
+
+TEST(SwitchStateStoreTest, OnlyChangesIncrementTheGeneration) {
+  SwitchStateStore<4> store;
+  const uint16_t generation = store.generation();
+  store.Update(1, true, false, 0);
+  EXPECT_EQ(store.generation(), generation + 1);
+  store.Update(1, true, false, 0);
+  EXPECT_EQ(store.generation(), generation + 1);
+  store.Update(1, true, true, 0);
+  EXPECT_EQ(store.generation(), generation + 2);
+  store.Update(1, true, true, 1);
+  EXPECT_EQ(store.generation(), generation + 3);
+  store.Update(1, false, true, 1);
+  EXPECT_EQ(store.generation(), generation + 4);
+  store.MarkUnknown(1);
+  EXPECT_EQ(store.generation(), generation + 5);
+  store.MarkUnknown(1);
+  store.MarkUnknown(2);
+  EXPECT_EQ(store.generation(), generation + 5);
+}
+
+TEST(SwitchStateStoreTest, ChangedSince) {
+  SwitchStateStore<4> store;
+  store.Update(0, true, false, 0);
+  store.Update(1, true, false, 0);
+  store.ClearChanges();
+  const uint16_t generation = store.generation();
+  EXPECT_FALSE(store.HasChangedSince(0, generation));
+  EXPECT_FALSE(store.HasChangedSince(1, generation));
+
+  store.Update(1, true, true, 1);
+  EXPECT_FALSE(store.HasChangedSince(0, generation));
+  EXPECT_TRUE(store.HasChangedSince(1, generation));
+  // The changed bitset doesn't record when a switch changed, so switch 1 may
+  // have changed since any generation after ClearChanges.
+  store.Update(2, true, true, 1);
+  EXPECT_TRUE(store.HasChangedSince(1, generation + 1));
+  EXPECT_TRUE(store.HasChangedSince(2, generation + 1));
+  EXPECT_FALSE(store.HasChangedSince(3, generation + 1));
+  // Nothing has changed since the current generation.
+  EXPECT_FALSE(store.HasChangedSince(1, store.generation()));
+  // Changes before ClearChanges are forgotten, so all switches may have
+  // changed since an earlier generation.
+  EXPECT_TRUE(store.HasChangedSince(0, generation - 1));
+  EXPECT_TRUE(store.HasChangedSince(3, generation - 2));
+
+  store.ClearChanges();
+  EXPECT_FALSE(store.HasChangedSince(1, store.generation()));
+  EXPECT_TRUE(store.HasChangedSince(1, generation));
+}
+
+TEST(SwitchStateStoreTest, GenerationWrapsAround) {
+  SwitchStateStore<1> store;
+  while (store.generation() != 65535) {
+    store.Update(0, true, !store.IsKnown(0) || !store.GetState(0), 0);
+  }
+  store.ClearChanges();
+  store.Update(0, true, !store.GetState(0), 0);
+  EXPECT_EQ(store.generation(), 0);
+  EXPECT_TRUE(store.HasChangedSince(0, 65535));
+  EXPECT_FALSE(store.HasChangedSince(0, 0));
+  EXPECT_TRUE(store.HasChangedSince(0, 65534));
+}
+
+TEST(SwitchStateStoreTest, ResetForgetsState) {
+  SwitchStateStore<3> store;
+  store.Update(2, true, true, 1);
+  const uint16_t generation = store.generation();
+  store.Reset();
+  EXPECT_FALSE(store.IsKnown(2));
+  EXPECT_TRUE(store.HasChangedSince(0, generation));
+  EXPECT_TRUE(store.HasChangedSince(2, generation));
+  EXPECT_FALSE(store.HasChangedSince(2, store.generation()));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
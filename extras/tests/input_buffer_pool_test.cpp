@@ -0,0 +1,53 @@
+#include "input_buffer_pool.h"
+
+// Tests of InputBufferPool.
+//
+// Author: james.synge@gmail.com
+
+#include "config.h"
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+TEST(InputBufferPoolTest, BorrowsEachBufferOnce) {
+  InputBufferPool pool;
+  EXPECT_EQ(pool.available(), TAS_NUM_INPUT_BUFFERS);
+
+  char* buffers[TAS_NUM_INPUT_BUFFERS];
+  for (int ndx = 0; ndx < TAS_NUM_INPUT_BUFFERS; ++ndx) {
+    buffers[ndx] = pool.Borrow();
+    ASSERT_NE(buffers[ndx], nullptr);
+    for (int other = 0; other < ndx; ++other) {
+      EXPECT_NE(buffers[ndx], buffers[other]);
+    }
+    EXPECT_EQ(pool.available(), TAS_NUM_INPUT_BUFFERS - ndx - 1);
+  }
+  EXPECT_EQ(pool.Borrow(), nullptr);
+  EXPECT_EQ(pool.available(), 0);
+
+  for (int ndx = 0; ndx < TAS_NUM_INPUT_BUFFERS; ++ndx) {
+    pool.Return(buffers[ndx]);
+    EXPECT_EQ(pool.available(), ndx + 1);
+  }
+}
+
+TEST(InputBufferPoolTest, ReusesReturnedBuffer) {
+  InputBufferPool pool;
+  char* first = pool.Borrow();
+  ASSERT_NE(first, nullptr);
+  pool.Return(first);
+  EXPECT_EQ(pool.Borrow(), first);
+
+  // The buffer is writable through its full size.
+  for (size_t ndx = 0; ndx < InputBufferPool::kBufferSize; ++ndx) {
+    first[ndx] = static_cast<char>(ndx);
+  }
+  EXPECT_EQ(first[InputBufferPool::kBufferSize - 1],
+            static_cast<char>(InputBufferPool::kBufferSize - 1));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
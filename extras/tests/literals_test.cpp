@@ -1,5 +1,7 @@
 #include "literals.h"
 
+#include <algorithm>
+
 #include "extras/test_tools/string_view_utils.h"
 #include "googletest/gtest.h"
 #include "utils/string_compare.h"
@@ -22,6 +24,29 @@ TEST(LiteralsTest, Basics) {
   EXPECT_EQ(literal1.prog_data_for_tests(), literal2.prog_data_for_tests());
 }
 
+TEST(LiteralsTest, PoolIsSmallerThanTheLiterals) {
+  // The literals are packed into a single pool, in which a literal that is a
+  // substring of another (e.g. "action" in "supportedactions") isn't stored
+  // separately.
+  PGM_P pool_begin = Literals::Get(static_cast<ELiteral>(0)).begin();
+  PGM_P pool_end = pool_begin;
+  size_t total_size = 0;
+  for (uint8_t ndx = 0; ndx < kNumLiterals; ++ndx) {
+    const auto literal = Literals::Get(static_cast<ELiteral>(ndx));
+    pool_begin = std::min(pool_begin, literal.begin());
+    pool_end = std::max(pool_end, literal.end());
+    total_size += literal.size();
+  }
+  EXPECT_LT(pool_end - pool_begin, total_size);
+}
+
+TEST(LiteralsTest, GetByEnum) {
+  EXPECT_EQ(Literals::Get(ELiteral::PUT), StringView("PUT"));
+  EXPECT_EQ(Literals::Get(ELiteral::PUT).prog_data_for_tests(),
+            Literals::PUT().prog_data_for_tests());
+  EXPECT_EQ(Literals::Get(ELiteral::HttpEndOfLine), StringView("\r\n"));
+}
+
 // Generate a trivial test for each Literal in literals.inc.
 
 #ifdef TAS_DEFINE_BUILTIN_LITERAL
@@ -33,6 +58,7 @@ TEST(LiteralsTest, Basics) {
     std::string expected(literal);                  \
     StringView view = MakeStringView(expected);     \
     EXPECT_EQ(Literals::name(), view);              \
+    EXPECT_EQ(Literals::Get(ELiteral::name), view); \
   }
 #include "literals.inc"
 #undef TAS_DEFINE_BUILTIN_LITERAL
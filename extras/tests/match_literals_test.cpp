@@ -43,6 +43,7 @@ TEST(MatchLiteralsTest, EApiGroup) {
       {"api", EApiGroup::kDevice},
       {"management", EApiGroup::kManagement},
       {"setup", EApiGroup::kSetup},
+      {"metrics", EApiGroup::kMetrics},
       {"API", EApiGroup::kUnknown},
       {"managements", EApiGroup::kUnknown},
       {"SetUp", EApiGroup::kUnknown},
@@ -122,6 +123,7 @@ using DeviceMethodTestCases =
 
 void PrependCommonDeviceMethodTestCases(DeviceMethodTestCases& test_cases) {
   const DeviceMethodTestCases kCommonDeviceMethods = {
+      {"action", EDeviceMethod::kAction},
       {"connected", EDeviceMethod::kConnected},
       {"description", EDeviceMethod::kDescription},
       {"driverinfo", EDeviceMethod::kDriverInfo},
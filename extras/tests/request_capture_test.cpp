@@ -0,0 +1,107 @@
+#include "request_capture.h"
+
+// Tests of RequestCapture. The times in the records come from micros(), so the
+// tests only check the time fields indirectly, via their length.
+//
+// Author: james.synge@gmail.com
+
+#include <string>
+
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+// Returns the number of bytes in the varint at the start of str.
+size_t VarintSize(const std::string& str, size_t offset) {
+  size_t size = 1;
+  while (offset < str.size() && (str[offset] & 0x80) != 0) {
+    ++size;
+    ++offset;
+  }
+  return size;
+}
+
+class RequestCaptureTest : public testing::Test {
+ protected:
+  void TearDown() override { RequestCapture::StopCapture(); }
+};
+
+TEST_F(RequestCaptureTest, NoOutputUnlessCapturing) {
+  EXPECT_FALSE(RequestCapture::IsCapturing());
+  RequestCapture::RecordConnect(1);
+  RequestCapture::RecordData(1, "abc", 3);
+  RequestCapture::RecordHalfClosed(1);
+  RequestCapture::RecordDisconnect(1);
+
+  PrintToStdString out;
+  RequestCapture::StartCapture(out);
+  EXPECT_TRUE(RequestCapture::IsCapturing());
+  RequestCapture::StopCapture();
+  EXPECT_FALSE(RequestCapture::IsCapturing());
+  RequestCapture::RecordConnect(1);
+
+  EXPECT_EQ(out.str(), std::string("TASCAP\x01", 7));
+}
+
+TEST_F(RequestCaptureTest, RecordsEvents) {
+  PrintToStdString out;
+  RequestCapture::StartCapture(out);
+  RequestCapture::RecordConnect(2);
+  RequestCapture::RecordData(2, "GET /", 5);
+  RequestCapture::RecordHalfClosed(2);
+  RequestCapture::RecordDisconnect(15);
+  RequestCapture::StopCapture();
+
+  const std::string str = out.str();
+  ASSERT_GE(str.size(), 7);
+  EXPECT_EQ(str.substr(0, 7), std::string("TASCAP\x01", 7));
+
+  size_t offset = 7;
+  ASSERT_LT(offset, str.size());
+  EXPECT_EQ(str[offset], 0x12);
+  offset += 1 + VarintSize(str, offset + 1);
+
+  ASSERT_LT(offset, str.size());
+  EXPECT_EQ(str[offset], 0x22);
+  offset += 1 + VarintSize(str, offset + 1);
+  ASSERT_LT(offset, str.size());
+  EXPECT_EQ(str[offset], 5);
+  EXPECT_EQ(str.substr(offset + 1, 5), "GET /");
+  offset += 6;
+
+  ASSERT_LT(offset, str.size());
+  EXPECT_EQ(str[offset], 0x32);
+  offset += 1 + VarintSize(str, offset + 1);
+
+  ASSERT_LT(offset, str.size());
+  EXPECT_EQ(str[offset], 0x4F);
+  offset += 1 + VarintSize(str, offset + 1);
+
+  EXPECT_EQ(offset, str.size());
+}
+
+TEST_F(RequestCaptureTest, LongDataRecord) {
+  const std::string data(300, 'x');
+  PrintToStdString out;
+  RequestCapture::StartCapture(out);
+  RequestCapture::RecordData(0, data.data(), data.size());
+  RequestCapture::StopCapture();
+
+  const std::string str = out.str();
+  ASSERT_GE(str.size(), 8);
+  EXPECT_EQ(str[7], 0x20);
+  const size_t offset = 8 + VarintSize(str, 8);
+  // 300 is 0b10'0101100, so the varint is 0xAC, 0x02.
+  ASSERT_EQ(str.size(), offset + 2 + data.size());
+  EXPECT_EQ(static_cast<uint8_t>(str[offset]), 0xAC);
+  EXPECT_EQ(str[offset + 1], 0x02);
+  EXPECT_EQ(str.substr(offset + 2), data);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
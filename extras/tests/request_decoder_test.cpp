@@ -434,6 +434,42 @@ TEST(RequestDecoderTest, SmallestServerSetupRequest) {
   }
 }
 
+TEST(RequestDecoderTest, SmallestServerMetricsRequest) {
+  AlpacaRequest alpaca_request;
+  StrictMock<MockRequestDecoderListener> listener;
+  RequestDecoder decoder(alpaca_request, &listener);
+
+  const std::string full_request(
+      "GET /metrics HTTP/1.1\r\n"
+      "\r\n");
+
+  for (auto partition : GenerateMultipleRequestPartitions(full_request)) {
+    auto result = DecodePartitionedRequest(decoder, partition);
+
+    const EHttpStatusCode status = std::get<0>(result);
+    const std::string buffer = std::get<1>(result);
+    const std::string remainder = std::get<2>(result);
+
+    EXPECT_EQ(status, EHttpStatusCode::kHttpOk);
+    EXPECT_THAT(buffer, IsEmpty());
+    EXPECT_THAT(remainder, IsEmpty());
+    EXPECT_EQ(alpaca_request.http_method, EHttpMethod::GET);
+    EXPECT_EQ(alpaca_request.api_group, EApiGroup::kMetrics);
+    EXPECT_EQ(alpaca_request.api, EAlpacaApi::kServerMetrics);
+
+    EXPECT_EQ(alpaca_request.device_type, EDeviceType::kUnknown);
+    EXPECT_EQ(alpaca_request.device_number, kResetDeviceNumber);
+    EXPECT_EQ(alpaca_request.device_method, EDeviceMethod::kUnknown);
+    EXPECT_FALSE(alpaca_request.have_client_id);
+    EXPECT_FALSE(alpaca_request.have_client_transaction_id);
+    EXPECT_EQ(GetNumExtraParameters(alpaca_request), 0);
+
+    if (TestHasFailed()) {
+      break;
+    }
+  }
+}
+
 TEST(RequestDecoderTest, SmallestPutRequest) {
   AlpacaRequest alpaca_request;
   StrictMock<MockRequestDecoderListener> listener;
@@ -1005,6 +1041,8 @@ TEST(RequestDecoderTest, NotFoundPaths) {
            "/management/v1/",
            "/management/v1/description/",
            "/management/v1/other",
+           "/metrics/",
+           "/metrics/v1",
            "/setup/",
            "/setup/v1",
            "/setup/v1/",
@@ -1031,6 +1069,7 @@ TEST(RequestDecoderTest, MethodNotAllowedPaths) {
 
   for (const auto& path : {
            "/management/",
+           "/metrics",
            "/setup",
            "/setup/",
        }) {
@@ -1532,6 +1571,44 @@ TEST(RequestDecoderTest, SwitchRequests) {
   }
 }
 
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+TEST(RequestDecoderTest, SavesActionParameters) {
+  AlpacaRequest alpaca_request;
+  RequestDecoder decoder(alpaca_request, nullptr);
+  const std::string body =
+      "Action=SetSwitchValues&Parameters=0_1_3_0.5&ClientID=7";
+  const std::string full_request = absl::StrCat(
+      "PUT /api/v1/switch/0/action HTTP/1.1\r\n",
+      "Content-Type: application/x-www-form-urlencoded\r\n",
+      "Content-Length: ", body.size(), "\r\n",
+      "\r\n", body);
+
+  for (auto partition : GenerateMultipleRequestPartitions(full_request)) {
+    auto result = DecodePartitionedRequest(decoder, partition);
+    EXPECT_EQ(std::get<0>(result), EHttpStatusCode::kHttpOk);
+    EXPECT_EQ(alpaca_request.device_method, EDeviceMethod::kAction);
+    EXPECT_EQ(alpaca_request.client_id, 7);
+    EXPECT_EQ(GetNumExtraParameters(alpaca_request), 2);
+    EXPECT_EQ(alpaca_request.extra_parameters.find(EParameter::kAction),
+              StringView("SetSwitchValues"));
+    EXPECT_EQ(alpaca_request.extra_parameters.find(EParameter::kParameters),
+              StringView("0_1_3_0.5"));
+    if (TestHasFailed()) {
+      return;
+    }
+  }
+}
+
+TEST(RequestDecoderTest, DetectsDuplicateActionParameter) {
+  AlpacaRequest alpaca_request;
+  RequestDecoder decoder(alpaca_request, nullptr);
+  std::string request(
+      "PUT /api/v1/switch/0/action?Action=a&Action=b HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(ResetAndDecodeFullBuffer(decoder, request),
+            EHttpStatusCode::kHttpBadRequest);
+}
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+
 }  // namespace
 }  // namespace test
 }  // namespace alpaca
@@ -0,0 +1,101 @@
+#include "request_timing.h"
+
+// Tests of RequestTimingHistograms.
+//
+// Author: james.synge@gmail.com
+
+#include "alpaca_request.h"
+#include "constants.h"
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+#include "utils/log2_histogram.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+constexpr uint32_t kUnit = 1 << RequestTimingHistograms::kMicrosShift;
+
+class RequestTimingTest : public testing::Test {
+ protected:
+  void SetUp() override { RequestTimingHistograms::Reset(); }
+};
+
+TEST_F(RequestTimingTest, RecordsManagementRequest) {
+  AlpacaRequest request;
+  request.Reset();
+  request.api = EAlpacaApi::kManagementDescription;
+
+  RequestTimingHistograms::Record(request, 1000, 1000 + kUnit,
+                                  1000 + 3 * kUnit, 1000 + 9 * kUnit);
+
+  const auto& decode = RequestTimingHistograms::ForPhase(ERequestPhase::kDecode);
+  EXPECT_EQ(decode.total_count(), 1);
+  EXPECT_EQ(decode.count(1), 1);
+  const auto& handle = RequestTimingHistograms::ForPhase(ERequestPhase::kHandle);
+  EXPECT_EQ(handle.count(2), 1);
+  const auto& send = RequestTimingHistograms::ForPhase(ERequestPhase::kSend);
+  EXPECT_EQ(send.count(3), 1);
+  const auto& total = RequestTimingHistograms::ForPhase(ERequestPhase::kTotal);
+  EXPECT_EQ(total.count(4), 1);
+
+  const auto& api =
+      RequestTimingHistograms::ForApi(EAlpacaApi::kManagementDescription);
+  EXPECT_EQ(api.count(4), 1);
+  EXPECT_EQ(api.total_count(), 1);
+
+  // Device type histograms are only updated for device API requests.
+  for (uint8_t ndx = 0; ndx <= static_cast<uint8_t>(EDeviceType::kTelescope);
+       ++ndx) {
+    EXPECT_EQ(RequestTimingHistograms::ForDeviceType(
+                  static_cast<EDeviceType>(ndx))
+                  .total_count(),
+              0);
+  }
+}
+
+TEST_F(RequestTimingTest, RecordsDeviceRequestAcrossWrapAround) {
+  AlpacaRequest request;
+  request.Reset();
+  request.api = EAlpacaApi::kDeviceApi;
+  request.device_type = EDeviceType::kSwitch;
+
+  const uint32_t start = 0xFFFFFFFF - kUnit;
+  RequestTimingHistograms::Record(request, start, start + kUnit,
+                                  start + 2 * kUnit, start + 4 * kUnit);
+
+  EXPECT_EQ(RequestTimingHistograms::ForApi(EAlpacaApi::kDeviceApi).count(3),
+            1);
+  EXPECT_EQ(
+      RequestTimingHistograms::ForDeviceType(EDeviceType::kSwitch).count(3), 1);
+  EXPECT_EQ(
+      RequestTimingHistograms::ForDeviceType(EDeviceType::kCamera).total_count(),
+      0);
+}
+
+TEST_F(RequestTimingTest, PrintTo) {
+  {
+    PrintToStdString out;
+    EXPECT_EQ(RequestTimingHistograms::PrintTo(out), 0);
+  }
+
+  AlpacaRequest request;
+  request.Reset();
+  request.api = EAlpacaApi::kDeviceApi;
+  request.device_type = EDeviceType::kSwitch;
+  RequestTimingHistograms::Record(request, 0, 0, 0, kUnit);
+
+  PrintToStdString out;
+  RequestTimingHistograms::PrintTo(out);
+  EXPECT_EQ(out.str(),
+            "phase Decode: 1\n"
+            "phase Handle: 1\n"
+            "phase Send: 0 1\n"
+            "phase Total: 0 1\n"
+            "api DeviceApi: 0 1\n"
+            "device_type Switch: 0 1\n");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,135 @@
+#include "server_metrics.h"
+
+// Tests of ServerMetrics.
+//
+// Author: james.synge@gmail.com
+
+#include <string>
+
+#include "constants.h"
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class ServerMetricsTest : public testing::Test {
+ protected:
+  void SetUp() override { ServerMetrics::Reset(); }
+
+  std::string PrintMetrics() {
+    PrintToStdString out;
+    const size_t count = ServerMetrics::PrintTo(out);
+    EXPECT_EQ(count, out.str().size());
+    return out.str();
+  }
+};
+
+TEST_F(ServerMetricsTest, InitiallyZero) {
+  const std::string metrics = PrintMetrics();
+  EXPECT_THAT(metrics, HasSubstr("# TYPE tas_requests_total counter\n"));
+  EXPECT_THAT(metrics, HasSubstr("tas_requests_total{api=\"DeviceApi\"} 0\n"));
+  EXPECT_THAT(metrics,
+              HasSubstr("tas_requests_total{api=\"ServerMetrics\"} 0\n"));
+  EXPECT_THAT(metrics, HasSubstr("# TYPE tas_responses_total counter\n"));
+  EXPECT_THAT(metrics, Not(HasSubstr("tas_responses_total{")));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_received_bytes_total 0\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_sent_bytes_total 0\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_connections_accepted_total 0\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_connections_closed_total 0\n"));
+  EXPECT_THAT(metrics,
+              HasSubstr("\ntas_maintain_devices_duration_us_count 0\n"));
+}
+
+TEST_F(ServerMetricsTest, CountsRequestsAndResponses) {
+  ServerMetrics::SetResponseStatus(EHttpStatusCode::kHttpOk);
+  ServerMetrics::RecordResponse(EAlpacaApi::kDeviceApi);
+  ServerMetrics::SetResponseStatus(EHttpStatusCode::kHttpOk);
+  ServerMetrics::RecordResponse(EAlpacaApi::kDeviceApi);
+  ServerMetrics::SetResponseStatus(EHttpStatusCode::kHttpBadRequest);
+  ServerMetrics::RecordResponse(EAlpacaApi::kManagementDescription);
+
+  const std::string metrics = PrintMetrics();
+  EXPECT_THAT(metrics, HasSubstr("tas_requests_total{api=\"DeviceApi\"} 2\n"));
+  EXPECT_THAT(
+      metrics,
+      HasSubstr("tas_requests_total{api=\"ManagementDescription\"} 1\n"));
+  EXPECT_THAT(metrics, HasSubstr("tas_responses_total{code=\"200\"} 2\n"));
+  EXPECT_THAT(metrics, HasSubstr("tas_responses_total{code=\"400\"} 1\n"));
+}
+
+TEST_F(ServerMetricsTest, LumpsExtraStatusCodesTogether) {
+  const EHttpStatusCode codes[] = {
+      EHttpStatusCode::kHttpBadRequest,
+      EHttpStatusCode::kHttpMethodNotAllowed,
+      EHttpStatusCode::kHttpNotAcceptable,
+      EHttpStatusCode::kHttpLengthRequired,
+      EHttpStatusCode::kHttpPayloadTooLarge,
+      EHttpStatusCode::kHttpUnsupportedMediaType,
+      EHttpStatusCode::kHttpRequestHeaderFieldsTooLarge,
+      EHttpStatusCode::kHttpInternalServerError,
+  };
+  for (const auto code : codes) {
+    ServerMetrics::RecordDecodeError(code);
+  }
+  ServerMetrics::RecordDecodeError(EHttpStatusCode::kHttpBadRequest);
+
+  const std::string metrics = PrintMetrics();
+  EXPECT_THAT(metrics,
+              HasSubstr("tas_decode_errors_total{code=\"400\"} 2\n"));
+  EXPECT_THAT(metrics,
+              HasSubstr("tas_decode_errors_total{code=\"415\"} 1\n"));
+  EXPECT_THAT(metrics, Not(HasSubstr("tas_decode_errors_total{code=\"431\"}")));
+  EXPECT_THAT(metrics,
+              HasSubstr("tas_decode_errors_total{code=\"other\"} 2\n"));
+}
+
+TEST_F(ServerMetricsTest, CountsConnectionsBytesAndPackets) {
+  ServerMetrics::RecordConnectionAccepted();
+  ServerMetrics::RecordConnectionAccepted();
+  ServerMetrics::RecordConnectionClosed();
+  ServerMetrics::RecordBytesReceived(100);
+  ServerMetrics::RecordBytesReceived(23);
+  ServerMetrics::RecordBytesSent(456);
+  ServerMetrics::RecordDiscoveryPacket(/*replied=*/true);
+  ServerMetrics::RecordDiscoveryPacket(/*replied=*/false);
+
+  const std::string metrics = PrintMetrics();
+  EXPECT_THAT(metrics, HasSubstr("\ntas_connections_accepted_total 2\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_connections_closed_total 1\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_received_bytes_total 123\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_sent_bytes_total 456\n"));
+  EXPECT_THAT(metrics,
+              HasSubstr("\ntas_discovery_packets_received_total 2\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_discovery_packets_replied_total 1\n"));
+}
+
+TEST_F(ServerMetricsTest, MaintainDevicesDurations) {
+  ServerMetrics::RecordMaintainDevicesDuration(10);
+  ServerMetrics::RecordMaintainDevicesDuration(30);
+  ServerMetrics::RecordMaintainDevicesDuration(20);
+
+  const std::string metrics = PrintMetrics();
+  EXPECT_THAT(metrics, HasSubstr("# TYPE tas_maintain_devices_duration_us "
+                                 "summary\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_maintain_devices_duration_us_sum 60\n"));
+  EXPECT_THAT(metrics,
+              HasSubstr("\ntas_maintain_devices_duration_us_count 3\n"));
+  EXPECT_THAT(metrics, HasSubstr("\ntas_maintain_devices_duration_us_max 30\n"));
+}
+
+TEST_F(ServerMetricsTest, StackUsage) {
+  const std::string metrics = PrintMetrics();
+  EXPECT_THAT(metrics, HasSubstr("# TYPE tas_stack_max_used_bytes gauge\n"
+                                 "tas_stack_max_used_bytes "));
+  // The RAM measurements are only available on AVR.
+  EXPECT_THAT(metrics, Not(HasSubstr("tas_ram_min_free_bytes")));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
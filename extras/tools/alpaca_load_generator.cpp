@@ -0,0 +1,776 @@
+// alpaca_load_generator sends Alpaca requests to a server from many concurrent
+// connections, optionally pipelining several requests per connection, and
+// reports latency histograms. Each request gets a random ClientTransactionID,
+// which the response must echo; responses with a JSON body are checked for
+// well-formedness, and for an ErrorNumber property.
+//
+// By default it repeatedly sends the management API requests, plus GET
+// requests for the common device methods of --device (if specified), as fast
+// as the server will respond. With --trace_file, it instead replays the
+// requests in the file, in order (repeating the file as needed), one per line
+// in one of these forms:
+//
+//   GET /api/v1/switch/0/getswitchvalue?Id=1
+//   PUT /api/v1/switch/0/setswitchvalue Id=1&Value=0.5
+//
+// where the PUT body is the remainder of the line. Blank lines and lines
+// starting with '#' are ignored. ClientID and ClientTransactionID parameters
+// are appended to each request, so should not be present in the trace.
+//
+// With --rate, requests are issued at that fixed rate (across all connections)
+// rather than as fast as possible; latency is then measured from the time at
+// which the request was scheduled to be sent, so that time spent waiting for a
+// free connection is included (i.e. avoiding coordinated omission).
+//
+// Examples:
+//
+//   alpaca_load_generator --host=192.168.1.50 --port=80 --connections=3 \
+//       --device=observingconditions/0 --seconds=30
+//
+//   alpaca_load_generator --port=18080 --trace_file=/tmp/trace.txt \
+//       --rate=200 --pipeline_depth=2 --seconds=60
+//
+// Author: james.synge@gmail.com
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "base/init_google.h"
+#include "extras/tools/json_checker.h"
+#include "logging.h"
+
+ABSL_FLAG(std::string, host, "127.0.0.1", "Host name or address of server.");
+ABSL_FLAG(int, port, 80, "TCP port of the server.");
+ABSL_FLAG(int, connections, 3, "Number of concurrent connections.");
+ABSL_FLAG(int, pipeline_depth, 1,
+          "Maximum number of requests sent on a connection before waiting "
+          "for the response to the first of them.");
+ABSL_FLAG(int, requests_per_connection, 0,
+          "Close and re-open a connection after this many requests; 0 means "
+          "keep the connection open for the entire run.");
+ABSL_FLAG(double, seconds, 10, "Duration of the run, in seconds.");
+ABSL_FLAG(int64_t, requests, 0,
+          "Stop after sending this many requests; 0 means no limit.");
+ABSL_FLAG(double, rate, 0,
+          "Requests per second to issue; 0 means as fast as possible.");
+ABSL_FLAG(std::string, device, "",
+          "Device (e.g. observingconditions/0) whose common methods are "
+          "requested; ignored if --trace_file is specified.");
+ABSL_FLAG(std::string, trace_file, "",
+          "File of requests to replay, instead of the default requests.");
+ABSL_FLAG(double, response_timeout_seconds, 5,
+          "Close a connection if a response takes longer than this.");
+ABSL_FLAG(int, seed, 0, "Seed for the random number generator.");
+
+namespace alpaca {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t MicrosBetween(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+      .count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Requests to be sent.
+
+struct RequestTemplate {
+  std::string http_method;  // GET or PUT.
+  std::string path;         // May include a query string.
+  std::string body;         // Only for PUT.
+  std::string label;        // For reporting, the path without the query.
+};
+
+RequestTemplate MakeTemplate(std::string http_method, std::string path,
+                             std::string body) {
+  RequestTemplate result;
+  result.label = absl::StrCat(http_method, " ", path.substr(0, path.find('?')));
+  result.http_method = std::move(http_method);
+  result.path = std::move(path);
+  result.body = std::move(body);
+  return result;
+}
+
+std::vector<RequestTemplate> DefaultRequests(const std::string& device) {
+  std::vector<RequestTemplate> result;
+  for (const char* path :
+       {"/management/apiversions", "/management/v1/description",
+        "/management/v1/configureddevices"}) {
+    result.push_back(MakeTemplate("GET", path, ""));
+  }
+  if (!device.empty()) {
+    for (const char* method :
+         {"connected", "description", "driverinfo", "driverversion",
+          "interfaceversion", "name", "supportedactions"}) {
+      result.push_back(MakeTemplate(
+          "GET", absl::StrCat("/api/v1/", device, "/", method), ""));
+    }
+  }
+  return result;
+}
+
+std::vector<RequestTemplate> ReadTraceFile(const std::string& file_path) {
+  std::ifstream in(file_path);
+  CHECK(in) << "Unable to open " << file_path;
+  std::vector<RequestTemplate> result;
+  std::string line;
+  int line_number = 0;
+  while (std::getline(in, line)) {
+    ++line_number;
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<std::string> parts =
+        absl::StrSplit(line, absl::MaxSplits(' ', 2));
+    CHECK_GE(parts.size(), 2) << file_path << ":" << line_number
+                              << ": expected METHOD PATH [BODY]";
+    CHECK(parts[0] == "GET" || parts[0] == "PUT")
+        << file_path << ":" << line_number << ": unsupported method "
+        << parts[0];
+    result.push_back(MakeTemplate(parts[0], parts[1],
+                                  parts.size() > 2 ? parts[2] : ""));
+  }
+  CHECK(!result.empty()) << "No requests in " << file_path;
+  return result;
+}
+
+std::string FormatRequest(const RequestTemplate& request, int client_id,
+                          uint32_t client_transaction_id,
+                          const std::string& host) {
+  const std::string ids = absl::StrCat(
+      "ClientID=", client_id, "&ClientTransactionID=", client_transaction_id);
+  if (request.http_method == "GET") {
+    return absl::StrCat("GET ", request.path,
+                        request.path.find('?') == std::string::npos ? "?" : "&",
+                        ids, " HTTP/1.1\r\nHost: ", host, "\r\n\r\n");
+  }
+  const std::string body =
+      request.body.empty() ? ids : absl::StrCat(request.body, "&", ids);
+  return absl::StrCat(request.http_method, " ", request.path,
+                      " HTTP/1.1\r\nHost: ", host,
+                      "\r\nContent-Type: application/x-www-form-urlencoded"
+                      "\r\nContent-Length: ",
+                      body.size(), "\r\n\r\n", body);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Latency histograms, with power of 2 bucket sizes.
+
+class LatencyHistogram {
+ public:
+  static constexpr int kNumBuckets = 32;
+
+  LatencyHistogram() : buckets_(kNumBuckets, 0) {}
+
+  void Add(int64_t micros) {
+    samples_.push_back(micros);
+    ++buckets_[BucketIndex(micros)];
+  }
+
+  size_t count() const { return samples_.size(); }
+
+  // Returns the smallest sample such that at least 'fraction' of the samples
+  // are no larger.
+  int64_t Percentile(double fraction) {
+    if (samples_.empty()) {
+      return 0;
+    }
+    if (!sorted_) {
+      std::sort(samples_.begin(), samples_.end());
+      sorted_ = true;
+    }
+    size_t ndx = static_cast<size_t>(fraction * samples_.size());
+    return samples_[std::min(ndx, samples_.size() - 1)];
+  }
+
+  void PrintBuckets() const {
+    int first = kNumBuckets, last = -1;
+    for (int ndx = 0; ndx < kNumBuckets; ++ndx) {
+      if (buckets_[ndx] > 0) {
+        first = std::min(first, ndx);
+        last = ndx;
+      }
+    }
+    int64_t cumulative = 0;
+    for (int ndx = first; ndx <= last; ++ndx) {
+      cumulative += buckets_[ndx];
+      const double percent = 100.0 * buckets_[ndx] / samples_.size();
+      std::printf("  [%9lld, %9lld) us %9lld %6.2f%% %7.3f%% |%s\n",
+                  static_cast<long long>(BucketLowerBound(ndx)),  // NOLINT
+                  static_cast<long long>(BucketLowerBound(ndx + 1)),  // NOLINT
+                  static_cast<long long>(buckets_[ndx]),  // NOLINT
+                  percent, 100.0 * cumulative / samples_.size(),
+                  std::string(static_cast<size_t>(percent / 2), '#').c_str());
+    }
+  }
+
+ private:
+  // Bucket 0 holds [0, 1), bucket n holds [2^(n-1), 2^n).
+  static int BucketIndex(int64_t micros) {
+    int ndx = 0;
+    while (micros > 0 && ndx < kNumBuckets - 1) {
+      micros >>= 1;
+      ++ndx;
+    }
+    return ndx;
+  }
+  static int64_t BucketLowerBound(int ndx) {
+    return ndx == 0 ? 0 : int64_t{1} << (ndx - 1);
+  }
+
+  std::vector<int64_t> buckets_;
+  std::vector<int64_t> samples_;
+  bool sorted_ = false;
+};
+
+struct Stats {
+  LatencyHistogram overall;
+  std::map<std::string, LatencyHistogram> by_label;
+  int64_t http_errors = 0;
+  int64_t json_errors = 0;
+  int64_t transaction_id_errors = 0;
+  int64_t ascom_errors = 0;
+  int64_t dropped = 0;
+  int64_t unsent = 0;
+  int64_t connection_failures = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Parsing of responses.
+
+struct ParsedResponse {
+  int status = 0;
+  bool is_json = false;
+  bool connection_close = false;
+  std::string body;
+};
+
+enum class EParseResult { kIncomplete, kComplete, kInvalid };
+
+// Removes one complete response from the front of 'buffer', if there is one.
+EParseResult ParseResponse(std::string& buffer, ParsedResponse& response) {
+  const auto header_end = buffer.find("\r\n\r\n");
+  if (header_end == std::string::npos) {
+    return EParseResult::kIncomplete;
+  }
+  std::string headers = buffer.substr(0, header_end + 2);
+  if (headers.compare(0, 5, "HTTP/") != 0) {
+    return EParseResult::kInvalid;
+  }
+  const auto space = headers.find(' ');
+  if (space == std::string::npos ||
+      !absl::SimpleAtoi(headers.substr(space + 1, 3), &response.status)) {
+    return EParseResult::kInvalid;
+  }
+  std::transform(headers.begin(), headers.end(), headers.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  size_t content_length = 0;
+  for (absl::string_view line : absl::StrSplit(headers, "\r\n")) {
+    const auto colon = line.find(':');
+    if (colon == absl::string_view::npos) {
+      continue;
+    }
+    absl::string_view name = line.substr(0, colon);
+    absl::string_view value = line.substr(colon + 1);
+    while (!value.empty() && value.front() == ' ') {
+      value.remove_prefix(1);
+    }
+    if (name == "content-length") {
+      if (!absl::SimpleAtoi(value, &content_length)) {
+        return EParseResult::kInvalid;
+      }
+    } else if (name == "content-type") {
+      response.is_json = value.find("application/json") != value.npos;
+    } else if (name == "connection") {
+      response.connection_close = value.find("close") != value.npos;
+    }
+  }
+  const size_t body_start = header_end + 4;
+  if (buffer.size() < body_start + content_length) {
+    return EParseResult::kIncomplete;
+  }
+  response.body = buffer.substr(body_start, content_length);
+  buffer.erase(0, body_start + content_length);
+  return EParseResult::kComplete;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The load generator.
+
+struct InFlightRequest {
+  size_t template_index;
+  uint32_t client_transaction_id;
+  Clock::time_point start;  // For measuring latency.
+  Clock::time_point sent;   // For detecting timeouts.
+};
+
+struct PendingRequest {
+  size_t template_index;
+  Clock::time_point scheduled;
+};
+
+struct ClientConnection {
+  int client_id = 0;
+  int fd = -1;
+  bool connecting = false;
+  bool closing = false;  // Don't send more requests on this connection.
+  int requests_sent = 0;
+  std::string output;
+  std::string input;
+  std::deque<InFlightRequest> in_flight;
+};
+
+class LoadGenerator {
+ public:
+  LoadGenerator(std::vector<RequestTemplate> templates, sockaddr_in address)
+      : templates_(std::move(templates)),
+        address_(address),
+        host_(absl::GetFlag(FLAGS_host)),
+        pipeline_depth_(std::max(1, absl::GetFlag(FLAGS_pipeline_depth))),
+        requests_per_connection_(absl::GetFlag(FLAGS_requests_per_connection)),
+        request_limit_(absl::GetFlag(FLAGS_requests)),
+        rate_(absl::GetFlag(FLAGS_rate)),
+        response_timeout_(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(
+                absl::GetFlag(FLAGS_response_timeout_seconds)))),
+        rng_(absl::GetFlag(FLAGS_seed)),
+        next_template_(0),
+        requests_issued_(0),
+        use_random_order_(absl::GetFlag(FLAGS_trace_file).empty()) {
+    const int num_connections = std::max(1, absl::GetFlag(FLAGS_connections));
+    connections_.resize(num_connections);
+    for (int ndx = 0; ndx < num_connections; ++ndx) {
+      connections_[ndx].client_id = ndx + 1;
+    }
+  }
+
+  void Run(double seconds) {
+    start_ = Clock::now();
+    const auto deadline =
+        start_ + std::chrono::duration_cast<Clock::duration>(
+                     std::chrono::duration<double>(seconds));
+    next_scheduled_ = start_;
+    while (true) {
+      const auto now = Clock::now();
+      const bool issuing = now < deadline && !ReachedRequestLimit();
+      if (!issuing && pending_.empty() && NothingInFlight()) {
+        break;
+      }
+      if (now > deadline + response_timeout_) {
+        break;
+      }
+      if (issuing) {
+        ScheduleRequests(now);
+      } else {
+        // No more requests are to be sent. In fixed rate mode, any requests
+        // still pending indicate that the server couldn't keep up.
+        if (rate_ > 0) {
+          stats_.unsent += pending_.size();
+        }
+        pending_.clear();
+      }
+      for (auto& conn : connections_) {
+        MaintainConnection(conn, now, issuing);
+      }
+      PollConnections(now);
+    }
+    elapsed_seconds_ =
+        std::chrono::duration<double>(Clock::now() - start_).count();
+    for (auto& conn : connections_) {
+      CloseConnection(conn);
+    }
+  }
+
+  void PrintReport() {
+    const auto completed = stats_.overall.count();
+    std::printf("Completed %zu requests in %.3f seconds: %.1f requests/sec\n",
+                completed, elapsed_seconds_, completed / elapsed_seconds_);
+    std::printf(
+        "Errors: http=%lld json=%lld client_transaction_id=%lld "
+        "dropped=%lld connection_failures=%lld; ASCOM errors: %lld\n",
+        static_cast<long long>(stats_.http_errors),            // NOLINT
+        static_cast<long long>(stats_.json_errors),            // NOLINT
+        static_cast<long long>(stats_.transaction_id_errors),  // NOLINT
+        static_cast<long long>(stats_.dropped),                // NOLINT
+        static_cast<long long>(stats_.connection_failures),    // NOLINT
+        static_cast<long long>(stats_.ascom_errors));          // NOLINT
+    if (stats_.unsent > 0) {
+      std::printf("Unable to sustain --rate: %lld requests not sent\n",
+                  static_cast<long long>(stats_.unsent));  // NOLINT
+    }
+    if (completed == 0) {
+      return;
+    }
+    std::printf("\nLatency histogram:\n");
+    stats_.overall.PrintBuckets();
+    std::printf("\n%-50s %9s %9s %9s %9s %9s %9s\n", "Request", "Count",
+                "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+    PrintPercentiles("(all)", stats_.overall);
+    for (auto& [label, histogram] : stats_.by_label) {
+      PrintPercentiles(label, histogram);
+    }
+  }
+
+  bool HadErrors() const {
+    return stats_.http_errors > 0 || stats_.json_errors > 0 ||
+           stats_.transaction_id_errors > 0 || stats_.dropped > 0;
+  }
+
+ private:
+  static void PrintPercentiles(const std::string& label,
+                               LatencyHistogram& histogram) {
+    std::printf("%-50s %9zu %9lld %9lld %9lld %9lld %9lld\n", label.c_str(),
+                histogram.count(),
+                static_cast<long long>(histogram.Percentile(0.5)),    // NOLINT
+                static_cast<long long>(histogram.Percentile(0.9)),    // NOLINT
+                static_cast<long long>(histogram.Percentile(0.99)),   // NOLINT
+                static_cast<long long>(histogram.Percentile(0.999)),  // NOLINT
+                static_cast<long long>(histogram.Percentile(1.0)));   // NOLINT
+  }
+
+  bool ReachedRequestLimit() const {
+    return request_limit_ > 0 && requests_issued_ >= request_limit_;
+  }
+
+  bool NothingInFlight() const {
+    for (const auto& conn : connections_) {
+      if (!conn.in_flight.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t NextTemplateIndex() {
+    if (use_random_order_) {
+      return rng_() % templates_.size();
+    }
+    const size_t result = next_template_;
+    next_template_ = (next_template_ + 1) % templates_.size();
+    return result;
+  }
+
+  // In fixed rate mode, adds to pending_ the requests whose scheduled time has
+  // arrived. Otherwise keeps one request pending per connection with room.
+  void ScheduleRequests(Clock::time_point now) {
+    if (rate_ > 0) {
+      const auto interval = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / rate_));
+      while (next_scheduled_ <= now && !ReachedRequestLimit()) {
+        pending_.push_back({NextTemplateIndex(), next_scheduled_});
+        next_scheduled_ += interval;
+        ++requests_issued_;
+      }
+    } else {
+      size_t room = 0;
+      for (const auto& conn : connections_) {
+        if (!conn.closing) {
+          room += pipeline_depth_ - conn.in_flight.size();
+        }
+      }
+      while (pending_.size() < room && !ReachedRequestLimit()) {
+        pending_.push_back({NextTemplateIndex(), now});
+        ++requests_issued_;
+      }
+    }
+  }
+
+  void MaintainConnection(ClientConnection& conn, Clock::time_point now,
+                          bool issuing) {
+    if (conn.fd >= 0 && !conn.in_flight.empty() &&
+        now - conn.in_flight.front().sent > response_timeout_) {
+      LOG(WARNING) << "Timed out waiting for response on connection "
+                   << conn.client_id;
+      CloseConnection(conn);
+    }
+    if (conn.fd >= 0 && conn.closing && conn.in_flight.empty()) {
+      CloseConnection(conn);
+    }
+    if (conn.fd < 0) {
+      if (!issuing) {
+        return;
+      }
+      OpenConnection(conn);
+      if (conn.fd < 0) {
+        return;
+      }
+    }
+    if (conn.connecting) {
+      return;
+    }
+    while (!conn.closing && conn.in_flight.size() < pipeline_depth_ &&
+           !pending_.empty()) {
+      const auto pending = pending_.front();
+      pending_.pop_front();
+      const uint32_t client_transaction_id = rng_();
+      conn.output += FormatRequest(templates_[pending.template_index],
+                                   conn.client_id, client_transaction_id,
+                                   host_);
+      // In fixed rate mode, latency includes the time waiting for a free
+      // connection.
+      conn.in_flight.push_back({pending.template_index, client_transaction_id,
+                                rate_ > 0 ? pending.scheduled : now, now});
+      ++conn.requests_sent;
+      if (requests_per_connection_ > 0 &&
+          conn.requests_sent >= requests_per_connection_) {
+        conn.closing = true;
+      }
+    }
+  }
+
+  void OpenConnection(ClientConnection& conn) {
+    conn.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, IPPROTO_TCP);
+    CHECK_GE(conn.fd, 0) << std::strerror(errno);
+    int value = 1;
+    ::setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof value);
+    conn.connecting = true;
+    conn.closing = false;
+    conn.requests_sent = 0;
+    conn.output.clear();
+    conn.input.clear();
+    if (::connect(conn.fd, reinterpret_cast<const sockaddr*>(&address_),
+                  sizeof address_) == 0) {
+      conn.connecting = false;
+    } else if (errno != EINPROGRESS) {
+      const auto error_number = errno;
+      VLOG(1) << "connect failed: " << std::strerror(error_number);
+      ++stats_.connection_failures;
+      CloseConnection(conn);
+    }
+  }
+
+  void CloseConnection(ClientConnection& conn) {
+    if (conn.fd >= 0) {
+      ::close(conn.fd);
+    }
+    conn.fd = -1;
+    conn.connecting = false;
+    // Any requests not yet answered will not be.
+    stats_.dropped += conn.in_flight.size();
+    conn.in_flight.clear();
+  }
+
+  void PollConnections(Clock::time_point now) {
+    std::vector<pollfd> fds;
+    std::vector<ClientConnection*> conns;
+    for (auto& conn : connections_) {
+      if (conn.fd >= 0) {
+        short events = POLLIN;  // NOLINT
+        if (conn.connecting || !conn.output.empty()) {
+          events |= POLLOUT;
+        }
+        fds.push_back({conn.fd, events, 0});
+        conns.push_back(&conn);
+      }
+    }
+    int timeout_ms = 10;
+    if (rate_ > 0 && next_scheduled_ > now) {
+      timeout_ms = std::min<int64_t>(
+          timeout_ms, MicrosBetween(now, next_scheduled_) / 1000);
+    }
+    if (fds.empty()) {
+      ::poll(nullptr, 0, timeout_ms);
+      return;
+    }
+    if (::poll(fds.data(), fds.size(), timeout_ms) <= 0) {
+      return;
+    }
+    for (size_t ndx = 0; ndx < fds.size(); ++ndx) {
+      auto& conn = *conns[ndx];
+      const auto revents = fds[ndx].revents;
+      if (conn.connecting && (revents & (POLLOUT | POLLERR | POLLHUP))) {
+        int error = 0;
+        socklen_t len = sizeof error;
+        ::getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &error, &len);
+        if (error != 0) {
+          VLOG(1) << "connect failed: " << std::strerror(error);
+          ++stats_.connection_failures;
+          CloseConnection(conn);
+          continue;
+        }
+        conn.connecting = false;
+      }
+      if (!conn.connecting && !conn.output.empty() && (revents & POLLOUT)) {
+        WriteOutput(conn);
+      }
+      if (conn.fd >= 0 && (revents & (POLLIN | POLLERR | POLLHUP))) {
+        ReadInput(conn);
+      }
+    }
+  }
+
+  void WriteOutput(ClientConnection& conn) {
+    auto ret = ::send(conn.fd, conn.output.data(), conn.output.size(),
+                      MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (ret > 0) {
+      conn.output.erase(0, ret);
+    } else if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+               errno != EINTR) {
+      const auto error_number = errno;
+      VLOG(1) << "send failed: " << std::strerror(error_number);
+      ++stats_.connection_failures;
+      CloseConnection(conn);
+    }
+  }
+
+  void ReadInput(ClientConnection& conn) {
+    char buffer[4096];
+    auto ret = ::recv(conn.fd, buffer, sizeof buffer, MSG_DONTWAIT);
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return;
+    }
+    if (ret > 0) {
+      conn.input.append(buffer, ret);
+    }
+    const auto now = Clock::now();
+    while (true) {
+      ParsedResponse response;
+      auto result = ParseResponse(conn.input, response);
+      if (result == EParseResult::kIncomplete) {
+        break;
+      } else if (result == EParseResult::kInvalid ||
+                 conn.in_flight.empty()) {
+        LOG(WARNING) << "Invalid or unexpected response on connection "
+                     << conn.client_id;
+        ++stats_.http_errors;
+        CloseConnection(conn);
+        return;
+      }
+      auto request = conn.in_flight.front();
+      conn.in_flight.pop_front();
+      RecordResponse(request, response, now);
+      if (response.connection_close) {
+        conn.closing = true;
+      }
+    }
+    if (ret <= 0) {
+      // The server closed the connection, or there was an error.
+      if (!conn.in_flight.empty()) {
+        ++stats_.connection_failures;
+      }
+      CloseConnection(conn);
+    }
+  }
+
+  void RecordResponse(const InFlightRequest& request,
+                      const ParsedResponse& response, Clock::time_point now) {
+    const auto& request_template = templates_[request.template_index];
+    if (response.status != 200) {
+      VLOG(1) << request_template.label << " -> HTTP " << response.status
+              << ": " << response.body;
+      ++stats_.http_errors;
+      return;
+    }
+    if (response.is_json) {
+      std::map<std::string, std::string> properties;
+      if (!CheckJson(response.body, &properties)) {
+        LOG(WARNING) << request_template.label
+                     << " -> invalid JSON: " << response.body;
+        ++stats_.json_errors;
+        return;
+      }
+      auto iter = properties.find("ClientTransactionID");
+      uint32_t echoed = 0;
+      if (iter == properties.end() ||
+          !absl::SimpleAtoi(iter->second, &echoed) ||
+          echoed != request.client_transaction_id) {
+        LOG(WARNING) << request_template.label
+                     << " -> wrong ClientTransactionID, expected "
+                     << request.client_transaction_id << ": " << response.body;
+        ++stats_.transaction_id_errors;
+        return;
+      }
+      iter = properties.find("ErrorNumber");
+      if (iter != properties.end() && iter->second != "0") {
+        ++stats_.ascom_errors;
+      }
+    }
+    const auto micros = MicrosBetween(request.start, now);
+    stats_.overall.Add(micros);
+    stats_.by_label[request_template.label].Add(micros);
+  }
+
+  const std::vector<RequestTemplate> templates_;
+  const sockaddr_in address_;
+  const std::string host_;
+  const size_t pipeline_depth_;
+  const int requests_per_connection_;
+  const int64_t request_limit_;
+  const double rate_;
+  const Clock::duration response_timeout_;
+  std::mt19937 rng_;
+  size_t next_template_;
+  int64_t requests_issued_;
+  const bool use_random_order_;
+  std::vector<ClientConnection> connections_;
+  std::deque<PendingRequest> pending_;
+  Clock::time_point start_;
+  Clock::time_point next_scheduled_;
+  double elapsed_seconds_ = 0;
+  Stats stats_;
+};
+
+sockaddr_in ResolveAddress(const std::string& host, int port) {
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof hints);
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  const int error = ::getaddrinfo(host.c_str(), nullptr, &hints, &addresses);
+  CHECK_EQ(error, 0) << "Unable to resolve " << host << ": "
+                     << ::gai_strerror(error);
+  sockaddr_in result = *reinterpret_cast<sockaddr_in*>(addresses->ai_addr);
+  ::freeaddrinfo(addresses);
+  result.sin_port = htons(port);
+  return result;
+}
+
+int Main() {
+  const std::string trace_file = absl::GetFlag(FLAGS_trace_file);
+  std::vector<RequestTemplate> templates =
+      trace_file.empty() ? DefaultRequests(absl::GetFlag(FLAGS_device))
+                         : ReadTraceFile(trace_file);
+  LoadGenerator generator(
+      std::move(templates),
+      ResolveAddress(absl::GetFlag(FLAGS_host), absl::GetFlag(FLAGS_port)));
+  generator.Run(absl::GetFlag(FLAGS_seconds));
+  generator.PrintReport();
+  return generator.HadErrors() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace alpaca
+
+int main(int argc, char* argv[]) {
+  InitGoogle(argv[0], &argc, &argv, /*remove_flags=*/true);
+  return alpaca::Main();
+}
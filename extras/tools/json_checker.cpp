@@ -0,0 +1,229 @@
+#include "extras/tools/json_checker.h"
+
+#include <cctype>
+
+namespace alpaca {
+namespace {
+
+class JsonChecker {
+ public:
+  explicit JsonChecker(std::string_view json) : json_(json), pos_(0) {}
+
+  bool CheckDocument(std::map<std::string, std::string>* properties) {
+    SkipWhitespace();
+    if (AtEnd()) {
+      return false;
+    }
+    bool ok;
+    if (Peek() == '{') {
+      ok = CheckObject(properties);
+    } else {
+      ok = CheckValue(nullptr);
+    }
+    SkipWhitespace();
+    return ok && AtEnd();
+  }
+
+ private:
+  bool AtEnd() const { return pos_ >= json_.size(); }
+  char Peek() const { return json_[pos_]; }
+
+  void SkipWhitespace() {
+    while (!AtEnd() && (Peek() == ' ' || Peek() == '\t' || Peek() == '\r' ||
+                        Peek() == '\n')) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(char c) {
+    if (!AtEnd() && Peek() == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  bool ConsumeWord(std::string_view word) {
+    if (json_.substr(pos_, word.size()) == word) {
+      pos_ += word.size();
+      return true;
+    }
+    return false;
+  }
+
+  // Checks the value starting at pos_. If 'scalar' is not null and the value
+  // is a scalar, stores the value there.
+  bool CheckValue(std::string* scalar) {
+    SkipWhitespace();
+    if (AtEnd()) {
+      return false;
+    }
+    const size_t start = pos_;
+    switch (Peek()) {
+      case '{':
+        return CheckObject(nullptr);
+      case '[':
+        return CheckArray();
+      case '"':
+        return CheckString(scalar);
+      case 't':
+        if (!ConsumeWord("true")) {
+          return false;
+        }
+        break;
+      case 'f':
+        if (!ConsumeWord("false")) {
+          return false;
+        }
+        break;
+      case 'n':
+        if (!ConsumeWord("null")) {
+          return false;
+        }
+        break;
+      default:
+        if (!CheckNumber()) {
+          return false;
+        }
+        break;
+    }
+    if (scalar != nullptr) {
+      *scalar = std::string(json_.substr(start, pos_ - start));
+    }
+    return true;
+  }
+
+  bool CheckObject(std::map<std::string, std::string>* properties) {
+    if (!Consume('{')) {
+      return false;
+    }
+    SkipWhitespace();
+    if (Consume('}')) {
+      return true;
+    }
+    while (true) {
+      SkipWhitespace();
+      std::string name;
+      if (!CheckString(&name)) {
+        return false;
+      }
+      SkipWhitespace();
+      if (!Consume(':')) {
+        return false;
+      }
+      std::string value;
+      if (!CheckValue(properties != nullptr ? &value : nullptr)) {
+        return false;
+      }
+      if (properties != nullptr) {
+        (*properties)[name] = value;
+      }
+      SkipWhitespace();
+      if (Consume('}')) {
+        return true;
+      } else if (!Consume(',')) {
+        return false;
+      }
+    }
+  }
+
+  bool CheckArray() {
+    if (!Consume('[')) {
+      return false;
+    }
+    SkipWhitespace();
+    if (Consume(']')) {
+      return true;
+    }
+    while (true) {
+      if (!CheckValue(nullptr)) {
+        return false;
+      }
+      SkipWhitespace();
+      if (Consume(']')) {
+        return true;
+      } else if (!Consume(',')) {
+        return false;
+      }
+    }
+  }
+
+  // Stores the contents of the string, without the quotes, in 'value' (if not
+  // null).
+  bool CheckString(std::string* value) {
+    if (!Consume('"')) {
+      return false;
+    }
+    const size_t start = pos_;
+    while (!AtEnd()) {
+      const char c = json_[pos_++];
+      if (c == '"') {
+        if (value != nullptr) {
+          *value = std::string(json_.substr(start, pos_ - start - 1));
+        }
+        return true;
+      } else if (c == '\\') {
+        if (AtEnd()) {
+          return false;
+        }
+        const char e = json_[pos_++];
+        if (e == 'u') {
+          for (int i = 0; i < 4; ++i) {
+            if (AtEnd() || !std::isxdigit(static_cast<unsigned char>(Peek()))) {
+              return false;
+            }
+            ++pos_;
+          }
+        } else if (std::string_view("\"\\/bfnrt").find(e) ==
+                   std::string_view::npos) {
+          return false;
+        }
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        // Control characters must be escaped.
+        return false;
+      }
+    }
+    return false;
+  }
+
+  bool ConsumeDigits() {
+    const size_t start = pos_;
+    while (!AtEnd() && std::isdigit(static_cast<unsigned char>(Peek()))) {
+      ++pos_;
+    }
+    return pos_ > start;
+  }
+
+  bool CheckNumber() {
+    Consume('-');
+    if (Consume('0')) {
+      // No leading zeros allowed.
+    } else if (!ConsumeDigits()) {
+      return false;
+    }
+    if (Consume('.') && !ConsumeDigits()) {
+      return false;
+    }
+    if (Consume('e') || Consume('E')) {
+      if (!Consume('+')) {
+        Consume('-');
+      }
+      if (!ConsumeDigits()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const std::string_view json_;
+  size_t pos_;
+};
+
+}  // namespace
+
+bool CheckJson(std::string_view json,
+               std::map<std::string, std::string>* properties) {
+  return JsonChecker(json).CheckDocument(properties);
+}
+
+}  // namespace alpaca
@@ -0,0 +1,30 @@
+#ifndef TINY_ALPACA_SERVER_EXTRAS_TOOLS_JSON_CHECKER_H_
+#define TINY_ALPACA_SERVER_EXTRAS_TOOLS_JSON_CHECKER_H_
+
+// CheckJson verifies that a response body is well-formed JSON, and extracts
+// the scalar properties of the top-level object so that a client can verify
+// the Alpaca fields of a response (e.g. ClientTransactionID and ErrorNumber).
+// It is a validator, not a general purpose parser: nested arrays and objects
+// are checked, but their values are not returned.
+//
+// Author: james.synge@gmail.com
+
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace alpaca {
+
+// Returns true if 'json' consists of exactly one JSON value, optionally
+// surrounded by whitespace. If that value is an object and 'properties' is not
+// null, the properties of the object are stored in 'properties', mapping from
+// property name to value; string values are stored without the quotes and with
+// escape sequences left as is, other scalar values are stored as they appear
+// in 'json' (e.g. "123", "-4.5e6", "true", "null"), and array and object values
+// are stored as empty strings.
+bool CheckJson(std::string_view json,
+               std::map<std::string, std::string>* properties);
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_EXTRAS_TOOLS_JSON_CHECKER_H_
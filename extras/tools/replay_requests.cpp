@@ -0,0 +1,302 @@
+// replay_requests feeds a recording made by RequestCapture (see
+// src/request_capture.h) back into RequestDecoder and, optionally,
+// TinyAlpacaServerBase, reproducing the chunks of bytes that
+// ServerConnection::OnCanRead read from each connection. It then reports the
+// number of requests decoded, the decoding errors, and the time taken.
+//
+// The input buffer handling of ServerConnection is emulated: each connection
+// has a buffer of SERVER_CONNECTION_INPUT_BUFFER_SIZE bytes, undecoded bytes
+// are kept for the next pass, and the decoder is told when the client has
+// half-closed the connection. If the buffer is smaller than that used when the
+// recording was made, chunks are split to fit.
+//
+// With --mode=decoder, only RequestDecoder is exercised; with --mode=server,
+// decoded requests are passed to a TinyAlpacaServerBase with the pretend
+// devices of TinyAlpacaServerDemo, and the responses are discarded.
+//
+// By default the recording is replayed as fast as possible (i.e. for profiling
+// and benchmarking); with --realtime, each chunk is delivered at the time
+// (relative to the start of the recording) at which it was originally read.
+//
+// Examples:
+//
+//   tiny_alpaca_server_benchmark --capture_file=/tmp/requests.tascap
+//
+//   replay_requests --capture_file=/tmp/requests.tascap --mode=server \
+//       --repeat=1000
+//
+// Author: james.synge@gmail.com
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "base/init_google.h"
+#include "config.h"
+#include "constants.h"
+#include "examples/TinyAlpacaServerDemo/dht22_handler.h"
+#include "extras/tools/request_capture_file.h"
+#include "logging.h"
+#include "request_capture.h"
+#include "request_decoder.h"
+#include "request_listener.h"
+#include "tiny_alpaca_server.h"
+#include "utils/counting_print.h"
+#include "utils/platform.h"
+
+ABSL_FLAG(std::string, capture_file, "",
+          "Recording of the bytes received by the server, as written by "
+          "RequestCapture.");
+ABSL_FLAG(std::string, mode, "decoder",
+          "What to replay the recording into: 'decoder' (just "
+          "RequestDecoder) or 'server' (TinyAlpacaServerBase).");
+ABSL_FLAG(bool, realtime, false,
+          "Deliver the bytes at the times at which they were recorded, rather "
+          "than as fast as possible.");
+ABSL_FLAG(int, repeat, 1, "Number of times to replay the recording.");
+
+namespace alpaca {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kInputBufferSize = SERVER_CONNECTION_INPUT_BUFFER_SIZE;
+// Socket numbers are stored in 4 bits.
+constexpr size_t kMaxSockets = 16;
+
+TAS_DEFINE_LITERAL(ServerName, "Tiny Alpaca Server Replay");
+TAS_DEFINE_LITERAL(Manufacturer, "Tiny Alpaca Server");
+TAS_DEFINE_LITERAL(ManufacturerVersion, "0.1");
+TAS_DEFINE_LITERAL(DeviceLocation, "localhost");
+
+const ServerDescription kServerDescription{
+    .server_name = ServerName(),
+    .manufacturer = Manufacturer(),
+    .manufacturer_version = ManufacturerVersion(),
+    .location = DeviceLocation(),
+};
+
+// Listener used with --mode=decoder: keeps every connection open, and ignores
+// the requests.
+class DecoderOnlyListener : public RequestListener {
+ public:
+  void OnStartDecoding(AlpacaRequest& request) override {}
+  bool OnRequestDecoded(AlpacaRequest& request, Print& out) override {
+    return true;
+  }
+  void OnRequestDecodingError(AlpacaRequest& request, EHttpStatusCode status,
+                              Print& out) override {}
+};
+
+struct ReplayStats {
+  uint64_t events = 0;
+  uint64_t bytes = 0;
+  uint64_t requests = 0;
+  // Count of decoding errors by HTTP status code.
+  std::map<int, uint64_t> errors;
+};
+
+// The state of one connection, emulating that of ServerConnection.
+class ReplayConnection {
+ public:
+  ReplayConnection() : decoder_(request_) {}
+
+  void Connect() {
+    decoder_.Reset();
+    input_buffer_size_ = 0;
+    pending_.clear();
+    open_ = true;
+  }
+
+  void Receive(const std::string& data, RequestListener& listener,
+               ReplayStats& stats) {
+    if (!open_) {
+      // The server would have closed the connection after an error, so
+      // wouldn't have read any more.
+      return;
+    }
+    stats.bytes += data.size();
+    pending_.append(data);
+    Decode(/*at_end=*/false, listener, stats);
+  }
+
+  void HalfClose(RequestListener& listener, ReplayStats& stats) {
+    if (!open_) {
+      return;
+    }
+    Decode(/*at_end=*/true, listener, stats);
+    if (open_ && !BetweenRequests()) {
+      RecordError(EHttpStatusCode::kHttpBadRequest, listener, stats);
+    }
+    open_ = false;
+  }
+
+  void Disconnect() { open_ = false; }
+
+ private:
+  bool BetweenRequests() const {
+    return decoder_.status() == RequestDecoderStatus::kReset &&
+           input_buffer_size_ == 0 && pending_.empty();
+  }
+
+  // Decodes as much of the received input as possible.
+  void Decode(bool at_end, RequestListener& listener, ReplayStats& stats) {
+    while (open_) {
+      // Move as much of the pending input into the buffer as will fit.
+      const size_t count =
+          std::min(pending_.size(), kInputBufferSize - input_buffer_size_);
+      std::memcpy(input_buffer_ + input_buffer_size_, pending_.data(), count);
+      pending_.erase(0, count);
+      input_buffer_size_ += count;
+      if (input_buffer_size_ == 0) {
+        return;
+      }
+
+      if (decoder_.status() == RequestDecoderStatus::kReset) {
+        listener.OnStartDecoding(request_);
+      }
+      StringView view(input_buffer_, input_buffer_size_);
+      const bool buffer_is_full = input_buffer_size_ == kInputBufferSize;
+      const auto status_code = decoder_.DecodeBuffer(
+          view, buffer_is_full, at_end && pending_.empty());
+      const size_t consumed = input_buffer_size_ - view.size();
+      if (consumed > 0) {
+        std::memmove(input_buffer_, view.data(), view.size());
+        input_buffer_size_ = view.size();
+      }
+
+      if (status_code == EHttpStatusCode::kHttpOk) {
+        ++stats.requests;
+        const bool keep_open = listener.OnRequestDecoded(request_, out_);
+        decoder_.Reset();
+        if (!keep_open) {
+          open_ = false;
+        }
+      } else if (status_code > EHttpStatusCode::kHttpOk) {
+        RecordError(status_code, listener, stats);
+        open_ = false;
+      } else if (pending_.empty() || consumed == 0) {
+        // Need more input than has been received.
+        return;
+      }
+    }
+  }
+
+  void RecordError(EHttpStatusCode status_code, RequestListener& listener,
+                   ReplayStats& stats) {
+    listener.OnRequestDecodingError(request_, status_code, out_);
+    ++stats.errors[static_cast<int>(status_code)];
+  }
+
+  AlpacaRequest request_;
+  RequestDecoder decoder_;
+  PrintNoOp out_;
+  char input_buffer_[kInputBufferSize];
+  size_t input_buffer_size_ = 0;
+  // Bytes received which haven't yet fit in input_buffer_.
+  std::string pending_;
+  bool open_ = false;
+};
+
+void ReplayOnce(const std::vector<CaptureEvent>& events, bool realtime,
+                RequestListener& listener, ReplayStats& stats) {
+  std::vector<ReplayConnection> connections(kMaxSockets);
+  const auto start = Clock::now();
+  for (const auto& event : events) {
+    if (realtime) {
+      std::this_thread::sleep_until(
+          start + std::chrono::microseconds(event.time_micros));
+    }
+    ++stats.events;
+    auto& connection = connections[event.sock_num];
+    switch (event.type) {
+      case RequestCapture::kConnect:
+        connection.Connect();
+        break;
+      case RequestCapture::kData:
+        connection.Receive(event.data, listener, stats);
+        break;
+      case RequestCapture::kHalfClosed:
+        connection.HalfClose(listener, stats);
+        break;
+      case RequestCapture::kDisconnect:
+        connection.Disconnect();
+        break;
+    }
+  }
+}
+
+int RunReplay() {
+  const std::string path = absl::GetFlag(FLAGS_capture_file);
+  if (path.empty()) {
+    LOG(ERROR) << "--capture_file must be specified";
+    return EXIT_FAILURE;
+  }
+  std::vector<CaptureEvent> events;
+  std::string error;
+  if (!ReadRequestCaptureFile(path, events, &error)) {
+    // Replay whatever preceded the problem, e.g. if the device was reset while
+    // capturing.
+    LOG(WARNING) << "Problem reading " << path << ": " << error;
+    if (events.empty()) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  DecoderOnlyListener decoder_only_listener;
+  Dht22Handler dht_handler;
+  DeviceInterface* devices[] = {&dht_handler};
+  TinyAlpacaServerBase server(kServerDescription, devices);
+  RequestListener* listener = &decoder_only_listener;
+  const std::string mode = absl::GetFlag(FLAGS_mode);
+  if (mode == "server") {
+    server.Initialize();
+    listener = &server;
+  } else if (mode != "decoder") {
+    LOG(ERROR) << "Unknown --mode: " << mode;
+    return EXIT_FAILURE;
+  }
+
+  const bool realtime = absl::GetFlag(FLAGS_realtime);
+  const int repeat = std::max(1, absl::GetFlag(FLAGS_repeat));
+  ReplayStats stats;
+  const auto start = Clock::now();
+  for (int pass = 0; pass < repeat; ++pass) {
+    ReplayOnce(events, realtime, *listener, stats);
+  }
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::printf("events: %llu\n",
+              static_cast<unsigned long long>(stats.events));  // NOLINT
+  std::printf("bytes: %llu\n",
+              static_cast<unsigned long long>(stats.bytes));  // NOLINT
+  std::printf("requests: %llu\n",
+              static_cast<unsigned long long>(stats.requests));  // NOLINT
+  for (const auto& [status_code, count] : stats.errors) {
+    std::printf("errors_%d: %llu\n", status_code,
+                static_cast<unsigned long long>(count));  // NOLINT
+  }
+  std::printf("elapsed_seconds: %.6f\n", elapsed);
+  if (!realtime && stats.requests > 0) {
+    std::printf("ns_per_request: %.1f\n", elapsed * 1e9 / stats.requests);
+    std::printf("megabytes_per_second: %.2f\n", stats.bytes / elapsed / 1e6);
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace alpaca
+
+int main(int argc, char* argv[]) {
+  InitGoogle(argv[0], &argc, &argv, /*remove_flags=*/true);
+  return alpaca::RunReplay();
+}
@@ -0,0 +1,121 @@
+#include "extras/tools/request_capture_file.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace alpaca {
+namespace {
+
+// Decodes an unsigned LEB128 varint of at most 32 bits from the front of
+// input, removing it. Returns false if input doesn't start with a complete
+// varint.
+bool ConsumeVarint(std::string_view& input, uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (input.empty()) {
+      return false;
+    }
+    const uint8_t b = static_cast<uint8_t>(input.front());
+    input.remove_prefix(1);
+    value |= static_cast<uint32_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SetError(std::string* error, const std::string& message,
+              size_t offset) {
+  if (error != nullptr) {
+    *error = message + " at offset " + std::to_string(offset);
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ParseRequestCapture(std::string_view capture,
+                         std::vector<CaptureEvent>& events,
+                         std::string* error) {
+  const size_t total_size = capture.size();
+  const std::string_view magic(RequestCapture::kMagic,
+                               RequestCapture::kMagicSize);
+  if (capture.substr(0, magic.size()) != magic) {
+    return SetError(error, "Missing capture header", 0);
+  }
+  capture.remove_prefix(magic.size());
+  if (capture.empty()) {
+    return SetError(error, "Missing format version", magic.size());
+  }
+  if (static_cast<uint8_t>(capture.front()) !=
+      RequestCapture::kFormatVersion) {
+    return SetError(error,
+                    "Unsupported format version " +
+                        std::to_string(static_cast<uint8_t>(capture.front())),
+                    magic.size());
+  }
+  capture.remove_prefix(1);
+
+  uint64_t time_micros = 0;
+  while (!capture.empty()) {
+    const size_t offset = total_size - capture.size();
+    const uint8_t tag = static_cast<uint8_t>(capture.front());
+    capture.remove_prefix(1);
+    CaptureEvent event;
+    event.type = static_cast<RequestCapture::ERecordType>(tag >> 4);
+    event.sock_num = tag & 0x0F;
+    switch (event.type) {
+      case RequestCapture::kConnect:
+      case RequestCapture::kData:
+      case RequestCapture::kHalfClosed:
+      case RequestCapture::kDisconnect:
+        break;
+      default:
+        return SetError(error, "Invalid record type", offset);
+    }
+    uint32_t delta;
+    if (!ConsumeVarint(capture, delta)) {
+      return SetError(error, "Truncated record time", offset);
+    }
+    time_micros += delta;
+    event.time_micros = time_micros;
+    if (event.type == RequestCapture::kData) {
+      uint32_t size;
+      if (!ConsumeVarint(capture, size) || size > capture.size()) {
+        return SetError(error, "Truncated data record", offset);
+      }
+      event.data = std::string(capture.substr(0, size));
+      capture.remove_prefix(size);
+    }
+    events.push_back(std::move(event));
+  }
+  return true;
+}
+
+bool ReadRequestCaptureFile(const std::string& path,
+                            std::vector<CaptureEvent>& events,
+                            std::string* error) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file) {
+    if (error != nullptr) {
+      *error = "Unable to open " + path;
+    }
+    return false;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return ParseRequestCapture(contents.str(), events, error);
+}
+
+size_t FilePrint::write(uint8_t b) {
+  return std::fputc(b, file_) == EOF ? 0 : 1;
+}
+
+size_t FilePrint::write(const uint8_t* buffer, size_t size) {
+  return std::fwrite(buffer, 1, size, file_);
+}
+
+void FilePrint::flush() { std::fflush(file_); }
+
+}  // namespace alpaca
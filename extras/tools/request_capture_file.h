@@ -0,0 +1,63 @@
+#ifndef TINY_ALPACA_SERVER_EXTRAS_TOOLS_REQUEST_CAPTURE_FILE_H_
+#define TINY_ALPACA_SERVER_EXTRAS_TOOLS_REQUEST_CAPTURE_FILE_H_
+
+// Support for reading the recordings produced by RequestCapture (see
+// src/request_capture.h for the format), and for writing them to a file on
+// host.
+//
+// Author: james.synge@gmail.com
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "request_capture.h"
+#include "utils/platform.h"
+
+namespace alpaca {
+
+struct CaptureEvent {
+  RequestCapture::ERecordType type;
+  uint8_t sock_num;
+
+  // Microseconds since the start of the capture, i.e. the sum of the deltas
+  // of this and all the preceding records.
+  uint64_t time_micros;
+
+  // The bytes read, for a kData record; else empty.
+  std::string data;
+};
+
+// Parses a recording, appending the events to 'events'. Returns true if the
+// recording is well formed; otherwise returns false, leaving in 'events' those
+// events that precede the problem, and storing a description of the problem in
+// 'error' (if not null). A recording that ends part way through a record (e.g.
+// because the device was reset while capturing) is treated as an error.
+bool ParseRequestCapture(std::string_view capture,
+                         std::vector<CaptureEvent>& events,
+                         std::string* error);
+
+// Reads the file at path and parses it with ParseRequestCapture.
+bool ReadRequestCaptureFile(const std::string& path,
+                            std::vector<CaptureEvent>& events,
+                            std::string* error);
+
+// Print implementation which writes to a stdio FILE, for passing to
+// RequestCapture::StartCapture on host. Doesn't take ownership of the FILE.
+class FilePrint : public Print {
+ public:
+  explicit FilePrint(FILE* file) : file_(file) {}
+
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  void flush() override;
+
+ private:
+  FILE* const file_;
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_EXTRAS_TOOLS_REQUEST_CAPTURE_FILE_H_
@@ -0,0 +1,78 @@
+#include "extras/tools/json_checker.h"
+
+// Tests of CheckJson.
+//
+// Author: james.synge@gmail.com
+
+#include <map>
+#include <string>
+
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(JsonCheckerTest, ValidScalars) {
+  for (const char* json :
+       {"0", "-1", "123", "1.5", "-0.25e+10", "2E-3", "true", "false", "null",
+        "\"\"", "\"abc\"", "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u00e9\"", " 1 "}) {
+    EXPECT_TRUE(CheckJson(json, nullptr)) << json;
+  }
+}
+
+TEST(JsonCheckerTest, InvalidScalars) {
+  for (const char* json :
+       {"", " ", "01", "-", "1.", ".5", "1e", "tru", "nul", "True", "\"abc",
+        "\"\\x\"", "\"\\u12\"", "\"a\nb\"", "1 2", "abc"}) {
+    EXPECT_FALSE(CheckJson(json, nullptr)) << json;
+  }
+}
+
+TEST(JsonCheckerTest, ValidCompounds) {
+  for (const char* json :
+       {"[]", "{}", "[1,2,3]", "[ [], {} , [{}] ]", "{\"a\": [1, {\"b\": {}}]}",
+        " { \"a\" : 1 , \"b\" : \"c\" } "}) {
+    EXPECT_TRUE(CheckJson(json, nullptr)) << json;
+  }
+}
+
+TEST(JsonCheckerTest, InvalidCompounds) {
+  for (const char* json :
+       {"[", "]", "[1,]", "[,1]", "{", "{\"a\"}", "{\"a\":}", "{a: 1}",
+        "{\"a\": 1,}", "{\"a\": 1} x", "[1] [2]"}) {
+    EXPECT_FALSE(CheckJson(json, nullptr)) << json;
+  }
+}
+
+TEST(JsonCheckerTest, ExtractsTopLevelScalars) {
+  std::map<std::string, std::string> properties;
+  EXPECT_TRUE(CheckJson(
+      R"({"Value": 1.5, "ClientTransactionID": 123, "ServerTransactionID": 9,)"
+      R"( "ErrorNumber": 0, "ErrorMessage": "", "Flag": true,)"
+      R"( "Array": [1, 2], "Object": {"Nested": 1}})",
+      &properties));
+  EXPECT_THAT(properties,
+              UnorderedElementsAre(Pair("Value", "1.5"),
+                                   Pair("ClientTransactionID", "123"),
+                                   Pair("ServerTransactionID", "9"),
+                                   Pair("ErrorNumber", "0"),
+                                   Pair("ErrorMessage", ""),
+                                   Pair("Flag", "true"), Pair("Array", ""),
+                                   Pair("Object", "")));
+}
+
+TEST(JsonCheckerTest, NonObjectHasNoProperties) {
+  std::map<std::string, std::string> properties;
+  EXPECT_TRUE(CheckJson("[{\"a\": 1}]", &properties));
+  EXPECT_THAT(properties, IsEmpty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,104 @@
+#include "extras/tools/request_capture_file.h"
+
+// Tests of ParseRequestCapture, using recordings made by RequestCapture.
+//
+// Author: james.synge@gmail.com
+
+#include <string>
+#include <vector>
+
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+#include "request_capture.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+std::string MakeRecording() {
+  PrintToStdString out;
+  RequestCapture::StartCapture(out);
+  RequestCapture::RecordConnect(0);
+  RequestCapture::RecordData(0, "GET /api", 8);
+  RequestCapture::RecordConnect(3);
+  RequestCapture::RecordData(0, std::string(200, 'v').data(), 200);
+  RequestCapture::RecordHalfClosed(0);
+  RequestCapture::RecordDisconnect(3);
+  RequestCapture::StopCapture();
+  return out.str();
+}
+
+TEST(RequestCaptureFileTest, RoundTrip) {
+  std::vector<CaptureEvent> events;
+  std::string error;
+  ASSERT_TRUE(ParseRequestCapture(MakeRecording(), events, &error)) << error;
+  ASSERT_EQ(events.size(), 6);
+
+  EXPECT_EQ(events[0].type, RequestCapture::kConnect);
+  EXPECT_EQ(events[0].sock_num, 0);
+  EXPECT_THAT(events[0].data, IsEmpty());
+  EXPECT_EQ(events[1].type, RequestCapture::kData);
+  EXPECT_EQ(events[1].sock_num, 0);
+  EXPECT_EQ(events[1].data, "GET /api");
+  EXPECT_EQ(events[2].type, RequestCapture::kConnect);
+  EXPECT_EQ(events[2].sock_num, 3);
+  EXPECT_EQ(events[3].type, RequestCapture::kData);
+  EXPECT_EQ(events[3].data, std::string(200, 'v'));
+  EXPECT_EQ(events[4].type, RequestCapture::kHalfClosed);
+  EXPECT_EQ(events[4].sock_num, 0);
+  EXPECT_EQ(events[5].type, RequestCapture::kDisconnect);
+  EXPECT_EQ(events[5].sock_num, 3);
+
+  for (size_t ndx = 1; ndx < events.size(); ++ndx) {
+    EXPECT_GE(events[ndx].time_micros, events[ndx - 1].time_micros);
+  }
+}
+
+TEST(RequestCaptureFileTest, EmptyRecording) {
+  std::vector<CaptureEvent> events;
+  EXPECT_TRUE(
+      ParseRequestCapture(std::string("TASCAP\x01", 7), events, nullptr));
+  EXPECT_THAT(events, IsEmpty());
+}
+
+TEST(RequestCaptureFileTest, BadHeader) {
+  std::vector<CaptureEvent> events;
+  std::string error;
+  EXPECT_FALSE(ParseRequestCapture("GET / HTTP/1.1\r\n", events, &error));
+  EXPECT_THAT(error, HasSubstr("header"));
+  EXPECT_FALSE(
+      ParseRequestCapture(std::string("TASCAP\x02", 7), events, &error));
+  EXPECT_THAT(error, HasSubstr("version"));
+  EXPECT_THAT(events, IsEmpty());
+}
+
+TEST(RequestCaptureFileTest, Truncated) {
+  const std::string recording = MakeRecording();
+  std::vector<CaptureEvent> events;
+  std::string error;
+  // Remove the last two records (each a 1 byte tag and a short time delta),
+  // and some of the data of the preceding data record.
+  ASSERT_FALSE(ParseRequestCapture(
+      recording.substr(0, recording.size() - 10), events, &error));
+  EXPECT_THAT(error, HasSubstr("Truncated data record"));
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(events[2].type, RequestCapture::kConnect);
+}
+
+TEST(RequestCaptureFileTest, InvalidRecordType) {
+  std::string recording("TASCAP\x01", 7);
+  recording += '\x70';
+  recording += '\x00';
+  std::vector<CaptureEvent> events;
+  std::string error;
+  EXPECT_FALSE(ParseRequestCapture(recording, events, &error));
+  EXPECT_THAT(error, HasSubstr("Invalid record type at offset 7"));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,108 @@
+#include "utils/binary_log_sink.h"
+
+// Tests of BinaryLogSink. The expected values of FileId are also checked by
+// extras/dev_tools/decode_binary_log_test.py, which must compute the same ids.
+//
+// Author: james.synge@gmail.com
+
+#include <string>
+
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+#include "utils/inline_literal.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+// Returns the record that BinaryLogSink should produce with file_id 0x1234 and
+// line_number 0x0102, with the fields between the header and the end.
+std::string Record(const std::string& fields) {
+  return std::string("\x1E\x34\x12\x02\x01", 5) + fields + std::string(1, '\0');
+}
+
+class SomePrintable {
+ public:
+  size_t printTo(Print& out) const { return out.print("xyz"); }
+};
+
+TEST(BinaryLogSinkTest, FileId) {
+  EXPECT_EQ(binary_log::FileId("foo.cpp"), 0x5050);
+  EXPECT_EQ(binary_log::FileId("/foo.cpp"), 0x5050);
+  EXPECT_EQ(binary_log::FileId("/a/b/c/foo.cpp"), 0x5050);
+  static_assert(TAS_BINARY_LOG_FILE_ID(__FILE__) == binary_log::FileId(__FILE__),
+                "FileId should be evaluated at compile time");
+  EXPECT_NE(binary_log::FileId("bar.cpp"), 0x5050);
+}
+
+TEST(BinaryLogSinkTest, EmptyRecord) {
+  PrintToStdString out;
+  { BinaryLogSink sink(out, 0x1234, 0x0102); }
+  EXPECT_EQ(out.str(), Record(""));
+}
+
+TEST(BinaryLogSinkTest, Integers) {
+  PrintToStdString out;
+  BinaryLogSink(out, 0x1234, 0x0102)
+      << static_cast<uint8_t>(1) << static_cast<uint16_t>(300)
+      << static_cast<int16_t>(-1) << static_cast<int32_t>(2) << true;
+  EXPECT_EQ(out.str(), Record(std::string("\x01\x01"
+                                          "\x01\xAC\x02"
+                                          "\x02\x01"
+                                          "\x02\x04"
+                                          "\x01\x01",
+                                          11)));
+}
+
+TEST(BinaryLogSinkTest, LargeIntegers) {
+  PrintToStdString out;
+  BinaryLogSink(out, 0x1234, 0x0102)
+      << static_cast<uint32_t>(0xFFFFFFFF) << static_cast<int32_t>(-2147483648);
+  EXPECT_EQ(out.str(), Record(std::string("\x01\xFF\xFF\xFF\xFF\x0F"
+                                          "\x02\xFF\xFF\xFF\xFF\x0F",
+                                          12)));
+}
+
+TEST(BinaryLogSinkTest, CharsAndStrings) {
+  PrintToStdString out;
+  BinaryLogSink(out, 0x1234, 0x0102)
+      << 'a' << "bc" << std::string("def") << SomePrintable();
+  EXPECT_EQ(out.str(), Record(std::string("\x03"
+                                          "a"
+                                          "\x07"
+                                          "bc\0"
+                                          "\x07"
+                                          "def\0"
+                                          "\x07"
+                                          "xyz\0",
+                                          16)));
+}
+
+TEST(BinaryLogSinkTest, FlashStringIsWrittenAsAddress) {
+  auto* flash_string = TAS_FLASHSTR("some long string literal");
+  uintptr_t address = reinterpret_cast<uintptr_t>(flash_string);
+  std::string fields("\x05");
+  while (address >= 0x80) {
+    fields.push_back(static_cast<char>(address | 0x80));
+    address >>= 7;
+  }
+  fields.push_back(static_cast<char>(address));
+
+  PrintToStdString out;
+  BinaryLogSink(out, 0x1234, 0x0102) << flash_string;
+  EXPECT_EQ(out.str(), Record(fields));
+}
+
+TEST(BinaryLogSinkTest, FloatAndBase) {
+  PrintToStdString out;
+  BinaryLogSink(out, 0x1234, 0x0102) << 1.0f << BaseHex << BaseDec;
+  EXPECT_EQ(out.str(), Record(std::string("\x04\x00\x00\x80\x3F"
+                                          "\x08\x10"
+                                          "\x08\x0A",
+                                          9)));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,195 @@
+#include "utils/connection.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "extras/test_tools/mock_ethernet_client.h"
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::StrictMock;
+
+// A Connection that reads from a string, one byte at a time, to test the
+// default implementation of Connection::read(buf, size).
+class StringConnection : public Connection {
+ public:
+  explicit StringConnection(std::string input) : input_(input) {}
+
+  using Connection::read;
+
+  size_t write(uint8_t b) override { return 0; }
+  size_t write(const uint8_t* buf, size_t size) override { return 0; }
+  int available() override { return input_.size() - cursor_; }
+  int read() override {
+    ++read_calls_;
+    if (cursor_ < input_.size()) {
+      return static_cast<uint8_t>(input_[cursor_++]);
+    }
+    return -1;
+  }
+  int peek() override { return -1; }
+  void close() override {}
+  bool connected() const override { return true; }
+  uint8_t sock_num() const override { return 0; }
+
+  int read_calls_ = 0;
+
+ private:
+  const std::string input_;
+  size_t cursor_ = 0;
+};
+
+class TestWrappedClientConnection : public WrappedClientConnection {
+ public:
+  explicit TestWrappedClientConnection(Client& client) : client_(client) {}
+
+  void close() override {}
+  bool connected() const override { return true; }
+  uint8_t sock_num() const override { return 0; }
+
+ protected:
+  Client& client() const override { return client_; }
+
+ private:
+  Client& client_;
+};
+
+class TestWriteBufferedWrappedClientConnection
+    : public WriteBufferedWrappedClientConnection {
+ public:
+  explicit TestWriteBufferedWrappedClientConnection(Client& client)
+      : WriteBufferedWrappedClientConnection(write_buffer_,
+                                             sizeof write_buffer_),
+        client_(client) {}
+
+  void close() override {}
+  bool connected() const override { return true; }
+  uint8_t sock_num() const override { return 0; }
+
+ protected:
+  Client& client() const override { return client_; }
+
+ private:
+  Client& client_;
+  uint8_t write_buffer_[8];
+};
+
+// Records the data passed to WriteBufferedData, and the number of times that
+// SendBufferedData is called, as a subclass that accumulates a response in the
+// network chip's TX buffer would do.
+class StagingConnection : public TestWriteBufferedWrappedClientConnection {
+ public:
+  using TestWriteBufferedWrappedClientConnection::
+      TestWriteBufferedWrappedClientConnection;
+
+  std::string staged_;
+  std::vector<std::string> sent_;
+
+ protected:
+  size_t WriteBufferedData(const uint8_t* buf, size_t size) override {
+    staged_.append(reinterpret_cast<const char*>(buf), size);
+    return size;
+  }
+  void SendBufferedData() override {
+    sent_.push_back(staged_);
+    staged_.clear();
+  }
+};
+
+TEST(ConnectionTest, DefaultReadStopsAtAvailable) {
+  StringConnection conn("abcdef");
+  uint8_t buf[16];
+  EXPECT_EQ(conn.read(buf, 4), 4);
+  EXPECT_EQ(std::string(reinterpret_cast<char*>(buf), 4), "abcd");
+  EXPECT_EQ(conn.read_calls_, 4);
+  EXPECT_EQ(conn.read(buf, sizeof buf), 2);
+  EXPECT_EQ(std::string(reinterpret_cast<char*>(buf), 2), "ef");
+  EXPECT_EQ(conn.read_calls_, 6);
+  EXPECT_EQ(conn.read(buf, sizeof buf), 0);
+  EXPECT_EQ(conn.read_calls_, 6);
+}
+
+TEST(ConnectionTest, WrappedReadIsSingleBurst) {
+  StrictMock<MockEthernetClient> client;
+  TestWrappedClientConnection conn(client);
+  uint8_t buf[16];
+
+  // Only 5 bytes are available, so only 5 are requested from the client, in
+  // one call.
+  EXPECT_CALL(client, available).WillOnce(Return(5));
+  EXPECT_CALL(client, read(buf, 5)).WillOnce(Return(5));
+  EXPECT_EQ(conn.read(buf, sizeof buf), 5);
+
+  // More bytes are available than will fit.
+  EXPECT_CALL(client, available).WillOnce(Return(100));
+  EXPECT_CALL(client, read(buf, sizeof buf)).WillOnce(Return(sizeof buf));
+  EXPECT_EQ(conn.read(buf, sizeof buf), sizeof buf);
+
+  // Nothing available, so no read.
+  EXPECT_CALL(client, available).WillOnce(Return(0));
+  EXPECT_EQ(conn.read(buf, sizeof buf), 0);
+
+  // The client reports an error.
+  EXPECT_CALL(client, available).WillOnce(Return(3));
+  EXPECT_CALL(client, read(buf, 3)).WillOnce(Return(-1));
+  EXPECT_EQ(conn.read(buf, sizeof buf), 0);
+}
+
+TEST(ConnectionTest, WriteBufferedReadIsSingleBurst) {
+  StrictMock<MockEthernetClient> client;
+  TestWriteBufferedWrappedClientConnection conn(client);
+  uint8_t buf[16];
+
+  EXPECT_CALL(client, available).WillOnce(Return(7));
+  EXPECT_CALL(client, read(buf, 7)).WillOnce(Return(7));
+  EXPECT_EQ(conn.read(buf, sizeof buf), 7);
+
+  EXPECT_CALL(client, available).WillOnce(Return(-1));
+  EXPECT_EQ(conn.read(buf, sizeof buf), 0);
+}
+
+TEST(ConnectionTest, WriteBufferedFlushesWhenFull) {
+  StrictMock<MockEthernetClient> client;
+  TestWriteBufferedWrappedClientConnection conn(client);
+
+  // Nothing is written until the 8 byte buffer is full.
+  conn.print("abcdefg");
+
+  EXPECT_CALL(client, connected).WillRepeatedly(Return(1));
+  EXPECT_CALL(client, write(_, 8)).WillOnce(Return(8));
+  conn.print("hij");
+
+  EXPECT_CALL(client, write(_, 2)).WillOnce(Return(2));
+  conn.flush();
+  EXPECT_FALSE(conn.hasWriteError());
+}
+
+TEST(ConnectionTest, WriteBufferedSendsOnceWhenFlushed) {
+  NiceMock<MockEthernetClient> client;
+  EXPECT_CALL(client, connected).WillRepeatedly(Return(1));
+  StagingConnection conn(client);
+
+  // The header and body are passed to WriteBufferedData one buffer-full at a
+  // time, but are only sent when flushed.
+  conn.print("HTTP/1.1 200 OK\r\n\r\n");
+  conn.print("{\"Value\": 1}");
+  EXPECT_THAT(conn.sent_, IsEmpty());
+  conn.flush();
+  EXPECT_THAT(conn.sent_,
+              ElementsAre("HTTP/1.1 200 OK\r\n\r\n{\"Value\": 1}"));
+  EXPECT_THAT(conn.staged_, IsEmpty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -52,6 +52,16 @@ TEST(CountingPrintTest, Mixed) {
   EXPECT_EQ(counter.count(), 4);
 }
 
+TEST(CountingSinkTest, Mixed) {
+  PrintNoOp no_op;
+  CountingSink<PrintNoOp> counter(no_op);
+  EXPECT_EQ(counter.count(), 0);
+  counter.print('a');
+  counter.print(123);
+  counter.write("abc\r\n", 5);
+  EXPECT_EQ(counter.count(), 9);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace alpaca
@@ -6,6 +6,7 @@
 
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <limits>
 #include <string>
@@ -22,6 +23,25 @@ namespace alpaca {
 namespace test {
 namespace {
 
+// Records the output, and the number of calls to write.
+class CallCountingPrint : public Print {
+ public:
+  size_t write(uint8_t b) override {
+    ++calls;
+    str.push_back(static_cast<char>(b));
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    ++calls;
+    str.append(reinterpret_cast<const char*>(buffer), size);
+    return size;
+  }
+  using Print::write;
+
+  std::string str;
+  int calls = 0;
+};
+
 class JsonEncodersTest : public testing::Test {
  protected:
   void ConfirmEncoding(const JsonElementSourceFunction& func,
@@ -163,6 +183,29 @@ TEST_F(JsonEncodersTest, ObjectWithDoubleValues) {
                    ", \"double NaN\": \"NaN\"}"));
 }
 
+// Values written by the JSON encoder must be read back by StringView::to_double
+// as the nearest double to the printed text (the encoder prints just 2 digits
+// after the decimal point, so that isn't the original value).
+TEST_F(JsonEncodersTest, DoubleRoundTripsThroughToDouble) {
+  const double kValues[] = {0,      1,     -1,     0.5,       0.25,
+                            -0.125, 12.34, 99.99,  -273.15,   1013.25,
+                            1.0e-3, 1e6,   12345.678, 4294967295, 1e12};
+  for (const double value : kValues) {
+    ElementSourceFunctionAdapter source(
+        [value](JsonArrayEncoder& encoder) { encoder.AddDoubleElement(value); });
+    PrintToStdString out;
+    JsonArrayEncoder::Encode(source, out);
+    const std::string json = out.str();
+    ASSERT_GE(json.size(), 3) << json;
+    const std::string text = json.substr(1, json.size() - 2);
+    double parsed = 0;
+    ASSERT_TRUE(StringView(text.data(), text.size()).to_double(parsed))
+        << text;
+    EXPECT_EQ(parsed, std::strtod(text.c_str(), nullptr)) << text;
+    EXPECT_NEAR(parsed, value, 0.00501) << text;
+  }
+}
+
 TEST_F(JsonEncodersTest, ObjectWithArrayValues) {
   const double kPi = 3.14159265359L;
   auto func = [kPi](JsonObjectEncoder& object_encoder) {
@@ -237,6 +280,21 @@ TEST_F(JsonEncodersTest, ArrayOfMixedValueTypes) {
                    "-1.00", ", {\"inner-empty-array\": []}]"));
 }
 
+TEST_F(JsonEncodersTest, EncodeReturnsSizeAndMinimizesWrites) {
+  PropertySourceFunctionAdapter source([](JsonObjectEncoder& encoder) {
+    encoder.AddStringProperty(StringView("a"), StringView("xy\"z"));
+    encoder.AddBooleanProperty(StringView("b"), true);
+  });
+  CallCountingPrint out;
+  const size_t size = JsonObjectEncoder::Encode(source, out);
+  EXPECT_EQ(size, out.str.size());
+  EXPECT_EQ(out.str, R"({"a": "xy\"z", "b": true})");
+  // {, "a", :, "xy\"z", comma, "b", :, true, } where each quoted string is
+  // written with a call per quote, plus a call per run of unescaped chars and
+  // per escape sequence.
+  EXPECT_EQ(out.calls, 1 + 3 + 1 + 5 + 1 + 3 + 1 + 1 + 1);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace alpaca
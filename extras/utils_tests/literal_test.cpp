@@ -167,6 +167,19 @@ TEST(LiteralTest, PrintTo) {
   EXPECT_EQ(out.str(), kMixedStr);
 }
 
+// printTo copies the literal in chunks; check lengths either side of the
+// chunk boundaries.
+TEST(LiteralTest, PrintToLongLiterals) {
+  const std::string str =
+      "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  for (size_t size = 0; size <= str.size(); ++size) {
+    Literal literal(str.data(), size);
+    PrintToStdString out;
+    EXPECT_EQ(literal.printTo(out), size);
+    EXPECT_EQ(out.str(), str.substr(0, size));
+  }
+}
+
 TEST(LiteralTest, StreamMixed) {
   Literal literal(kMixedStr);
 
@@ -226,6 +239,24 @@ TEST(LiteralTest, Inequality) {
   EXPECT_NE(literal1, literal3);
 }
 
+// operator== compares the literals in chunks; check that a difference in any
+// position is detected.
+TEST(LiteralTest, LongLiteralEquality) {
+  const std::string str1 =
+      "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  for (size_t size = 1; size <= str1.size(); ++size) {
+    std::string str2 = str1;
+    Literal literal1(str1.data(), size);
+    Literal literal2(str2.data(), size);
+    EXPECT_EQ(literal1, literal2);
+    for (size_t pos = 0; pos < size; ++pos) {
+      str2[pos] = '_';
+      EXPECT_NE(literal1, literal2) << "size=" << size << ", pos=" << pos;
+      str2[pos] = str1[pos];
+    }
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace alpaca
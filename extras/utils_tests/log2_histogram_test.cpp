@@ -0,0 +1,85 @@
+#include "utils/log2_histogram.h"
+
+// Tests of Log2Histogram.
+//
+// Author: james.synge@gmail.com
+
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+TEST(Log2HistogramTest, BucketFor) {
+  EXPECT_EQ(Log2Histogram::BucketFor(0), 0);
+  EXPECT_EQ(Log2Histogram::BucketFor(1), 1);
+  EXPECT_EQ(Log2Histogram::BucketFor(2), 2);
+  EXPECT_EQ(Log2Histogram::BucketFor(3), 2);
+  EXPECT_EQ(Log2Histogram::BucketFor(4), 3);
+  EXPECT_EQ(Log2Histogram::BucketFor(0x1FFF), 13);
+  EXPECT_EQ(Log2Histogram::BucketFor(0x2000), 14);
+  EXPECT_EQ(Log2Histogram::BucketFor(0x3FFF), 14);
+  EXPECT_EQ(Log2Histogram::BucketFor(0x4000), 15);
+  EXPECT_EQ(Log2Histogram::BucketFor(0xFFFFFFFF), 15);
+}
+
+TEST(Log2HistogramTest, BucketLowerBound) {
+  EXPECT_EQ(Log2Histogram::BucketLowerBound(0), 0);
+  for (uint8_t bucket = 1; bucket < Log2Histogram::kNumBuckets; ++bucket) {
+    const uint32_t lower_bound = Log2Histogram::BucketLowerBound(bucket);
+    EXPECT_EQ(Log2Histogram::BucketFor(lower_bound), bucket);
+    EXPECT_EQ(Log2Histogram::BucketFor(lower_bound - 1), bucket - 1);
+  }
+}
+
+TEST(Log2HistogramTest, RecordAndReset) {
+  Log2Histogram histogram;
+  EXPECT_EQ(histogram.total_count(), 0);
+  for (uint8_t bucket = 0; bucket < Log2Histogram::kNumBuckets; ++bucket) {
+    EXPECT_EQ(histogram.count(bucket), 0);
+  }
+
+  histogram.Record(0);
+  histogram.Record(5);
+  histogram.Record(6);
+  histogram.Record(1000000);
+  EXPECT_EQ(histogram.count(0), 1);
+  EXPECT_EQ(histogram.count(3), 2);
+  EXPECT_EQ(histogram.count(15), 1);
+  EXPECT_EQ(histogram.total_count(), 4);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.total_count(), 0);
+}
+
+TEST(Log2HistogramTest, CountsSaturate) {
+  Log2Histogram histogram;
+  for (uint32_t i = 0; i < 70000; ++i) {
+    histogram.Record(7);
+  }
+  EXPECT_EQ(histogram.count(3), 65535);
+  EXPECT_EQ(histogram.total_count(), 65535);
+}
+
+TEST(Log2HistogramTest, PrintTo) {
+  Log2Histogram histogram;
+  {
+    PrintToStdString out;
+    EXPECT_EQ(histogram.printTo(out), 0);
+    EXPECT_EQ(out.str(), "");
+  }
+
+  histogram.Record(1);
+  histogram.Record(4);
+  histogram.Record(5);
+  {
+    PrintToStdString out;
+    EXPECT_EQ(histogram.printTo(out), 7);
+    EXPECT_EQ(out.str(), "0 1 0 2");
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
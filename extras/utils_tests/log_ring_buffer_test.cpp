@@ -0,0 +1,107 @@
+#include "utils/log_ring_buffer.h"
+
+// Tests of LogRingBuffer.
+//
+// Author: james.synge@gmail.com
+
+#include <string>
+
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+constexpr size_t kUnlimited = ~static_cast<size_t>(0);
+
+TEST(LogRingBufferTest, Empty) {
+  uint8_t storage[8];
+  LogRingBuffer buffer(storage, sizeof storage);
+  EXPECT_EQ(buffer.size(), 0);
+  EXPECT_EQ(buffer.dropped_count(), 0);
+
+  PrintToStdString out;
+  EXPECT_EQ(buffer.Drain(out, kUnlimited), 0);
+  EXPECT_EQ(out.str(), "");
+}
+
+TEST(LogRingBufferTest, WriteAndDrain) {
+  uint8_t storage[8];
+  LogRingBuffer buffer(storage, sizeof storage);
+  EXPECT_EQ(buffer.print("abc"), 3);
+  EXPECT_EQ(buffer.print('d'), 1);
+  EXPECT_EQ(buffer.size(), 4);
+
+  PrintToStdString out;
+  EXPECT_EQ(buffer.Drain(out, kUnlimited), 4);
+  EXPECT_EQ(out.str(), "abcd");
+  EXPECT_EQ(buffer.size(), 0);
+  EXPECT_EQ(buffer.dropped_count(), 0);
+}
+
+TEST(LogRingBufferTest, DrainIsLimited) {
+  uint8_t storage[8];
+  LogRingBuffer buffer(storage, sizeof storage);
+  buffer.print("abcdef");
+
+  PrintToStdString out;
+  EXPECT_EQ(buffer.Drain(out, 2), 2);
+  EXPECT_EQ(out.str(), "ab");
+  EXPECT_EQ(buffer.size(), 4);
+  EXPECT_EQ(buffer.Drain(out, 0), 0);
+  EXPECT_EQ(buffer.Drain(out, 3), 3);
+  EXPECT_EQ(out.str(), "abcde");
+  EXPECT_EQ(buffer.Drain(out, 3), 1);
+  EXPECT_EQ(out.str(), "abcdef");
+}
+
+TEST(LogRingBufferTest, WrapsAround) {
+  uint8_t storage[8];
+  LogRingBuffer buffer(storage, sizeof storage);
+  PrintToStdString out;
+  std::string expected;
+  for (int i = 0; i < 10; ++i) {
+    buffer.print("12345");
+    expected += "12345";
+    EXPECT_EQ(buffer.Drain(out, kUnlimited), 5);
+    EXPECT_EQ(out.str(), expected);
+  }
+  EXPECT_EQ(buffer.dropped_count(), 0);
+}
+
+TEST(LogRingBufferTest, DropsWhenFull) {
+  uint8_t storage[8];
+  LogRingBuffer buffer(storage, sizeof storage);
+  EXPECT_EQ(buffer.print("abcdef"), 6);
+  EXPECT_EQ(buffer.print("ghijk"), 2);
+  EXPECT_EQ(buffer.print('l'), 0);
+  EXPECT_EQ(buffer.size(), 8);
+  EXPECT_EQ(buffer.dropped_count(), 4);
+
+  PrintToStdString out;
+  EXPECT_EQ(buffer.Drain(out, 3), 3);
+  EXPECT_EQ(buffer.print("mnop"), 3);
+  EXPECT_EQ(buffer.dropped_count(), 5);
+  EXPECT_EQ(buffer.Drain(out, kUnlimited), 8);
+  EXPECT_EQ(out.str(), "abcdefghmno");
+}
+
+TEST(LogRingBufferTest, DrainsInChunks) {
+  uint8_t storage[200];
+  LogRingBuffer buffer(storage, sizeof storage);
+  std::string expected;
+  for (int i = 0; i < 150; ++i) {
+    expected.push_back('a' + (i % 26));
+  }
+  EXPECT_EQ(buffer.print(expected.c_str()), expected.size());
+
+  PrintToStdString out;
+  EXPECT_EQ(buffer.Drain(out, 100), 100);
+  EXPECT_EQ(buffer.Drain(out, kUnlimited), 50);
+  EXPECT_EQ(out.str(), expected);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
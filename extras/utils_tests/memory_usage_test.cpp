@@ -0,0 +1,57 @@
+#include "utils/memory_usage.h"
+
+// Tests of the host implementation of the memory usage functions.
+//
+// Author: james.synge@gmail.com
+
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+// Uses about size bytes of stack per level of recursion.
+template <size_t size>
+ABSL_ATTRIBUTE_NOINLINE int Recurse(int levels) {
+  volatile char buffer[size];
+  buffer[0] = static_cast<char>(levels);
+  NoteStackUsage();
+  if (levels > 1) {
+    return Recurse<size>(levels - 1) + buffer[0];
+  }
+  return buffer[0];
+}
+
+TEST(MemoryUsageTest, NoUsageAfterReset) {
+  ResetMemoryUsage();
+  EXPECT_EQ(MaxStackUsed(), 0);
+}
+
+TEST(MemoryUsageTest, RecordsDeepestCall) {
+  ResetMemoryUsage();
+  Recurse<100>(1);
+  const size_t one_level = MaxStackUsed();
+  EXPECT_GE(one_level, 100);
+
+  Recurse<100>(10);
+  const size_t ten_levels = MaxStackUsed();
+  EXPECT_GE(ten_levels, one_level + 900);
+
+  // Shallower calls don't reduce the maximum.
+  Recurse<100>(2);
+  EXPECT_EQ(MaxStackUsed(), ten_levels);
+
+  ResetMemoryUsage();
+  Recurse<100>(2);
+  EXPECT_LT(MaxStackUsed(), ten_levels);
+}
+
+TEST(MemoryUsageTest, NoRamMeasurementsOnHost) {
+  EXPECT_EQ(MinFreeRam(), 0);
+  EXPECT_EQ(CurrentFreeRam(), 0);
+  EXPECT_EQ(HeapSize(), 0);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,91 @@
+#include "utils/resumable_print.h"
+
+// Tests of ResumablePrint.
+//
+// Author: james.synge@gmail.com
+
+#include <string>
+
+#include "extras/test_tools/print_to_std_string.h"
+#include "googletest/gmock.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+constexpr uint32_t kUnlimited = ~static_cast<uint32_t>(0);
+
+// Generates the same output each time, using a mix of write calls.
+void GenerateOutput(Print& out) {
+  out.print("abc");
+  out.print('d');
+  out.print(1234);
+  out.write(reinterpret_cast<const uint8_t*>("efghij"), 6);
+}
+
+const char kFullOutput[] = "abcd1234efghij";
+
+TEST(ResumablePrintTest, Unused) {
+  PrintToStdString p2ss;
+  ResumablePrint out(p2ss, 0, kUnlimited);
+  EXPECT_EQ(out.count(), 0);
+  EXPECT_EQ(out.forwarded(), 0);
+  EXPECT_TRUE(out.is_complete());
+}
+
+TEST(ResumablePrintTest, Unlimited) {
+  PrintToStdString p2ss;
+  ResumablePrint out(p2ss, 0, kUnlimited);
+  GenerateOutput(out);
+  EXPECT_EQ(p2ss.str(), kFullOutput);
+  EXPECT_EQ(out.count(), 14);
+  EXPECT_EQ(out.forwarded(), 14);
+  EXPECT_TRUE(out.is_complete());
+}
+
+TEST(ResumablePrintTest, SkipWithUnlimited) {
+  PrintToStdString p2ss;
+  ResumablePrint out(p2ss, 5, kUnlimited);
+  GenerateOutput(out);
+  EXPECT_EQ(p2ss.str(), "234efghij");
+  EXPECT_EQ(out.count(), 14);
+  EXPECT_EQ(out.forwarded(), 9);
+  EXPECT_TRUE(out.is_complete());
+}
+
+TEST(ResumablePrintTest, ExactLimit) {
+  PrintToStdString p2ss;
+  ResumablePrint out(p2ss, 0, 14);
+  GenerateOutput(out);
+  EXPECT_EQ(p2ss.str(), kFullOutput);
+  EXPECT_TRUE(out.is_complete());
+}
+
+TEST(ResumablePrintTest, WriteInPieces) {
+  // Write the output in pieces of every size from 1 to the full size, and
+  // confirm that the concatenation of the pieces matches the full output.
+  for (uint32_t limit = 1; limit <= 14; ++limit) {
+    PrintToStdString p2ss;
+    uint32_t skip = 0;
+    int calls = 0;
+    while (true) {
+      ResumablePrint out(p2ss, skip, limit);
+      GenerateOutput(out);
+      ++calls;
+      EXPECT_EQ(out.count(), 14);
+      EXPECT_LE(out.forwarded(), limit);
+      skip += out.forwarded();
+      if (out.is_complete()) {
+        break;
+      }
+      EXPECT_EQ(out.forwarded(), limit);
+      ASSERT_LT(calls, 20);
+    }
+    EXPECT_EQ(p2ss.str(), kFullOutput) << "limit=" << limit;
+    EXPECT_EQ(calls, (14 + limit - 1) / limit) << "limit=" << limit;
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
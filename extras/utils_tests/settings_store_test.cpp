@@ -0,0 +1,334 @@
+#include "utils/settings_store.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "googletest/gtest.h"
+#include "utils/platform.h"
+#include "utils/string_view.h"
+#include "utils/task_scheduler.h"
+#include "utils/utils_config.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+// Each bank is 64 bytes: an 8 byte header, with room for 3 records of 8 byte
+// values (15 bytes each), or 7 records of 1 byte values.
+constexpr int kAddress = 512;
+constexpr uint16_t kSize = 128;
+constexpr uint8_t kMaxValueSize = 8;
+
+using TestStore = SettingsStore<4, kMaxValueSize>;
+
+std::vector<uint8_t> ReadRegion() {
+  std::vector<uint8_t> result;
+  for (int ndx = 0; ndx < kSize; ++ndx) {
+    result.push_back(EEPROM.read(kAddress + ndx));
+  }
+  return result;
+}
+
+int CountDifferences(const std::vector<uint8_t>& a,
+                     const std::vector<uint8_t>& b) {
+  int result = 0;
+  for (size_t ndx = 0; ndx < a.size(); ++ndx) {
+    if (a[ndx] != b[ndx]) {
+      ++result;
+    }
+  }
+  return result;
+}
+
+std::string GetString(const SettingsStoreBase& store, uint16_t key) {
+  const StringView view = store.GetString(key);
+  return std::string(view.data(), view.size());
+}
+
+class SettingsStoreTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int ndx = 0; ndx < kSize; ++ndx) {
+      EEPROM.write(kAddress + ndx, 0xFF);
+    }
+  }
+};
+
+TEST_F(SettingsStoreTest, FormatsEmptyRegion) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  EXPECT_EQ(store.generation(), 1);
+  EXPECT_EQ(store.active_bank(), 0);
+  EXPECT_EQ(store.bytes_used(), 8);
+  EXPECT_FALSE(store.Contains(1));
+  EXPECT_TRUE(store.GetString(1).empty());
+  EXPECT_FALSE(store.HasPendingWrites());
+
+  // The header is recognized when loaded again.
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(store2.generation(), 1);
+  EXPECT_EQ(store2.bytes_used(), 8);
+}
+
+TEST_F(SettingsStoreTest, RoundTripAfterFlush) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  EXPECT_TRUE(store.PutString(1, StringView("Heater")));
+  EXPECT_TRUE(store.PutValue<uint16_t>(2, 1234));
+  EXPECT_EQ(GetString(store, 1), "Heater");
+  EXPECT_TRUE(store.HasPendingWrites());
+  store.Flush();
+  EXPECT_FALSE(store.HasPendingWrites());
+  EXPECT_EQ(store.bytes_used(), 8 + 13 + 9);
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(GetString(store2, 1), "Heater");
+  uint16_t value = 0;
+  EXPECT_TRUE(store2.GetValue(2, value));
+  EXPECT_EQ(value, 1234);
+  // The size must match.
+  uint32_t wrong_size;
+  EXPECT_FALSE(store2.GetValue(2, wrong_size));
+  EXPECT_EQ(store2.bytes_used(), store.bytes_used());
+}
+
+TEST_F(SettingsStoreTest, WritesAreDeferred) {
+  TaskScheduler scheduler;
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  store.SetTaskScheduler(scheduler);
+  const auto before = ReadRegion();
+
+  EXPECT_TRUE(store.PutString(1, StringView("Dew")));
+  EXPECT_EQ(ReadRegion(), before);
+  EXPECT_TRUE(store.is_scheduled());
+
+  int steps = 0;
+  auto previous = before;
+  while (store.HasPendingWrites()) {
+    ASSERT_EQ(scheduler.RunDueTasks(millis()), 1);
+    const auto current = ReadRegion();
+    EXPECT_LE(CountDifferences(previous, current),
+              TAS_SETTINGS_STORE_BYTES_PER_STEP);
+    previous = current;
+    ++steps;
+  }
+  EXPECT_GE(steps, 10 / TAS_SETTINGS_STORE_BYTES_PER_STEP);
+  EXPECT_FALSE(store.is_scheduled());
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(GetString(store2, 1), "Dew");
+}
+
+TEST_F(SettingsStoreTest, UnchangedValueIsNotWritten) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  EXPECT_TRUE(store.PutString(1, StringView("abc")));
+  store.Flush();
+  const uint16_t bytes_used = store.bytes_used();
+  EXPECT_TRUE(store.PutString(1, StringView("abc")));
+  EXPECT_FALSE(store.HasPendingWrites());
+  EXPECT_EQ(store.bytes_used(), bytes_used);
+}
+
+TEST_F(SettingsStoreTest, LaterRecordsReplaceEarlierOnes) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  EXPECT_TRUE(store.PutString(1, StringView("first")));
+  store.Flush();
+  EXPECT_TRUE(store.PutString(1, StringView("second")));
+  store.Flush();
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(GetString(store2, 1), "second");
+  EXPECT_EQ(store2.generation(), 1);
+}
+
+TEST_F(SettingsStoreTest, RemoveIsPersisted) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  EXPECT_TRUE(store.PutString(1, StringView("one")));
+  EXPECT_TRUE(store.PutString(2, StringView("two")));
+  store.Flush();
+  EXPECT_TRUE(store.Remove(1));
+  EXPECT_FALSE(store.Contains(1));
+  EXPECT_FALSE(store.Remove(1));
+  store.Flush();
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_FALSE(store2.Contains(1));
+  EXPECT_EQ(GetString(store2, 2), "two");
+}
+
+TEST_F(SettingsStoreTest, CompactionAlternatesBanks) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  // Each change to setting 1 appends an 8 byte record, so 7 fit in a bank.
+  for (uint8_t value = 0; value < 7; ++value) {
+    EXPECT_TRUE(store.PutValue(1, value));
+    store.Flush();
+  }
+  EXPECT_EQ(store.generation(), 1);
+  EXPECT_EQ(store.active_bank(), 0);
+  EXPECT_EQ(store.bytes_used(), 64);
+
+  EXPECT_TRUE(store.PutValue<uint8_t>(1, 7));
+  store.Flush();
+  EXPECT_EQ(store.generation(), 2);
+  EXPECT_EQ(store.active_bank(), 1);
+  EXPECT_EQ(store.bytes_used(), 16);
+
+  for (uint8_t value = 8; value < 15; ++value) {
+    EXPECT_TRUE(store.PutValue(1, value));
+    store.Flush();
+  }
+  EXPECT_EQ(store.generation(), 3);
+  EXPECT_EQ(store.active_bank(), 0);
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(store2.generation(), 3);
+  EXPECT_EQ(store2.active_bank(), 0);
+  EXPECT_EQ(store2.bytes_used(), store.bytes_used());
+  uint8_t value = 0;
+  EXPECT_TRUE(store2.GetValue(1, value));
+  EXPECT_EQ(value, 14);
+}
+
+TEST_F(SettingsStoreTest, CompactionDropsRemovedSettings) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  EXPECT_TRUE(store.PutValue<uint8_t>(1, 1));
+  EXPECT_TRUE(store.PutValue<uint8_t>(2, 2));
+  store.Flush();
+  for (uint8_t value = 10; value < 15; ++value) {
+    EXPECT_TRUE(store.PutValue(1, value));
+    store.Flush();
+  }
+  EXPECT_EQ(store.bytes_used(), 64);
+
+  // The bank is full, so the removal is recorded by compaction, which doesn't
+  // copy the removed setting.
+  EXPECT_TRUE(store.Remove(2));
+  EXPECT_TRUE(store.PutValue<uint8_t>(1, 20));
+  store.Flush();
+  EXPECT_EQ(store.generation(), 2);
+  EXPECT_EQ(store.bytes_used(), 16);
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_FALSE(store2.Contains(2));
+  uint8_t value = 0;
+  EXPECT_TRUE(store2.GetValue(1, value));
+  EXPECT_EQ(value, 20);
+}
+
+TEST_F(SettingsStoreTest, TornRecordIsIgnored) {
+  TaskScheduler scheduler;
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  store.SetTaskScheduler(scheduler);
+  EXPECT_TRUE(store.PutString(1, StringView("old")));
+  store.Flush();
+  EXPECT_TRUE(store.PutString(1, StringView("new")));
+  // Write only part of the record, as if reset while writing.
+  scheduler.RunDueTasks(millis());
+  scheduler.RunDueTasks(millis());
+  EXPECT_TRUE(store.HasPendingWrites());
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(GetString(store2, 1), "old");
+
+  // Records appended after reloading replace the torn record.
+  EXPECT_TRUE(store2.PutString(1, StringView("newer")));
+  store2.Flush();
+  TestStore store3(kAddress, kSize);
+  store3.Initialize();
+  EXPECT_EQ(GetString(store3, 1), "newer");
+}
+
+TEST_F(SettingsStoreTest, StaleRecordsAreNotLoaded) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  // Fill bank 0, then compact into bank 1, and then back into bank 0, leaving
+  // records of generation 1 after the end of those of generation 3.
+  for (uint8_t value = 0; value < 7; ++value) {
+    EXPECT_TRUE(store.PutValue(2, value));
+    store.Flush();
+  }
+  EXPECT_TRUE(store.Remove(2));
+  for (uint8_t value = 0; value < 8; ++value) {
+    EXPECT_TRUE(store.PutValue(1, value));
+    store.Flush();
+  }
+  EXPECT_EQ(store.generation(), 3);
+  EXPECT_EQ(store.active_bank(), 0);
+  EXPECT_LT(store.bytes_used(), 64);
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_FALSE(store2.Contains(2));
+  EXPECT_EQ(store2.bytes_used(), store.bytes_used());
+}
+
+TEST_F(SettingsStoreTest, CorruptHeaderSelectsOtherBank) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  for (uint8_t value = 0; value < 8; ++value) {
+    EXPECT_TRUE(store.PutValue(1, value));
+    store.Flush();
+  }
+  EXPECT_EQ(store.active_bank(), 1);
+
+  // Corrupt the generation in the header of bank 1.
+  EEPROM.write(kAddress + 64 + 2, 0x55);
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(store2.active_bank(), 0);
+  uint8_t value = 0;
+  EXPECT_TRUE(store2.GetValue(1, value));
+  EXPECT_EQ(value, 6);
+}
+
+TEST_F(SettingsStoreTest, RejectsWhatDoesNotFit) {
+  TestStore store(kAddress, kSize);
+  store.Initialize();
+  EXPECT_FALSE(store.PutString(SettingsStoreBase::kInvalidKey,
+                               StringView("x")));
+  EXPECT_FALSE(store.PutString(1, StringView("123456789")));
+
+  // Three 15 byte records fill a bank.
+  EXPECT_TRUE(store.PutString(1, StringView("12345678")));
+  EXPECT_TRUE(store.PutString(2, StringView("12345678")));
+  EXPECT_TRUE(store.PutString(3, StringView("12345678")));
+  EXPECT_FALSE(store.PutString(4, StringView("12345678")));
+  // But a smaller one will fit.
+  EXPECT_TRUE(store.PutString(4, StringView("1")));
+  // And now nothing more will fit.
+  EXPECT_FALSE(store.PutString(5, StringView("1")));
+  EXPECT_FALSE(store.Contains(5));
+
+  // Changing an existing setting is OK if the total still fits.
+  EXPECT_TRUE(store.PutString(1, StringView("abcdefgh")));
+  store.Flush();
+  EXPECT_TRUE(store.PutString(2, StringView("ABCDEFGH")));
+  store.Flush();
+
+  TestStore store2(kAddress, kSize);
+  store2.Initialize();
+  EXPECT_EQ(GetString(store2, 1), "abcdefgh");
+  EXPECT_EQ(GetString(store2, 2), "ABCDEFGH");
+  EXPECT_EQ(GetString(store2, 3), "12345678");
+  EXPECT_EQ(GetString(store2, 4), "1");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -3,12 +3,14 @@
 // Author: james.synge@gmail.com
 
 #include <cstdint>
+#include <cstdlib>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "config.h"
 #include "extras/test_tools/string_view_utils.h"
 #include "googletest/gmock.h"
@@ -333,6 +335,64 @@ TEST(StringViewTest, ToUint32Fails) {
   }
 }
 
+// Reference implementation for checking the implementations of to_uint32.
+bool ReferenceToUint32(const std::string& str, uint32_t& out) {
+  if (str.empty()) {
+    return false;
+  }
+  uint64_t value = 0;
+  for (const char c : str) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    value = value * 10 + (c - '0');
+    if (value > UINT32_MAX) {
+      return false;
+    }
+  }
+  out = static_cast<uint32_t>(value);
+  return true;
+}
+
+TEST(StringViewTest, ToUint32ImplementationsAgree) {
+  std::vector<std::string> inputs({
+      "", "0", "9", "12345678", "123456789", "1234567890", "00000000",
+      "99999999", "0000000000000000", "00000000004294967295", "4294967295",
+      "4294967296", "42949672950", "9999999999", "18446744073709551616",
+      // Non-digits adjacent to '0' and '9', in each position of a group of 8.
+      "/2345678", "1:345678", "12/45678", "123:5678", "1234/678", "12345:78",
+      "123456/8", "1234567:", "12345678/", "1234567\x80", "\xb0\xb0",
+      "1234 678", "1234-678", "1234+678",
+  });
+  uint32_t seed = 1;
+  auto next_random = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+  };
+  for (int n = 0; n < 5000; ++n) {
+    std::string str(next_random() % 20, '0');
+    for (char& c : str) {
+      c = '0' + next_random() % 10;
+    }
+    if (!str.empty() && next_random() % 4 == 0) {
+      str[next_random() % str.size()] = next_random() % 256;
+    }
+    inputs.push_back(str);
+  }
+  for (const auto& input : inputs) {
+    uint32_t expected = 0;
+    const bool expected_ok = ReferenceToUint32(input, expected);
+    const StringView view = MakeStringView(input);
+    for (auto* parse :
+         {internal::ParseUInt32Swar, internal::ParseUInt32In16BitHalves}) {
+      uint32_t out = 12345;
+      EXPECT_EQ(parse(view, out), expected_ok) << "\nInput string: " << input;
+      EXPECT_EQ(out, expected_ok ? expected : 12345)
+          << "\nInput string: " << input;
+    }
+  }
+}
+
 TEST(StringViewTest, ToInt32) {
   std::vector<std::pair<std::string, int32_t>> test_cases({
       {"0", 0},
@@ -421,6 +481,15 @@ TEST(StringViewTest, ToDouble) {
       {"4294967295", 4294967295},
       {"0000004294967295", UINT32_MAX},
       {"429496729500", UINT32_MAX * 100.0},
+      {"1e3", 1000},
+      {"1E3", 1000},
+      {"1e+3", 1000},
+      {"-1.5e-3", -0.0015},
+      {".5e1", 5},
+      {"5.e-1", 0.5},
+      {"12e24", 12e24},
+      {"0e999999", 0},
+      {"1e-999999", 0},
   });
   for (const auto& test_case : test_cases) {
     StringView view = MakeStringView(test_case.first);
@@ -451,6 +520,13 @@ TEST(StringViewTest, ToDoubleFails) {
            "+.",       // Sign and decimal point only.
            "123,456",  // Number with non-digit.
            "1.2.3",    // Too many decimal points.
+           "e5",       // Exponent without a mantissa.
+           ".e5",      // Exponent without a mantissa.
+           "1e",       // Exponent without digits.
+           "1e+",      // Exponent without digits.
+           "1e--1",    // Exponent with two signs.
+           "1e1.5",    // Fractional exponent.
+           "1e400",    // Too large for a double.
        }) {
     StringView view = MakeStringView(not_a_double);
     double out = tester;
@@ -460,6 +536,47 @@ TEST(StringViewTest, ToDoubleFails) {
   }
 }
 
+// Verifies that to_double produces the correctly rounded value, i.e. the same
+// as strtod, for both the fast and slow paths.
+TEST(StringViewTest, ToDoubleIsExact) {
+  std::vector<std::string> inputs({
+      "0.1", "0.2", "0.3", "2.675", "1.015", "9007199254740992",
+      "9007199254740993",     // 2^53 + 1, requires rounding.
+      "9007199254740993.0",   // Ditto.
+      "123456789012345678",   // Too many digits for the fast path.
+      "1.7976931348623157e308", "2.2250738585072014e-308", "4.9e-324",
+      "1e22", "1e23", "8.98846567431158e307",
+      "0.000000000000000000000000000000000000000000001",
+      "3.141592653589793238462643383279502884197169399375105820974944",
+      "0.5000000000000000555111512312578270211815834045410156250001",
+      "1234567890123456789012345678901234567890",
+  });
+  uint32_t seed = 1;
+  auto next_random = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) & 0xFFFFFF;
+  };
+  for (int n = 0; n < 2000; ++n) {
+    const uint64_t mantissa =
+        static_cast<uint64_t>(next_random()) * next_random() % 100000000000000;
+    const int point = next_random() % 16;
+    std::string digits = absl::StrCat(mantissa);
+    if (point < digits.size()) {
+      digits.insert(digits.size() - point, ".");
+    }
+    const int exponent = static_cast<int>(next_random() % 61) - 30;
+    inputs.push_back(digits);
+    inputs.push_back(absl::StrCat(digits, "e", exponent));
+  }
+  for (const auto& input : inputs) {
+    const double expected = std::strtod(input.c_str(), nullptr);
+    double out = 0;
+    StringView view = MakeStringView(input);
+    EXPECT_TRUE(view.to_double(out)) << "\nInput string: " << input;
+    EXPECT_EQ(out, expected) << "\nInput string: " << input;
+  }
+}
+
 #ifdef NDEBUG
 // Really slow if not optimized.
 #if TAS_ENABLED_VLOG_LEVEL < 1
@@ -0,0 +1,177 @@
+#include "utils/task_scheduler.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "googletest/gmock.h"
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Records its runs in a shared log, and returns period_millis from RunTask.
+class TestTask : public ScheduledTask {
+ public:
+  TestTask(const std::string& name, uint32_t period_millis,
+           std::vector<std::string>& log)
+      : name_(name), period_millis_(period_millis), log_(log) {}
+
+  uint32_t RunTask(uint32_t now_millis) override {
+    log_.push_back(name_ + "@" + std::to_string(now_millis));
+    if (on_run) {
+      on_run();
+    }
+    return period_millis_;
+  }
+
+  std::function<void()> on_run;
+
+ private:
+  const std::string name_;
+  const uint32_t period_millis_;
+  std::vector<std::string>& log_;
+};
+
+TEST(TaskSchedulerTest, NothingScheduled) {
+  TaskScheduler scheduler;
+  EXPECT_FALSE(scheduler.HasDueTask(0));
+  EXPECT_EQ(scheduler.MillisUntilNextTask(0), ScheduledTask::kDontReschedule);
+  EXPECT_EQ(scheduler.RunDueTasks(12345), 0);
+}
+
+TEST(TaskSchedulerTest, RunsTasksInDeadlineOrder) {
+  std::vector<std::string> log;
+  TestTask a("a", ScheduledTask::kDontReschedule, log);
+  TestTask b("b", ScheduledTask::kDontReschedule, log);
+  TestTask c("c", ScheduledTask::kDontReschedule, log);
+  TaskScheduler scheduler;
+  scheduler.ScheduleAt(c, 30);
+  scheduler.ScheduleAt(a, 10);
+  scheduler.ScheduleAt(b, 20);
+  EXPECT_TRUE(a.is_scheduled());
+  EXPECT_EQ(a.deadline_millis(), 10);
+
+  EXPECT_FALSE(scheduler.HasDueTask(9));
+  EXPECT_EQ(scheduler.MillisUntilNextTask(4), 6);
+  EXPECT_EQ(scheduler.RunDueTasks(9), 0);
+  EXPECT_THAT(log, IsEmpty());
+
+  EXPECT_TRUE(scheduler.HasDueTask(10));
+  EXPECT_EQ(scheduler.RunDueTasks(25), 2);
+  EXPECT_THAT(log, ElementsAre("a@25", "b@25"));
+  EXPECT_FALSE(a.is_scheduled());
+  EXPECT_TRUE(c.is_scheduled());
+  EXPECT_EQ(scheduler.MillisUntilNextTask(25), 5);
+  EXPECT_EQ(scheduler.MillisUntilNextTask(35), 0);
+
+  EXPECT_EQ(scheduler.RunDueTasks(30), 1);
+  EXPECT_THAT(log, ElementsAre("a@25", "b@25", "c@30"));
+  EXPECT_FALSE(scheduler.HasDueTask(0xFFFFFFFF));
+}
+
+TEST(TaskSchedulerTest, TasksWithTheSameDeadlineRunInScheduleOrder) {
+  std::vector<std::string> log;
+  TestTask a("a", ScheduledTask::kDontReschedule, log);
+  TestTask b("b", ScheduledTask::kDontReschedule, log);
+  TestTask c("c", ScheduledTask::kDontReschedule, log);
+  TaskScheduler scheduler;
+  scheduler.ScheduleAt(b, 10);
+  scheduler.ScheduleAt(c, 10);
+  scheduler.ScheduleAt(a, 10);
+  EXPECT_EQ(scheduler.RunDueTasks(10), 3);
+  EXPECT_THAT(log, ElementsAre("b@10", "c@10", "a@10"));
+}
+
+TEST(TaskSchedulerTest, PeriodicTasksAreRescheduled) {
+  std::vector<std::string> log;
+  TestTask fast("fast", 10, log);
+  TestTask slow("slow", 25, log);
+  TaskScheduler scheduler;
+  scheduler.ScheduleAt(fast, 0);
+  scheduler.ScheduleAt(slow, 0);
+  for (uint32_t now = 0; now <= 50; now += 5) {
+    scheduler.RunDueTasks(now);
+  }
+  // Both are due at 50, but slow was scheduled for 50 first (at 25).
+  EXPECT_THAT(log, ElementsAre("fast@0", "slow@0", "fast@10", "fast@20",
+                               "slow@25", "fast@30", "fast@40", "slow@50",
+                               "fast@50"));
+}
+
+TEST(TaskSchedulerTest, ZeroPeriodTaskRunsOncePerCall) {
+  std::vector<std::string> log;
+  TestTask busy("busy", 0, log);
+  TaskScheduler scheduler;
+  scheduler.ScheduleAfter(busy, 0, 100);
+  EXPECT_EQ(scheduler.RunDueTasks(100), 1);
+  EXPECT_EQ(scheduler.RunDueTasks(100), 1);
+  EXPECT_THAT(log, ElementsAre("busy@100", "busy@100"));
+  scheduler.Cancel(busy);
+}
+
+TEST(TaskSchedulerTest, Cancel) {
+  std::vector<std::string> log;
+  TestTask a("a", 10, log);
+  TestTask b("b", 10, log);
+  TaskScheduler scheduler;
+  scheduler.ScheduleAt(a, 10);
+  scheduler.ScheduleAt(b, 20);
+  scheduler.Cancel(a);
+  scheduler.Cancel(a);
+  EXPECT_FALSE(a.is_scheduled());
+  EXPECT_EQ(scheduler.MillisUntilNextTask(0), 20);
+  scheduler.Cancel(b);
+  EXPECT_FALSE(scheduler.HasDueTask(100));
+  EXPECT_EQ(scheduler.RunDueTasks(100), 0);
+  EXPECT_THAT(log, IsEmpty());
+}
+
+TEST(TaskSchedulerTest, TaskMayCancelAnotherDueTask) {
+  std::vector<std::string> log;
+  TestTask a("a", ScheduledTask::kDontReschedule, log);
+  TestTask b("b", ScheduledTask::kDontReschedule, log);
+  TaskScheduler scheduler;
+  a.on_run = [&] { scheduler.Cancel(b); };
+  scheduler.ScheduleAt(a, 1);
+  scheduler.ScheduleAt(b, 2);
+  EXPECT_EQ(scheduler.RunDueTasks(5), 1);
+  EXPECT_THAT(log, ElementsAre("a@5"));
+  EXPECT_FALSE(b.is_scheduled());
+}
+
+TEST(TaskSchedulerTest, TaskMayRescheduleItself) {
+  std::vector<std::string> log;
+  TestTask a("a", 10, log);
+  TaskScheduler scheduler;
+  // The explicit schedule takes precedence over the returned period.
+  a.on_run = [&] { scheduler.ScheduleAt(a, 100); };
+  scheduler.ScheduleAt(a, 1);
+  scheduler.RunDueTasks(1);
+  EXPECT_EQ(a.deadline_millis(), 100);
+  scheduler.Cancel(a);
+}
+
+TEST(TaskSchedulerTest, DeadlinesWrapAround) {
+  std::vector<std::string> log;
+  TestTask before("before", ScheduledTask::kDontReschedule, log);
+  TestTask after("after", ScheduledTask::kDontReschedule, log);
+  TaskScheduler scheduler;
+  const uint32_t now = 0xFFFFFFF0;
+  scheduler.ScheduleAfter(after, 0x20, now);  // i.e. at 0x10.
+  scheduler.ScheduleAfter(before, 0x8, now);
+  EXPECT_EQ(scheduler.MillisUntilNextTask(now), 8);
+  EXPECT_EQ(scheduler.RunDueTasks(now + 0x8), 1);
+  EXPECT_FALSE(scheduler.HasDueTask(0));
+  EXPECT_EQ(scheduler.RunDueTasks(0x10), 1);
+  EXPECT_THAT(log, ElementsAre("before@4294967288", "after@16"));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -0,0 +1,159 @@
+#include "utils/windowed_statistics.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+#include "absl/random/random.h"
+#include "googletest/gtest.h"
+
+namespace alpaca {
+namespace test {
+namespace {
+
+TEST(WindowedStatisticsTest, NoValues) {
+  WindowedStatistics<4> stats(100);
+  EXPECT_FALSE(stats.has_value());
+  EXPECT_EQ(stats.count(), 0);
+  EXPECT_EQ(stats.window_duration(), 100);
+  stats.AdvanceTo(1000);
+  EXPECT_FALSE(stats.has_value());
+}
+
+TEST(WindowedStatisticsTest, SingleValue) {
+  WindowedStatistics<4> stats(100);
+  stats.RecordNewValue(7, 1000);
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats.count(), 1);
+  EXPECT_EQ(stats.average_value(), 7);
+  EXPECT_EQ(stats.min_value(), 7);
+  EXPECT_EQ(stats.max_value(), 7);
+  EXPECT_EQ(stats.last_update_time(), 1000);
+
+  // Still in the window until 4 buckets (of 25) have passed.
+  stats.AdvanceTo(1099);
+  EXPECT_TRUE(stats.has_value());
+  stats.AdvanceTo(1100);
+  EXPECT_FALSE(stats.has_value());
+}
+
+TEST(WindowedStatisticsTest, OldValuesExpireByBucket) {
+  WindowedStatistics<4> stats(100);
+  stats.RecordNewValue(10, 0);
+  stats.RecordNewValue(0, 30);
+  stats.RecordNewValue(5, 60);
+  stats.RecordNewValue(20, 90);
+  EXPECT_EQ(stats.count(), 4);
+  EXPECT_EQ(stats.average_value(), 35.0 / 4);
+  EXPECT_EQ(stats.min_value(), 0);
+  EXPECT_EQ(stats.max_value(), 20);
+
+  // The bucket holding 10 expires.
+  stats.RecordNewValue(1, 100);
+  EXPECT_EQ(stats.count(), 4);
+  EXPECT_EQ(stats.average_value(), 26.0 / 4);
+  EXPECT_EQ(stats.min_value(), 0);
+
+  // The bucket holding 0 expires.
+  stats.AdvanceTo(125);
+  EXPECT_EQ(stats.count(), 3);
+  EXPECT_EQ(stats.min_value(), 1);
+  EXPECT_EQ(stats.max_value(), 20);
+
+  // Those holding 5 and 20 expire.
+  stats.AdvanceTo(175);
+  EXPECT_EQ(stats.count(), 1);
+  EXPECT_EQ(stats.min_value(), 1);
+  EXPECT_EQ(stats.max_value(), 1);
+}
+
+TEST(WindowedStatisticsTest, ChangingTheWindowDiscardsValues) {
+  WindowedStatistics<8> stats(800);
+  stats.RecordNewValue(1, 0);
+  stats.set_window_duration(1600);
+  EXPECT_FALSE(stats.has_value());
+  EXPECT_EQ(stats.window_duration(), 1600);
+  stats.RecordNewValue(2, 10);
+  stats.RecordNewValue(4, 1500);
+  EXPECT_EQ(stats.average_value(), 3);
+  stats.Reset();
+  EXPECT_FALSE(stats.has_value());
+}
+
+TEST(WindowedStatisticsTest, TimeWrapsAround) {
+  WindowedStatistics<4> stats(400);
+  const uint32_t start = 0xFFFFFF00;
+  stats.RecordNewValue(1, start);
+  stats.RecordNewValue(3, start + 0x100);  // i.e. time 0.
+  EXPECT_EQ(stats.count(), 2);
+  EXPECT_EQ(stats.average_value(), 2);
+  stats.AdvanceTo(start + 400);
+  EXPECT_EQ(stats.count(), 1);
+  EXPECT_EQ(stats.min_value(), 3);
+}
+
+TEST(WindowedStatisticsTest, TinyWindow) {
+  // A window shorter than the number of buckets has buckets of duration 1.
+  WindowedStatistics<16> stats(0);
+  stats.RecordNewValue(1, 5);
+  stats.RecordNewValue(2, 5);
+  EXPECT_EQ(stats.count(), 2);
+  stats.RecordNewValue(3, 21);
+  EXPECT_EQ(stats.count(), 1);
+  EXPECT_EQ(stats.max_value(), 3);
+}
+
+// Compares with a direct computation over the values whose buckets are in the
+// window, with random values at random intervals.
+template <uint8_t kNumBuckets>
+void CompareWithBruteForce(uint32_t window_duration, uint32_t max_interval) {
+  absl::BitGen gen;
+  WindowedStatistics<kNumBuckets> stats(window_duration);
+  const uint32_t bucket_duration =
+      std::max<uint32_t>(1, window_duration / kNumBuckets);
+  // The buckets start at the time of the first value.
+  const uint32_t start = absl::Uniform<uint32_t>(gen);
+  // Pairs of (bucket number relative to start, value).
+  std::deque<std::pair<uint32_t, double>> values;
+  uint32_t now = start;
+  for (int i = 0; i < 20000; ++i) {
+    if (i > 0) {
+      now += absl::Uniform<uint32_t>(gen, 0, max_interval);
+    }
+    const double value = absl::Uniform<int>(gen, -1000, 1000) / 8.0;
+    const uint32_t bucket = (now - start) / bucket_duration;
+    stats.RecordNewValue(value, now);
+    values.emplace_back(bucket, value);
+    while (bucket - values.front().first >= kNumBuckets) {
+      values.pop_front();
+    }
+
+    ASSERT_TRUE(stats.has_value());
+    ASSERT_EQ(stats.count(), values.size());
+    double sum = 0;
+    double min_value = values.front().second;
+    double max_value = min_value;
+    for (const auto& [unused, v] : values) {
+      sum += v;
+      min_value = std::min(min_value, v);
+      max_value = std::max(max_value, v);
+    }
+    ASSERT_NEAR(stats.average_value(), sum / values.size(), 1e-9);
+    ASSERT_EQ(stats.min_value(), min_value);
+    ASSERT_EQ(stats.max_value(), max_value);
+  }
+}
+
+TEST(WindowedStatisticsTest, MatchesBruteForce) {
+  CompareWithBruteForce<1>(100, 50);
+  CompareWithBruteForce<4>(1000, 100);
+  CompareWithBruteForce<4>(1000, 3000);  // Often expires the whole window.
+  CompareWithBruteForce<16>(60000, 1000);
+  CompareWithBruteForce<16>(60000, 10000);
+  CompareWithBruteForce<30>(120000, 3000);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace alpaca
@@ -20,16 +20,21 @@
 #include "constants.h"                // IWYU pragma: export
 #include "device_info.h"              // IWYU pragma: export
 #include "device_interface.h"         // IWYU pragma: export
+#include "device_types/async_operation.h"       // IWYU pragma: export
 #include "device_types/cover_calibrator/cover_calibrator_adapter.h"  // IWYU pragma: export
 #include "device_types/cover_calibrator/cover_calibrator_constants.h"  // IWYU pragma: export
 #include "device_types/device_impl_base.h"  // IWYU pragma: export
 #include "device_types/observing_conditions/observing_conditions_adapter.h"  // IWYU pragma: export
+#include "device_types/observing_conditions/sampled_observing_conditions_adapter.h"  // IWYU pragma: export
+#include "device_types/observing_conditions/sensor_sampler.h"  // IWYU pragma: export
 #include "device_types/switch/multi_switch_adapter.h"  // IWYU pragma: export
 #include "device_types/switch/switch_adapter.h"        // IWYU pragma: export
 #include "device_types/switch/switch_interface.h"      // IWYU pragma: export
+#include "device_types/switch/switch_state_store.h"    // IWYU pragma: export
 #include "device_types/switch/toggle_switch_base.h"    // IWYU pragma: export
 #include "extra_parameters.h"                          // IWYU pragma: export
 #include "http_response_header.h"                      // IWYU pragma: export
+#include "input_buffer_pool.h"                         // IWYU pragma: export
 #include "json_response.h"                             // IWYU pragma: export
 #include "literals.h"                                  // IWYU pragma: export
 #include "match_literals.h"                            // IWYU pragma: export
@@ -66,15 +71,18 @@
 #include "utils/printable_cat.h"                       // IWYU pragma: export
 #include "utils/printable_progmem_string.h"            // IWYU pragma: export
 #include "utils/server_socket.h"                       // IWYU pragma: export
+#include "utils/settings_store.h"                      // IWYU pragma: export
 #include "utils/socket_listener.h"                     // IWYU pragma: export
 #include "utils/status.h"                              // IWYU pragma: export
 #include "utils/status_or.h"                           // IWYU pragma: export
 #include "utils/stream_to_print.h"                     // IWYU pragma: export
 #include "utils/string_compare.h"                      // IWYU pragma: export
 #include "utils/string_view.h"                         // IWYU pragma: export
+#include "utils/task_scheduler.h"                      // IWYU pragma: export
 #include "utils/tiny_string.h"                         // IWYU pragma: export
 #include "utils/traits/print_to_trait.h"               // IWYU pragma: export
 #include "utils/traits/type_traits.h"                  // IWYU pragma: export
 #include "utils/utils_config.h"                        // IWYU pragma: export
+#include "utils/windowed_statistics.h"                  // IWYU pragma: export
 
 #endif  // TINY_ALPACA_SERVER_SRC_TINYALPACASERVER_H_
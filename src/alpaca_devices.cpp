@@ -83,6 +83,7 @@ bool AlpacaDevices::Initialize() {
     return false;
   }
   for (DeviceInterface* device : devices_) {
+    device->SetTaskScheduler(task_scheduler_);
     device->Initialize();
   }
   return true;
@@ -93,6 +94,11 @@ void AlpacaDevices::MaintainDevices() {
   for (DeviceInterface* device : devices_) {
     device->MaintainDevice();
   }
+  RunDueTasks();
+}
+
+uint8_t AlpacaDevices::RunDueTasks() {
+  return task_scheduler_.RunDueTasks(millis());
 }
 
 bool AlpacaDevices::HandleManagementConfiguredDevices(AlpacaRequest& request,
@@ -15,6 +15,7 @@
 #include "utils/array_view.h"
 #include "utils/json_encoder.h"
 #include "utils/platform.h"
+#include "utils/task_scheduler.h"
 
 namespace alpaca {
 
@@ -27,9 +28,18 @@ class AlpacaDevices {
   bool Initialize();
 
   // Delegates to device drivers so that they can perform actions other than
-  // responding to a request (e.g. periodically reading sensor values).
+  // responding to a request (e.g. periodically reading sensor values), and
+  // runs the tasks which are due.
   void MaintainDevices();
 
+  // Runs the scheduled tasks which are due, if any; this is cheap if none are
+  // due, so may be called between other activities (e.g. servicing sockets).
+  // Returns the number of tasks run.
+  uint8_t RunDueTasks();
+
+  // The scheduler provided to each device before it is initialized.
+  TaskScheduler& task_scheduler() { return task_scheduler_; }
+
   // Given a request for "/management/v1/configureddevices", writes the response
   // to out.
   bool HandleManagementConfiguredDevices(AlpacaRequest& request, Print& out);
@@ -45,6 +55,7 @@ class AlpacaDevices {
                              Print& out);
 
   ArrayView<DeviceInterface*> devices_;
+  TaskScheduler task_scheduler_;
 };
 
 }  // namespace alpaca
@@ -1,5 +1,6 @@
 #include "alpaca_discovery_server.h"
 
+#include "server_metrics.h"
 #include "utils/hex_escape.h"
 #include "utils/literal.h"
 #include "utils/o_print_stream.h"
@@ -31,6 +32,7 @@ void TinyAlpacaDiscoveryServer::PerformIO() {
   if (packet_size != kDiscoveryMessage().size()) {
     // Ignoring unexpected message.
     TAS_VLOG(1) << TAS_FLASHSTR("Ignoring UDP message of unexpected length");
+    ServerMetrics::RecordDiscoveryPacket(/*replied=*/false);
     return;
   }
 
@@ -45,6 +47,7 @@ void TinyAlpacaDiscoveryServer::PerformIO() {
     // Ignoring unexpected message.
     TAS_VLOG(1) << TAS_FLASHSTR("Expected to read ") << packet_size
                 << TAS_FLASHSTR(" bytes, but actually got ") << copied;
+    ServerMetrics::RecordDiscoveryPacket(/*replied=*/false);
     return;
   }
 
@@ -54,6 +57,7 @@ void TinyAlpacaDiscoveryServer::PerformIO() {
   if (kDiscoveryMessage() != view) {
     // Ignoring unexpected message.
     TAS_VLOG(1) << TAS_FLASHSTR("Received unexpected discovery message");
+    ServerMetrics::RecordDiscoveryPacket(/*replied=*/false);
     return;
   }
 
@@ -66,6 +70,7 @@ void TinyAlpacaDiscoveryServer::PerformIO() {
   udp_.print(tcp_port_, DEC);
   udp_.print('}');
   udp_.endPacket();
+  ServerMetrics::RecordDiscoveryPacket(/*replied=*/true);
 }
 
 }  // namespace alpaca
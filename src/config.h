@@ -23,6 +23,49 @@
 // where that extra byte is necessary to detect the end of that item.
 #define SERVER_CONNECTION_INPUT_BUFFER_SIZE 128
 
+// Number of input buffers, each of SERVER_CONNECTION_INPUT_BUFFER_SIZE bytes,
+// shared by the TAS_NUM_SERVER_CONNECTIONS connections (see
+// input_buffer_pool.h). A connection only holds a buffer while it is receiving
+// a request, so this can be less than the number of connections. Must be in
+// the range [1, 8].
+#define TAS_NUM_INPUT_BUFFERS 2
+
+// Minimum number of bytes of room in a connection's TX buffer before we'll
+// start writing a response. Responses are written in pieces if necessary,
+// re-generating the response each time OnCanWrite is called, and skipping the
+// bytes already written. Because PUT requests have side-effects, we don't want
+// to re-generate their responses, so this should be large enough for any PUT
+// response (they're small) to be written in one piece.
+#define SERVER_CONNECTION_MIN_RESPONSE_SPACE 512
+
+// If non-zero, ServerConnection measures how long each phase of handling a
+// request takes, and records those durations in histograms (see
+// request_timing.h). This costs a few calls to micros() per request, and about
+// 700 bytes of RAM for the histograms.
+#define TAS_ENABLE_REQUEST_TIMING 0
+
+// If non-zero, ServerConnection passes the bytes it reads, and the connection
+// events, to RequestCapture (see request_capture.h), which records them once
+// RequestCapture::StartCapture has been called. This costs a few bytes of RAM
+// and a test per read when not capturing, so is enabled by default only on
+// host, where the recordings are made by tiny_alpaca_server_benchmark.
+#ifdef ARDUINO
+#define TAS_ENABLE_REQUEST_CAPTURE 0
+#else
+#define TAS_ENABLE_REQUEST_CAPTURE 1
+#endif
+
+// If non-zero, the server maintains counters of requests, responses, errors,
+// bytes, connections, etc. (see server_metrics.h), which are served in response
+// to GET /metrics. The counters need about 120 bytes of RAM.
+#define TAS_ENABLE_SERVER_METRICS 1
+
+// The number of milliseconds that a single step of an AsyncOperation (e.g.
+// advancing the motion of a telescope cover) may take before it is logged as
+// having exceeded its budget. Request handlers start long operations rather
+// than performing them, so this bounds how long a handler blocks the server.
+#define TAS_ASYNC_OPERATION_STEP_BUDGET_MILLIS 10
+
 // This isn't fully fleshed out, but the basics are there for storing the
 // parameter enum and short string value of parameter types that are defined
 // and have token entries in kRecognizedParameters passed
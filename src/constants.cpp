@@ -183,6 +183,8 @@ const __FlashStringHelper* ToFlashStringHelper(EApiGroup v) {
       return TAS_FLASHSTR("Management");
     case EApiGroup::kSetup:
       return TAS_FLASHSTR("Setup");
+    case EApiGroup::kMetrics:
+      return TAS_FLASHSTR("Metrics");
   }
   return nullptr;
 }
@@ -203,6 +205,8 @@ const __FlashStringHelper* ToFlashStringHelper(EAlpacaApi v) {
       return TAS_FLASHSTR("ManagementConfiguredDevices");
     case EAlpacaApi::kServerSetup:
       return TAS_FLASHSTR("ServerSetup");
+    case EAlpacaApi::kServerMetrics:
+      return TAS_FLASHSTR("ServerMetrics");
   }
   return nullptr;
 }
@@ -526,6 +530,8 @@ std::ostream& operator<<(std::ostream& os, EApiGroup v) {
       return os << "Management";
     case EApiGroup::kSetup:
       return os << "Setup";
+    case EApiGroup::kMetrics:
+      return os << "Metrics";
   }
   return os << "Unknown {name}, value=" << static_cast<int64_t>(v);
 }
@@ -546,6 +552,8 @@ std::ostream& operator<<(std::ostream& os, EAlpacaApi v) {
       return os << "ManagementConfiguredDevices";
     case EAlpacaApi::kServerSetup:
       return os << "ServerSetup";
+    case EAlpacaApi::kServerMetrics:
+      return os << "ServerMetrics";
   }
   return os << "Unknown {name}, value=" << static_cast<int64_t>(v);
 }
@@ -106,6 +106,7 @@ enum class EApiGroup : uint8_t {
   kDevice,      // Path: /api...
   kManagement,  // Path: /management...
   kSetup,       // Path: /setup...
+  kMetrics,     // Path: /metrics
 };
 
 using EAlpacaApi_UnderlyingType = uint8_t;
@@ -129,6 +130,9 @@ enum class EAlpacaApi : uint8_t {
 
   // Path: /setup
   kServerSetup,
+
+  // Path: /metrics
+  kServerMetrics,
 };
 
 using EManagementMethod_UnderlyingType = uint8_t;
@@ -253,7 +257,7 @@ enum class EParameter : EParameter_UnderlyingType {
 
   // Switch parameters.
   kId,
-  kName,  // DECODING NOT YET SUPPORTED (No provision for storage)
+  kName,  // Saved in AlpacaRequest::extra_parameters, if enabled.
   kState,
   kValue,
 };
@@ -29,6 +29,7 @@
 #include "json_response.h"
 #include "utils/array_view.h"
 #include "utils/platform.h"
+#include "utils/task_scheduler.h"
 
 namespace alpaca {
 
@@ -45,6 +46,11 @@ class DeviceInterface {
   virtual EDeviceType device_type() const = 0;
   virtual uint32_t device_number() const = 0;
 
+  // Called before Initialize to provide the scheduler with which the device
+  // may schedule tasks (e.g. reading a sensor periodically), rather than
+  // checking in MaintainDevice whether there is work to be done.
+  virtual void SetTaskScheduler(TaskScheduler& scheduler) {}
+
   // Called to initialize the handler and underlying device.
   virtual void Initialize() = 0;
 
@@ -0,0 +1,57 @@
+#include "device_types/async_operation.h"
+
+#include "config.h"
+#include "utils/logging.h"
+
+namespace alpaca {
+
+AsyncOperation::AsyncOperation() : state_(EAsyncOperationState::kIdle) {}
+
+Status AsyncOperation::Start(TaskScheduler& scheduler, uint32_t now_millis) {
+  Cancel(scheduler);
+  state_ = EAsyncOperationState::kRunning;
+  status_ = OkStatus();
+  const uint32_t delay_millis = PerformStep(now_millis);
+  if (delay_millis != kFinished) {
+    scheduler.ScheduleAfter(*this, delay_millis, now_millis);
+  }
+  return status_;
+}
+
+bool AsyncOperation::Cancel(TaskScheduler& scheduler) {
+  scheduler.Cancel(*this);
+  if (!is_running()) {
+    return false;
+  }
+  state_ = EAsyncOperationState::kCancelled;
+  OnCancel();
+  return true;
+}
+
+uint32_t AsyncOperation::RunTask(uint32_t now_millis) {
+  if (!is_running()) {
+    return kDontReschedule;
+  }
+  return PerformStep(now_millis);
+}
+
+uint32_t AsyncOperation::PerformStep(uint32_t now_millis) {
+  const auto start_millis = millis();
+  auto status_or_delay = Step(now_millis);
+  const auto elapsed_millis = millis() - start_millis;
+  if (elapsed_millis > TAS_ASYNC_OPERATION_STEP_BUDGET_MILLIS) {
+    TAS_VLOG(1) << TAS_FLASHSTR("AsyncOperation step took ") << elapsed_millis
+                << TAS_FLASHSTR("ms, budget is ")
+                << TAS_ASYNC_OPERATION_STEP_BUDGET_MILLIS;
+  }
+  if (!status_or_delay.ok()) {
+    state_ = EAsyncOperationState::kFailed;
+    status_ = status_or_delay.status();
+    return kFinished;
+  } else if (status_or_delay.value() == kFinished) {
+    state_ = EAsyncOperationState::kSucceeded;
+  }
+  return status_or_delay.value();
+}
+
+}  // namespace alpaca
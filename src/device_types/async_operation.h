@@ -0,0 +1,78 @@
+#ifndef TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_ASYNC_OPERATION_H_
+#define TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_ASYNC_OPERATION_H_
+
+// AsyncOperation is the base for device operations that take far longer than
+// a request handler may (e.g. moving a telescope cover, or ramping up the
+// brightness of a flat panel). The handler starts the operation, which
+// performs its first step immediately, and then returns its response; the
+// remaining steps are run by the TaskScheduler, and the client polls for
+// completion (e.g. via /coverstate).
+//
+// Each call to Step should take no longer than
+// TAS_ASYNC_OPERATION_STEP_BUDGET_MILLIS; steps which exceed the budget are
+// logged, so that the culprit can be found when the server is sluggish.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+#include "utils/status.h"
+#include "utils/status_or.h"
+#include "utils/task_scheduler.h"
+
+namespace alpaca {
+
+enum class EAsyncOperationState : uint8_t {
+  kIdle = 0,       // Never started.
+  kRunning = 1,    // Started, and not yet finished.
+  kSucceeded = 2,  // The last run finished successfully.
+  kFailed = 3,     // The last run ended with an error; see status().
+  kCancelled = 4,  // The last run was cancelled before it finished.
+};
+
+class AsyncOperation : public ScheduledTask {
+ public:
+  // Value returned by Step when the operation has finished successfully.
+  static constexpr uint32_t kFinished = kDontReschedule;
+
+  AsyncOperation();
+
+  EAsyncOperationState state() const { return state_; }
+  bool is_running() const { return state_ == EAsyncOperationState::kRunning; }
+  bool has_failed() const { return state_ == EAsyncOperationState::kFailed; }
+
+  // The error which ended the last run, else OK.
+  const Status& status() const { return status_; }
+
+  // Starts the operation, cancelling it first if it is already running, and
+  // performs the first step. If the first step fails, returns that error;
+  // otherwise the operation is scheduled to perform the remaining steps, and
+  // OK is returned.
+  Status Start(TaskScheduler& scheduler, uint32_t now_millis);
+
+  // If the operation is running, stops it (calling OnCancel), and returns true.
+  bool Cancel(TaskScheduler& scheduler);
+
+ protected:
+  // Performs the next step of the operation. Returns the number of
+  // milliseconds until the following step should be performed, kFinished if
+  // the operation has completed, or an error if it has failed.
+  virtual StatusOr<uint32_t> Step(uint32_t now_millis) = 0;
+
+  // Called when the operation is cancelled while running, so that the device
+  // can be stopped (e.g. turn off the cover motor).
+  virtual void OnCancel() {}
+
+ private:
+  uint32_t RunTask(uint32_t now_millis) override;
+
+  // Performs a step, and updates the state based on the result. Returns the
+  // delay until the next step, or kFinished.
+  uint32_t PerformStep(uint32_t now_millis);
+
+  Status status_;
+  EAsyncOperationState state_;
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_ASYNC_OPERATION_H_
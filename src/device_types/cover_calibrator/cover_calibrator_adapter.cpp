@@ -8,7 +8,9 @@
 namespace alpaca {
 
 CoverCalibratorAdapter::CoverCalibratorAdapter(const DeviceInfo& device_info)
-    : DeviceImplBase(device_info) {
+    : DeviceImplBase(device_info),
+      cover_operation_(nullptr),
+      calibrator_operation_(nullptr) {
   TAS_DCHECK_EQ(device_info.device_type, EDeviceType::kCoverCalibrator);
 }
 
@@ -24,11 +26,11 @@ bool CoverCalibratorAdapter::HandleGetRequest(const AlpacaRequest& request,
 
     case EDeviceMethod::kCalibratorState:
       return WriteResponse::StatusOrIntEnumResponse<ECalibratorStatus>(
-          request, GetCalibratorState(), out);
+          request, GetCurrentCalibratorState(), out);
 
     case EDeviceMethod::kCoverState:
       return WriteResponse::StatusOrIntEnumResponse<ECoverStatus>(
-          request, GetCoverState(), out);
+          request, GetCurrentCoverState(), out);
 
     case EDeviceMethod::kMaxBrightness:
       return WriteResponse::StatusOrIntResponse(request, GetMaxBrightness(),
@@ -40,6 +42,29 @@ bool CoverCalibratorAdapter::HandleGetRequest(const AlpacaRequest& request,
   return DeviceImplBase::HandleGetRequest(request, out);
 }
 
+StatusOr<ECalibratorStatus>
+CoverCalibratorAdapter::GetCurrentCalibratorState() {
+  if (calibrator_operation_ != nullptr) {
+    if (calibrator_operation_->is_running()) {
+      return ECalibratorStatus::kNotReady;
+    } else if (calibrator_operation_->has_failed()) {
+      return ECalibratorStatus::kError;
+    }
+  }
+  return GetCalibratorState();
+}
+
+StatusOr<ECoverStatus> CoverCalibratorAdapter::GetCurrentCoverState() {
+  if (cover_operation_ != nullptr) {
+    if (cover_operation_->is_running()) {
+      return ECoverStatus::kMoving;
+    } else if (cover_operation_->has_failed()) {
+      return ECoverStatus::kError;
+    }
+  }
+  return GetCoverState();
+}
+
 StatusOr<int32_t> CoverCalibratorAdapter::GetBrightness() {
   return ErrorCodes::ActionNotImplemented();
 }
@@ -90,6 +115,9 @@ bool CoverCalibratorAdapter::HandlePutRequest(const AlpacaRequest& request,
 
 bool CoverCalibratorAdapter::HandlePutCalibratorOff(
     const AlpacaRequest& request, Print& out) {
+  if (calibrator_operation_ != nullptr) {
+    CancelAsyncOperation(*calibrator_operation_);
+  }
   return WriteResponse::StatusResponse(request, SetCalibratorOff(), out);
 }
 
@@ -124,6 +152,10 @@ bool CoverCalibratorAdapter::HandlePutCloseCover(const AlpacaRequest& request,
 
 bool CoverCalibratorAdapter::HandlePutHaltCover(const AlpacaRequest& request,
                                                 Print& out) {
+  if (cover_operation_ != nullptr) {
+    CancelAsyncOperation(*cover_operation_);
+    return WriteResponse::StatusResponse(request, OkStatus(), out);
+  }
   return WriteResponse::StatusResponse(request, HaltCoverMotion(), out);
 }
 
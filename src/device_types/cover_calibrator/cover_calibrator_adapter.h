@@ -13,6 +13,7 @@
 //
 // Author: james.synge@gmail.com
 
+#include "device_types/async_operation.h"
 #include "device_types/cover_calibrator/cover_calibrator_constants.h"
 #include "device_types/device_impl_base.h"
 #include "utils/platform.h"
@@ -84,6 +85,32 @@ class CoverCalibratorAdapter : public DeviceImplBase {
 
   virtual Status MoveCover(bool open);
   virtual Status HaltCoverMotion();
+
+ protected:
+  // A subclass whose cover or calibrator takes time to change state should
+  // perform that change with an AsyncOperation (i.e. MoveCover or
+  // SetCalibratorBrightness calls StartAsyncOperation), and register the
+  // operation here. While the operation is running, /coverstate reports
+  // kMoving (or /calibratorstate reports kNotReady), and if it fails, kError;
+  // otherwise GetCoverState (or GetCalibratorState) is called. /haltcover
+  // cancels the cover operation instead of calling HaltCoverMotion, and
+  // /calibratoroff cancels the calibrator operation before calling
+  // SetCalibratorOff.
+  void set_cover_operation(AsyncOperation* operation) {
+    cover_operation_ = operation;
+  }
+  void set_calibrator_operation(AsyncOperation* operation) {
+    calibrator_operation_ = operation;
+  }
+
+ private:
+  // Returns the state based on the operation, if registered and running or
+  // failed, else from GetCalibratorState or GetCoverState.
+  StatusOr<ECalibratorStatus> GetCurrentCalibratorState();
+  StatusOr<ECoverStatus> GetCurrentCoverState();
+
+  AsyncOperation* cover_operation_;
+  AsyncOperation* calibrator_operation_;
 };
 
 }  // namespace alpaca
@@ -8,6 +8,7 @@
 #include "literals.h"
 #include "utils/counting_print.h"
 #include "utils/json_encoder.h"
+#include "utils/logging.h"
 #include "utils/o_print_stream.h"
 #include "utils/status.h"
 
@@ -176,4 +177,19 @@ StatusOr<bool> DeviceImplBase::GetConnected() { return true; }
 
 Status DeviceImplBase::SetConnected(bool value) { return OkStatus(); }
 
+Status DeviceImplBase::StartAsyncOperation(AsyncOperation& operation) {
+  if (task_scheduler_ == nullptr) {
+    TAS_VLOG(1) << TAS_FLASHSTR("No TaskScheduler for AsyncOperation");
+    return ErrorCodes::InvalidOperation();
+  }
+  return operation.Start(*task_scheduler_, millis());
+}
+
+bool DeviceImplBase::CancelAsyncOperation(AsyncOperation& operation) {
+  if (task_scheduler_ == nullptr) {
+    return false;
+  }
+  return operation.Cancel(*task_scheduler_);
+}
+
 }  // namespace alpaca
@@ -17,22 +17,27 @@
 #include "ascom_error_codes.h"
 #include "device_info.h"
 #include "device_interface.h"
+#include "device_types/async_operation.h"
 #include "utils/platform.h"
 #include "utils/status.h"
 #include "utils/status_or.h"
+#include "utils/task_scheduler.h"
 
 namespace alpaca {
 
 class DeviceImplBase : public DeviceInterface {
  public:
   explicit DeviceImplBase(const DeviceInfo& device_info)
-      : device_info_(device_info) {}
+      : device_info_(device_info), task_scheduler_(nullptr) {}
   ~DeviceImplBase() override {}
 
   // Overrides of the base class methods:
   const DeviceInfo& device_info() const override { return device_info_; }
   EDeviceType device_type() const override { return device_info_.device_type; }
   uint32_t device_number() const override { return device_info_.device_number; }
+  void SetTaskScheduler(TaskScheduler& scheduler) override {
+    task_scheduler_ = &scheduler;
+  }
   void Initialize() override {}
   void MaintainDevice() override {}
   size_t GetUniqueBytes(uint8_t* buffer, size_t buffer_size) override {
@@ -58,6 +63,20 @@ class DeviceImplBase : public DeviceInterface {
                               Print& out) override;
 
  protected:
+  // Returns the scheduler provided to SetTaskScheduler, or nullptr if none has
+  // been provided (e.g. in tests), in which case MaintainDevice should be used
+  // for periodic work.
+  TaskScheduler* task_scheduler() const { return task_scheduler_; }
+
+  // Starts a long running operation (e.g. moving a cover), which is then
+  // advanced by the task scheduler, so that the request handler which starts
+  // it can respond immediately. Returns an error if there is no scheduler, or
+  // if the first step of the operation fails.
+  Status StartAsyncOperation(AsyncOperation& operation);
+
+  // Cancels the operation, returning true if it was running.
+  bool CancelAsyncOperation(AsyncOperation& operation);
+
   // Additional methods provided by this class, can be overridden by subclass.
 
   // Handles a subset of the "ASCOM Alpaca Methods Common To All Devices": the
@@ -117,6 +136,7 @@ class DeviceImplBase : public DeviceInterface {
 
  private:
   const DeviceInfo& device_info_;
+  TaskScheduler* task_scheduler_;
 };
 
 }  // namespace alpaca
@@ -0,0 +1,117 @@
+#include "device_types/observing_conditions/sampled_observing_conditions_adapter.h"
+
+#include "ascom_error_codes.h"
+#include "utils/logging.h"
+
+namespace alpaca {
+namespace {
+constexpr double kMillisPerHour = 3600000.0;
+}  // namespace
+
+SampledObservingConditionsAdapter::SampledObservingConditionsAdapter(
+    const DeviceInfo& device_info, ArrayView<SampledSensor> sensors,
+    double max_average_period_hours)
+    : ObservingConditionsAdapter(device_info),
+      sampler_(*this, sensors),
+      max_average_period_hours_(max_average_period_hours) {
+  TAS_DCHECK_GE(max_average_period_hours, 0);
+}
+
+void SampledObservingConditionsAdapter::Initialize() {
+  ObservingConditionsAdapter::Initialize();
+  const uint32_t now = millis();
+  sampler_.SampleAll(now);
+  if (task_scheduler() != nullptr) {
+    const uint32_t delay = sampler_.MillisUntilNextSample(now);
+    if (delay != ScheduledTask::kDontReschedule) {
+      task_scheduler()->ScheduleAfter(sampler_, delay, now);
+    }
+  }
+}
+
+void SampledObservingConditionsAdapter::MaintainDevice() {
+  ObservingConditionsAdapter::MaintainDevice();
+  if (task_scheduler() == nullptr) {
+    sampler_.SampleDueSensors(millis());
+  }
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetAveragePeriod() {
+  return sampler_.average_period_millis() / kMillisPerHour;
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetCloudCover() {
+  return sampler_.GetValue(ESensorName::kCloudCover);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetDewPoint() {
+  return sampler_.GetValue(ESensorName::kDewPoint);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetHumidity() {
+  return sampler_.GetValue(ESensorName::kHumidity);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetPressure() {
+  return sampler_.GetValue(ESensorName::kPressure);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetRainRate() {
+  return sampler_.GetValue(ESensorName::kRainRate);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetSkyBrightness() {
+  return sampler_.GetValue(ESensorName::kSkyBrightness);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetSkyQuality() {
+  return sampler_.GetValue(ESensorName::kSkyQuality);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetSkyTemperature() {
+  return sampler_.GetValue(ESensorName::kSkyTemperature);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetStarFullWidthHalfMax() {
+  return sampler_.GetValue(ESensorName::kStarFullWidthHalfMax);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetTemperature() {
+  return sampler_.GetValue(ESensorName::kTemperature);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetTimeSinceLastUpdate(
+    ESensorName sensor_name) {
+  return sampler_.GetTimeSinceLastUpdate(sensor_name, millis());
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetWindDirection() {
+  return sampler_.GetValue(ESensorName::kWindDirection);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetWindGust() {
+  return sampler_.GetValue(ESensorName::kWindGust);
+}
+
+StatusOr<double> SampledObservingConditionsAdapter::GetWindSpeed() {
+  return sampler_.GetValue(ESensorName::kWindSpeed);
+}
+
+Status SampledObservingConditionsAdapter::SetAveragePeriod(double hours) {
+  if (hours < 0 || hours > max_average_period_hours_) {
+    return ErrorCodes::InvalidValue();
+  }
+  sampler_.set_average_period_millis(
+      static_cast<uint32_t>(hours * kMillisPerHour));
+  return OkStatus();
+}
+
+double SampledObservingConditionsAdapter::MaxAveragePeriod() const {
+  return max_average_period_hours_;
+}
+
+Status SampledObservingConditionsAdapter::Refresh() {
+  return sampler_.SampleAll(millis());
+}
+
+}  // namespace alpaca
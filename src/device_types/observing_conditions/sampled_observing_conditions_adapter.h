@@ -0,0 +1,74 @@
+#ifndef TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_OBSERVING_CONDITIONS_SAMPLED_OBSERVING_CONDITIONS_ADAPTER_H_
+#define TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_OBSERVING_CONDITIONS_SAMPLED_OBSERVING_CONDITIONS_ADAPTER_H_
+
+// SampledObservingConditionsAdapter is an ObservingConditionsAdapter whose
+// sensor values are read in the background by a SensorSampler, so that
+// subclasses need only implement ReadSensor (which talks to the hardware) and
+// GetSensorDescription. The GetXyz methods and GetTimeSinceLastUpdate are
+// answered from the latest readings, and return NotImplemented for sensors not
+// provided to the constructor.
+//
+// If a TaskScheduler has been provided (see DeviceInterface::SetTaskScheduler),
+// the sampler is run as a scheduled task when the next sensor is due;
+// otherwise the due sensors are sampled by MaintainDevice.
+//
+// Author: james.synge@gmail.com
+
+#include "device_info.h"
+#include "device_types/observing_conditions/observing_conditions_adapter.h"
+#include "device_types/observing_conditions/sensor_sampler.h"
+#include "utils/array_view.h"
+#include "utils/platform.h"
+#include "utils/status.h"
+#include "utils/status_or.h"
+
+namespace alpaca {
+
+class SampledObservingConditionsAdapter : public ObservingConditionsAdapter,
+                                          public SensorSampler::SensorReader {
+ public:
+  // If max_average_period_hours is greater than zero, clients may request
+  // averaging of those sensors which have a MovingAverage.
+  SampledObservingConditionsAdapter(const DeviceInfo& device_info,
+                                    ArrayView<SampledSensor> sensors,
+                                    double max_average_period_hours = 0);
+
+  // Reads all of the sensors, and schedules the sampler to read them again.
+  void Initialize() override;
+
+  // Reads those sensors which are due to be read, if there is no scheduler.
+  void MaintainDevice() override;
+
+  StatusOr<double> GetAveragePeriod() override;
+  StatusOr<double> GetCloudCover() override;
+  StatusOr<double> GetDewPoint() override;
+  StatusOr<double> GetHumidity() override;
+  StatusOr<double> GetPressure() override;
+  StatusOr<double> GetRainRate() override;
+  StatusOr<double> GetSkyBrightness() override;
+  StatusOr<double> GetSkyQuality() override;
+  StatusOr<double> GetSkyTemperature() override;
+  StatusOr<double> GetStarFullWidthHalfMax() override;
+  StatusOr<double> GetTemperature() override;
+  StatusOr<double> GetTimeSinceLastUpdate(ESensorName sensor_name) override;
+  StatusOr<double> GetWindDirection() override;
+  StatusOr<double> GetWindGust() override;
+  StatusOr<double> GetWindSpeed() override;
+
+  Status SetAveragePeriod(double hours) override;
+  double MaxAveragePeriod() const override;
+
+  // Reads all of the sensors, returning an error if any can not be read.
+  Status Refresh() override;
+
+ protected:
+  const SensorSampler& sampler() const { return sampler_; }
+
+ private:
+  SensorSampler sampler_;
+  const double max_average_period_hours_;
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_OBSERVING_CONDITIONS_SAMPLED_OBSERVING_CONDITIONS_ADAPTER_H_
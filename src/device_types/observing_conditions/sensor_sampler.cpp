@@ -0,0 +1,205 @@
+#include "device_types/observing_conditions/sensor_sampler.h"
+
+#include "ascom_error_codes.h"
+#include "utils/logging.h"
+
+#if TAS_HOST_TARGET
+#include <cstring>
+#endif  // TAS_HOST_TARGET
+
+namespace alpaca {
+
+#if TAS_HOST_TARGET
+
+// A seqlock: the writer makes the sequence number odd while it updates the
+// fields, and even again when done; a reader retries if the sequence number
+// was odd, or changed while it was copying the fields.
+
+SensorSnapshot::SensorSnapshot()
+    : sequence_(0), value_bits_(0), time_millis_(0) {}
+
+void SensorSnapshot::Write(double value, uint32_t time_millis) {
+  static_assert(sizeof value == sizeof(uint64_t), "Unexpected double size");
+  uint64_t value_bits;
+  std::memcpy(&value_bits, &value, sizeof value);
+
+  const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  value_bits_.store(value_bits, std::memory_order_relaxed);
+  time_millis_.store(time_millis, std::memory_order_relaxed);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+bool SensorSnapshot::Read(double& value, uint32_t& time_millis) const {
+  uint32_t before, after;
+  uint64_t value_bits;
+  do {
+    before = sequence_.load(std::memory_order_acquire);
+    value_bits = value_bits_.load(std::memory_order_relaxed);
+    time_millis = time_millis_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = sequence_.load(std::memory_order_relaxed);
+  } while ((before & 1) != 0 || before != after);
+  if (before == 0) {
+    return false;
+  }
+  std::memcpy(&value, &value_bits, sizeof value);
+  return true;
+}
+
+#else  // !TAS_HOST_TARGET
+
+SensorSnapshot::SensorSnapshot()
+    : value_(0), time_millis_(0), has_value_(false) {}
+
+void SensorSnapshot::Write(double value, uint32_t time_millis) {
+  value_ = value;
+  time_millis_ = time_millis;
+  has_value_ = true;
+}
+
+bool SensorSnapshot::Read(double& value, uint32_t& time_millis) const {
+  value = value_;
+  time_millis = time_millis_;
+  return has_value_;
+}
+
+#endif  // TAS_HOST_TARGET
+
+SampledSensor::SampledSensor(ESensorName sensor_name, uint32_t period_millis,
+                             WindowedStatisticsBase* statistics)
+    : sensor_name_(sensor_name),
+      period_millis_(period_millis),
+      statistics_(statistics),
+      last_attempt_millis_(0),
+      attempted_(false) {}
+
+SensorSampler::SensorSampler(SensorReader& reader,
+                             ArrayView<SampledSensor> sensors)
+    : reader_(reader), sensors_(sensors), average_period_millis_(0) {
+  for (auto& index : sensor_index_) {
+    index = kNoSensor;
+  }
+  for (uint8_t ndx = 0; ndx < sensors_.size(); ++ndx) {
+    const auto name = static_cast<uint8_t>(sensors_[ndx].sensor_name());
+    TAS_DCHECK_LT(name, kNumSensorNames);
+    TAS_DCHECK_EQ(sensor_index_[name], kNoSensor)
+        << TAS_FLASHSTR("Duplicate sensor ") << sensors_[ndx].sensor_name();
+    sensor_index_[name] = ndx;
+  }
+}
+
+void SensorSampler::set_average_period_millis(uint32_t value) {
+  average_period_millis_ = value;
+  for (uint8_t ndx = 0; ndx < sensors_.size(); ++ndx) {
+    WindowedStatisticsBase* statistics = sensors_[ndx].statistics_;
+    if (statistics != nullptr) {
+      statistics->set_window_duration(value);
+    }
+  }
+}
+
+void SensorSampler::SampleDueSensors(uint32_t now_millis) {
+  for (uint8_t ndx = 0; ndx < sensors_.size(); ++ndx) {
+    SampledSensor& sensor = sensors_[ndx];
+    if (!sensor.attempted_ ||
+        (now_millis - sensor.last_attempt_millis_) >= sensor.period_millis_) {
+      Sample(sensor, now_millis);
+    }
+  }
+}
+
+uint32_t SensorSampler::MillisUntilNextSample(uint32_t now_millis) const {
+  uint32_t result = kDontReschedule;
+  for (uint8_t ndx = 0; ndx < sensors_.size(); ++ndx) {
+    const SampledSensor& sensor = sensors_[ndx];
+    if (!sensor.attempted_) {
+      return 0;
+    }
+    const uint32_t elapsed = now_millis - sensor.last_attempt_millis_;
+    if (elapsed >= sensor.period_millis_) {
+      return 0;
+    }
+    const uint32_t remaining = sensor.period_millis_ - elapsed;
+    if (remaining < result) {
+      result = remaining;
+    }
+  }
+  return result;
+}
+
+uint32_t SensorSampler::RunTask(uint32_t now_millis) {
+  SampleDueSensors(now_millis);
+  return MillisUntilNextSample(now_millis);
+}
+
+Status SensorSampler::SampleAll(uint32_t now_millis) {
+  Status result;
+  for (uint8_t ndx = 0; ndx < sensors_.size(); ++ndx) {
+    Status status = Sample(sensors_[ndx], now_millis);
+    if (result.ok() && !status.ok()) {
+      result = status;
+    }
+  }
+  return result;
+}
+
+Status SensorSampler::Sample(SampledSensor& sensor, uint32_t now_millis) {
+  sensor.last_attempt_millis_ = now_millis;
+  sensor.attempted_ = true;
+  auto status_or_value = reader_.ReadSensor(sensor.sensor_name_);
+  if (!status_or_value.ok()) {
+    TAS_VLOG(2) << TAS_FLASHSTR("Unable to read sensor ")
+                << sensor.sensor_name_;
+    return status_or_value.status();
+  }
+  double value = status_or_value.value();
+  if (sensor.statistics_ != nullptr && average_period_millis_ > 0) {
+    sensor.statistics_->RecordNewValue(value, now_millis);
+    value = sensor.statistics_->average_value();
+  }
+  sensor.snapshot_.Write(value, now_millis);
+  return OkStatus();
+}
+
+bool SensorSampler::HasSensor(ESensorName sensor_name) const {
+  return Find(sensor_name) != nullptr;
+}
+
+const SampledSensor* SensorSampler::Find(ESensorName sensor_name) const {
+  const auto name = static_cast<uint8_t>(sensor_name);
+  if (name >= kNumSensorNames || sensor_index_[name] == kNoSensor) {
+    return nullptr;
+  }
+  return &sensors_[sensor_index_[name]];
+}
+
+StatusOr<double> SensorSampler::GetValue(ESensorName sensor_name) const {
+  const SampledSensor* sensor = Find(sensor_name);
+  if (sensor == nullptr) {
+    return ErrorCodes::NotImplemented();
+  }
+  double value;
+  uint32_t time_millis;
+  if (!sensor->snapshot_.Read(value, time_millis)) {
+    return ErrorCodes::ValueNotSet();
+  }
+  return value;
+}
+
+StatusOr<double> SensorSampler::GetTimeSinceLastUpdate(
+    ESensorName sensor_name, uint32_t now_millis) const {
+  const SampledSensor* sensor = Find(sensor_name);
+  if (sensor == nullptr) {
+    return ErrorCodes::NotImplemented();
+  }
+  double value;
+  uint32_t time_millis;
+  if (!sensor->snapshot_.Read(value, time_millis)) {
+    return ErrorCodes::ValueNotSet();
+  }
+  return (now_millis - time_millis) / 3600000.0;
+}
+
+}  // namespace alpaca
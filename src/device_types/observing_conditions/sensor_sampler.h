@@ -0,0 +1,159 @@
+#ifndef TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_OBSERVING_CONDITIONS_SENSOR_SAMPLER_H_
+#define TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_OBSERVING_CONDITIONS_SENSOR_SAMPLER_H_
+
+// SensorSampler reads the sensors of an Observing Conditions device in the
+// background (i.e. from DeviceInterface::MaintainDevice), each on its own
+// period, so that requests for sensor values can be answered immediately from
+// the most recent reading rather than by talking to the hardware.
+//
+// The sampler is the only writer of the readings; they may be read at any
+// time. On host the latest reading of each sensor is held in a seqlock, so
+// that threads other than the one calling SampleDueSensors (e.g. the worker
+// threads of a test or tool) can read a consistent value and timestamp
+// without locking. On an Arduino there is only the one thread, so the reading
+// is held in plain fields.
+//
+// SensorSampler is also a ScheduledTask, so that its owner can schedule it to
+// run when the next sensor is due, rather than calling SampleDueSensors on
+// every pass through loop().
+//
+// Author: james.synge@gmail.com
+
+#include "constants.h"
+#include "utils/array_view.h"
+#include "utils/platform.h"
+#include "utils/status.h"
+#include "utils/status_or.h"
+#include "utils/task_scheduler.h"
+#include "utils/windowed_statistics.h"
+
+#if TAS_HOST_TARGET
+#include <atomic>
+#endif  // TAS_HOST_TARGET
+
+namespace alpaca {
+
+// The most recent reading of a sensor, along with the time (millis()) at which
+// it was read. Write must only be called by one thread at a time; Read may be
+// called concurrently with Write.
+class SensorSnapshot {
+ public:
+  SensorSnapshot();
+
+  void Write(double value, uint32_t time_millis);
+
+  // Returns false if Write has never been called, else stores the most
+  // recently written value and time in the arguments and returns true.
+  bool Read(double& value, uint32_t& time_millis) const;
+
+ private:
+#if TAS_HOST_TARGET
+  // Odd while a Write is in progress; zero if Write has never been called.
+  std::atomic<uint32_t> sequence_;
+  // The bits of the double value, so that they can be accessed atomically.
+  std::atomic<uint64_t> value_bits_;
+  std::atomic<uint32_t> time_millis_;
+#else
+  double value_;
+  uint32_t time_millis_;
+  bool has_value_;
+#endif  // TAS_HOST_TARGET
+};
+
+// The schedule and latest reading of a single sensor of a SensorSampler.
+class SampledSensor {
+ public:
+  // The sensor will be read every period_millis. If statistics is not null and
+  // the sampler has a non-zero average period, each reading is recorded in it,
+  // and the average of the readings during the average period is reported
+  // instead of the reading itself.
+  SampledSensor(ESensorName sensor_name, uint32_t period_millis,
+                WindowedStatisticsBase* statistics = nullptr);
+
+  ESensorName sensor_name() const { return sensor_name_; }
+  uint32_t period_millis() const { return period_millis_; }
+
+ private:
+  friend class SensorSampler;
+
+  const ESensorName sensor_name_;
+  const uint32_t period_millis_;
+  WindowedStatisticsBase* const statistics_;
+
+  // The time at which the sensor was last read, successfully or not.
+  uint32_t last_attempt_millis_;
+  bool attempted_;
+
+  SensorSnapshot snapshot_;
+};
+
+class SensorSampler : public ScheduledTask {
+ public:
+  // Interface to be implemented by the owner of the sensors.
+  class SensorReader {
+   public:
+    virtual ~SensorReader() {}
+
+    // Reads the named sensor from the hardware, returning its current value or
+    // an error if it can not be read.
+    virtual StatusOr<double> ReadSensor(ESensorName sensor_name) = 0;
+  };
+
+  // Each sensor name may appear at most once in sensors.
+  SensorSampler(SensorReader& reader, ArrayView<SampledSensor> sensors);
+
+  // Reads those sensors whose period has elapsed since they were last read (or
+  // since an attempt to read them failed). Intended to be called from
+  // MaintainDevice.
+  void SampleDueSensors(uint32_t now_millis);
+
+  // Returns the number of milliseconds until the next sensor is due to be read
+  // (0 if one is already due), or kDontReschedule if there are no sensors.
+  uint32_t MillisUntilNextSample(uint32_t now_millis) const;
+
+  // Reads all of the sensors now (e.g. for a Refresh request), returning OK if
+  // all of them were read successfully, else the first error.
+  Status SampleAll(uint32_t now_millis);
+
+  // Returns true if sensor_name is one of the sensors being sampled.
+  bool HasSensor(ESensorName sensor_name) const;
+
+  // Returns the latest reading (or average) of the named sensor, in O(1) time.
+  // Returns NotImplemented if the sensor isn't being sampled, or ValueNotSet if
+  // it hasn't yet been read successfully.
+  StatusOr<double> GetValue(ESensorName sensor_name) const;
+
+  // Returns the number of hours since the named sensor was last read
+  // successfully, with the same errors as GetValue.
+  StatusOr<double> GetTimeSinceLastUpdate(ESensorName sensor_name,
+                                          uint32_t now_millis) const;
+
+  // The period over which readings are averaged, for those sensors with a
+  // WindowedStatisticsBase. Zero (the default) means no averaging. Changing the
+  // period discards the readings recorded so far.
+  uint32_t average_period_millis() const { return average_period_millis_; }
+  void set_average_period_millis(uint32_t value);
+
+ protected:
+  // Samples the due sensors, then returns the time until the next is due.
+  uint32_t RunTask(uint32_t now_millis) override;
+
+ private:
+  static constexpr uint8_t kNoSensor = 255;
+  static constexpr uint8_t kNumSensorNames =
+      static_cast<uint8_t>(ESensorName::kWindSpeed) + 1;
+
+  Status Sample(SampledSensor& sensor, uint32_t now_millis);
+  const SampledSensor* Find(ESensorName sensor_name) const;
+
+  SensorReader& reader_;
+  ArrayView<SampledSensor> sensors_;
+  uint32_t average_period_millis_;
+
+  // Index in sensors_ of each ESensorName, or kNoSensor.
+  uint8_t sensor_index_[kNumSensorNames];
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_OBSERVING_CONDITIONS_SENSOR_SAMPLER_H_
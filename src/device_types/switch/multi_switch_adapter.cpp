@@ -2,15 +2,85 @@
 
 #include "alpaca_response.h"
 #include "ascom_error_codes.h"
+#include "config.h"
 #include "constants.h"
 #include "device_info.h"
 #include "literals.h"
+#include "utils/any_printable.h"
+#include "utils/status.h"
+#include "utils/string_view.h"
 
 namespace alpaca {
 
 MultiSwitchAdapter::MultiSwitchAdapter(const DeviceInfo& device_info,
-                                       ArrayView<SwitchInterface*> switches)
-    : SwitchAdapter(device_info), switches_(switches) {}
+                                       ArrayView<SwitchInterface*> switches,
+                                       SwitchStateStoreBase* state_store)
+    : SwitchAdapter(device_info),
+      switches_(switches),
+      state_store_(state_store),
+      name_store_(nullptr),
+      first_name_key_(0),
+      next_switch_to_refresh_(0) {}
+
+void MultiSwitchAdapter::Initialize() {
+  SwitchAdapter::Initialize();
+  if (state_store_ != nullptr) {
+    TAS_CHECK_LE(switches_.size(), state_store_->max_switches());
+    state_store_->Reset();
+    for (uint16_t switch_id = 0; switch_id < switches_.size(); ++switch_id) {
+      RefreshSwitch(switch_id);
+    }
+    // Reading the switches for the first time isn't a change.
+    state_store_->ClearChanges();
+  }
+  if (name_store_ != nullptr && task_scheduler() != nullptr) {
+    name_store_->SetTaskScheduler(*task_scheduler());
+  }
+}
+
+void MultiSwitchAdapter::MaintainDevice() {
+  SwitchAdapter::MaintainDevice();
+  // Refresh just one switch per call, so that the time taken by a single call
+  // doesn't grow with the number of switches.
+  if (state_store_ != nullptr && switches_.size() > 0) {
+    if (next_switch_to_refresh_ >= switches_.size()) {
+      next_switch_to_refresh_ = 0;
+    }
+    RefreshSwitch(next_switch_to_refresh_++);
+  }
+}
+
+bool MultiSwitchAdapter::IsStored(uint16_t switch_id) const {
+  return state_store_ != nullptr && state_store_->IsKnown(switch_id);
+}
+
+void MultiSwitchAdapter::RefreshSwitch(uint16_t switch_id) {
+  if (state_store_ == nullptr) {
+    return;
+  }
+  SwitchInterface* switch_interface = GetSwitchInterface(switch_id);
+  // Only switches whose values are small non-negative integers can be stored.
+  const double max_value = switch_interface->GetMaxSwitchValue();
+  if (switch_interface->GetMinSwitchValue() != 0 ||
+      switch_interface->GetSwitchStep() != 1 || max_value > 255) {
+    state_store_->MarkUnknown(switch_id);
+    return;
+  }
+  auto state = switch_interface->GetSwitch();
+  if (!state.ok()) {
+    state_store_->MarkUnknown(switch_id);
+    return;
+  }
+  auto value = switch_interface->GetSwitchValue();
+  if (!value.ok() || value.value() < 0 || max_value < value.value()) {
+    state_store_->MarkUnknown(switch_id);
+    return;
+  }
+  // The value should be an integer, but round in case it isn't exactly so.
+  const uint8_t step_index = static_cast<uint8_t>(value.value() + 0.5);
+  state_store_->Update(switch_id, switch_interface->GetCanWrite(),
+                       state.value(), step_index);
+}
 
 SwitchInterface* MultiSwitchAdapter::GetSwitchInterface(
     uint16_t switch_id) const {
@@ -26,25 +96,58 @@ bool MultiSwitchAdapter::HandleGetSwitchDescription(
 
 bool MultiSwitchAdapter::HandleGetSwitchName(const AlpacaRequest& request,
                                              uint16_t switch_id, Print& out) {
+  if (name_store_ != nullptr) {
+    const StringView name =
+        name_store_->GetString(first_name_key_ + switch_id);
+    if (!name.empty()) {
+      return WriteResponse::AnyPrintableStringResponse(
+          request, AnyPrintable(name), out);
+    }
+  }
   return GetSwitchInterface(switch_id)->HandleGetSwitchName(request, out);
 }
 
 bool MultiSwitchAdapter::HandleSetSwitchName(const AlpacaRequest& request,
                                              uint16_t switch_id, Print& out) {
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+  if (name_store_ != nullptr) {
+    if (!request.extra_parameters.contains(EParameter::kName)) {
+      return WriteResponse::AscomParameterMissingErrorResponse(
+          request, Literals::Name(), out);
+    }
+    // The store is written in the background, so this doesn't wait for the
+    // EEPROM.
+    const StringView name = request.extra_parameters.find(EParameter::kName);
+    Status status = OkStatus();
+    if (!name_store_->PutString(first_name_key_ + switch_id, name)) {
+      status = ErrorCodes::SettingsProviderError();
+    }
+    return WriteResponse::StatusResponse(request, status, out);
+  }
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
   return GetSwitchInterface(switch_id)->HandleSetSwitchName(request, out);
 }
 
 uint16_t MultiSwitchAdapter::GetMaxSwitch() { return switches_.size(); }
 
 bool MultiSwitchAdapter::GetCanWrite(uint16_t switch_id) {
+  if (IsStored(switch_id)) {
+    return state_store_->GetCanWrite(switch_id);
+  }
   return GetSwitchInterface(switch_id)->GetCanWrite();
 }
 
 StatusOr<bool> MultiSwitchAdapter::GetSwitch(uint16_t switch_id) {
+  if (IsStored(switch_id)) {
+    return state_store_->GetState(switch_id);
+  }
   return GetSwitchInterface(switch_id)->GetSwitch();
 }
 
 StatusOr<double> MultiSwitchAdapter::GetSwitchValue(uint16_t switch_id) {
+  if (IsStored(switch_id)) {
+    return static_cast<double>(state_store_->GetStepIndex(switch_id));
+  }
   return GetSwitchInterface(switch_id)->GetSwitchValue();
 }
 
@@ -61,11 +164,16 @@ double MultiSwitchAdapter::GetSwitchStep(uint16_t switch_id) {
 }
 
 Status MultiSwitchAdapter::SetSwitch(uint16_t switch_id, bool state) {
-  return GetSwitchInterface(switch_id)->SetSwitch(state);
+  Status status = GetSwitchInterface(switch_id)->SetSwitch(state);
+  // Read back the state even on failure, as the switch may have changed.
+  RefreshSwitch(switch_id);
+  return status;
 }
 
 Status MultiSwitchAdapter::SetSwitchValue(uint16_t switch_id, double value) {
-  return GetSwitchInterface(switch_id)->SetSwitchValue(value);
+  Status status = GetSwitchInterface(switch_id)->SetSwitchValue(value);
+  RefreshSwitch(switch_id);
+  return status;
 }
 
 }  // namespace alpaca
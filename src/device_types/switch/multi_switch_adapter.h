@@ -3,23 +3,45 @@
 
 // Forwards calls to the appropriate SwitchInterface device.
 //
+// If provided with a SwitchStateStore, MultiSwitchAdapter keeps a copy of the
+// state of those switches whose values are 0, 1, ..., N (N <= 255), i.e. of
+// toggle switches and simple multi-state switches. GetSwitch, GetSwitchValue
+// and GetCanWrite are then answered from the store, without calling the
+// switch. The store is updated after each SetSwitch or SetSwitchValue, and one
+// switch is re-read each time MaintainDevice is called, so that changes made
+// outside of the server (e.g. by a human pushing a button) are noticed. The
+// store also records which switches have changed, for those who want to know.
+//
+// If provided with a SettingsStore, MultiSwitchAdapter supports SetSwitchName
+// by recording the new name of the switch in the store (as the value of key
+// first_key + switch_id), from which it is written to the EEPROM in the
+// background, and answers GetSwitchName from the store for switches that have
+// been renamed. Requires TAS_ENABLE_EXTRA_REQUEST_PARAMETERS, so that the Name
+// parameter of the request is available.
+//
 // Author: james.synge@gmail.com
 
 #include "device_types/switch/switch_adapter.h"
 #include "device_types/switch/switch_interface.h"
+#include "device_types/switch/switch_state_store.h"
 #include "utils/array_view.h"
 #include "utils/platform.h"
+#include "utils/settings_store.h"
 #include "utils/status_or.h"
 
 namespace alpaca {
 
 class MultiSwitchAdapter : public SwitchAdapter {
  public:
+  // state_store, if provided, must have room for all of the switches.
   MultiSwitchAdapter(const DeviceInfo& device_info,
-                     ArrayView<SwitchInterface*> switches);
+                     ArrayView<SwitchInterface*> switches,
+                     SwitchStateStoreBase* state_store = nullptr);
   // ~MultiSwitchAdapter() override {}
 
   // Overrides of the base class methods:
+  void Initialize() override;
+  void MaintainDevice() override;
   bool HandleGetSwitchDescription(const AlpacaRequest& request,
                                   uint16_t switch_id, Print& out) override;
   bool HandleGetSwitchName(const AlpacaRequest& request, uint16_t switch_id,
@@ -36,10 +58,33 @@ class MultiSwitchAdapter : public SwitchAdapter {
   Status SetSwitch(uint16_t switch_id, bool state) override;
   Status SetSwitchValue(uint16_t switch_id, double value) override;
 
+  // Returns the store of switch states, or nullptr if there isn't one.
+  const SwitchStateStoreBase* state_store() const { return state_store_; }
+
+  // Records the names set by SetSwitchName in store, using keys first_key
+  // through first_key + GetMaxSwitch() - 1. Should be called before Initialize,
+  // which provides the store with the server's TaskScheduler, if there is one.
+  void set_switch_name_store(SettingsStoreBase* store, uint16_t first_key) {
+    name_store_ = store;
+    first_name_key_ = first_key;
+  }
+
  private:
   SwitchInterface* GetSwitchInterface(uint16_t switch_id) const;
 
+  // Returns true if the state of the switch is available from the store.
+  bool IsStored(uint16_t switch_id) const;
+
+  // Reads the state of the switch into the store, if there is one.
+  void RefreshSwitch(uint16_t switch_id);
+
   ArrayView<SwitchInterface*> switches_;
+  SwitchStateStoreBase* const state_store_;
+  SettingsStoreBase* name_store_;
+  uint16_t first_name_key_;
+
+  // The switch to be refreshed by the next call to MaintainDevice.
+  uint8_t next_switch_to_refresh_;
 };
 
 }  // namespace alpaca
@@ -4,8 +4,124 @@
 #include "ascom_error_codes.h"
 #include "constants.h"
 #include "literals.h"
+#include "utils/inline_literal.h"
+#include "utils/json_encoder.h"
+#include "utils/literal.h"
+#include "utils/string_compare.h"
 
 namespace alpaca {
+namespace {
+
+TAS_DEFINE_LITERAL(GetSwitchStatesAction, "GetSwitchStates");
+TAS_DEFINE_LITERAL(SetSwitchValuesAction, "SetSwitchValues");
+TAS_DEFINE_LITERAL(CanWriteProperty, "CanWrite");
+TAS_DEFINE_LITERAL(StepProperty, "Step");
+
+// The supported actions listed in the DeviceInfo, plus the batch actions.
+class SupportedActionsSource : public JsonElementSource {
+ public:
+  explicit SupportedActionsSource(const LiteralArray& device_actions)
+      : device_actions_(device_actions) {}
+
+  void AddTo(JsonArrayEncoder& encoder) const override {
+    for (const Literal& literal : device_actions_) {
+      encoder.AddStringElement(literal);
+    }
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+    encoder.AddStringElement(GetSwitchStatesAction());
+    encoder.AddStringElement(SetSwitchValuesAction());
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+  }
+
+ private:
+  const LiteralArray& device_actions_;
+};
+
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+
+// The state of one switch, an element of the GetSwitchStates array.
+class SwitchStateSource : public JsonPropertySource {
+ public:
+  SwitchStateSource(SwitchAdapter& adapter, uint16_t switch_id)
+      : adapter_(adapter), switch_id_(switch_id) {}
+
+  void AddTo(JsonObjectEncoder& encoder) const override {
+    encoder.AddUIntProperty(Literals::Id(), switch_id_);
+    encoder.AddBooleanProperty(CanWriteProperty(),
+                               adapter_.GetCanWrite(switch_id_));
+    auto state = adapter_.GetSwitch(switch_id_);
+    if (state.ok()) {
+      encoder.AddBooleanProperty(Literals::State(), state.value());
+    }
+    auto value = adapter_.GetSwitchValue(switch_id_);
+    if (value.ok()) {
+      encoder.AddDoubleProperty(Literals::Value(), value.value());
+    }
+    encoder.AddDoubleProperty(Literals::Minimum(),
+                              adapter_.GetMinSwitchValue(switch_id_));
+    encoder.AddDoubleProperty(Literals::Maximum(),
+                              adapter_.GetMaxSwitchValue(switch_id_));
+    encoder.AddDoubleProperty(StepProperty(),
+                              adapter_.GetSwitchStep(switch_id_));
+  }
+
+ private:
+  SwitchAdapter& adapter_;
+  const uint16_t switch_id_;
+};
+
+// Streams the state of every switch; nothing is buffered, so the switches are
+// read once for computing the Content-Length, and again for writing the body.
+class SwitchStatesSource : public JsonElementSource {
+ public:
+  explicit SwitchStatesSource(SwitchAdapter& adapter) : adapter_(adapter) {}
+
+  void AddTo(JsonArrayEncoder& encoder) const override {
+    const uint16_t max_switch = adapter_.GetMaxSwitch();
+    for (uint16_t switch_id = 0; switch_id < max_switch; ++switch_id) {
+      encoder.AddObjectElement(SwitchStateSource(adapter_, switch_id));
+    }
+  }
+
+ private:
+  SwitchAdapter& adapter_;
+};
+
+// Removes the text up to the next underscore (or the end) from the front of
+// view, storing it in field. Returns false if view is empty.
+bool ConsumeField(StringView& view, StringView& field) {
+  if (view.empty()) {
+    return false;
+  }
+  StringView::size_type length = 0;
+  while (length < view.size() && view.at(length) != '_') {
+    ++length;
+  }
+  field = view.prefix(length);
+  view.remove_prefix(length < view.size() ? length + 1 : length);
+  return true;
+}
+
+// Removes the next id and value from the front of view. Returns false if view
+// is empty, or if the id or value is malformed, in which case valid is false.
+bool ConsumeIdAndValue(StringView& view, uint32_t& id, double& value,
+                       bool& valid) {
+  valid = true;
+  StringView id_field, value_field;
+  if (!ConsumeField(view, id_field)) {
+    return false;
+  }
+  if (!ConsumeField(view, value_field) || !id_field.to_uint32(id) ||
+      !value_field.to_double(value)) {
+    valid = false;
+    return false;
+  }
+  return true;
+}
+
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+
+}  // namespace
 
 SwitchAdapter::SwitchAdapter(const DeviceInfo& device_info)
     : DeviceImplBase(device_info) {
@@ -77,6 +193,11 @@ bool SwitchAdapter::HandleGetRequest(const AlpacaRequest& request, Print& out) {
       return WriteResponse::StatusOrDoubleResponse(
           request, GetSwitchStep(request.id), out);
 
+    case EDeviceMethod::kSupportedActions:
+      return WriteResponse::ArrayResponse(
+          request, SupportedActionsSource(device_info().supported_actions),
+          out);
+
     default:
       return DeviceImplBase::HandleGetRequest(request, out);
   }
@@ -139,6 +260,73 @@ bool SwitchAdapter::HandlePutRequest(const AlpacaRequest& request, Print& out) {
   }
 }
 
+bool SwitchAdapter::HandlePutAction(const AlpacaRequest& request, Print& out) {
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+  const StringView action =
+      request.extra_parameters.find(EParameter::kAction);
+  if (CaseEqual(action, GetSwitchStatesAction())) {
+    return WriteSwitchStatesResponse(request, out);
+  } else if (CaseEqual(action, SetSwitchValuesAction())) {
+    if (!request.extra_parameters.contains(EParameter::kParameters)) {
+      return WriteResponse::AscomParameterMissingErrorResponse(
+          request, Literals::Parameters(), out);
+    }
+    return HandleSetSwitchValues(
+        request, request.extra_parameters.find(EParameter::kParameters), out);
+  }
+  // DeviceImplBase reports that actions aren't implemented at all if the
+  // DeviceInfo lists none, but the batch actions are supported.
+  if (device_info().supported_actions.size == 0) {
+    return WriteResponse::AscomErrorResponse(
+        request, ErrorCodes::ActionNotImplemented(), out);
+  }
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+  return DeviceImplBase::HandlePutAction(request, out);
+}
+
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+
+bool SwitchAdapter::WriteSwitchStatesResponse(const AlpacaRequest& request,
+                                              Print& out) {
+  return WriteResponse::ArrayResponse(request, SwitchStatesSource(*this), out);
+}
+
+bool SwitchAdapter::HandleSetSwitchValues(const AlpacaRequest& request,
+                                          const StringView& parameters,
+                                          Print& out) {
+  // Validate all of the ids and values before setting any of them.
+  const uint16_t max_switch = GetMaxSwitch();
+  StringView view = parameters;
+  uint32_t id;
+  double value;
+  bool valid;
+  while (ConsumeIdAndValue(view, id, value, valid)) {
+    if (id >= max_switch || value < GetMinSwitchValue(id) ||
+        GetMaxSwitchValue(id) < value) {
+      valid = false;
+      break;
+    }
+    if (!GetCanWrite(id)) {
+      return WriteResponse::AscomNotImplementedResponse(request, out);
+    }
+  }
+  if (!valid || parameters.empty()) {
+    return WriteResponse::AscomParameterInvalidErrorResponse(
+        request, Literals::Parameters(), out);
+  }
+
+  view = parameters;
+  while (ConsumeIdAndValue(view, id, value, valid)) {
+    Status status = SetSwitchValue(id, value);
+    if (!status.ok()) {
+      return WriteResponse::StatusResponse(request, status, out);
+    }
+  }
+  return WriteSwitchStatesResponse(request, out);
+}
+
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+
 bool SwitchAdapter::ValidateSwitchIdParameter(const AlpacaRequest& request,
                                               Print& out, bool& handler_ret) {
   if (request.have_id) {
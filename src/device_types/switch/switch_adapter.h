@@ -32,11 +32,33 @@
 // have two states, and multi-state if it can have more than two values. These
 // are treated the same in the interface definition.
 //
+// Batch Actions
+//
+// Reading the state of all of the switches with the standard methods takes
+// several requests per switch, which is slow with a network chip that has few
+// sockets. So SwitchAdapter also supports these custom actions (i.e. PUT
+// /action requests), which it adds to the list returned by /supportedactions:
+//
+//   GetSwitchStates: returns as the Value an array with an object per switch,
+//   with the properties Id, CanWrite, State, Value, Minimum, Maximum and Step;
+//   State and Value are omitted if they can not be read.
+//
+//   SetSwitchValues: sets several switch values, then returns the same array
+//   as GetSwitchStates. The Parameters are the ids and values to be set,
+//   separated by underscores (i.e. characters which don't need to be percent
+//   encoded), for example "0_1_3_0.5" sets switch 0 to 1 and switch 3 to 0.5.
+//   All of the ids and values are validated before any switch is set.
+//
+// The actions require TAS_ENABLE_EXTRA_REQUEST_PARAMETERS, so that the Action
+// and Parameters are available to the adapter.
+//
 // Author: james.synge@gmail.com
 
+#include "config.h"
 #include "device_types/device_impl_base.h"
 #include "utils/platform.h"
 #include "utils/status_or.h"
+#include "utils/string_view.h"
 
 namespace alpaca {
 
@@ -74,6 +96,10 @@ class SwitchAdapter : public DeviceImplBase {
   // device type are delegated to the base class, DeviceImplBase.
   bool HandlePutRequest(const AlpacaRequest& request, Print& out) override;
 
+  // Handles the batch actions described above, and delegates any other action
+  // to DeviceImplBase.
+  bool HandlePutAction(const AlpacaRequest& request, Print& out) override;
+
   //////////////////////////////////////////////////////////////////////////////
   // Delegatees from the above methods which allow the method to write the full
   // response to out. These return true to indicate that the response was
@@ -191,6 +217,17 @@ class SwitchAdapter : public DeviceImplBase {
   // HandlePutRequest.
   bool ValidateSwitchIdParameter(const AlpacaRequest& request, Print& out,
                                  bool& handler_ret);
+
+ private:
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+  // Writes the response to GetSwitchStates.
+  bool WriteSwitchStatesResponse(const AlpacaRequest& request, Print& out);
+
+  // Validates the Parameters of a SetSwitchValues action, and sets the switch
+  // values if they are valid.
+  bool HandleSetSwitchValues(const AlpacaRequest& request,
+                             const StringView& parameters, Print& out);
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
 };
 
 }  // namespace alpaca
@@ -0,0 +1,120 @@
+#include "device_types/switch/switch_state_store.h"
+
+#include "utils/logging.h"
+
+namespace alpaca {
+
+SwitchStateStoreBase::SwitchStateStoreBase(uint8_t max_switches, uint8_t* bits,
+                                           uint8_t* step_indices)
+    : bits_(bits),
+      step_indices_(step_indices),
+      max_switches_(max_switches),
+      bitset_size_(BitsetSize(max_switches)),
+      generation_(0),
+      changes_start_generation_(0) {
+  // Doesn't call Reset because the storage is in the subclass, and hasn't been
+  // constructed yet; the subclass calls it instead.
+}
+
+void SwitchStateStoreBase::Reset() {
+  for (uint8_t ndx = 0; ndx < kNumBitsets * bitset_size_; ++ndx) {
+    bits_[ndx] = 0;
+  }
+  for (uint8_t ndx = 0; ndx < max_switches_; ++ndx) {
+    step_indices_[ndx] = 0;
+  }
+  ++generation_;
+  changes_start_generation_ = generation_;
+}
+
+void SwitchStateStoreBase::Update(uint8_t switch_id, bool can_write,
+                                  bool state, uint8_t step_index) {
+  TAS_DCHECK_LT(switch_id, max_switches_);
+  bool changed = SetBit(kKnownBits, switch_id, true);
+  changed |= SetBit(kCanWriteBits, switch_id, can_write);
+  changed |= SetBit(kStateBits, switch_id, state);
+  if (step_indices_[switch_id] != step_index) {
+    step_indices_[switch_id] = step_index;
+    changed = true;
+  }
+  if (changed) {
+    RecordChange(switch_id);
+  }
+}
+
+void SwitchStateStoreBase::MarkUnknown(uint8_t switch_id) {
+  TAS_DCHECK_LT(switch_id, max_switches_);
+  if (SetBit(kKnownBits, switch_id, false)) {
+    RecordChange(switch_id);
+  }
+}
+
+bool SwitchStateStoreBase::IsKnown(uint8_t switch_id) const {
+  return switch_id < max_switches_ && GetBit(kKnownBits, switch_id);
+}
+
+bool SwitchStateStoreBase::GetCanWrite(uint8_t switch_id) const {
+  TAS_DCHECK(IsKnown(switch_id));
+  return GetBit(kCanWriteBits, switch_id);
+}
+
+bool SwitchStateStoreBase::GetState(uint8_t switch_id) const {
+  TAS_DCHECK(IsKnown(switch_id));
+  return GetBit(kStateBits, switch_id);
+}
+
+uint8_t SwitchStateStoreBase::GetStepIndex(uint8_t switch_id) const {
+  TAS_DCHECK(IsKnown(switch_id));
+  return step_indices_[switch_id];
+}
+
+bool SwitchStateStoreBase::HasChangedSince(uint8_t switch_id,
+                                           uint16_t generation) const {
+  TAS_DCHECK_LT(switch_id, max_switches_);
+  // Compare ages rather than generations, so that wrap around is handled.
+  const uint16_t age = generation_ - generation;
+  if (age == 0) {
+    return false;
+  }
+  const uint16_t changes_age = generation_ - changes_start_generation_;
+  if (age > changes_age) {
+    // Changes before the changed bitset was cleared have been forgotten.
+    return true;
+  }
+  return GetBit(kChangedBits, switch_id);
+}
+
+void SwitchStateStoreBase::ClearChanges() {
+  ClearBitset(kChangedBits);
+  changes_start_generation_ = generation_;
+}
+
+bool SwitchStateStoreBase::GetBit(EBitset bitset, uint8_t switch_id) const {
+  const uint8_t byte = bits_[bitset * bitset_size_ + switch_id / 8];
+  return (byte & (1 << (switch_id % 8))) != 0;
+}
+
+bool SwitchStateStoreBase::SetBit(EBitset bitset, uint8_t switch_id,
+                                  bool value) {
+  uint8_t& byte = bits_[bitset * bitset_size_ + switch_id / 8];
+  const uint8_t mask = 1 << (switch_id % 8);
+  const uint8_t new_byte = value ? (byte | mask) : (byte & ~mask);
+  if (new_byte == byte) {
+    return false;
+  }
+  byte = new_byte;
+  return true;
+}
+
+void SwitchStateStoreBase::ClearBitset(EBitset bitset) {
+  for (uint8_t ndx = 0; ndx < bitset_size_; ++ndx) {
+    bits_[bitset * bitset_size_ + ndx] = 0;
+  }
+}
+
+void SwitchStateStoreBase::RecordChange(uint8_t switch_id) {
+  ++generation_;
+  SetBit(kChangedBits, switch_id, true);
+}
+
+}  // namespace alpaca
@@ -0,0 +1,135 @@
+#ifndef TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_SWITCH_SWITCH_STATE_STORE_H_
+#define TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_SWITCH_SWITCH_STATE_STORE_H_
+
+// SwitchStateStore holds a compact copy of the state of a group of switches,
+// so that MultiSwitchAdapter can answer GetSwitch, GetSwitchValue and
+// GetCanWrite without calling (virtual) methods of each SwitchInterface, and
+// so that the owner can determine which switches have changed recently rather
+// than polling all of them.
+//
+// Each switch takes one bit in each of several bitsets (state, can write,
+// known, changed), plus one byte for the step index of a multi-state switch
+// (i.e. the value of a switch whose values are 0, 1, ..., N, where N <= 255).
+// Thus a group of 16 switches needs just 24 bytes, plus about 10 bytes.
+//
+// The store has a generation number which is incremented each time the state
+// of a switch changes. Along with the changed bitset, which records the
+// switches that have changed since ClearChanges was last called, this allows
+// the owner to ask whether a switch may have changed since a generation it
+// previously observed.
+//
+// As with WindowedStatistics, the logic is in a non-template base class, and
+// the template subclass provides the storage for a fixed number of switches.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+
+namespace alpaca {
+
+class SwitchStateStoreBase {
+ public:
+  // Forgets the state of all of the switches (i.e. marks them as unknown),
+  // and clears the record of changes. Increments the generation, so that all
+  // switches appear to have changed since any earlier generation.
+  void Reset();
+
+  // The number of switches for which there is storage.
+  uint8_t max_switches() const { return max_switches_; }
+
+  // Records the state of a switch, as read from the switch. If the switch was
+  // previously unknown, or its state differs from that recorded, then the
+  // generation is incremented and the switch is marked as changed.
+  void Update(uint8_t switch_id, bool can_write, bool state,
+              uint8_t step_index);
+
+  // Records that the state of the switch is unknown, for example because it
+  // can not be read, or because its values can not be represented by a step
+  // index. This counts as a change if the state was previously known.
+  void MarkUnknown(uint8_t switch_id);
+
+  // Returns true if the state of the switch is known, in which case the
+  // following accessors return the recorded state.
+  bool IsKnown(uint8_t switch_id) const;
+  bool GetCanWrite(uint8_t switch_id) const;
+  bool GetState(uint8_t switch_id) const;
+  uint8_t GetStepIndex(uint8_t switch_id) const;
+
+  // Incremented (with wrap around) each time that the state of any switch
+  // changes.
+  uint16_t generation() const { return generation_; }
+
+  // Returns true if the switch may have changed after the store had the
+  // specified generation. The changed bitset only records which switches have
+  // changed since the last call to ClearChanges (or Reset), so the answer may
+  // be true for a switch that changed before the specified generation (but
+  // after ClearChanges), and is always true for a generation older than the
+  // last ClearChanges, or if the generation has since wrapped around.
+  bool HasChangedSince(uint8_t switch_id, uint16_t generation) const;
+
+  // Clears the record of which switches have changed, which may be useful
+  // once all interested parties have observed the current generation.
+  void ClearChanges();
+
+ protected:
+  // The number of bytes needed for a bitset with a bit for each switch.
+  static constexpr uint8_t BitsetSize(uint8_t max_switches) {
+    return (max_switches + 7) / 8;
+  }
+
+  // The number of bitsets stored in the bits array.
+  static constexpr uint8_t kNumBitsets = 4;
+
+  // bits must have room for kNumBitsets * BitsetSize(max_switches) bytes, and
+  // step_indices for max_switches bytes.
+  SwitchStateStoreBase(uint8_t max_switches, uint8_t* bits,
+                       uint8_t* step_indices);
+
+ private:
+  enum EBitset : uint8_t {
+    kStateBits = 0,
+    kCanWriteBits = 1,
+    kKnownBits = 2,
+    kChangedBits = 3,
+  };
+
+  bool GetBit(EBitset bitset, uint8_t switch_id) const;
+  // Returns true if the bit was changed.
+  bool SetBit(EBitset bitset, uint8_t switch_id, bool value);
+  void ClearBitset(EBitset bitset);
+
+  void RecordChange(uint8_t switch_id);
+
+  uint8_t* const bits_;
+  uint8_t* const step_indices_;
+  const uint8_t max_switches_;
+  const uint8_t bitset_size_;
+
+  uint16_t generation_;
+
+  // The generation when the changed bitset was last cleared.
+  uint16_t changes_start_generation_;
+};
+
+template <uint8_t kMaxSwitches>
+class SwitchStateStore : public SwitchStateStoreBase {
+  static_assert(kMaxSwitches >= 1, "Must have at least one switch");
+
+ public:
+  SwitchStateStore()
+      : SwitchStateStoreBase(kMaxSwitches, bits_, step_indices_) {
+    Reset();
+  }
+
+  // Copying would leave the copy referring to the original's storage.
+  SwitchStateStore(const SwitchStateStore&) = delete;
+  SwitchStateStore& operator=(const SwitchStateStore&) = delete;
+
+ private:
+  uint8_t bits_[kNumBitsets * BitsetSize(kMaxSwitches)];
+  uint8_t step_indices_[kMaxSwitches];
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_DEVICE_TYPES_SWITCH_SWITCH_STATE_STORE_H_
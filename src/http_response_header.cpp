@@ -2,6 +2,7 @@
 
 #include "constants.h"
 #include "literals.h"
+#include "server_metrics.h"
 
 namespace alpaca {
 namespace {
@@ -26,6 +27,7 @@ void HttpResponseHeader::Reset() {
 }
 
 size_t HttpResponseHeader::printTo(Print& out) const {
+  ServerMetrics::SetResponseStatus(status_code);
   size_t count = 0;
   count += Literals::HttpVersion().printTo(out);
   count += out.print(' ');
@@ -0,0 +1,43 @@
+#include "input_buffer_pool.h"
+
+#include "utils/logging.h"
+
+namespace alpaca {
+
+InputBufferPool::InputBufferPool() : borrowed_mask_(0) {}
+
+char* InputBufferPool::Borrow() {
+  for (uint8_t ndx = 0; ndx < kNumBuffers; ++ndx) {
+    const uint8_t bit = 1 << ndx;
+    if ((borrowed_mask_ & bit) == 0) {
+      borrowed_mask_ |= bit;
+      TAS_VLOG(5) << TAS_FLASHSTR("InputBufferPool::Borrow ") << ndx;
+      return buffers_[ndx];
+    }
+  }
+  TAS_VLOG(3) << TAS_FLASHSTR("InputBufferPool::Borrow ")
+              << TAS_FLASHSTR("no buffer available");
+  return nullptr;
+}
+
+void InputBufferPool::Return(char* buffer) {
+  const auto ndx = (buffer - buffers_[0]) / kBufferSize;
+  TAS_DCHECK_LT(ndx, kNumBuffers);
+  TAS_DCHECK_EQ(buffer, buffers_[ndx]);
+  const uint8_t bit = 1 << ndx;
+  TAS_DCHECK_NE(borrowed_mask_ & bit, 0);
+  TAS_VLOG(5) << TAS_FLASHSTR("InputBufferPool::Return ") << ndx;
+  borrowed_mask_ &= ~bit;
+}
+
+uint8_t InputBufferPool::available() const {
+  uint8_t count = 0;
+  for (uint8_t ndx = 0; ndx < kNumBuffers; ++ndx) {
+    if ((borrowed_mask_ & (1 << ndx)) == 0) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+}  // namespace alpaca
@@ -0,0 +1,49 @@
+#ifndef TINY_ALPACA_SERVER_SRC_INPUT_BUFFER_POOL_H_
+#define TINY_ALPACA_SERVER_SRC_INPUT_BUFFER_POOL_H_
+
+// InputBufferPool owns the buffers into which ServerConnection reads the bytes
+// of a request. A connection borrows a buffer when data arrives, and returns it
+// once the request has been decoded and the buffer is empty (i.e. there are no
+// bytes of a pipelined request remaining), or when the connection is closed.
+// Because requests rarely arrive on more than one connection at a time, there
+// can be fewer buffers (TAS_NUM_INPUT_BUFFERS) than connections
+// (TAS_NUM_SERVER_CONNECTIONS); a connection which can't borrow a buffer leaves
+// the data in the network chip's RX buffer, and tries again on the next call to
+// PerformIO.
+//
+// Author: james.synge@gmail.com
+
+#include "config.h"
+#include "utils/platform.h"
+
+namespace alpaca {
+
+class InputBufferPool {
+ public:
+  static constexpr uint8_t kNumBuffers = TAS_NUM_INPUT_BUFFERS;
+  static constexpr size_t kBufferSize = SERVER_CONNECTION_INPUT_BUFFER_SIZE;
+
+  InputBufferPool();
+
+  // Returns a buffer of kBufferSize bytes, or nullptr if all of the buffers
+  // have been borrowed.
+  char* Borrow();
+
+  // Returns a buffer previously returned by Borrow to the pool.
+  void Return(char* buffer);
+
+  // Number of buffers that are not currently borrowed.
+  uint8_t available() const;
+
+ private:
+  static_assert(0 < kNumBuffers, "Too few input buffers");
+  static_assert(kNumBuffers <= 8, "Too many input buffers");
+
+  // Bit N is set if buffers_[N] has been borrowed.
+  uint8_t borrowed_mask_;
+  char buffers_[kNumBuffers][kBufferSize];
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_INPUT_BUFFER_POOL_H_
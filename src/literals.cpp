@@ -1,22 +1,76 @@
 #include "literals.h"
 
 namespace alpaca {
-
-// Define string literal constants in a nested namespace.
 namespace progmem_data {
-#define TAS_DEFINE_BUILTIN_LITERAL(name, literal) \
-  constexpr char k##name[] AVR_PROGMEM = literal;
-#include "literals.inc"
-#undef TAS_DEFINE_BUILTIN_LITERAL
+
+struct LiteralsPoolEntry {
+  uint16_t offset;
+  Literal::size_type length;
+};
+
+// Define the pool of string literals, and the offset and length of each
+// literal in the pool, indexed by ELiteral.
+#define TAS_LITERALS_POOL(text) \
+  constexpr char kLiteralsPool[] AVR_PROGMEM = text;
+#define TAS_LITERALS_POOL_ENTRY(name, offset, length)
+#include "literals_pool.inc"
+#undef TAS_LITERALS_POOL_ENTRY
+#undef TAS_LITERALS_POOL
+
+#define TAS_LITERALS_POOL(text)
+#define TAS_LITERALS_POOL_ENTRY(name, offset, length) {offset, length},
+constexpr LiteralsPoolEntry kLiteralsPoolEntries[] AVR_PROGMEM = {
+#include "literals_pool.inc"
+};
+#undef TAS_LITERALS_POOL_ENTRY
+#undef TAS_LITERALS_POOL
+
+static_assert(sizeof(kLiteralsPoolEntries) / sizeof(kLiteralsPoolEntries[0]) ==
+                  kNumLiterals,
+              "Too many literals for ELiteral");
+static_assert(sizeof(kLiteralsPool) <= 65536,
+              "The pool is too large for 16-bit offsets");
+
+constexpr LiteralsPoolEntry EntryOf(ELiteral id) {
+  return kLiteralsPoolEntries[static_cast<uint8_t>(id)];
+}
+
+// Returns true if the pool contains literal (of the specified length) at
+// offset. Used to detect that literals_pool.inc is stale.
+constexpr bool PoolContains(const char* literal, size_t length,
+                            LiteralsPoolEntry entry) {
+  return length == entry.length &&
+         (length == 0 ||
+          (literal[0] == kLiteralsPool[entry.offset] &&
+           PoolContains(literal + 1, length - 1,
+                        {static_cast<uint16_t>(entry.offset + 1),
+                         static_cast<Literal::size_type>(length - 1)})));
+}
+
 }  // namespace progmem_data
 
 // Define static Literal factory methods in a struct, acting as a nested
-// namespace.
-#define TAS_DEFINE_BUILTIN_LITERAL(name, literal) \
-  Literal Literals::name() { return Literal(progmem_data::k##name); }
+// namespace. The offset and length are compile time constants, so there is no
+// need to read the table of offsets.
+#define TAS_DEFINE_BUILTIN_LITERAL(name, literal)                            \
+  Literal Literals::name() {                                                 \
+    constexpr auto entry = progmem_data::EntryOf(ELiteral::name);            \
+    static_assert(                                                           \
+        progmem_data::PoolContains(literal, sizeof(literal) - 1, entry),     \
+        "literals_pool.inc is out of date; run make_literals_inc.py");       \
+    return Literal(progmem_data::kLiteralsPool + entry.offset, entry.length); \
+  }
 
 #include "literals.inc"
 
 #undef TAS_DEFINE_BUILTIN_LITERAL
 
+Literal Literals::Get(ELiteral id) {
+  const auto* entry =
+      &progmem_data::kLiteralsPoolEntries[static_cast<uint8_t>(id)];
+  const uint16_t offset = pgm_read_word(&entry->offset);
+  const Literal::size_type length = pgm_read_byte(&entry->length);
+  return Literal(progmem_data::kLiteralsPool + offset, length);
+}
+
 }  // namespace alpaca
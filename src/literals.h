@@ -3,9 +3,18 @@
 
 // To avoid wasting RAM on string literals on Arduino's based on Microchip
 // Techonology's AVR microcontrollers, we gather the strings together in
-// literals.inc, and then include that file here to define arrays in PROGMEM for
-// those strings, and to define factory functions for corresponding Literal
-// instances.
+// literals.inc, and then include that file here to define factory functions for
+// corresponding Literal instances.
+//
+// To save flash, the strings aren't stored separately. Instead
+// extras/dev_tools/make_literals_inc.py packs them into a single string (the
+// pool) in which a literal that is a substring of another (e.g. "action" in
+// "supportedactions") isn't stored separately, and in which the end of one
+// literal overlaps the start of the next where possible. The pool, and the
+// offset and length of each literal in the pool, are in literals_pool.inc,
+// which must be regenerated after editing literals.inc. Each literal is also
+// identified by an ELiteral value, which allows tables of literals (e.g. for
+// matching) to be stored in a byte per literal.
 //
 // Author: james.synge@gmail.com
 
@@ -18,6 +27,24 @@
 
 namespace alpaca {
 
+#define TAS_LITERALS_POOL(text)
+#define TAS_LITERALS_POOL_ENTRY(name, offset, length) name,
+
+enum class ELiteral : uint8_t {
+#include "literals_pool.inc"
+};
+
+#undef TAS_LITERALS_POOL_ENTRY
+#define TAS_LITERALS_POOL_ENTRY(name, offset, length) +1
+
+// The number of literals in the pool.
+constexpr uint8_t kNumLiterals = 0
+#include "literals_pool.inc"
+    ;  // NOLINT
+
+#undef TAS_LITERALS_POOL_ENTRY
+#undef TAS_LITERALS_POOL
+
 // Define static Literal factory methods in a struct, acting as a nested
 // namespace, but ensuring that each method defined in the source file matches
 // a declaration in the header file.
@@ -25,6 +52,11 @@ namespace alpaca {
 
 struct Literals {
 #include "literals.inc"
+
+  // Returns the Literal identified by id. Prefer the factory methods above
+  // where the literal is known at compile time, as they don't need to read the
+  // table of offsets from flash.
+  static Literal Get(ELiteral id);
 };
 
 #undef TAS_DEFINE_BUILTIN_LITERAL
@@ -7,129 +7,196 @@
 #include "utils/logging.h"
 #include "utils/string_compare.h"
 
-#define MATCH_ONE_LITERAL_EXACTLY(literal_name, enum_value) \
-  if (Literals::literal_name() == view) {                   \
-    match = enum_value;                                     \
-    return true;                                            \
+namespace alpaca {
+namespace {
+
+// The literal to be matched, and the value to which it maps. The literals of
+// each function below are in a table in PROGMEM, so that each costs two bytes
+// of flash, rather than the code for a comparison.
+struct LiteralMatch {
+  ELiteral literal;
+  uint8_t value;
+};
+
+#define TAS_LITERAL_MATCH(literal_name, enum_value) \
+  { ELiteral::literal_name, static_cast<uint8_t>(enum_value) }
+
+bool FindLiteralMatch(const LiteralMatch* table, size_t size,
+                      const StringView& view, bool case_sensitive,
+                      uint8_t& value) {
+  for (size_t ndx = 0; ndx < size; ++ndx) {
+    const auto* entry = &table[ndx];
+    const auto literal = Literals::Get(static_cast<ELiteral>(
+        pgm_read_byte(reinterpret_cast<const uint8_t*>(&entry->literal))));
+    if (literal.size() != view.size()) {
+      continue;
+    }
+    if (case_sensitive ? literal == view : CaseEqual(literal, view)) {
+      value = pgm_read_byte(&entry->value);
+      return true;
+    }
   }
+  return false;
+}
 
-#define MATCH_ONE_LITERAL_CASE_INSENSITIVELY(literal_name, enum_value) \
-  if (CaseEqual(Literals::literal_name(), view)) {                     \
-    match = enum_value;                                                \
-    return true;                                                       \
+template <typename E, size_t N>
+bool MatchExactly(const LiteralMatch (&table)[N], const StringView& view,
+                  E& match) {
+  uint8_t value;
+  if (FindLiteralMatch(table, N, view, /*case_sensitive=*/true, value)) {
+    match = static_cast<E>(value);
+    return true;
   }
+  return false;
+}
 
-namespace alpaca {
+template <typename E, size_t N>
+bool MatchCaseInsensitively(const LiteralMatch (&table)[N],
+                            const StringView& view, E& match) {
+  uint8_t value;
+  if (FindLiteralMatch(table, N, view, /*case_sensitive=*/false, value)) {
+    match = static_cast<E>(value);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+constexpr LiteralMatch kHttpMethodLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(GET, EHttpMethod::GET),
+    TAS_LITERAL_MATCH(PUT, EHttpMethod::PUT),
+    TAS_LITERAL_MATCH(HEAD, EHttpMethod::HEAD),
+};
 
 bool MatchHttpMethod(const StringView& view, EHttpMethod& match) {
-  MATCH_ONE_LITERAL_EXACTLY(GET, EHttpMethod::GET);
-  MATCH_ONE_LITERAL_EXACTLY(PUT, EHttpMethod::PUT);
-  MATCH_ONE_LITERAL_EXACTLY(HEAD, EHttpMethod::HEAD);
-  return false;
+  return MatchExactly(kHttpMethodLiterals, view, match);
 }
 
+constexpr LiteralMatch kApiGroupLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(api, EApiGroup::kDevice),
+    TAS_LITERAL_MATCH(management, EApiGroup::kManagement),
+    TAS_LITERAL_MATCH(setup, EApiGroup::kSetup),
+    TAS_LITERAL_MATCH(metrics, EApiGroup::kMetrics),
+};
+
 bool MatchApiGroup(const StringView& view, EApiGroup& match) {
-  MATCH_ONE_LITERAL_EXACTLY(api, EApiGroup::kDevice);
-  MATCH_ONE_LITERAL_EXACTLY(management, EApiGroup::kManagement);
-  MATCH_ONE_LITERAL_EXACTLY(setup, EApiGroup::kSetup);
-  return false;
+  return MatchExactly(kApiGroupLiterals, view, match);
 }
 
+constexpr LiteralMatch kManagementMethodLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(description, EManagementMethod::kDescription),
+    TAS_LITERAL_MATCH(configureddevices, EManagementMethod::kConfiguredDevices),
+};
+
 bool MatchManagementMethod(const StringView& view, EManagementMethod& match) {
-  MATCH_ONE_LITERAL_EXACTLY(description, EManagementMethod::kDescription);
-  MATCH_ONE_LITERAL_EXACTLY(configureddevices,
-                            EManagementMethod::kConfiguredDevices);
-  return false;
+  return MatchExactly(kManagementMethodLiterals, view, match);
 }
 
+constexpr LiteralMatch kDeviceTypeLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(camera, EDeviceType::kCamera),
+    TAS_LITERAL_MATCH(covercalibrator, EDeviceType::kCoverCalibrator),
+    TAS_LITERAL_MATCH(dome, EDeviceType::kDome),
+    TAS_LITERAL_MATCH(filterwheel, EDeviceType::kFilterWheel),
+    TAS_LITERAL_MATCH(focuser, EDeviceType::kFocuser),
+    TAS_LITERAL_MATCH(observingconditions, EDeviceType::kObservingConditions),
+    TAS_LITERAL_MATCH(rotator, EDeviceType::kRotator),
+    TAS_LITERAL_MATCH(safetymonitor, EDeviceType::kSafetyMonitor),
+    TAS_LITERAL_MATCH(DeviceTypeSwitch, EDeviceType::kSwitch),
+    TAS_LITERAL_MATCH(telescope, EDeviceType::kTelescope),
+};
+
 bool MatchDeviceType(const StringView& view, EDeviceType& match) {
-  MATCH_ONE_LITERAL_EXACTLY(camera, EDeviceType::kCamera);
-  MATCH_ONE_LITERAL_EXACTLY(covercalibrator, EDeviceType::kCoverCalibrator);
-  MATCH_ONE_LITERAL_EXACTLY(dome, EDeviceType::kDome);
-  MATCH_ONE_LITERAL_EXACTLY(filterwheel, EDeviceType::kFilterWheel);
-  MATCH_ONE_LITERAL_EXACTLY(focuser, EDeviceType::kFocuser);
-  MATCH_ONE_LITERAL_EXACTLY(observingconditions,
-                            EDeviceType::kObservingConditions);
-  MATCH_ONE_LITERAL_EXACTLY(rotator, EDeviceType::kRotator);
-  MATCH_ONE_LITERAL_EXACTLY(safetymonitor, EDeviceType::kSafetyMonitor);
-  MATCH_ONE_LITERAL_EXACTLY(DeviceTypeSwitch, EDeviceType::kSwitch);
-  MATCH_ONE_LITERAL_EXACTLY(telescope, EDeviceType::kTelescope);
-  return false;
+  return MatchExactly(kDeviceTypeLiterals, view, match);
 }
 
 namespace internal {
+constexpr LiteralMatch kCommonDeviceMethodLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(action, EDeviceMethod::kAction),
+    TAS_LITERAL_MATCH(connected, EDeviceMethod::kConnected),
+    TAS_LITERAL_MATCH(description, EDeviceMethod::kDescription),
+    TAS_LITERAL_MATCH(driverinfo, EDeviceMethod::kDriverInfo),
+    TAS_LITERAL_MATCH(driverversion, EDeviceMethod::kDriverVersion),
+    TAS_LITERAL_MATCH(interfaceversion, EDeviceMethod::kInterfaceVersion),
+    TAS_LITERAL_MATCH(name, EDeviceMethod::kName),
+    TAS_LITERAL_MATCH(supportedactions, EDeviceMethod::kSupportedActions),
+};
+
 // Exposed for testing.
 bool MatchCommonDeviceMethod(const StringView& view, EDeviceMethod& match) {
-  MATCH_ONE_LITERAL_EXACTLY(connected, EDeviceMethod::kConnected);
-  MATCH_ONE_LITERAL_EXACTLY(description, EDeviceMethod::kDescription);
-  MATCH_ONE_LITERAL_EXACTLY(driverinfo, EDeviceMethod::kDriverInfo);
-  MATCH_ONE_LITERAL_EXACTLY(driverversion, EDeviceMethod::kDriverVersion);
-  MATCH_ONE_LITERAL_EXACTLY(interfaceversion, EDeviceMethod::kInterfaceVersion);
-  MATCH_ONE_LITERAL_EXACTLY(name, EDeviceMethod::kName);
-  MATCH_ONE_LITERAL_EXACTLY(supportedactions, EDeviceMethod::kSupportedActions);
-  return false;
+  return MatchExactly(kCommonDeviceMethodLiterals, view, match);
 }
 }  // namespace internal
 
 namespace {
+constexpr LiteralMatch kCoverCalibratorMethodLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(brightness, EDeviceMethod::kBrightness),
+    TAS_LITERAL_MATCH(calibratoroff, EDeviceMethod::kCalibratorOff),
+    TAS_LITERAL_MATCH(calibratoron, EDeviceMethod::kCalibratorOn),
+    TAS_LITERAL_MATCH(calibratorstate, EDeviceMethod::kCalibratorState),
+    TAS_LITERAL_MATCH(closecover, EDeviceMethod::kCloseCover),
+    TAS_LITERAL_MATCH(coverstate, EDeviceMethod::kCoverState),
+    TAS_LITERAL_MATCH(haltcover, EDeviceMethod::kHaltCover),
+    TAS_LITERAL_MATCH(maxbrightness, EDeviceMethod::kMaxBrightness),
+    TAS_LITERAL_MATCH(opencover, EDeviceMethod::kOpenCover),
+};
+
 bool MatchCoverCalibratorMethod(const StringView& view, EDeviceMethod& match) {
-  MATCH_ONE_LITERAL_EXACTLY(brightness, EDeviceMethod::kBrightness);
-  MATCH_ONE_LITERAL_EXACTLY(calibratoroff, EDeviceMethod::kCalibratorOff);
-  MATCH_ONE_LITERAL_EXACTLY(calibratoron, EDeviceMethod::kCalibratorOn);
-  MATCH_ONE_LITERAL_EXACTLY(calibratorstate, EDeviceMethod::kCalibratorState);
-  MATCH_ONE_LITERAL_EXACTLY(closecover, EDeviceMethod::kCloseCover);
-  MATCH_ONE_LITERAL_EXACTLY(coverstate, EDeviceMethod::kCoverState);
-  MATCH_ONE_LITERAL_EXACTLY(haltcover, EDeviceMethod::kHaltCover);
-  MATCH_ONE_LITERAL_EXACTLY(maxbrightness, EDeviceMethod::kMaxBrightness);
-  MATCH_ONE_LITERAL_EXACTLY(opencover, EDeviceMethod::kOpenCover);
-  return false;
+  return MatchExactly(kCoverCalibratorMethodLiterals, view, match);
 }
 
+constexpr LiteralMatch kObservingConditionsMethodLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(averageperiod, EDeviceMethod::kAveragePeriod),
+    TAS_LITERAL_MATCH(cloudcover, EDeviceMethod::kCloudCover),
+    TAS_LITERAL_MATCH(dewpoint, EDeviceMethod::kDewPoint),
+    TAS_LITERAL_MATCH(humidity, EDeviceMethod::kHumidity),
+    TAS_LITERAL_MATCH(pressure, EDeviceMethod::kPressure),
+    TAS_LITERAL_MATCH(rainrate, EDeviceMethod::kRainRate),
+    TAS_LITERAL_MATCH(refresh, EDeviceMethod::kRefresh),
+    TAS_LITERAL_MATCH(sensordescription, EDeviceMethod::kSensorDescription),
+    TAS_LITERAL_MATCH(skybrightness, EDeviceMethod::kSkyBrightness),
+    TAS_LITERAL_MATCH(skyquality, EDeviceMethod::kSkyQuality),
+    TAS_LITERAL_MATCH(skytemperature, EDeviceMethod::kSkyTemperature),
+    TAS_LITERAL_MATCH(starfullwidthhalfmax,
+                      EDeviceMethod::kStarFullWidthHalfMax),
+    TAS_LITERAL_MATCH(temperature, EDeviceMethod::kTemperature),
+    TAS_LITERAL_MATCH(timesincelastupdate, EDeviceMethod::kTimeSinceLastUpdate),
+    TAS_LITERAL_MATCH(winddirection, EDeviceMethod::kWindDirection),
+    TAS_LITERAL_MATCH(windgust, EDeviceMethod::kWindGust),
+    TAS_LITERAL_MATCH(windspeed, EDeviceMethod::kWindSpeed),
+};
+
 bool MatchObservingConditionsMethod(const StringView& view,
                                     EDeviceMethod& match) {
-  MATCH_ONE_LITERAL_EXACTLY(averageperiod, EDeviceMethod::kAveragePeriod);
-  MATCH_ONE_LITERAL_EXACTLY(cloudcover, EDeviceMethod::kCloudCover);
-  MATCH_ONE_LITERAL_EXACTLY(dewpoint, EDeviceMethod::kDewPoint);
-  MATCH_ONE_LITERAL_EXACTLY(humidity, EDeviceMethod::kHumidity);
-  MATCH_ONE_LITERAL_EXACTLY(pressure, EDeviceMethod::kPressure);
-  MATCH_ONE_LITERAL_EXACTLY(rainrate, EDeviceMethod::kRainRate);
-  MATCH_ONE_LITERAL_EXACTLY(refresh, EDeviceMethod::kRefresh);
-  MATCH_ONE_LITERAL_EXACTLY(sensordescription,
-                            EDeviceMethod::kSensorDescription);
-  MATCH_ONE_LITERAL_EXACTLY(skybrightness, EDeviceMethod::kSkyBrightness);
-  MATCH_ONE_LITERAL_EXACTLY(skyquality, EDeviceMethod::kSkyQuality);
-  MATCH_ONE_LITERAL_EXACTLY(skytemperature, EDeviceMethod::kSkyTemperature);
-  MATCH_ONE_LITERAL_EXACTLY(starfullwidthhalfmax,
-                            EDeviceMethod::kStarFullWidthHalfMax);
-  MATCH_ONE_LITERAL_EXACTLY(temperature, EDeviceMethod::kTemperature);
-  MATCH_ONE_LITERAL_EXACTLY(timesincelastupdate,
-                            EDeviceMethod::kTimeSinceLastUpdate);
-  MATCH_ONE_LITERAL_EXACTLY(winddirection, EDeviceMethod::kWindDirection);
-  MATCH_ONE_LITERAL_EXACTLY(windgust, EDeviceMethod::kWindGust);
-  MATCH_ONE_LITERAL_EXACTLY(windspeed, EDeviceMethod::kWindSpeed);
-  return false;
+  return MatchExactly(kObservingConditionsMethodLiterals, view, match);
 }
 
+constexpr LiteralMatch kSafetyMonitorMethodLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(issafe, EDeviceMethod::kIsSafe),
+};
+
 bool MatchSafetyMonitorMethod(const StringView& view, EDeviceMethod& match) {
-  MATCH_ONE_LITERAL_EXACTLY(issafe, EDeviceMethod::kIsSafe);
-  return false;
+  return MatchExactly(kSafetyMonitorMethodLiterals, view, match);
 }
 
+constexpr LiteralMatch kSwitchMethodLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(canwrite, EDeviceMethod::kCanWrite),
+    TAS_LITERAL_MATCH(getswitch, EDeviceMethod::kGetSwitch),
+    TAS_LITERAL_MATCH(getswitchdescription,
+                      EDeviceMethod::kGetSwitchDescription),
+    TAS_LITERAL_MATCH(getswitchname, EDeviceMethod::kGetSwitchName),
+    TAS_LITERAL_MATCH(getswitchvalue, EDeviceMethod::kGetSwitchValue),
+    TAS_LITERAL_MATCH(maxswitch, EDeviceMethod::kMaxSwitch),
+    TAS_LITERAL_MATCH(maxswitchvalue, EDeviceMethod::kMaxSwitchValue),
+    TAS_LITERAL_MATCH(minswitchvalue, EDeviceMethod::kMinSwitchValue),
+    TAS_LITERAL_MATCH(setswitch, EDeviceMethod::kSetSwitch),
+    TAS_LITERAL_MATCH(setswitchname, EDeviceMethod::kSetSwitchName),
+    TAS_LITERAL_MATCH(setswitchvalue, EDeviceMethod::kSetSwitchValue),
+    TAS_LITERAL_MATCH(switchstep, EDeviceMethod::kSwitchStep),
+};
+
 bool MatchSwitchMethod(const StringView& view, EDeviceMethod& match) {
-  MATCH_ONE_LITERAL_EXACTLY(canwrite, EDeviceMethod::kCanWrite);
-  MATCH_ONE_LITERAL_EXACTLY(getswitch, EDeviceMethod::kGetSwitch);
-  MATCH_ONE_LITERAL_EXACTLY(getswitchdescription,
-                            EDeviceMethod::kGetSwitchDescription);
-  MATCH_ONE_LITERAL_EXACTLY(getswitchname, EDeviceMethod::kGetSwitchName);
-  MATCH_ONE_LITERAL_EXACTLY(getswitchvalue, EDeviceMethod::kGetSwitchValue);
-  MATCH_ONE_LITERAL_EXACTLY(maxswitch, EDeviceMethod::kMaxSwitch);
-  MATCH_ONE_LITERAL_EXACTLY(maxswitchvalue, EDeviceMethod::kMaxSwitchValue);
-  MATCH_ONE_LITERAL_EXACTLY(minswitchvalue, EDeviceMethod::kMinSwitchValue);
-  MATCH_ONE_LITERAL_EXACTLY(setswitch, EDeviceMethod::kSetSwitch);
-  MATCH_ONE_LITERAL_EXACTLY(setswitchname, EDeviceMethod::kSetSwitchName);
-  MATCH_ONE_LITERAL_EXACTLY(setswitchvalue, EDeviceMethod::kSetSwitchValue);
-  MATCH_ONE_LITERAL_EXACTLY(switchstep, EDeviceMethod::kSwitchStep);
-  return false;
+  return MatchExactly(kSwitchMethodLiterals, view, match);
 }
 
 }  // namespace
@@ -176,7 +243,10 @@ bool MatchDeviceMethod(const EApiGroup group, const EDeviceType device_type,
     return internal::MatchCommonDeviceMethod(view, match);
   } else if (group == EApiGroup::kSetup) {
     // NOTE: Not checking whether the device type is supported.
-    MATCH_ONE_LITERAL_EXACTLY(setup, EDeviceMethod::kSetup);
+    if (Literals::setup() == view) {
+      match = EDeviceMethod::kSetup;
+      return true;
+    }
     return false;
   } else {
     TAS_CHECK(false) << TAS_FLASHSTR("api group (") << group
@@ -185,61 +255,59 @@ bool MatchDeviceMethod(const EApiGroup group, const EDeviceType device_type,
   }
 }
 
-bool MatchParameter(const StringView& view, EParameter& match) {
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(action, EParameter::kAction);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(brightness, EParameter::kBrightness);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(ClientID, EParameter::kClientID);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(ClientTransactionID,
-                                       EParameter::kClientTransactionID);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(Command, EParameter::kCommand);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(Connected, EParameter::kConnected);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(Id, EParameter::kId);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(Name, EParameter::kName);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(Parameters, EParameter::kParameters);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(Raw, EParameter::kRaw);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(SensorName, EParameter::kSensorName);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(State, EParameter::kState);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(Value, EParameter::kValue);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(AveragePeriod,
-                                       EParameter::kAveragePeriod);
+constexpr LiteralMatch kParameterLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(action, EParameter::kAction),
+    TAS_LITERAL_MATCH(brightness, EParameter::kBrightness),
+    TAS_LITERAL_MATCH(ClientID, EParameter::kClientID),
+    TAS_LITERAL_MATCH(ClientTransactionID, EParameter::kClientTransactionID),
+    TAS_LITERAL_MATCH(Command, EParameter::kCommand),
+    TAS_LITERAL_MATCH(Connected, EParameter::kConnected),
+    TAS_LITERAL_MATCH(Id, EParameter::kId),
+    TAS_LITERAL_MATCH(Name, EParameter::kName),
+    TAS_LITERAL_MATCH(Parameters, EParameter::kParameters),
+    TAS_LITERAL_MATCH(Raw, EParameter::kRaw),
+    TAS_LITERAL_MATCH(SensorName, EParameter::kSensorName),
+    TAS_LITERAL_MATCH(State, EParameter::kState),
+    TAS_LITERAL_MATCH(Value, EParameter::kValue),
+    TAS_LITERAL_MATCH(AveragePeriod, EParameter::kAveragePeriod),
+};
 
-  return false;
+bool MatchParameter(const StringView& view, EParameter& match) {
+  return MatchCaseInsensitively(kParameterLiterals, view, match);
 }
 
+constexpr LiteralMatch kSensorNameLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(cloudcover, ESensorName::kCloudCover),
+    TAS_LITERAL_MATCH(dewpoint, ESensorName::kDewPoint),
+    TAS_LITERAL_MATCH(humidity, ESensorName::kHumidity),
+    TAS_LITERAL_MATCH(pressure, ESensorName::kPressure),
+    TAS_LITERAL_MATCH(rainrate, ESensorName::kRainRate),
+    TAS_LITERAL_MATCH(skybrightness, ESensorName::kSkyBrightness),
+    TAS_LITERAL_MATCH(skyquality, ESensorName::kSkyQuality),
+    TAS_LITERAL_MATCH(skytemperature, ESensorName::kSkyTemperature),
+    TAS_LITERAL_MATCH(starfullwidthhalfmax, ESensorName::kStarFullWidthHalfMax),
+    TAS_LITERAL_MATCH(temperature, ESensorName::kTemperature),
+    TAS_LITERAL_MATCH(winddirection, ESensorName::kWindDirection),
+    TAS_LITERAL_MATCH(windgust, ESensorName::kWindGust),
+    TAS_LITERAL_MATCH(windspeed, ESensorName::kWindSpeed),
+};
+
 bool MatchSensorName(const StringView& view, ESensorName& match) {
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(cloudcover, ESensorName::kCloudCover);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(dewpoint, ESensorName::kDewPoint);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(humidity, ESensorName::kHumidity);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(pressure, ESensorName::kPressure);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(rainrate, ESensorName::kRainRate);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(skybrightness,
-                                       ESensorName::kSkyBrightness);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(skyquality, ESensorName::kSkyQuality);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(skytemperature,
-                                       ESensorName::kSkyTemperature);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(starfullwidthhalfmax,
-                                       ESensorName::kStarFullWidthHalfMax);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(temperature, ESensorName::kTemperature);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(winddirection,
-                                       ESensorName::kWindDirection);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(windgust, ESensorName::kWindGust);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(windspeed, ESensorName::kWindSpeed);
-  return false;
+  return MatchCaseInsensitively(kSensorNameLiterals, view, match);
 }
 
-bool MatchHttpHeader(const StringView& view, EHttpHeader& match) {
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(HttpAccept, EHttpHeader::kHttpAccept);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(HttpContentLength,
-                                       EHttpHeader::kHttpContentLength);
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(HttpContentType,
-                                       EHttpHeader::kHttpContentType);
-
+constexpr LiteralMatch kHttpHeaderLiterals[] AVR_PROGMEM = {
+    TAS_LITERAL_MATCH(HttpAccept, EHttpHeader::kHttpAccept),
+    TAS_LITERAL_MATCH(HttpContentLength, EHttpHeader::kHttpContentLength),
+    TAS_LITERAL_MATCH(HttpContentType, EHttpHeader::kHttpContentType),
   // Content-Encoding is used in tests as an example of a header we know
   // the name of, but don't have built-in handling for the value. It isn't
   // clear whether this is generally useful.
-  MATCH_ONE_LITERAL_CASE_INSENSITIVELY(HttpContentEncoding,
-                                       EHttpHeader::kHttpContentEncoding);
-  return false;
+    TAS_LITERAL_MATCH(HttpContentEncoding, EHttpHeader::kHttpContentEncoding),
+};
+
+bool MatchHttpHeader(const StringView& view, EHttpHeader& match) {
+  return MatchCaseInsensitively(kHttpHeaderLiterals, view, match);
 }
 
 }  // namespace alpaca
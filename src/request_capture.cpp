@@ -0,0 +1,71 @@
+#include "request_capture.h"
+
+#include "utils/platform.h"
+
+namespace alpaca {
+namespace {
+
+// Where the records are written, or nullptr if not capturing.
+Print* capture_out = nullptr;  // NOLINT
+
+// The time (from micros()) of the previous record.
+uint32_t last_record_time = 0;  // NOLINT
+
+void WriteVarint(Print& out, uint32_t value) {
+  while (value >= 0x80) {
+    out.write(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.write(static_cast<uint8_t>(value));
+}
+
+// Writes the start of a record, returning the Print instance to which any
+// additional fields should be written, or nullptr if not capturing.
+Print* StartRecord(RequestCapture::ERecordType type, uint8_t sock_num) {
+  Print* out = capture_out;
+  if (out != nullptr) {
+    const uint32_t now = micros();
+    out->write(static_cast<uint8_t>((type << 4) | (sock_num & 0x0F)));
+    WriteVarint(*out, now - last_record_time);
+    last_record_time = now;
+  }
+  return out;
+}
+
+}  // namespace
+
+constexpr char RequestCapture::kMagic[];
+
+void RequestCapture::StartCapture(Print& out) {
+  out.write(reinterpret_cast<const uint8_t*>(kMagic), kMagicSize);
+  out.write(kFormatVersion);
+  last_record_time = micros();
+  capture_out = &out;
+}
+
+void RequestCapture::StopCapture() { capture_out = nullptr; }
+
+bool RequestCapture::IsCapturing() { return capture_out != nullptr; }
+
+void RequestCapture::RecordConnect(uint8_t sock_num) {
+  StartRecord(kConnect, sock_num);
+}
+
+void RequestCapture::RecordData(uint8_t sock_num, const char* data,
+                                size_t size) {
+  Print* out = StartRecord(kData, sock_num);
+  if (out != nullptr) {
+    WriteVarint(*out, size);
+    out->write(reinterpret_cast<const uint8_t*>(data), size);
+  }
+}
+
+void RequestCapture::RecordHalfClosed(uint8_t sock_num) {
+  StartRecord(kHalfClosed, sock_num);
+}
+
+void RequestCapture::RecordDisconnect(uint8_t sock_num) {
+  StartRecord(kDisconnect, sock_num);
+}
+
+}  // namespace alpaca
@@ -0,0 +1,65 @@
+#ifndef TINY_ALPACA_SERVER_SRC_REQUEST_CAPTURE_H_
+#define TINY_ALPACA_SERVER_SRC_REQUEST_CAPTURE_H_
+
+// Support for recording the raw bytes received by ServerConnection, exactly as
+// ServerConnection::OnCanRead sees them (i.e. with the chunk boundaries of
+// each read and the time of arrival), along with the connection events that
+// delimit them. The recording can later be fed back into RequestDecoder and
+// TinyAlpacaServerBase by extras/tools/replay_requests, for reproducing
+// problems seen in the field, and for profiling and regression benchmarks.
+//
+// The recording is written to a Print instance provided to StartCapture: on
+// host that is typically a file, and on an Arduino a spare serial port (i.e.
+// not the one used for logging), whose output is saved by a program on the
+// attached computer. Writing to a serial port is slow compared to reading from
+// the network chip, so capturing at a low baud rate will change the timing of
+// the traffic being captured.
+//
+// The format is compact, so that it is cheap to produce on an AVR:
+//
+//   Header: the 6 characters "TASCAP", then a format version byte (1).
+//
+//   Records: a byte holding the ERecordType in the high nibble and the socket
+//   number in the low nibble; then the number of microseconds since the
+//   previous record (or since StartCapture), as an unsigned LEB128 varint.
+//   A kData record then has the number of bytes read as a varint, followed by
+//   the bytes.
+//
+// Recording is compiled into ServerConnection if TAS_ENABLE_REQUEST_CAPTURE is
+// non-zero, but does nothing until StartCapture is called.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+
+namespace alpaca {
+
+struct RequestCapture {
+  static constexpr char kMagic[] = "TASCAP";
+  static constexpr uint8_t kMagicSize = sizeof(kMagic) - 1;
+  static constexpr uint8_t kFormatVersion = 1;
+
+  enum ERecordType : uint8_t {
+    kConnect = 1,     // A connection has been accepted.
+    kData = 2,        // Bytes returned by a single call to Connection::read.
+    kHalfClosed = 3,  // The client has finished sending.
+    kDisconnect = 4,  // The connection has been closed (by either end).
+  };
+
+  // Writes the header to out, and starts recording to out.
+  static void StartCapture(Print& out);
+
+  // Stops recording. Doesn't flush the Print instance passed to StartCapture.
+  static void StopCapture();
+
+  static bool IsCapturing();
+
+  static void RecordConnect(uint8_t sock_num);
+  static void RecordData(uint8_t sock_num, const char* data, size_t size);
+  static void RecordHalfClosed(uint8_t sock_num);
+  static void RecordDisconnect(uint8_t sock_num);
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_REQUEST_CAPTURE_H_
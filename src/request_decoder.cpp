@@ -26,6 +26,7 @@
 #include "match_literals.h"
 #include "utils/hex_escape.h"
 #include "utils/logging.h"
+#include "utils/memory_usage.h"
 #include "utils/string_compare.h"
 
 // NOTE: The syntax for the query portion of a URI is not as clearly specified
@@ -541,9 +542,26 @@ EHttpStatusCode DecodeParamValue(RequestDecoderState& state, StringView& view) {
     if (state.listener) {
       status = state.listener->OnUnknownParameterValue(value);
     }
-  } else {
+#endif  // TAS_ENABLE_REQUEST_DECODER_LISTENER
+  } else if (state.current_parameter != EParameter::kUnknown) {
     // Recognized but no built-in support.
-    if (state.listener) {
+#if TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+    // Save the value for the handler of the request (e.g. the Action and
+    // Parameters of an action request).
+    switch (state.request.extra_parameters.insert(state.current_parameter,
+                                                  value)) {
+      case ExtraParameterValueMap::kInserted:
+        break;
+      case ExtraParameterValueMap::kValueTooLong:
+        status = EHttpStatusCode::kHttpPayloadTooLarge;
+        break;
+      default:
+        status = EHttpStatusCode::kHttpBadRequest;
+        break;
+    }
+#endif  // TAS_ENABLE_EXTRA_REQUEST_PARAMETERS
+#if TAS_ENABLE_REQUEST_DECODER_LISTENER
+    if (state.listener && status == EHttpStatusCode::kContinueDecoding) {
       status = state.listener->OnExtraParameter(state.current_parameter, value);
     }
 #endif  // TAS_ENABLE_REQUEST_DECODER_LISTENER
@@ -751,6 +769,9 @@ EHttpStatusCode ProcessApiGroup(RequestDecoderState& state,
     // The path continues.
     // NOTE: If adding support for more paths (e.g. a PUT or POST request to
     // handle updating parameters in EEPROM), we'll need to adjust this code.
+    if (group == EApiGroup::kMetrics) {
+      return EHttpStatusCode::kHttpBadRequest;
+    }
     if (!HttpMethodIsRead(state.request.http_method) &&
         group != EApiGroup::kDevice) {
       return EHttpStatusCode::kHttpMethodNotAllowed;
@@ -767,10 +788,13 @@ EHttpStatusCode ProcessApiGroup(RequestDecoderState& state,
         << TAS_FLASHSTR("group: ") << group;
     return state.SetDecodeFunction(DecodeApiVersion);
   }
-  if (group != EApiGroup::kSetup) {
+  if (group == EApiGroup::kSetup) {
+    state.request.api = EAlpacaApi::kServerSetup;
+  } else if (group == EApiGroup::kMetrics) {
+    state.request.api = EAlpacaApi::kServerMetrics;
+  } else {
     return EHttpStatusCode::kHttpBadRequest;
   }
-  state.request.api = EAlpacaApi::kServerSetup;
   if (!HttpMethodIsRead(state.request.http_method)) {
     return EHttpStatusCode::kHttpMethodNotAllowed;
   }
@@ -944,6 +968,7 @@ EHttpStatusCode RequestDecoderState::DecodeMessageHeader(
                 << TAS_FLASHSTR(" chars))");
 #endif
 
+    NoteStackUsage();
     status = decode_function(*this, buffer);
 
 #if TAS_ENABLE_DEBUGGING
@@ -1022,6 +1047,7 @@ EHttpStatusCode RequestDecoderState::DecodeMessageBody(StringView& buffer,
                 << TAS_FLASHSTR(" chars))");
 #endif
 
+    NoteStackUsage();
     status = decode_function(*this, buffer);
     const auto consumed_chars = buffer_size_before_decode - buffer.size();
 
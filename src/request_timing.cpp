@@ -0,0 +1,152 @@
+#include "request_timing.h"
+
+#include "alpaca_request.h"
+#include "constants.h"
+#include "utils/inline_literal.h"
+#include "utils/log2_histogram.h"
+#include "utils/platform.h"
+
+namespace alpaca {
+namespace {
+
+constexpr uint8_t kNumApis =
+    static_cast<uint8_t>(EAlpacaApi::kServerMetrics) + 1;
+constexpr uint8_t kNumDeviceTypes =
+    static_cast<uint8_t>(EDeviceType::kTelescope) + 1;
+constexpr uint8_t kNumPhases = static_cast<uint8_t>(ERequestPhase::kTotal) + 1;
+
+Log2Histogram api_histograms[kNumApis];                 // NOLINT
+Log2Histogram device_type_histograms[kNumDeviceTypes];  // NOLINT
+Log2Histogram phase_histograms[kNumPhases];             // NOLINT
+
+// Returns the duration from start to end (correct across a single wrap around
+// of micros()), in the units of the histograms.
+uint32_t ScaledDuration(uint32_t start, uint32_t end) {
+  return (end - start) >> RequestTimingHistograms::kMicrosShift;
+}
+
+Log2Histogram& MutableHistogramForApi(EAlpacaApi api) {
+  const auto ndx = static_cast<uint8_t>(api);
+  return api_histograms[ndx < kNumApis ? ndx : 0];
+}
+
+Log2Histogram& MutableHistogramForDeviceType(EDeviceType device_type) {
+  const auto ndx = static_cast<uint8_t>(device_type);
+  return device_type_histograms[ndx < kNumDeviceTypes ? ndx : 0];
+}
+
+Log2Histogram& MutableHistogramForPhase(ERequestPhase phase) {
+  return phase_histograms[static_cast<uint8_t>(phase)];
+}
+
+size_t PrintHistogramIfNotEmpty(const __FlashStringHelper* kind,
+                                const __FlashStringHelper* name,
+                                const Log2Histogram& histogram, Print& out) {
+  if (histogram.total_count() == 0) {
+    return 0;
+  }
+  size_t count = out.print(kind);
+  count += out.print(' ');
+  count += out.print(name);
+  count += out.print(TAS_FLASHSTR(": "));
+  count += histogram.printTo(out);
+  count += out.println();
+  return count;
+}
+
+const __FlashStringHelper* PhaseName(ERequestPhase phase) {
+  switch (phase) {
+    case ERequestPhase::kDecode:
+      return TAS_FLASHSTR("Decode");
+    case ERequestPhase::kHandle:
+      return TAS_FLASHSTR("Handle");
+    case ERequestPhase::kSend:
+      return TAS_FLASHSTR("Send");
+    case ERequestPhase::kTotal:
+      return TAS_FLASHSTR("Total");
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+// static
+const Log2Histogram& RequestTimingHistograms::ForApi(EAlpacaApi api) {
+  return MutableHistogramForApi(api);
+}
+
+// static
+const Log2Histogram& RequestTimingHistograms::ForDeviceType(
+    EDeviceType device_type) {
+  return MutableHistogramForDeviceType(device_type);
+}
+
+// static
+const Log2Histogram& RequestTimingHistograms::ForPhase(ERequestPhase phase) {
+  return MutableHistogramForPhase(phase);
+}
+
+// static
+void RequestTimingHistograms::Record(const AlpacaRequest& request,
+                                     uint32_t first_byte_time,
+                                     uint32_t decoded_time,
+                                     uint32_t handled_time,
+                                     uint32_t flushed_time) {
+  const uint32_t total = ScaledDuration(first_byte_time, flushed_time);
+  MutableHistogramForPhase(ERequestPhase::kDecode)
+      .Record(ScaledDuration(first_byte_time, decoded_time));
+  MutableHistogramForPhase(ERequestPhase::kHandle)
+      .Record(ScaledDuration(decoded_time, handled_time));
+  MutableHistogramForPhase(ERequestPhase::kSend)
+      .Record(ScaledDuration(handled_time, flushed_time));
+  MutableHistogramForPhase(ERequestPhase::kTotal).Record(total);
+  MutableHistogramForApi(request.api).Record(total);
+  if (request.api == EAlpacaApi::kDeviceApi) {
+    MutableHistogramForDeviceType(request.device_type).Record(total);
+  }
+}
+
+// static
+void RequestTimingHistograms::Reset() {
+  for (auto& histogram : api_histograms) {
+    histogram.Reset();
+  }
+  for (auto& histogram : device_type_histograms) {
+    histogram.Reset();
+  }
+  for (auto& histogram : phase_histograms) {
+    histogram.Reset();
+  }
+}
+
+// static
+size_t RequestTimingHistograms::PrintTo(Print& out) {
+  size_t count = 0;
+  for (uint8_t ndx = 0; ndx < kNumPhases; ++ndx) {
+    const auto phase = static_cast<ERequestPhase>(ndx);
+    count += PrintHistogramIfNotEmpty(TAS_FLASHSTR("phase"), PhaseName(phase),
+                                      ForPhase(phase), out);
+  }
+  for (uint8_t ndx = 0; ndx < kNumApis; ++ndx) {
+    const auto api = static_cast<EAlpacaApi>(ndx);
+    count += PrintHistogramIfNotEmpty(
+        TAS_FLASHSTR("api"), ToFlashStringHelper(api), ForApi(api), out);
+  }
+  for (uint8_t ndx = 0; ndx < kNumDeviceTypes; ++ndx) {
+    const auto device_type = static_cast<EDeviceType>(ndx);
+    count += PrintHistogramIfNotEmpty(TAS_FLASHSTR("device_type"),
+                                      ToFlashStringHelper(device_type),
+                                      ForDeviceType(device_type), out);
+  }
+  return count;
+}
+
+RequestTimer::RequestTimer()
+    : first_byte_time_(0), decoded_time_(0), handled_time_(0) {}
+
+void RequestTimer::RecordFlushed(const AlpacaRequest& request) {
+  RequestTimingHistograms::Record(request, first_byte_time_, decoded_time_,
+                                  handled_time_, micros());
+}
+
+}  // namespace alpaca
@@ -0,0 +1,88 @@
+#ifndef TINY_ALPACA_SERVER_SRC_REQUEST_TIMING_H_
+#define TINY_ALPACA_SERVER_SRC_REQUEST_TIMING_H_
+
+// Support for measuring how long it takes to handle each request, and for
+// accumulating those measurements in histograms, one per EAlpacaApi and one per
+// EDeviceType (for kDeviceApi requests), plus one for each phase of handling a
+// request (decoding, handling, and sending the response). This makes it
+// possible to find out which devices or APIs are responsible for slow
+// responses.
+//
+// A RequestTimer records the time (from micros()) at which:
+//
+// * The first byte of a request is available for decoding.
+// * The request has been completely decoded.
+// * The handler (i.e. RequestListener::OnRequestDecoded) has returned.
+// * The entire response has been written and flushed.
+//
+// The durations are recorded in RequestTimingHistograms in units of
+// 2^kMicrosShift microseconds; the resolution of micros() on a 16MHz AVR is 4
+// microseconds, so we lose little by dropping the low bits, and the last
+// bucket then counts durations of at least 2^(14+kMicrosShift) microseconds
+// (about a quarter second) rather than just 16 milliseconds.
+//
+// Collection is enabled by TAS_ENABLE_REQUEST_TIMING.
+//
+// Author: james.synge@gmail.com
+
+#include "alpaca_request.h"
+#include "constants.h"
+#include "utils/log2_histogram.h"
+#include "utils/platform.h"
+
+namespace alpaca {
+
+enum class ERequestPhase : uint8_t {
+  kDecode,  // From first byte available to request decoded.
+  kHandle,  // From request decoded to the handler returning.
+  kSend,    // From the handler returning to the response being flushed.
+  kTotal,   // From first byte available to the response being flushed.
+};
+
+struct RequestTimingHistograms {
+  static constexpr uint8_t kMicrosShift = 4;
+
+  // Returns the histogram of the total time to handle requests for api.
+  static const Log2Histogram& ForApi(EAlpacaApi api);
+
+  // Returns the histogram of the total time to handle requests for devices of
+  // type device_type.
+  static const Log2Histogram& ForDeviceType(EDeviceType device_type);
+
+  // Returns the histogram of the time to complete phase, across all requests.
+  static const Log2Histogram& ForPhase(ERequestPhase phase);
+
+  // Records the timings of a single request. The times are from micros(), and
+  // may wrap around between first_byte_time and flushed_time.
+  static void Record(const AlpacaRequest& request, uint32_t first_byte_time,
+                     uint32_t decoded_time, uint32_t handled_time,
+                     uint32_t flushed_time);
+
+  // Sets all of the counts to zero.
+  static void Reset();
+
+  // Prints the non-empty histograms, one per line.
+  static size_t PrintTo(Print& out);
+};
+
+class RequestTimer {
+ public:
+  RequestTimer();
+
+  void RecordFirstByte() { first_byte_time_ = micros(); }
+  void RecordDecoded() { decoded_time_ = micros(); }
+  void RecordHandled() { handled_time_ = micros(); }
+
+  // Records the time at which the response was flushed, and adds the durations
+  // to RequestTimingHistograms.
+  void RecordFlushed(const AlpacaRequest& request);
+
+ private:
+  uint32_t first_byte_time_;
+  uint32_t decoded_time_;
+  uint32_t handled_time_;
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_REQUEST_TIMING_H_
@@ -3,8 +3,11 @@
 #include "alpaca_response.h"
 #include "constants.h"
 #include "literals.h"
+#include "request_capture.h"
 #include "request_listener.h"
+#include "server_metrics.h"
 #include "utils/platform_ethernet.h"
+#include "utils/resumable_print.h"
 #include "utils/string_view.h"
 
 #if TAS_HOST_TARGET
@@ -12,11 +15,21 @@
 #endif
 
 namespace alpaca {
+namespace {
+constexpr uint32_t kUnlimited = ~static_cast<uint32_t>(0);
+constexpr size_t kInputBufferSize = InputBufferPool::kBufferSize;
+}  // namespace
 
-ServerConnection::ServerConnection(RequestListener& request_listener)
+ServerConnection::ServerConnection(RequestListener& request_listener,
+                                   InputBufferPool& input_buffer_pool)
     : request_listener_(request_listener),
+      input_buffer_pool_(input_buffer_pool),
       request_decoder_(request_),
-      sock_num_(MAX_SOCK_NUM) {
+      sock_num_(MAX_SOCK_NUM),
+      response_pending_(false),
+      response_bytes_written_(0),
+      input_buffer_size_(0),
+      input_buffer_(nullptr) {
   TAS_VLOG(4) << TAS_FLASHSTR("ServerConnection @ ") << this
               << TAS_FLASHSTR(" ctor");
 }
@@ -25,9 +38,16 @@ void ServerConnection::OnConnect(Connection& connection) {
   TAS_VLOG(2) << TAS_FLASHSTR("ServerConnection @ ") << this
               << TAS_FLASHSTR(" ->::OnConnect ") << connection.sock_num();
   TAS_DCHECK(!has_socket());
+  TAS_DCHECK_EQ(input_buffer_, nullptr);
   sock_num_ = connection.sock_num();
+  ServerMetrics::RecordConnectionAccepted();
+#if TAS_ENABLE_REQUEST_CAPTURE
+  RequestCapture::RecordConnect(sock_num_);
+#endif  // TAS_ENABLE_REQUEST_CAPTURE
   request_decoder_.Reset();
   between_requests_ = true;
+  response_pending_ = false;
+  response_bytes_written_ = 0;
   input_buffer_size_ = 0;
 }
 
@@ -36,31 +56,60 @@ void ServerConnection::OnCanRead(Connection& connection) {
               << TAS_FLASHSTR(" ->::OnCanRead ") << TAS_FLASHSTR("socket ")
               << connection.sock_num();
   TAS_DCHECK_EQ(sock_num(), connection.sock_num());
+  TAS_DCHECK(!response_pending_);
   TAS_DCHECK(request_decoder_.status() == RequestDecoderStatus::kReset ||
              request_decoder_.status() == RequestDecoderStatus::kDecoding);
-  // Load input_buffer_ with as much data as will fit.
-  if (input_buffer_size_ < sizeof input_buffer_) {
-    auto ret = connection.read(
-        reinterpret_cast<uint8_t*>(&input_buffer_[input_buffer_size_]),
-        (sizeof input_buffer_) - input_buffer_size_);
-    if (ret > 0) {
-      input_buffer_size_ += ret;
-      between_requests_ = false;
+  if (input_buffer_ == nullptr) {
+    // If none is available, the input will wait in the network chip until the
+    // next call.
+    input_buffer_ = input_buffer_pool_.Borrow();
+    if (input_buffer_ == nullptr) {
+      return;
     }
+    TAS_DCHECK_EQ(input_buffer_size_, 0);
   }
+  EHttpStatusCode status_code;
+  while (true) {
+    // Load input_buffer_ with as much data as will fit, using a single burst
+    // read of the bytes currently available.
+    bool read_some = false;
+    if (input_buffer_size_ < kInputBufferSize) {
+      auto ret = connection.read(
+          reinterpret_cast<uint8_t*>(&input_buffer_[input_buffer_size_]),
+          kInputBufferSize - input_buffer_size_);
+      if (ret > 0) {
+        ServerMetrics::RecordBytesReceived(ret);
+#if TAS_ENABLE_REQUEST_CAPTURE
+        RequestCapture::RecordData(sock_num_,
+                                   &input_buffer_[input_buffer_size_], ret);
+#endif  // TAS_ENABLE_REQUEST_CAPTURE
+        input_buffer_size_ += ret;
+        between_requests_ = false;
+        read_some = true;
+      }
+    }
+
+    // If there is no data to be decoded, we're done for now.
+    if (input_buffer_size_ == 0) {
+      if (request_decoder_.status() == RequestDecoderStatus::kReset) {
+        // Not in the middle of a request, so we don't need the buffer.
+        ReturnInputBuffer();
+      }
+      return;
+    }
 
-  // If there is data to be decoded, do so.
-  if (input_buffer_size_ > 0) {
     if (request_decoder_.status() == RequestDecoderStatus::kReset) {
+#if TAS_ENABLE_REQUEST_TIMING
+      request_timer_.RecordFirstByte();
+#endif  // TAS_ENABLE_REQUEST_TIMING
       request_listener_.OnStartDecoding(request_);
     }
 
     StringView view(input_buffer_, input_buffer_size_);
-    const bool buffer_is_full = input_buffer_size_ == sizeof input_buffer_;
+    const bool buffer_is_full = input_buffer_size_ == kInputBufferSize;
     const bool at_end = PlatformEthernet::IsClientDone(connection.sock_num());
 
-    EHttpStatusCode status_code =
-        request_decoder_.DecodeBuffer(view, buffer_is_full, at_end);
+    status_code = request_decoder_.DecodeBuffer(view, buffer_is_full, at_end);
 
     // Update the input buffer to reflect that some input has (hopefully) been
     // decoded.
@@ -80,49 +129,122 @@ void ServerConnection::OnCanRead(Connection& connection) {
     }
 
     // Are we done decoding?
-    if (status_code < EHttpStatusCode::kHttpOk) {
-      // No.
+    if (status_code >= EHttpStatusCode::kHttpOk) {
+      break;
+    }
+
+    // No. If the decoder made room in the buffer and there is more input
+    // available, keep going rather than waiting for the next call to
+    // PerformIO; this way a request that is larger than input_buffer_ can be
+    // decoded with one burst read per buffer-full.
+    if (!read_some || input_buffer_size_ >= kInputBufferSize ||
+        connection.available() <= 0) {
       return;
     }
+  }
 
-    bool close_connection = false;
-    if (status_code == EHttpStatusCode::kHttpOk) {
-      TAS_VLOG(4) << TAS_FLASHSTR("ServerConnection @ ") << this
-                  << TAS_FLASHSTR(" ->::OnCanRead ")
-                  << TAS_FLASHSTR("status_code: ") << status_code;
-      if (input_buffer_size_ == 0) {
-        between_requests_ = true;
-      }
-      if (!request_listener_.OnRequestDecoded(request_, connection)) {
-        close_connection = true;
-      }
-    } else {
-      TAS_VLOG(3) << TAS_FLASHSTR("ServerConnection @ ") << this
-                  << TAS_FLASHSTR(" ->::OnCanRead ")
-                  << TAS_FLASHSTR("status_code: ") << status_code;
-      request_listener_.OnRequestDecodingError(request_, status_code,
-                                               connection);
-      close_connection = true;
+  if (status_code == EHttpStatusCode::kHttpOk) {
+#if TAS_ENABLE_REQUEST_TIMING
+    request_timer_.RecordDecoded();
+#endif  // TAS_ENABLE_REQUEST_TIMING
+    TAS_VLOG(4) << TAS_FLASHSTR("ServerConnection @ ") << this
+                << TAS_FLASHSTR(" ->::OnCanRead ")
+                << TAS_FLASHSTR("status_code: ") << status_code;
+    if (input_buffer_size_ == 0) {
+      // The request has been decoded, and nothing has been received after it,
+      // so the buffer can be lent to another connection.
+      between_requests_ = true;
+      ReturnInputBuffer();
     }
+    // The response may not fit in the TX buffer, in which case the remainder
+    // will be written by OnCanWrite, as room becomes available.
+    response_pending_ = true;
+    response_bytes_written_ = 0;
+    ContinueResponse(connection);
+    return;
+  }
 
-    // If we've returned an error, then we also close the connection so that
-    // we don't require finding the end of a corrupt input request.
-    if (close_connection) {
-      TAS_VLOG(3) << TAS_FLASHSTR("ServerConnection @ ") << this
-                  << TAS_FLASHSTR(" ->::OnCanRead ")
-                  << TAS_FLASHSTR("closing connection");
+  TAS_VLOG(3) << TAS_FLASHSTR("ServerConnection @ ") << this
+              << TAS_FLASHSTR(" ->::OnCanRead ")
+              << TAS_FLASHSTR("status_code: ") << status_code;
+  WriteDecodingErrorResponse(status_code, connection);
 
-      connection.close();
-      sock_num_ = MAX_SOCK_NUM;
-    } else {
-      // Prepare the decoder for the next request.
-      request_decoder_.Reset();
-    }
+  // If we've returned an error, then we also close the connection so that
+  // we don't require finding the end of a corrupt input request.
+  TAS_VLOG(3) << TAS_FLASHSTR("ServerConnection @ ") << this
+              << TAS_FLASHSTR(" ->::OnCanRead ")
+              << TAS_FLASHSTR("closing connection");
+  CloseConnection(connection);
+}
+
+void ServerConnection::OnCanWrite(Connection& connection) {
+  TAS_VLOG(5) << TAS_FLASHSTR("ServerConnection @ ") << this
+              << TAS_FLASHSTR(" ->::OnCanWrite ") << TAS_FLASHSTR("socket ")
+              << connection.sock_num();
+  TAS_DCHECK_EQ(sock_num(), connection.sock_num());
+  TAS_DCHECK(response_pending_);
+  ContinueResponse(connection);
+}
+
+bool ServerConnection::HasPendingOutput() { return response_pending_; }
+
+void ServerConnection::ContinueResponse(Connection& connection) {
+  const size_t available = connection.availableToWrite();
+  if (response_bytes_written_ == 0 &&
+      available < SERVER_CONNECTION_MIN_RESPONSE_SPACE) {
+    // Wait until there is a reasonable amount of room before starting.
+    return;
+  }
+
+  // PUT requests have side-effects, so we must generate their responses
+  // exactly once, even if that means blocking until there is room for all of
+  // the response. Similarly, the metrics change while they're being written,
+  // so the response can't be generated more than once.
+  const uint32_t limit = (request_.http_method == EHttpMethod::PUT ||
+                          request_.api == EAlpacaApi::kServerMetrics)
+                             ? kUnlimited
+                             : available;
+  ResumablePrint out(connection, response_bytes_written_, limit);
+  const bool keep_open = request_listener_.OnRequestDecoded(request_, out);
+  ServerMetrics::RecordBytesSent(out.forwarded());
+#if TAS_ENABLE_REQUEST_TIMING
+  if (response_bytes_written_ == 0) {
+    request_timer_.RecordHandled();
+  }
+#endif  // TAS_ENABLE_REQUEST_TIMING
+  connection.flush();
+
+  if (!out.is_complete() && !connection.hasWriteError()) {
+    response_bytes_written_ += out.forwarded();
+    TAS_VLOG(4) << TAS_FLASHSTR("ServerConnection @ ") << this
+                << TAS_FLASHSTR(" ->::ContinueResponse ")
+                << TAS_FLASHSTR("bytes written: ") << response_bytes_written_
+                << TAS_FLASHSTR(" of ") << out.count();
+    return;
+  }
+
+#if TAS_ENABLE_REQUEST_TIMING
+  request_timer_.RecordFlushed(request_);
+#endif  // TAS_ENABLE_REQUEST_TIMING
+  ServerMetrics::RecordResponse(request_.api);
+  response_pending_ = false;
+  response_bytes_written_ = 0;
+  if (!keep_open || connection.hasWriteError()) {
+    TAS_VLOG(3) << TAS_FLASHSTR("ServerConnection @ ") << this
+                << TAS_FLASHSTR(" ->::ContinueResponse ")
+                << TAS_FLASHSTR("closing connection");
+    CloseConnection(connection);
+  } else {
+    // Prepare the decoder for the next request.
+    request_decoder_.Reset();
   }
 }
 
 void ServerConnection::OnHalfClosed(Connection& connection) {
   TAS_DCHECK_EQ(sock_num(), connection.sock_num());
+#if TAS_ENABLE_REQUEST_CAPTURE
+  RequestCapture::RecordHalfClosed(sock_num_);
+#endif  // TAS_ENABLE_REQUEST_CAPTURE
 
   if (!between_requests_) {
     // We've read some data but haven't been able to decode a complete request.
@@ -130,22 +252,50 @@ void ServerConnection::OnHalfClosed(Connection& connection) {
                 << TAS_FLASHSTR(" ->::OnHalfClosed socket ")
                 << connection.sock_num()
                 << " between_requests_=" << between_requests_;
-    request_listener_.OnRequestDecodingError(
-        request_, EHttpStatusCode::kHttpBadRequest, connection);
+    WriteDecodingErrorResponse(EHttpStatusCode::kHttpBadRequest, connection);
   } else {
     TAS_VLOG(4) << TAS_FLASHSTR("ServerConnection @ ") << this
                 << TAS_FLASHSTR(" ->::OnHalfClosed socket ")
                 << connection.sock_num();
   }
-  connection.close();
-  sock_num_ = MAX_SOCK_NUM;
+  CloseConnection(connection);
 }
 
 void ServerConnection::OnDisconnect() {
   TAS_VLOG(2) << TAS_FLASHSTR("ServerConnection @ ") << this
               << TAS_FLASHSTR(" ->::OnDisconnect, sock_num_=") << sock_num_;
   TAS_DCHECK(has_socket());
+  ServerMetrics::RecordConnectionClosed();
+#if TAS_ENABLE_REQUEST_CAPTURE
+  RequestCapture::RecordDisconnect(sock_num_);
+#endif  // TAS_ENABLE_REQUEST_CAPTURE
   sock_num_ = MAX_SOCK_NUM;
+  ReturnInputBuffer();
+}
+
+void ServerConnection::WriteDecodingErrorResponse(EHttpStatusCode status_code,
+                                                  Connection& connection) {
+  ResumablePrint out(connection, 0, kUnlimited);
+  request_listener_.OnRequestDecodingError(request_, status_code, out);
+  ServerMetrics::RecordBytesSent(out.forwarded());
+}
+
+void ServerConnection::CloseConnection(Connection& connection) {
+  connection.close();
+  ServerMetrics::RecordConnectionClosed();
+#if TAS_ENABLE_REQUEST_CAPTURE
+  RequestCapture::RecordDisconnect(sock_num_);
+#endif  // TAS_ENABLE_REQUEST_CAPTURE
+  sock_num_ = MAX_SOCK_NUM;
+  ReturnInputBuffer();
+}
+
+void ServerConnection::ReturnInputBuffer() {
+  if (input_buffer_ != nullptr) {
+    input_buffer_pool_.Return(input_buffer_);
+    input_buffer_ = nullptr;
+  }
+  input_buffer_size_ = 0;
 }
 
 }  // namespace alpaca
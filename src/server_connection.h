@@ -5,14 +5,19 @@
 // connection from a client, without actually including any of the networking
 // classes that need to deal with the platform's networking API. On Arduino,
 // where we have no dynamic memory allocation and a fixed maximum number of TCP
-// connections, we pre-allocate everything needed to handle one TCP connection.
+// connections, we pre-allocate everything needed to handle one TCP connection,
+// except for the input buffer, which is borrowed from an InputBufferPool only
+// while a request is being received.
 //
 // Author: james.synge@gmail.com
 
 #include "alpaca_request.h"
 #include "config.h"
+#include "constants.h"
+#include "input_buffer_pool.h"
 #include "request_decoder.h"
 #include "request_listener.h"
+#include "request_timing.h"
 #include "utils/platform.h"
 #include "utils/socket_listener.h"
 
@@ -20,7 +25,8 @@ namespace alpaca {
 
 class ServerConnection : public ServerSocketListener {
  public:
-  explicit ServerConnection(RequestListener& request_listener);
+  ServerConnection(RequestListener& request_listener,
+                   InputBufferPool& input_buffer_pool);
 
   // The sock_num is set when OnConnect is called, and cleared when either the
   // instance calls close on a connection, or when OnDisconnect is called.
@@ -30,17 +36,45 @@ class ServerConnection : public ServerSocketListener {
   // Methods from ServerSocketListener.
   void OnConnect(Connection& connection) override;
   void OnCanRead(Connection& connection) override;
+  void OnCanWrite(Connection& connection) override;
+  bool HasPendingOutput() override;
   void OnHalfClosed(Connection& connection) override;
   void OnDisconnect() override;
 
  private:
+  // Writes as much of the response to the decoded request as there is room for
+  // in the connection's TX buffer, without blocking. When the entire response
+  // has been written, prepares for the next request or closes the connection.
+  void ContinueResponse(Connection& connection);
+
+  // Asks the listener to write an error response for a request that couldn't
+  // be decoded.
+  void WriteDecodingErrorResponse(EHttpStatusCode status_code,
+                                  Connection& connection);
+
+  // Closes the connection, which is then no longer associated with this.
+  void CloseConnection(Connection& connection);
+
+  // Returns input_buffer_ (if borrowed) to input_buffer_pool_.
+  void ReturnInputBuffer();
+
   RequestListener& request_listener_;
+  InputBufferPool& input_buffer_pool_;
   AlpacaRequest request_;
   RequestDecoder request_decoder_;
   uint8_t sock_num_;
   bool between_requests_;
+  bool response_pending_;
+  uint32_t response_bytes_written_;
   uint8_t input_buffer_size_;
-  char input_buffer_[SERVER_CONNECTION_INPUT_BUFFER_SIZE];
+#if TAS_ENABLE_REQUEST_TIMING
+  RequestTimer request_timer_;
+#endif  // TAS_ENABLE_REQUEST_TIMING
+
+  // Borrowed from input_buffer_pool_ when there is input to be read, and
+  // returned once a request has been decoded and there is no more input in the
+  // buffer. nullptr when not borrowed.
+  char* input_buffer_;
 };
 
 }  // namespace alpaca
@@ -0,0 +1,242 @@
+#include "server_metrics.h"
+
+#if TAS_ENABLE_SERVER_METRICS
+
+#include "constants.h"
+#include "utils/inline_literal.h"
+#include "utils/memory_usage.h"
+#include "utils/platform.h"
+
+namespace alpaca {
+namespace {
+
+constexpr uint8_t kNumApis =
+    static_cast<uint8_t>(EAlpacaApi::kServerMetrics) + 1;
+
+// Maximum number of distinct HTTP status codes for which we keep separate
+// counts; any others are lumped together.
+constexpr uint8_t kMaxStatusCodes = 6;
+
+// Counts of occurrences of HTTP status codes, with the slots for codes
+// assigned in the order in which the codes are first recorded.
+struct StatusCodeCounters {
+  void Record(EHttpStatusCode status_code) {
+    const auto code = static_cast<uint16_t>(status_code);
+    for (uint8_t ndx = 0; ndx < kMaxStatusCodes; ++ndx) {
+      if (codes[ndx] == code) {
+        ++counts[ndx];
+        return;
+      } else if (codes[ndx] == 0) {
+        codes[ndx] = code;
+        counts[ndx] = 1;
+        return;
+      }
+    }
+    ++other_count;
+  }
+
+  uint16_t codes[kMaxStatusCodes];
+  uint32_t counts[kMaxStatusCodes];
+  uint32_t other_count;
+};
+
+struct Counters {
+  uint32_t requests[kNumApis];
+  StatusCodeCounters responses;
+  StatusCodeCounters decode_errors;
+  uint32_t bytes_received;
+  uint32_t bytes_sent;
+  uint32_t connections_accepted;
+  uint32_t connections_closed;
+  uint32_t discovery_packets_received;
+  uint32_t discovery_packets_replied;
+  uint32_t maintain_devices_count;
+  uint32_t maintain_devices_micros;
+  uint32_t maintain_devices_max_micros;
+  EHttpStatusCode response_status;
+};
+
+// Zero initialized because it is a global.
+Counters counters;  // NOLINT
+
+size_t PrintType(const __FlashStringHelper* name,
+                 const __FlashStringHelper* type, Print& out) {
+  size_t count = out.print(TAS_FLASHSTR("# TYPE "));
+  count += out.print(name);
+  count += out.print(' ');
+  count += out.print(type);
+  count += out.print('\n');
+  return count;
+}
+
+size_t PrintSampleValue(uint32_t value, Print& out) {
+  size_t count = out.print(' ');
+  count += out.print(value);
+  count += out.print('\n');
+  return count;
+}
+
+size_t PrintCounter(const __FlashStringHelper* name, uint32_t value,
+                    Print& out) {
+  size_t count = PrintType(name, TAS_FLASHSTR("counter"), out);
+  count += out.print(name);
+  count += PrintSampleValue(value, out);
+  return count;
+}
+
+size_t PrintGauge(const __FlashStringHelper* name, uint32_t value,
+                  Print& out) {
+  size_t count = PrintType(name, TAS_FLASHSTR("gauge"), out);
+  count += out.print(name);
+  count += PrintSampleValue(value, out);
+  return count;
+}
+
+// Prints the start of a sample with a single label, up to the value of the
+// label, e.g.: name{label="
+size_t PrintSampleStart(const __FlashStringHelper* name,
+                        const __FlashStringHelper* label, Print& out) {
+  size_t count = out.print(name);
+  count += out.print('{');
+  count += out.print(label);
+  count += out.print(TAS_FLASHSTR("=\""));
+  return count;
+}
+
+size_t PrintSampleEnd(uint32_t value, Print& out) {
+  size_t count = out.print(TAS_FLASHSTR("\"}"));
+  count += PrintSampleValue(value, out);
+  return count;
+}
+
+size_t PrintStatusCodeCounters(const __FlashStringHelper* name,
+                               const StatusCodeCounters& counters,
+                               Print& out) {
+  size_t count = PrintType(name, TAS_FLASHSTR("counter"), out);
+  for (uint8_t ndx = 0; ndx < kMaxStatusCodes && counters.codes[ndx] != 0;
+       ++ndx) {
+    count += PrintSampleStart(name, TAS_FLASHSTR("code"), out);
+    count += out.print(counters.codes[ndx]);
+    count += PrintSampleEnd(counters.counts[ndx], out);
+  }
+  if (counters.other_count != 0) {
+    count += PrintSampleStart(name, TAS_FLASHSTR("code"), out);
+    count += out.print(TAS_FLASHSTR("other"));
+    count += PrintSampleEnd(counters.other_count, out);
+  }
+  return count;
+}
+
+}  // namespace
+
+// static
+void ServerMetrics::RecordConnectionAccepted() {
+  ++counters.connections_accepted;
+}
+
+// static
+void ServerMetrics::RecordConnectionClosed() { ++counters.connections_closed; }
+
+// static
+void ServerMetrics::RecordBytesReceived(uint32_t count) {
+  counters.bytes_received += count;
+}
+
+// static
+void ServerMetrics::RecordBytesSent(uint32_t count) {
+  counters.bytes_sent += count;
+}
+
+// static
+void ServerMetrics::SetResponseStatus(EHttpStatusCode status_code) {
+  counters.response_status = status_code;
+}
+
+// static
+void ServerMetrics::RecordResponse(EAlpacaApi api) {
+  const auto ndx = static_cast<uint8_t>(api);
+  ++counters.requests[ndx < kNumApis ? ndx : 0];
+  counters.responses.Record(counters.response_status);
+}
+
+// static
+void ServerMetrics::RecordDecodeError(EHttpStatusCode status_code) {
+  counters.decode_errors.Record(status_code);
+}
+
+// static
+void ServerMetrics::RecordDiscoveryPacket(bool replied) {
+  ++counters.discovery_packets_received;
+  if (replied) {
+    ++counters.discovery_packets_replied;
+  }
+}
+
+// static
+void ServerMetrics::RecordMaintainDevicesDuration(uint32_t micros) {
+  ++counters.maintain_devices_count;
+  counters.maintain_devices_micros += micros;
+  if (counters.maintain_devices_max_micros < micros) {
+    counters.maintain_devices_max_micros = micros;
+  }
+}
+
+// static
+void ServerMetrics::Reset() { counters = Counters(); }
+
+// static
+size_t ServerMetrics::PrintTo(Print& out) {
+  auto requests_name = TAS_FLASHSTR("tas_requests_total");
+  size_t count = PrintType(requests_name, TAS_FLASHSTR("counter"), out);
+  for (uint8_t ndx = 0; ndx < kNumApis; ++ndx) {
+    count += PrintSampleStart(requests_name, TAS_FLASHSTR("api"), out);
+    count += PrintValueTo(static_cast<EAlpacaApi>(ndx), out);
+    count += PrintSampleEnd(counters.requests[ndx], out);
+  }
+  count += PrintStatusCodeCounters(TAS_FLASHSTR("tas_responses_total"),
+                                   counters.responses, out);
+  count += PrintStatusCodeCounters(TAS_FLASHSTR("tas_decode_errors_total"),
+                                   counters.decode_errors, out);
+  count += PrintCounter(TAS_FLASHSTR("tas_received_bytes_total"),
+                        counters.bytes_received, out);
+  count += PrintCounter(TAS_FLASHSTR("tas_sent_bytes_total"),
+                        counters.bytes_sent, out);
+  count += PrintCounter(TAS_FLASHSTR("tas_connections_accepted_total"),
+                        counters.connections_accepted, out);
+  count += PrintCounter(TAS_FLASHSTR("tas_connections_closed_total"),
+                        counters.connections_closed, out);
+  count += PrintCounter(TAS_FLASHSTR("tas_discovery_packets_received_total"),
+                        counters.discovery_packets_received, out);
+  count += PrintCounter(TAS_FLASHSTR("tas_discovery_packets_replied_total"),
+                        counters.discovery_packets_replied, out);
+
+  auto maintain_name = TAS_FLASHSTR("tas_maintain_devices_duration_us");
+  count += PrintType(maintain_name, TAS_FLASHSTR("summary"), out);
+  count += out.print(maintain_name);
+  count += out.print(TAS_FLASHSTR("_sum"));
+  count += PrintSampleValue(counters.maintain_devices_micros, out);
+  count += out.print(maintain_name);
+  count += out.print(TAS_FLASHSTR("_count"));
+  count += PrintSampleValue(counters.maintain_devices_count, out);
+  auto max_name = TAS_FLASHSTR("tas_maintain_devices_duration_us_max");
+  count += PrintType(max_name, TAS_FLASHSTR("gauge"), out);
+  count += out.print(max_name);
+  count += PrintSampleValue(counters.maintain_devices_max_micros, out);
+
+#if TAS_ENABLE_MEMORY_USAGE
+  count += PrintGauge(TAS_FLASHSTR("tas_stack_max_used_bytes"), MaxStackUsed(),
+                      out);
+#ifdef ARDUINO_ARCH_AVR
+  count +=
+      PrintGauge(TAS_FLASHSTR("tas_ram_min_free_bytes"), MinFreeRam(), out);
+  count +=
+      PrintGauge(TAS_FLASHSTR("tas_ram_free_bytes"), CurrentFreeRam(), out);
+  count += PrintGauge(TAS_FLASHSTR("tas_heap_size_bytes"), HeapSize(), out);
+#endif  // ARDUINO_ARCH_AVR
+#endif  // TAS_ENABLE_MEMORY_USAGE
+  return count;
+}
+
+}  // namespace alpaca
+
+#endif  // TAS_ENABLE_SERVER_METRICS
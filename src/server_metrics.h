@@ -0,0 +1,77 @@
+#ifndef TINY_ALPACA_SERVER_SRC_SERVER_METRICS_H_
+#define TINY_ALPACA_SERVER_SRC_SERVER_METRICS_H_
+
+// ServerMetrics holds counters describing the activity of the server: requests
+// by EAlpacaApi, responses by HTTP status code, request decoding errors by HTTP
+// status code, bytes received and sent, connections accepted and closed,
+// discovery packets, and the time spent in MaintainDevices. The counters are
+// in statically allocated RAM, and are updated from ServerConnection,
+// TinyAlpacaServerBase and TinyAlpacaDiscoveryServer.
+//
+// PrintTo writes the counters in the Prometheus text exposition format; this
+// is served by TinyAlpacaServerBase in response to GET /metrics. The counters
+// are uint32_t, so will eventually wrap around; Prometheus treats that as a
+// counter reset.
+//
+// If TAS_ENABLE_MEMORY_USAGE is non-zero, PrintTo also writes gauges of the
+// stack and RAM high-water marks (see utils/memory_usage.h).
+//
+// When TAS_ENABLE_SERVER_METRICS is zero, the Record methods are empty inline
+// functions, and PrintTo prints nothing.
+//
+// Author: james.synge@gmail.com
+
+#include "config.h"
+#include "constants.h"
+#include "utils/platform.h"
+
+namespace alpaca {
+
+#if TAS_ENABLE_SERVER_METRICS
+
+struct ServerMetrics {
+  static void RecordConnectionAccepted();
+  static void RecordConnectionClosed();
+  static void RecordBytesReceived(uint32_t count);
+  static void RecordBytesSent(uint32_t count);
+
+  // Records the status code of the response currently being written. Called
+  // by HttpResponseHeader::printTo, which may be called several times for the
+  // same response if it is written in pieces.
+  static void SetResponseStatus(EHttpStatusCode status_code);
+
+  // Records that the response to a request for api has been completely
+  // written, with the status code most recently passed to SetResponseStatus.
+  static void RecordResponse(EAlpacaApi api);
+
+  static void RecordDecodeError(EHttpStatusCode status_code);
+  static void RecordDiscoveryPacket(bool replied);
+  static void RecordMaintainDevicesDuration(uint32_t micros);
+
+  // Sets all of the counters to zero.
+  static void Reset();
+
+  static size_t PrintTo(Print& out);
+};
+
+#else  // !TAS_ENABLE_SERVER_METRICS
+
+struct ServerMetrics {
+  static void RecordConnectionAccepted() {}
+  static void RecordConnectionClosed() {}
+  static void RecordBytesReceived(uint32_t count) {}
+  static void RecordBytesSent(uint32_t count) {}
+  static void SetResponseStatus(EHttpStatusCode status_code) {}
+  static void RecordResponse(EAlpacaApi api) {}
+  static void RecordDecodeError(EHttpStatusCode status_code) {}
+  static void RecordDiscoveryPacket(bool replied) {}
+  static void RecordMaintainDevicesDuration(uint32_t micros) {}
+  static void Reset() {}
+  static size_t PrintTo(Print& out) { return 0; }
+};
+
+#endif  // TAS_ENABLE_SERVER_METRICS
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_SERVER_METRICS_H_
@@ -3,8 +3,9 @@
 namespace alpaca {
 
 ServerSocketAndConnection::ServerSocketAndConnection(
-    uint16_t tcp_port, RequestListener& request_listener)
-    : server_connection_(request_listener),
+    uint16_t tcp_port, RequestListener& request_listener,
+    InputBufferPool& input_buffer_pool)
+    : server_connection_(request_listener, input_buffer_pool),
       server_socket_(tcp_port, server_connection_) {}
 
 bool ServerSocketAndConnection::Initialize() {
@@ -6,6 +6,7 @@
 //
 // Author: james.synge@gmail.com
 
+#include "input_buffer_pool.h"
 #include "server_connection.h"
 #include "utils/platform.h"
 #include "utils/server_socket.h"
@@ -15,7 +16,8 @@ namespace alpaca {
 class ServerSocketAndConnection {
  public:
   ServerSocketAndConnection(uint16_t tcp_port,
-                            RequestListener& request_listener);
+                            RequestListener& request_listener,
+                            InputBufferPool& input_buffer_pool);
 
   // Placement new operator. Used to allow us to have a compile time
   // configuration of the number of simultaneous connections that we want to
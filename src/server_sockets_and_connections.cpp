@@ -11,7 +11,8 @@ ServerSocketsAndConnections::ServerSocketsAndConnections(
 
   for (size_t ndx = 0; ndx < kNumSockets; ++ndx) {
     new (GetServerSocketAndConnection(ndx))
-        ServerSocketAndConnection(tcp_port, request_listener);
+        ServerSocketAndConnection(tcp_port, request_listener,
+                                  input_buffer_pool_);
   }
 }
 
@@ -2,10 +2,12 @@
 #define TINY_ALPACA_SERVER_SRC_SERVER_SOCKETS_AND_CONNECTIONS_H_
 
 // ServerSocketsAndConnections owns the set of ServerConnection objects used to
-// implement the HTTP server feature of Tiny Alpaca Server.
+// implement the HTTP server feature of Tiny Alpaca Server, and the pool of
+// input buffers which they share.
 //
 // Author: james.synge@gmail.com
 
+#include "input_buffer_pool.h"
 #include "request_listener.h"
 #include "server_socket_and_connection.h"
 #include "utils/platform.h"
@@ -40,6 +42,8 @@ class ServerSocketsAndConnections {
   // 'ndx' is in the range [0, kNumSockets-1].
   ServerSocketAndConnection* GetServerSocketAndConnection(size_t ndx);
 
+  InputBufferPool input_buffer_pool_;
+
   alignas(ServerSocketAndConnection) uint8_t
       sockets_storage_[kServerSocketAndConnectionStorage];
 };
@@ -4,14 +4,27 @@
 #include "constants.h"
 #include "http_response_header.h"
 #include "literals.h"
+#include "server_metrics.h"
 #include "utils/any_printable.h"
 #include "utils/array_view.h"
 #include "utils/counting_print.h"
 #include "utils/json_encoder.h"
 #include "utils/json_encoder_helpers.h"
+#include "utils/log_ring_buffer.h"
 #include "utils/printable_cat.h"
 
 namespace alpaca {
+namespace {
+
+// Adapts ServerMetrics::PrintTo to the Printable interface.
+class MetricsSource : public Printable {
+ public:
+  size_t printTo(Print& out) const override {
+    return ServerMetrics::PrintTo(out);
+  }
+};
+
+}  // namespace
 
 TinyAlpacaServerBase::TinyAlpacaServerBase(
     const ServerDescription& server_description,
@@ -23,9 +36,13 @@ TinyAlpacaServerBase::TinyAlpacaServerBase(
 bool TinyAlpacaServerBase::Initialize() { return alpaca_devices_.Initialize(); }
 
 void TinyAlpacaServerBase::MaintainDevices() {
+  const uint32_t start_time = micros();
   alpaca_devices_.MaintainDevices();
+  ServerMetrics::RecordMaintainDevicesDuration(micros() - start_time);
 }
 
+void TinyAlpacaServerBase::RunDueTasks() { alpaca_devices_.RunDueTasks(); }
+
 void TinyAlpacaServerBase::OnStartDecoding(AlpacaRequest& request) {
   request.set_server_transaction_id(++server_transaction_id_);
 }
@@ -52,6 +69,9 @@ bool TinyAlpacaServerBase::OnRequestDecoded(AlpacaRequest& request,
 
     case EAlpacaApi::kServerSetup:
       return HandleServerSetup(request, out);
+
+    case EAlpacaApi::kServerMetrics:
+      return HandleServerMetrics(request, out);
   }
 
   TAS_VLOG(5) << TAS_FLASHSTR("OnRequestDecoded: api=") << request.api;
@@ -63,6 +83,7 @@ void TinyAlpacaServerBase::OnRequestDecodingError(AlpacaRequest& request,
                                                   EHttpStatusCode status,
                                                   Print& out) {
   TAS_VLOG(3) << TAS_FLASHSTR("OnRequestDecodingError: status=") << status;
+  ServerMetrics::RecordDecodeError(status);
   WriteResponse::HttpErrorResponse(status, AnyPrintable(), out);
 }
 
@@ -98,6 +119,14 @@ bool TinyAlpacaServerBase::HandleServerSetup(AlpacaRequest& request,
                                    /*append_http_newline=*/true);
 }
 
+bool TinyAlpacaServerBase::HandleServerMetrics(AlpacaRequest& request,
+                                               Print& out) {
+  TAS_VLOG(3) << TAS_FLASHSTR("HandleServerMetrics");
+  MetricsSource body;
+  return WriteResponse::OkResponse(request, EContentType::kTextPlain, body,
+                                   out);
+}
+
 TinyAlpacaServer::TinyAlpacaServer(uint16_t tcp_port,
                                    const ServerDescription& server_description,
                                    ArrayView<DeviceInterface*> devices)
@@ -122,7 +151,15 @@ bool TinyAlpacaServer::Initialize() {
 void TinyAlpacaServer::PerformIO() {
   TinyAlpacaServerBase::MaintainDevices();
   discovery_server_.PerformIO();
+  // Run any tasks that became due while handling discovery, so that they
+  // aren't delayed until after all of the sockets have been serviced.
+  TinyAlpacaServerBase::RunDueTasks();
   sockets_.PerformIO();
+#if TAS_ENABLE_ASYNC_LOG_SINK
+  // Now that we've handled any pending requests, write some of the logged
+  // messages.
+  DrainDefaultLogRingBuffer();
+#endif  // TAS_ENABLE_ASYNC_LOG_SINK
 }
 
 }  // namespace alpaca
@@ -46,6 +46,9 @@ class TinyAlpacaServerBase : public RequestListener {
   // Gives devices a chance to perform periodic work.
   void MaintainDevices();
 
+  // Runs the device tasks which are due, if any.
+  void RunDueTasks();
+
   // RequestListener method overrides...
   void OnStartDecoding(AlpacaRequest& request) override;
   bool OnRequestDecoded(AlpacaRequest& request, Print& out) override;
@@ -56,6 +59,7 @@ class TinyAlpacaServerBase : public RequestListener {
   bool HandleManagementApiVersions(AlpacaRequest& request, Print& out);
   bool HandleManagementDescription(AlpacaRequest& request, Print& out);
   bool HandleServerSetup(AlpacaRequest& request, Print& out);
+  bool HandleServerMetrics(AlpacaRequest& request, Print& out);
 
   AlpacaDevices alpaca_devices_;
   const ServerDescription& server_description_;
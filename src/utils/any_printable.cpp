@@ -1,5 +1,7 @@
 #include "utils/any_printable.h"
 
+#include "utils/memory_usage.h"
+
 namespace alpaca {
 
 AnyPrintable::AnyPrintable() : type_(AnyPrintable::kEmpty), signed_(0) {}
@@ -84,6 +86,7 @@ AnyPrintable& AnyPrintable::operator=(const AnyPrintable& other) {
 }
 
 size_t AnyPrintable::printTo(Print& out) const {
+  NoteStackUsage();
   switch (type_) {
     case kEmpty:
       // break here and return below to allow for 100% line coverage. I.e. the
@@ -0,0 +1,60 @@
+#include "utils/binary_log_sink.h"
+
+#include "utils/log_ring_buffer.h"
+#include "utils/platform.h"
+#include "utils/utils_config.h"
+
+#ifdef ARDUINO
+#define DEFAULT_SINK_OUT ::Serial
+#else
+#define DEFAULT_SINK_OUT ::ToStdErr
+#endif
+
+// Same destination as that of LogSink, so that binary records are interleaved
+// correctly with the text emitted by TAS_CHECK.
+#if TAS_ENABLE_ASYNC_LOG_SINK
+#define DEFAULT_LOG_SINK_OUT ::alpaca::DefaultLogRingBuffer()
+#else
+#define DEFAULT_LOG_SINK_OUT DEFAULT_SINK_OUT
+#endif  // TAS_ENABLE_ASYNC_LOG_SINK
+
+namespace alpaca {
+
+BinaryLogSink::BinaryLogSink(Print& out, uint16_t file_id,
+                             uint16_t line_number)
+    : OPrintStream(out) {
+  const uint8_t header[] = {
+      binary_log::kRecordStart,
+      static_cast<uint8_t>(file_id & 0xFF),
+      static_cast<uint8_t>(file_id >> 8),
+      static_cast<uint8_t>(line_number & 0xFF),
+      static_cast<uint8_t>(line_number >> 8),
+  };
+  out_.write(header, sizeof header);
+}
+
+BinaryLogSink::BinaryLogSink(uint16_t file_id, uint16_t line_number)
+    : BinaryLogSink(DEFAULT_LOG_SINK_OUT, file_id, line_number) {}
+
+BinaryLogSink::~BinaryLogSink() {
+  out_.write(binary_log::kRecordEnd);
+  out_.flush();
+}
+
+void BinaryLogSink::WriteText(const char* value) {
+  WriteTag(EField::kText);
+  if (value != nullptr) {
+    out_.print(value);
+  }
+  EndText();
+}
+
+void BinaryLogSink::WriteFloat(float value) {
+  static_assert(sizeof value == 4, "Expected float to be 4 bytes");
+  uint8_t bytes[sizeof value];
+  memcpy(bytes, &value, sizeof value);
+  WriteTag(EField::kFloat);
+  out_.write(bytes, sizeof bytes);
+}
+
+}  // namespace alpaca
@@ -0,0 +1,222 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_BINARY_LOG_SINK_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_BINARY_LOG_SINK_H_
+
+// BinaryLogSink is used in place of LogSink by TAS_VLOG when
+// TAS_ENABLE_BINARY_LOGGING is non-zero. Rather than formatting each message as
+// text, it emits a compact record identifying the logging statement (a hash of
+// the basename of the source file, and the line number), followed by the raw
+// bytes of the values inserted into the statement. The text is rebuilt on the
+// host by extras/dev_tools/decode_binary_log.py, using a table of the TAS_VLOG
+// statements that it extracts from the source files.
+//
+// A record has this layout:
+//
+//    kRecordStart, file id (2 bytes, LE), line number (2 bytes, LE),
+//    zero or more fields, kRecordEnd
+//
+// Each field starts with a tag (one of the EField values), followed by a
+// payload whose format is determined by the tag. Integers (including addresses)
+// are written as LEB128 varints, so small values take a single byte. Values
+// for which we have no binary representation (e.g. Printable instances and
+// enums) are written as NUL terminated text.
+//
+// The contents of string literals (e.g. TAS_FLASHSTR("...")) are not written,
+// only their (PROGMEM) address, because the decoder has the text of the literal
+// in its table.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/o_print_stream.h"
+#include "utils/platform.h"
+#include "utils/traits/print_to_trait.h"
+#include "utils/traits/type_traits.h"
+
+#if TAS_HOST_TARGET
+#include <string>  // pragma: keep standard include
+#endif
+
+namespace alpaca {
+namespace binary_log {
+
+constexpr uint8_t kRecordStart = 0x1E;  // ASCII Record Separator.
+constexpr uint8_t kRecordEnd = 0x00;
+
+// Tags of the fields in a record. Don't change the values, they are known to
+// decode_binary_log.py.
+enum class EField : uint8_t {
+  kUnsigned = 1,     // Varint.
+  kSigned = 2,       // ZigZag encoded varint.
+  kChar = 3,         // One byte.
+  kFloat = 4,        // IEEE 754 single precision, little-endian.
+  kFlashString = 5,  // Varint address of the string.
+  kPointer = 6,      // Varint address.
+  kText = 7,         // NUL terminated.
+  kBase = 8,         // One byte, the base for printing following integers.
+};
+
+constexpr uint32_t kFnvOffsetBasis = 2166136261UL;
+constexpr uint32_t kFnvPrime = 16777619UL;
+
+// Returns the 32-bit FNV-1a hash of the basename of path, i.e. of the portion
+// after the last slash. Written recursively so that it can be evaluated at
+// compile time by a C++11 compiler.
+constexpr uint32_t HashBasename(const char* path,
+                                uint32_t hash = kFnvOffsetBasis) {
+  return *path == '\0'
+             ? hash
+             : HashBasename(path + 1,
+                            *path == '/' ? kFnvOffsetBasis
+                                         : ((hash ^ static_cast<uint8_t>(*path)) *
+                                            kFnvPrime));
+}
+
+// Returns the 16-bit id of the source file whose path is `path`.
+constexpr uint16_t FileId(const char* path) {
+  return static_cast<uint16_t>((HashBasename(path) >> 16) ^
+                               (HashBasename(path) & 0xFFFF));
+}
+
+// Used by TAS_BINARY_LOG_FILE_ID to ensure that FileId is evaluated at compile
+// time, and not at runtime (which is permitted for constexpr functions).
+template <uint16_t kFileId>
+struct FileIdConstant {
+  static constexpr uint16_t value = kFileId;
+};
+
+}  // namespace binary_log
+
+#define TAS_BINARY_LOG_FILE_ID(path_literal) \
+  (::alpaca::binary_log::FileIdConstant<     \
+      ::alpaca::binary_log::FileId(path_literal)>::value)
+
+class BinaryLogSink final : public OPrintStream {
+ public:
+  using EField = binary_log::EField;
+
+  BinaryLogSink(Print& out, uint16_t file_id, uint16_t line_number);
+  BinaryLogSink(uint16_t file_id, uint16_t line_number);
+  ~BinaryLogSink();
+
+  template <typename T>
+  BinaryLogSink& operator<<(const T value) {
+    do_write_a(value, has_print_to<T>{});
+    return *this;
+  }
+
+ private:
+  void WriteTag(EField tag) { out_.write(static_cast<uint8_t>(tag)); }
+  void WriteText(const char* value);
+  void WriteFloat(float value);
+  void EndText() { out_.write(static_cast<uint8_t>(0)); }
+
+  // Writes the tag, then value as an LEB128 varint, i.e. 7 bits per byte,
+  // least significant first, with the high bit set in all but the last byte.
+  // U is an unsigned type, uint32_t or uintptr_t.
+  template <typename U>
+  void WriteVarint(EField tag, U value) {
+    WriteTag(tag);
+    while (value >= 0x80) {
+      out_.write(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    out_.write(static_cast<uint8_t>(value));
+  }
+
+  // The dispatch below mirrors that in OPrintStream.
+
+  // T is a class with a printTo function.
+  template <typename T>
+  void do_write_a(const T value, true_type /*has_print_to*/) {
+    WriteTag(EField::kText);
+    value.printTo(out_);
+    EndText();
+  }
+
+  template <typename T>
+  void do_write_a(const T value, false_type /*!has_print_to*/) {
+    do_write_b(value, is_integral<T>{});
+  }
+
+  // Type T is an integral type (includes bool, but not char). The expression
+  // `T(-1) > T(0)` is true only for unsigned types.
+  template <typename T>
+  void do_write_b(const T value, true_type /*is_integral*/) {
+    if (T(-1) > T(0)) {
+      WriteVarint(EField::kUnsigned, static_cast<uint32_t>(value));
+    } else {
+      // ZigZag encoding, so that small negative values are also short.
+      const int32_t v = value;
+      WriteVarint(EField::kSigned, (static_cast<uint32_t>(v) << 1) ^
+                                       static_cast<uint32_t>(v >> 31));
+    }
+  }
+
+  template <typename T>
+  void do_write_b(const T value, false_type /*!is_integral*/) {
+    do_write_c(value, has_print_value_to<T>{});
+  }
+
+  template <typename T>
+  void do_write_c(const T value, true_type /*has_print_value_to*/) {
+    WriteTag(EField::kText);
+    PrintValueTo(value, out_);
+    EndText();
+  }
+
+  template <typename T>
+  void do_write_c(const T value, false_type /*has_print_value_to*/) {
+    do_write_d(value, is_pointer<T>{});
+  }
+
+  void do_write_d(const char* value, true_type /*is_pointer*/) {
+    WriteText(value);
+  }
+
+  void do_write_d(const __FlashStringHelper* value, true_type /*is_pointer*/) {
+    WriteVarint(EField::kFlashString, reinterpret_cast<uintptr_t>(value));
+  }
+
+  void do_write_d(OPrintStreamManipulator manipulator,
+                  true_type /*is_pointer*/) {
+    (*manipulator)(*this);
+    WriteTag(EField::kBase);
+    out_.write(base_);
+  }
+
+  void do_write_d(const void* misc_pointer, true_type /*is_pointer*/) {
+    WriteVarint(EField::kPointer, reinterpret_cast<uintptr_t>(misc_pointer));
+  }
+
+  void do_write_d(const char value, false_type /*!is_pointer*/) {
+    WriteTag(EField::kChar);
+    out_.write(static_cast<uint8_t>(value));
+  }
+
+  void do_write_d(const float value, false_type /*!is_pointer*/) {
+    WriteFloat(value);
+  }
+
+  void do_write_d(const double value, false_type /*!is_pointer*/) {
+    WriteFloat(static_cast<float>(value));
+  }
+
+#if TAS_HOST_TARGET
+  void do_write_d(const std::string& value, false_type /*!is_pointer*/) {
+    WriteTag(EField::kText);
+    out_.write(value.data(), value.size());
+    EndText();
+  }
+#endif
+
+  // Any other type is written as text.
+  template <typename T>
+  void do_write_d(const T value, false_type /*!is_pointer*/) {
+    WriteTag(EField::kText);
+    out_.print(value);
+    EndText();
+  }
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_BINARY_LOG_SINK_H_
@@ -3,8 +3,38 @@
 #include "utils/logging.h"
 
 namespace alpaca {
+namespace {
+
+// Reads min(available, size) bytes from client with a single call to
+// Client::read(buf, size). For Ethernet3, that becomes a single burst transfer
+// from the W5500's RX buffer, followed by a single RECV command to advance the
+// read pointer, rather than several SPI transactions per byte.
+size_t ReadAvailableBytes(Client &client, uint8_t *buf, size_t size) {
+  const int available = client.available();
+  if (available <= 0 || size == 0) {
+    return 0;
+  }
+  if (static_cast<size_t>(available) < size) {
+    size = available;
+  }
+  int result = client.read(buf, size);
+  if (result > 0) {
+    TAS_DCHECK_LE(static_cast<size_t>(result), size);
+    return result;
+  } else {
+    return 0;
+  }
+}
+
+}  // namespace
 
 size_t Connection::read(uint8_t *buf, size_t size) {
+  const int available = this->available();
+  if (available <= 0) {
+    return 0;
+  } else if (static_cast<size_t>(available) < size) {
+    size = available;
+  }
   size_t result = 0;
   while (size > 0) {
     int c = read();
@@ -24,6 +54,8 @@ bool Connection::hasWriteError() {
   return getWriteError() != 0 || !connected();
 }
 
+size_t Connection::availableToWrite() { return ~static_cast<size_t>(0); }
+
 size_t WrappedClientConnection::write(uint8_t b) { return client().write(b); }
 size_t WrappedClientConnection::write(const uint8_t *buf, size_t size) {
   return client().write(buf, size);
@@ -31,12 +63,7 @@ size_t WrappedClientConnection::write(const uint8_t *buf, size_t size) {
 int WrappedClientConnection::available() { return client().available(); }
 int WrappedClientConnection::read() { return client().read(); }
 size_t WrappedClientConnection::read(uint8_t *buf, size_t size) {
-  int result = client().read(buf, size);
-  if (result >= 0) {
-    return result;
-  } else {
-    return 0;
-  }
+  return ReadAvailableBytes(client(), buf, size);
 }
 int WrappedClientConnection::peek() { return client().peek(); }
 void WrappedClientConnection::flush() { return client().flush(); }
@@ -50,9 +77,7 @@ WriteBufferedWrappedClientConnection::WriteBufferedWrappedClientConnection(
   TAS_DCHECK(write_buffer_limit > 0);
 }
 size_t WriteBufferedWrappedClientConnection::write(uint8_t b) {
-  if (write_buffer_size_ >= write_buffer_limit_) {
-    flush();
-  }
+  FlushIfFull();
   write_buffer_[write_buffer_size_++] = b;
   return 1;
 }
@@ -83,15 +108,26 @@ int WriteBufferedWrappedClientConnection::available() {
 }
 int WriteBufferedWrappedClientConnection::read() { return client().read(); }
 size_t WriteBufferedWrappedClientConnection::read(uint8_t *buf, size_t size) {
-  int result = client().read(buf, size);
-  if (result >= 0) {
-    return result;
-  } else {
-    return 0;
-  }
+  return ReadAvailableBytes(client(), buf, size);
 }
 int WriteBufferedWrappedClientConnection::peek() { return client().peek(); }
 void WriteBufferedWrappedClientConnection::flush() {
+  DrainWriteBuffer();
+  if (!hasWriteError()) {
+    SendBufferedData();
+  }
+}
+size_t WriteBufferedWrappedClientConnection::WriteBufferedData(
+    const uint8_t *buf, size_t size) {
+  return client().write(buf, size);
+}
+void WriteBufferedWrappedClientConnection::SendBufferedData() {}
+void WriteBufferedWrappedClientConnection::FlushIfFull() {
+  if (write_buffer_size_ >= write_buffer_limit_) {
+    DrainWriteBuffer();
+  }
+}
+void WriteBufferedWrappedClientConnection::DrainWriteBuffer() {
   if (write_buffer_size_ > 0) {
     TAS_VLOG(4) << TAS_FLASHSTR("write_buffer_size_=") << write_buffer_size_;
     if (!hasWriteError()) {
@@ -99,7 +135,7 @@ void WriteBufferedWrappedClientConnection::flush() {
       auto cursor = write_buffer_;
       auto remaining = write_buffer_size_;
       while (true) {
-        auto wrote = client().write(cursor, remaining);
+        auto wrote = WriteBufferedData(cursor, remaining);
         TAS_VLOG(4) << TAS_FLASHSTR("wrote=") << wrote;
         TAS_DCHECK_LE(wrote, remaining);
         if (wrote <= 0 || !client().connected()) {
@@ -116,12 +152,6 @@ void WriteBufferedWrappedClientConnection::flush() {
       TAS_VLOG(3) << TAS_FLASHSTR("hasWriteError=") << true;
     }
     write_buffer_size_ = 0;
-    return;
-  }
-}
-void WriteBufferedWrappedClientConnection::FlushIfFull() {
-  if (write_buffer_size_ >= write_buffer_limit_) {
-    flush();
   }
 }
 
@@ -24,8 +24,11 @@ class Connection : public Stream {
 
   // Reads up to 'size' bytes into buf, stopping early if there are no more
   // bytes available to read from the connection. Returns the number of bytes
-  // read. The default implementation uses `int Stream::read()` to read one byte
-  // at a time.
+  // read. Implementations should read min(available(), size) bytes in a single
+  // burst where the underlying hardware supports that (i.e. a single transfer
+  // from the W5500's RX buffer, and a single update of the read pointer). The
+  // default implementation uses `int Stream::read()` to read one byte at a
+  // time, but reads no more than available() bytes.
   virtual size_t read(uint8_t *buf, size_t size);
 
   using Stream::read;
@@ -36,6 +39,11 @@ class Connection : public Stream {
 
   // Returns true if there is a write error or if the connection is broken.
   virtual bool hasWriteError();
+
+  // Returns the number of bytes that can be written to the connection without
+  // blocking (e.g. the free space in the network chip's TX buffer). The default
+  // implementation returns the max value of size_t, i.e. no known limit.
+  virtual size_t availableToWrite();
 };
 
 // An abstract implementation of Connection that delegates to a Client instance
@@ -56,8 +64,17 @@ class WrappedClientConnection : public Connection {
 };
 
 // An abstract implementation of Connection that delegates to a Client instance
-// provided by a subclass. To produce a concrete instance, some subclass will
-// also need to implement close() and connected().
+// provided by a subclass, and which buffers writes so that many small writes
+// (e.g. of a response header and body) become a few large writes. To produce a
+// concrete instance, some subclass will also need to implement close() and
+// connected().
+//
+// When the write buffer is full, its contents are passed to WriteBufferedData.
+// When flush is called, any remaining contents are passed to WriteBufferedData,
+// and then SendBufferedData is called. By default WriteBufferedData writes to
+// the Client, and SendBufferedData does nothing; a subclass may instead
+// accumulate the data in the network chip's TX buffer, and then send all of it
+// at once from SendBufferedData, thus minimizing the number of TCP segments.
 class WriteBufferedWrappedClientConnection : public Connection {
  public:
   WriteBufferedWrappedClientConnection(uint8_t *write_buffer,
@@ -75,8 +92,18 @@ class WriteBufferedWrappedClientConnection : public Connection {
   virtual Client &client() const = 0;
   uint8_t write_buffer_size() const { return write_buffer_size_; }
 
+  // Writes up to 'size' bytes from 'buf' to the destination of the connection,
+  // returning the number of bytes written; 0 indicates an error. The default
+  // implementation writes to client().
+  virtual size_t WriteBufferedData(const uint8_t *buf, size_t size);
+
+  // Called by flush() after all of the buffered data has been passed to
+  // WriteBufferedData. The default implementation does nothing.
+  virtual void SendBufferedData();
+
  private:
   void FlushIfFull();
+  void DrainWriteBuffer();
 
   uint8_t *const write_buffer_;
   const uint8_t write_buffer_limit_;
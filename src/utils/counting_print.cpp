@@ -20,7 +20,7 @@ size_t CountingPrint::write(const uint8_t* buffer, size_t size) {
 
 uint32_t SizeOfPrintable(const Printable& value) {
   PrintNoOp no_op;
-  CountingPrint counter(no_op);
+  CountingSink<PrintNoOp> counter(no_op);
   value.printTo(counter);
   return counter.count();
 }
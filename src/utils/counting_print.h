@@ -8,13 +8,18 @@
 // Combining the two allows us to compute the value to be placed in the
 // Content-Length header of an HTTP response message.
 //
+// CountingSink is like CountingPrint, but the type of the Print instance to
+// which it writes is a template parameter, so when that type is final (e.g.
+// PrintNoOp) the calls to it aren't virtual and can be inlined; counting the
+// bytes written to a PrintNoOp then costs one virtual call per write, not two.
+//
 // Author: james.synge@gmail.com
 
 #include "utils/platform.h"
 
 namespace alpaca {
 
-class PrintNoOp : public Print {
+class PrintNoOp final : public Print {
  public:
   // These are the two abstract virtual methods in Arduino's Print class.
   size_t write(uint8_t) override { return 1; }
@@ -45,6 +50,33 @@ class CountingPrint : public Print {
   uint32_t count_;
 };
 
+template <class Sink>
+class CountingSink final : public Print {
+ public:
+  explicit CountingSink(Sink& sink) : sink_(sink), count_(0) {}
+
+  size_t write(uint8_t value) override {
+    const size_t result = sink_.write(value);
+    count_ += result;
+    return result;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    const size_t result = sink_.write(buffer, size);
+    count_ += result;
+    return result;
+  }
+
+  using Print::write;
+
+  // The total count of bytes written.
+  uint32_t count() const { return count_; }
+
+ private:
+  Sink& sink_;
+  uint32_t count_;
+};
+
 uint32_t SizeOfPrintable(const Printable& value);
 
 }  // namespace alpaca
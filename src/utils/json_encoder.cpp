@@ -6,6 +6,7 @@
 
 #include "utils/counting_print.h"
 #include "utils/literal.h"
+#include "utils/memory_usage.h"
 #include "utils/o_print_stream.h"
 
 namespace alpaca {
@@ -17,90 +18,117 @@ TAS_DEFINE_LITERAL(JsonNan, "NaN")
 TAS_DEFINE_LITERAL(JsonNegInf, "-Inf")
 TAS_DEFINE_LITERAL(JsonInf, "Inf")
 
+// Prints the pair of chars with a single call to out.write.
+size_t PrintPair(Print& out, const char a, const char b) {
+  const uint8_t buffer[2] = {static_cast<uint8_t>(a), static_cast<uint8_t>(b)};
+  return out.write(buffer, 2);
+}
+
+bool NeedsJsonEscaping(const char c) {
+  return c == '"' || c == '\\' || !isPrintable(c);
+}
+
+// Prints c, which needs escaping, as a JSON escape sequence.
 size_t PrintCharJsonEscaped(Print& out, const char c) {
-  size_t total = 0;
-  if (isPrintable(c)) {
-    if (c == '"') {
-      total += out.print('\\');
-      total += out.print('"');
-    } else if (c == '\\') {
-      total += out.print('\\');
-      total += out.print('\\');
-    } else {
-      total += out.print(c);
-    }
+  char escaped;
+  if (c == '"' || c == '\\') {
+    escaped = c;
   } else if (c == '\b') {
-    total += out.print('\\');
-    total += out.print('b');
+    escaped = 'b';
   } else if (c == '\f') {
-    total += out.print('\\');
-    total += out.print('f');
+    escaped = 'f';
   } else if (c == '\n') {
-    total += out.print('\\');
-    total += out.print('n');
+    escaped = 'n';
   } else if (c == '\r') {
-    total += out.print('\\');
-    total += out.print('r');
+    escaped = 'r';
   } else if (c == '\t') {
-    total += out.print('\\');
-    total += out.print('t');
+    escaped = 't';
   } else {
     // This used to be a DCHECK, but a VLOG is better because the character
     // could come from client input.
     TAS_VLOG(4) << TAS_FLASHSTR("Unsupported JSON character: ") << BaseHex
                 << (c + 0);
+    return 0;
   }
-  return total;
+  return PrintPair(out, '\\', escaped);
 }
 
 // Wraps a Print instance, forwards output to that instance with JSON escaping
 // applied. Note that this does NOT add double quotes before and after the
-// output.
-class PrintJsonEscaped : public Print {
+// output. Runs of characters that don't need escaping are forwarded with a
+// single call to the wrapped instance.
+class PrintJsonEscaped final : public Print {
  public:
-  explicit PrintJsonEscaped(Print& wrapped) : wrapped_(wrapped) {}
+  explicit PrintJsonEscaped(Print& wrapped) : wrapped_(wrapped), count_(0) {}
 
   // These are the two abstract virtual methods in Arduino's Print class. I'm
   // treating the uint8_t 'b' as an ASCII char.
   size_t write(uint8_t b) override {
-    return PrintCharJsonEscaped(wrapped_, static_cast<char>(b));
+    const char c = static_cast<char>(b);
+    size_t count;
+    if (NeedsJsonEscaping(c)) {
+      count = PrintCharJsonEscaped(wrapped_, c);
+    } else {
+      count = wrapped_.write(b);
+    }
+    count_ += count;
+    return count;
   }
 
   size_t write(const uint8_t* buffer, size_t size) override {
     size_t count = 0;
+    size_t run_start = 0;
     for (size_t ndx = 0; ndx < size; ++ndx) {
-      count += PrintCharJsonEscaped(wrapped_, static_cast<char>(buffer[ndx]));
+      const char c = static_cast<char>(buffer[ndx]);
+      if (NeedsJsonEscaping(c)) {
+        if (run_start < ndx) {
+          count += wrapped_.write(buffer + run_start, ndx - run_start);
+        }
+        count += PrintCharJsonEscaped(wrapped_, c);
+        run_start = ndx + 1;
+      }
+    }
+    if (run_start < size) {
+      count += wrapped_.write(buffer + run_start, size - run_start);
     }
+    count_ += count;
     return count;
   }
 
   // Export the other write methods.
   using Print::write;
 
+  // The number of bytes written to the wrapped instance.
+  size_t count() const { return count_; }
+
  private:
   Print& wrapped_;
+  size_t count_;
 };
 
+// Doesn't rely on the value returned by value.printTo, which isn't always the
+// number of bytes written.
 size_t PrintJsonEscapedStringTo(const Printable& value, Print& raw_output) {
   PrintJsonEscaped out(raw_output);
   size_t count = raw_output.print('"');
-  count += value.printTo(out);
+  value.printTo(out);
+  count += out.count();
   count += raw_output.print('"');
   return count;
 }
 
-void PrintBoolean(Print& out, const bool value) {
+size_t PrintBoolean(Print& out, const bool value) {
   if (value) {
-    JsonTrue().printTo(out);
+    return JsonTrue().printTo(out);
   } else {
-    JsonFalse().printTo(out);
+    return JsonFalse().printTo(out);
   }
 }
 
 template <typename T>
-void PrintInteger(Print& out, const T value) {
+size_t PrintInteger(Print& out, const T value) {
   // +0 to cause promotion of chars, if they're passed in.
-  out.print(value + static_cast<uint16_t>(0));
+  return out.print(value + static_cast<uint16_t>(0));
 }
 
 // Prints the floating point value to out, if possible. If not, prints a JSON
@@ -108,16 +136,16 @@ void PrintInteger(Print& out, const T value) {
 // libraries, which inspired this. TBD whether this is a good idea in the ASCOM
 // Alpaca setting.
 template <typename T>
-void PrintFloatingPoint(Print& out, const T value) {
+size_t PrintFloatingPoint(Print& out, const T value) {
   // Haven't got std::isnan or std::isfinite in the Arduino environment, so
   // using the C versions in <math.h>.
   if (isnan(value)) {
-    PrintJsonEscapedStringTo(AnyPrintable(JsonNan()), out);
+    return PrintJsonEscapedStringTo(AnyPrintable(JsonNan()), out);
   } else if (!isfinite(value)) {
     if (value > 0) {
-      PrintJsonEscapedStringTo(AnyPrintable(JsonInf()), out);
+      return PrintJsonEscapedStringTo(AnyPrintable(JsonInf()), out);
     } else {
-      PrintJsonEscapedStringTo(AnyPrintable(JsonNegInf()), out);
+      return PrintJsonEscapedStringTo(AnyPrintable(JsonNegInf()), out);
     }
   } else {
     // We're assuming that the Print object is configured to match JSON
@@ -139,7 +167,7 @@ void PrintFloatingPoint(Print& out, const T value) {
     // https://stackoverflow.com/a/19083594
     // https://stackoverflow.com/a/28334452
     // https://stackoverflow.com/a/17175504
-    out.print(value);
+    return out.print(value);
   }
 }
 
@@ -149,63 +177,70 @@ JsonElementSource::~JsonElementSource() {}
 
 JsonPropertySource::~JsonPropertySource() {}
 
-AbstractJsonEncoder::AbstractJsonEncoder(Print& out)
-    : out_(out), first_(true) {}
+AbstractJsonEncoder::AbstractJsonEncoder(Print& out, size_t& count)
+    : out_(out), count_(count), first_(true) {}
 
 void AbstractJsonEncoder::StartItem() {
   if (first_) {
     first_ = false;
   } else {
-    out_.print(',');
-    out_.print(' ');
+    PrintChars(',', ' ');
   }
 }
 
+void AbstractJsonEncoder::PrintChar(const char c) { count_ += out_.print(c); }
+
+void AbstractJsonEncoder::PrintChars(const char a, const char b) {
+  count_ += PrintPair(out_, a, b);
+}
+
 void AbstractJsonEncoder::EncodeChildArray(const JsonElementSource& source) {
-  JsonArrayEncoder encoder(out_);
+  JsonArrayEncoder encoder(out_, count_);
   source.AddTo(encoder);
 }
 
 void AbstractJsonEncoder::EncodeChildObject(const JsonPropertySource& source) {
-  JsonObjectEncoder encoder(out_);
+  JsonObjectEncoder encoder(out_, count_);
   source.AddTo(encoder);
 }
 
 void AbstractJsonEncoder::PrintString(const Printable& printable) {
-  PrintJsonEscapedStringTo(printable, out_);
+  count_ += PrintJsonEscapedStringTo(printable, out_);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-JsonArrayEncoder::JsonArrayEncoder(Print& out) : AbstractJsonEncoder(out) {
-  out_.print('[');
+JsonArrayEncoder::JsonArrayEncoder(Print& out, size_t& count)
+    : AbstractJsonEncoder(out, count) {
+  NoteStackUsage();
+  PrintChar('[');
 }
 
-JsonArrayEncoder::~JsonArrayEncoder() { out_.print(']'); }
+JsonArrayEncoder::~JsonArrayEncoder() { PrintChar(']'); }
 
 void JsonArrayEncoder::AddIntElement(const int32_t value) {
   StartItem();
-  PrintInteger(out_, value);
+  count_ += PrintInteger(out_, value);
 }
 
 void JsonArrayEncoder::AddUIntElement(const uint32_t value) {
   StartItem();
-  PrintInteger(out_, value);
+  count_ += PrintInteger(out_, value);
 }
 
 void JsonArrayEncoder::AddFloatElement(float value) {
   StartItem();
-  PrintFloatingPoint(out_, value);
+  count_ += PrintFloatingPoint(out_, value);
 }
 
 void JsonArrayEncoder::AddDoubleElement(double value) {
   StartItem();
-  PrintFloatingPoint(out_, value);
+  count_ += PrintFloatingPoint(out_, value);
 }
 
 void JsonArrayEncoder::AddBooleanElement(const bool value) {
   StartItem();
-  PrintBoolean(out_, value);
+  count_ += PrintBoolean(out_, value);
 }
 
 void JsonArrayEncoder::AddStringElement(const AnyPrintable& value) {
@@ -229,62 +264,66 @@ void JsonArrayEncoder::AddObjectElement(const JsonPropertySource& source) {
 }
 
 // static
-void JsonArrayEncoder::Encode(const JsonElementSource& source, Print& out) {
-  JsonArrayEncoder encoder(out);
-  source.AddTo(encoder);
+size_t JsonArrayEncoder::Encode(const JsonElementSource& source, Print& out) {
+  size_t count = 0;
+  {
+    // The closing bracket is printed by the destructor.
+    JsonArrayEncoder encoder(out, count);
+    source.AddTo(encoder);
+  }
+  return count;
 }
 
 // static
 size_t JsonArrayEncoder::EncodedSize(const JsonElementSource& source) {
   PrintNoOp no_op;
-  CountingPrint counter(no_op);
-  Encode(source, counter);
-  return counter.count();
+  return Encode(source, no_op);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-JsonObjectEncoder::JsonObjectEncoder(Print& out) : AbstractJsonEncoder(out) {
-  out_.print('{');
+JsonObjectEncoder::JsonObjectEncoder(Print& out, size_t& count)
+    : AbstractJsonEncoder(out, count) {
+  NoteStackUsage();
+  PrintChar('{');
 }
 
-JsonObjectEncoder::~JsonObjectEncoder() { out_.print('}'); }
+JsonObjectEncoder::~JsonObjectEncoder() { PrintChar('}'); }
 
 void JsonObjectEncoder::StartProperty(const AnyPrintable& name) {
   StartItem();
   PrintString(name);
-  out_.print(':');
-  out_.print(' ');
+  PrintChars(':', ' ');
 }
 
 void JsonObjectEncoder::AddIntProperty(const AnyPrintable& name,
                                        int32_t value) {
   StartProperty(name);
-  PrintInteger(out_, value);
+  count_ += PrintInteger(out_, value);
 }
 
 void JsonObjectEncoder::AddUIntProperty(const AnyPrintable& name,
                                         uint32_t value) {
   StartProperty(name);
-  PrintInteger(out_, value);
+  count_ += PrintInteger(out_, value);
 }
 
 void JsonObjectEncoder::AddFloatProperty(const AnyPrintable& name,
                                          float value) {
   StartProperty(name);
-  PrintFloatingPoint(out_, value);
+  count_ += PrintFloatingPoint(out_, value);
 }
 
 void JsonObjectEncoder::AddDoubleProperty(const AnyPrintable& name,
                                           double value) {
   StartProperty(name);
-  PrintFloatingPoint(out_, value);
+  count_ += PrintFloatingPoint(out_, value);
 }
 
 void JsonObjectEncoder::AddBooleanProperty(const AnyPrintable& name,
                                            const bool value) {
   StartProperty(name);
-  PrintBoolean(out_, value);
+  count_ += PrintBoolean(out_, value);
 }
 
 void JsonObjectEncoder::AddStringProperty(const AnyPrintable& name,
@@ -312,17 +351,21 @@ void JsonObjectEncoder::AddObjectProperty(const AnyPrintable& name,
 }
 
 // static
-void JsonObjectEncoder::Encode(const JsonPropertySource& source, Print& out) {
-  JsonObjectEncoder encoder(out);
-  source.AddTo(encoder);
+size_t JsonObjectEncoder::Encode(const JsonPropertySource& source,
+                                 Print& out) {
+  size_t count = 0;
+  {
+    // The closing brace is printed by the destructor.
+    JsonObjectEncoder encoder(out, count);
+    source.AddTo(encoder);
+  }
+  return count;
 }
 
 // static
 size_t JsonObjectEncoder::EncodedSize(const JsonPropertySource& source) {
   PrintNoOp no_op;
-  CountingPrint counter(no_op);
-  Encode(source, counter);
-  return counter.count();
+  return Encode(source, no_op);
 }
 
 }  // namespace alpaca
@@ -4,6 +4,13 @@
 // Supports writing a JSON object, with values that are numbers, bools, strings,
 // and arrays of the same. Usage examples can be found in the test file.
 //
+// Responses are usually encoded twice, first to compute the Content-Length,
+// then to send them, so the encoder minimizes the number of (virtual) calls
+// to Print::write: it keeps its own count of the bytes written rather than
+// wrapping the Print instance in a CountingPrint, writes separators and escape
+// sequences with a single call, and writes runs of characters in a string that
+// don't need escaping with a single call.
+//
 // Author: james.synge@gmail.com
 
 #include "utils/any_printable.h"
@@ -34,7 +41,8 @@ class JsonPropertySource {
 // Base class for the object and array encoders.
 class AbstractJsonEncoder {
  protected:
-  explicit AbstractJsonEncoder(Print& out);
+  // Bytes written to out are added to count.
+  AbstractJsonEncoder(Print& out, size_t& count);
 
   AbstractJsonEncoder(const AbstractJsonEncoder&) = delete;
   AbstractJsonEncoder(AbstractJsonEncoder&&) = delete;
@@ -44,12 +52,17 @@ class AbstractJsonEncoder {
   // Prints the comma between elements in an array or properties in an object.
   void StartItem();
 
+  // Prints c, or the pair of chars a and b, to out_, counting them.
+  void PrintChar(char c);
+  void PrintChars(char a, char b);
+
   void EncodeChildArray(const JsonElementSource& source);
   void EncodeChildObject(const JsonPropertySource& source);
 
   void PrintString(const Printable& printable);
 
   Print& out_;
+  size_t& count_;
 
  private:
   bool first_;
@@ -68,13 +81,14 @@ class JsonArrayEncoder : public AbstractJsonEncoder {
   void AddArrayElement(const JsonElementSource& source);
   void AddObjectElement(const JsonPropertySource& source);
 
-  static void Encode(const JsonElementSource& source, Print& out);
+  // Writes the array to out, returning the number of bytes written.
+  static size_t Encode(const JsonElementSource& source, Print& out);
   static size_t EncodedSize(const JsonElementSource& source);
 
  private:
   friend class AbstractJsonEncoder;
 
-  explicit JsonArrayEncoder(Print& out);
+  JsonArrayEncoder(Print& out, size_t& count);
   JsonArrayEncoder(const JsonArrayEncoder&) = delete;
   JsonArrayEncoder(JsonArrayEncoder&&) = delete;
   JsonArrayEncoder& operator=(const JsonArrayEncoder&) = delete;
@@ -98,13 +112,14 @@ class JsonObjectEncoder : public AbstractJsonEncoder {
   void AddObjectProperty(const AnyPrintable& name,
                          const JsonPropertySource& source);
 
-  static void Encode(const JsonPropertySource& source, Print& out);
+  // Writes the object to out, returning the number of bytes written.
+  static size_t Encode(const JsonPropertySource& source, Print& out);
   static size_t EncodedSize(const JsonPropertySource& source);
 
  private:
   friend class AbstractJsonEncoder;
 
-  explicit JsonObjectEncoder(Print& out);
+  JsonObjectEncoder(Print& out, size_t& count);
   JsonObjectEncoder(const JsonObjectEncoder&) = delete;
   JsonObjectEncoder(JsonObjectEncoder&&) = delete;
   JsonObjectEncoder& operator=(const JsonObjectEncoder&) = delete;
@@ -5,6 +5,12 @@
 
 namespace alpaca {
 namespace {
+// Size of the stack allocated buffer into which printTo and operator== copy
+// the string from PROGMEM, a chunk at a time. Large enough that most literals
+// are handled in one or two chunks, small enough to be affordable on the stack
+// of an AVR.
+constexpr Literal::size_type kChunkSize = 16;
+
 // Returns the char at the specified location in PROGMEM.
 inline char pgm_read_char(PGM_P ptr) {
   auto byte = pgm_read_byte(reinterpret_cast<const uint8_t*>(ptr));
@@ -17,10 +23,19 @@ bool Literal::operator==(const Literal& other) const {
     if (ptr_ == other.ptr_) {
       return true;
     }
-    for (size_type offset = 0; offset < size_; ++offset) {
-      if (at(offset) != other.at(offset)) {
+    // Both strings are in PROGMEM, but memcmp_P can only compare a string in
+    // PROGMEM with one in RAM, so we copy the other string into RAM a chunk at
+    // a time.
+    char buffer[kChunkSize];
+    size_type offset = 0;
+    while (offset < size_) {
+      const size_type remaining = size_ - offset;
+      const size_type n = remaining < kChunkSize ? remaining : kChunkSize;
+      memcpy_P(buffer, other.ptr_ + offset, n);
+      if (0 != memcmp_P(buffer, ptr_ + offset, n)) {
         return false;
       }
+      offset += n;
     }
     return true;
   }
@@ -68,13 +83,19 @@ bool Literal::copyTo(char* out, size_type size) {
 
 size_t Literal::printTo(Print& out) const {
   static_assert(has_print_to<decltype(*this)>{}, "has_print_to should be true");
-  // Not particularly efficient, but probably OK. If not, use memcpy_P to copy
-  // in sequential chunks of the literal into a small stack allocated buffer
-  // (e.g. char buffer[16]), printing the buffer's contents after each copy
-  // operation.
+  // Copy sequential chunks of the literal into a small stack allocated buffer,
+  // and write each chunk with a single call, rather than printing one char at
+  // a time, which costs a virtual call (and for a network connection, maybe
+  // much more) per char.
+  char buffer[kChunkSize];
   size_t total = 0;
-  for (size_type offset = 0; offset < size_; ++offset) {
-    total += out.print(at(offset));
+  size_type offset = 0;
+  while (offset < size_) {
+    const size_type remaining = size_ - offset;
+    const size_type n = remaining < kChunkSize ? remaining : kChunkSize;
+    memcpy_P(buffer, ptr_ + offset, n);
+    total += out.write(buffer, n);
+    offset += n;
   }
   return total;
 }
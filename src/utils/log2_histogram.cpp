@@ -0,0 +1,69 @@
+#include "utils/log2_histogram.h"
+
+#include "utils/platform.h"
+
+namespace alpaca {
+
+Log2Histogram::Log2Histogram() { Reset(); }
+
+// static
+uint8_t Log2Histogram::BucketFor(uint32_t value) {
+  constexpr uint8_t kLastBucket = kNumBuckets - 1;
+  if (value >= (static_cast<uint32_t>(1) << (kLastBucket - 1))) {
+    return kLastBucket;
+  }
+  // The value now fits in 16 bits, which keeps the shifts cheap on AVR.
+  uint16_t v = static_cast<uint16_t>(value);
+  uint8_t bucket = 0;
+  while (v != 0) {
+    ++bucket;
+    v >>= 1;
+  }
+  return bucket;
+}
+
+// static
+uint32_t Log2Histogram::BucketLowerBound(uint8_t bucket) {
+  if (bucket == 0) {
+    return 0;
+  }
+  return static_cast<uint32_t>(1) << (bucket - 1);
+}
+
+void Log2Histogram::Record(uint32_t value) {
+  Count& count = counts_[BucketFor(value)];
+  if (count != static_cast<Count>(~static_cast<Count>(0))) {
+    ++count;
+  }
+}
+
+void Log2Histogram::Reset() {
+  for (uint8_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+    counts_[bucket] = 0;
+  }
+}
+
+uint32_t Log2Histogram::total_count() const {
+  uint32_t total = 0;
+  for (uint8_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+    total += counts_[bucket];
+  }
+  return total;
+}
+
+size_t Log2Histogram::printTo(Print& out) const {
+  uint8_t limit = kNumBuckets;
+  while (limit > 0 && counts_[limit - 1] == 0) {
+    --limit;
+  }
+  size_t count = 0;
+  for (uint8_t bucket = 0; bucket < limit; ++bucket) {
+    if (bucket > 0) {
+      count += out.print(' ');
+    }
+    count += out.print(counts_[bucket]);
+  }
+  return count;
+}
+
+}  // namespace alpaca
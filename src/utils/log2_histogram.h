@@ -0,0 +1,50 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_LOG2_HISTOGRAM_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_LOG2_HISTOGRAM_H_
+
+// Log2Histogram counts values (e.g. durations) in a fixed set of buckets whose
+// bounds are powers of two. Bucket 0 counts the value 0, bucket b (for b > 0)
+// counts values in the range [2^(b-1), 2^b), and the last bucket also counts
+// all values that are larger than that. The counts saturate rather than wrap
+// around. There is no allocation, and recording a value takes a handful of
+// shifts, so it is cheap enough to leave enabled on an Arduino.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+
+namespace alpaca {
+
+class Log2Histogram {
+ public:
+  static constexpr uint8_t kNumBuckets = 16;
+  using Count = uint16_t;
+
+  Log2Histogram();
+
+  // Returns the index of the bucket that counts value.
+  static uint8_t BucketFor(uint32_t value);
+
+  // Returns the smallest value that is counted by bucket.
+  static uint32_t BucketLowerBound(uint8_t bucket);
+
+  // Increments the count of the bucket that value belongs in.
+  void Record(uint32_t value);
+
+  // Sets all of the counts to zero.
+  void Reset();
+
+  Count count(uint8_t bucket) const { return counts_[bucket]; }
+
+  // Sum of the counts of all the buckets (not saturated).
+  uint32_t total_count() const;
+
+  // Prints the counts as a space separated list, omitting the trailing zeroes.
+  size_t printTo(Print& out) const;
+
+ private:
+  Count counts_[kNumBuckets];
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_LOG2_HISTOGRAM_H_
@@ -0,0 +1,181 @@
+#include "utils/log_ring_buffer.h"
+
+#include "utils/inline_literal.h"
+#include "utils/platform.h"
+
+#if TAS_HOST_TARGET
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <thread>  // NOLINT
+#endif             // TAS_HOST_TARGET
+
+#if TAS_HOST_TARGET
+// The host drains the buffer from another thread, so we need to serialize
+// access to the buffer.
+#define TAS_LOCK_RING_BUFFER() std::lock_guard<std::mutex> lock(mutex_)
+#else
+#define TAS_LOCK_RING_BUFFER()
+#endif  // TAS_HOST_TARGET
+
+namespace alpaca {
+namespace {
+
+// Drain copies the bytes out of the buffer in chunks of this size, so that on
+// the host the buffer isn't locked while writing to the output.
+constexpr uint8_t kDrainChunkSize = 32;
+
+}  // namespace
+
+LogRingBuffer::LogRingBuffer(uint8_t* storage, uint16_t storage_size)
+    : storage_(storage),
+      storage_size_(storage_size),
+      read_pos_(0),
+      size_(0),
+      dropped_count_(0) {}
+
+size_t LogRingBuffer::write(uint8_t value) { return write(&value, 1); }
+
+size_t LogRingBuffer::write(const uint8_t* buffer, size_t size) {
+  TAS_LOCK_RING_BUFFER();
+  size_t stored = storage_size_ - size_;
+  if (stored > size) {
+    stored = size;
+  }
+  dropped_count_ += size - stored;
+  // Copy into the free space, which may wrap around the end of storage_.
+  uint16_t write_pos = read_pos_ + size_;
+  if (write_pos >= storage_size_) {
+    write_pos -= storage_size_;
+  }
+  for (size_t ndx = 0; ndx < stored; ++ndx) {
+    storage_[write_pos] = buffer[ndx];
+    if (++write_pos == storage_size_) {
+      write_pos = 0;
+    }
+  }
+  size_ += stored;
+  return stored;
+}
+
+size_t LogRingBuffer::Drain(Print& out, size_t limit) {
+  size_t drained = 0;
+  while (drained < limit) {
+    uint8_t chunk[kDrainChunkSize];
+    uint8_t chunk_size = 0;
+    {
+      TAS_LOCK_RING_BUFFER();
+      while (chunk_size < kDrainChunkSize && size_ > 0 &&
+             drained + chunk_size < limit) {
+        chunk[chunk_size++] = storage_[read_pos_];
+        if (++read_pos_ == storage_size_) {
+          read_pos_ = 0;
+        }
+        --size_;
+      }
+    }
+    if (chunk_size == 0) {
+      break;
+    }
+    out.write(chunk, chunk_size);
+    drained += chunk_size;
+  }
+  return drained;
+}
+
+uint16_t LogRingBuffer::size() const {
+  TAS_LOCK_RING_BUFFER();
+  return size_;
+}
+
+uint32_t LogRingBuffer::dropped_count() const {
+  TAS_LOCK_RING_BUFFER();
+  return dropped_count_;
+}
+
+#if TAS_ENABLE_ASYNC_LOG_SINK
+
+namespace {
+
+#if TAS_HOST_TARGET
+#define DRAIN_OUT ::ToStdErr
+#else
+#define DRAIN_OUT ::Serial
+#endif  // TAS_HOST_TARGET
+
+constexpr size_t kUnlimited = ~static_cast<size_t>(0);
+
+uint8_t default_storage[TAS_LOG_RING_BUFFER_SIZE];  // NOLINT
+LogRingBuffer default_buffer(default_storage,       // NOLINT
+                             TAS_LOG_RING_BUFFER_SIZE);
+uint32_t reported_dropped_count = 0;  // NOLINT
+
+// Once the buffer has been emptied, reports how many bytes have been dropped
+// since the last report, if any.
+void ReportDroppedBytes(Print& out) {
+  if (default_buffer.size() != 0) {
+    return;
+  }
+  const uint32_t dropped_count = default_buffer.dropped_count();
+  if (dropped_count != reported_dropped_count) {
+    out.print(TAS_FLASHSTR("\nLogRingBuffer dropped "));
+    out.print(dropped_count - reported_dropped_count);
+    out.println(TAS_FLASHSTR(" bytes"));
+    reported_dropped_count = dropped_count;
+  }
+}
+
+#if TAS_HOST_TARGET
+void DrainForever() {
+  while (true) {
+    if (default_buffer.Drain(DRAIN_OUT, kUnlimited) == 0) {
+      ReportDroppedBytes(DRAIN_OUT);
+      DRAIN_OUT.flush();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+void FlushAtExit() { FlushDefaultLogRingBuffer(DRAIN_OUT); }
+
+bool StartDrainThread() {
+  std::thread(DrainForever).detach();
+  std::atexit(FlushAtExit);
+  return true;
+}
+#endif  // TAS_HOST_TARGET
+
+}  // namespace
+
+LogRingBuffer& DefaultLogRingBuffer() {
+#if TAS_HOST_TARGET
+  static const bool started = StartDrainThread();  // NOLINT
+  (void)started;
+#endif  // TAS_HOST_TARGET
+  return default_buffer;
+}
+
+void DrainDefaultLogRingBuffer() {
+#if TAS_HOST_TARGET
+  // The drain thread does the work.
+#else
+  // The notice of dropped bytes is short, so we reserve room for it.
+  constexpr int kReservedRoom = 32;
+  const int room = DRAIN_OUT.availableForWrite();
+  if (room > 0) {
+    default_buffer.Drain(DRAIN_OUT, room);
+  }
+  if (DRAIN_OUT.availableForWrite() >= kReservedRoom) {
+    ReportDroppedBytes(DRAIN_OUT);
+  }
+#endif  // TAS_HOST_TARGET
+}
+
+void FlushDefaultLogRingBuffer(Print& out) {
+  default_buffer.Drain(out, kUnlimited);
+  ReportDroppedBytes(out);
+  out.flush();
+}
+
+#endif  // TAS_ENABLE_ASYNC_LOG_SINK
+
+}  // namespace alpaca
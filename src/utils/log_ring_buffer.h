@@ -0,0 +1,84 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_LOG_RING_BUFFER_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_LOG_RING_BUFFER_H_
+
+// LogRingBuffer is a Print implementation that appends the bytes written to it
+// to a fixed size ring buffer in RAM, dropping (and counting) the bytes that
+// don't fit, so that writing to it never blocks. The bytes are later copied to
+// another Print instance (e.g. Serial) by calling Drain.
+//
+// When TAS_ENABLE_ASYNC_LOG_SINK is non-zero, LogSink (i.e. TAS_VLOG) writes to
+// the buffer returned by DefaultLogRingBuffer, instead of directly to Serial.
+// On Arduino, DrainDefaultLogRingBuffer should then be called periodically
+// (e.g. it is called by TinyAlpacaServer::PerformIO); it copies to Serial only
+// as many bytes as Serial can accept without blocking. On the host, a
+// background thread drains the buffer to stderr.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+#include "utils/utils_config.h"
+
+#if TAS_HOST_TARGET
+#include <mutex>  // NOLINT
+#endif            // TAS_HOST_TARGET
+
+namespace alpaca {
+
+class LogRingBuffer : public Print {
+ public:
+  LogRingBuffer(uint8_t* storage, uint16_t storage_size);
+
+  // These are the two abstract virtual methods in Arduino's Print class. They
+  // return the number of bytes stored in the buffer, which is less than the
+  // number requested if the buffer is full.
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+
+  // Pull in the other variants of write; otherwise, only the above two are
+  // visible.
+  using Print::write;
+
+  // Does nothing: LogSink calls flush at the end of each message, but the
+  // point of this class is to avoid waiting for the bytes to be written.
+  void flush() override {}
+
+  // Removes up to limit bytes from the buffer, writing them to out. Returns
+  // the number of bytes removed.
+  size_t Drain(Print& out, size_t limit);
+
+  // Number of bytes in the buffer.
+  uint16_t size() const;
+
+  // Total number of bytes that have been dropped because the buffer was full.
+  uint32_t dropped_count() const;
+
+ private:
+  uint8_t* const storage_;
+  const uint16_t storage_size_;
+  uint16_t read_pos_;
+  uint16_t size_;
+  uint32_t dropped_count_;
+#if TAS_HOST_TARGET
+  mutable std::mutex mutex_;
+#endif  // TAS_HOST_TARGET
+};
+
+#if TAS_ENABLE_ASYNC_LOG_SINK
+
+// Returns the buffer which LogSink writes to by default. On the host, the first
+// call starts the thread that drains the buffer.
+LogRingBuffer& DefaultLogRingBuffer();
+
+// Writes to Serial as much of the contents of DefaultLogRingBuffer as Serial
+// can accept without blocking, and notes if any bytes have been dropped.
+void DrainDefaultLogRingBuffer();
+
+// Writes all of the contents of DefaultLogRingBuffer to out, blocking if
+// necessary. Used before reporting a TAS_CHECK failure.
+void FlushDefaultLogRingBuffer(Print& out);
+
+#endif  // TAS_ENABLE_ASYNC_LOG_SINK
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_LOG_RING_BUFFER_H_
@@ -1,6 +1,7 @@
 #include "utils/log_sink.h"
 
 #include "utils/inline_literal.h"
+#include "utils/log_ring_buffer.h"
 #include "utils/platform.h"
 
 #ifndef ARDUINO
@@ -15,6 +16,12 @@
 #define DEFAULT_SINK_OUT ::ToStdErr
 #endif
 
+#if TAS_ENABLE_ASYNC_LOG_SINK
+#define DEFAULT_LOG_SINK_OUT ::alpaca::DefaultLogRingBuffer()
+#else
+#define DEFAULT_LOG_SINK_OUT DEFAULT_SINK_OUT
+#endif  // TAS_ENABLE_ASYNC_LOG_SINK
+
 namespace alpaca {
 namespace {
 // If file is provided, and has a '/' in it, return the location after the last
@@ -53,11 +60,11 @@ LogSink::LogSink(Print& out, const __FlashStringHelper* file,
 }
 
 LogSink::LogSink(const __FlashStringHelper* file, uint16_t line_number)
-    : LogSink(DEFAULT_SINK_OUT, file, line_number) {}
+    : LogSink(DEFAULT_LOG_SINK_OUT, file, line_number) {}
 
 LogSink::LogSink(Print& out) : LogSink(out, nullptr, 0) {}
 
-LogSink::LogSink() : LogSink(DEFAULT_SINK_OUT) {}
+LogSink::LogSink() : LogSink(DEFAULT_LOG_SINK_OUT) {}
 
 LogSink::~LogSink() {
   // End the line of output produced by the active logging statement.
@@ -70,6 +77,10 @@ CheckSink::CheckSink(Print& out, const __FlashStringHelper* file,
                      const __FlashStringHelper* expression_message)
     : MessageSinkBase(out, file, line_number),
       expression_message_(expression_message) {
+#if TAS_ENABLE_ASYNC_LOG_SINK
+  // Make sure that the messages logged before the failure are visible.
+  FlushDefaultLogRingBuffer(DEFAULT_SINK_OUT);
+#endif  // TAS_ENABLE_ASYNC_LOG_SINK
   Announce(out);
 }
 
@@ -27,6 +27,11 @@
 // compiler and linker are working as expected, the entire logging statement
 // will be omitted from the compiled binary.
 //
+// If TAS_ENABLE_BINARY_LOGGING is non-zero, TAS_VLOG instead emits a compact
+// binary record (see binary_log_sink.h) identifying the statement and holding
+// the raw values, which extras/dev_tools/decode_binary_log.py turns back into
+// text. TAS_CHECK and TAS_DCHECK always emit text.
+//
 ///////////////////////////////////////////////////////////////////////////////
 //
 // TAS_CHECK Usage:
@@ -81,6 +86,7 @@
 // named comparison.
 
 #include "utils/basename.h"
+#include "utils/binary_log_sink.h"
 #include "utils/log_sink.h"
 #include "utils/utils_config.h"
 
@@ -88,6 +94,19 @@
 
 #if defined(TAS_ENABLED_VLOG_LEVEL) && TAS_ENABLED_VLOG_LEVEL > 0
 
+#if TAS_ENABLE_BINARY_LOGGING
+
+#define TAS_VLOG(level)                                                 \
+  switch (0)                                                            \
+  default:                                                              \
+    (TAS_ENABLED_VLOG_LEVEL < level)                                    \
+        ? (void)0                                                       \
+        : ::alpaca::LogSinkVoidify() &&                                 \
+              ::alpaca::BinaryLogSink(TAS_BINARY_LOG_FILE_ID(__FILE__), \
+                                      __LINE__)
+
+#else  // !TAS_ENABLE_BINARY_LOGGING
+
 #define TAS_VLOG(level)                 \
   switch (0)                            \
   default:                              \
@@ -96,6 +115,8 @@
         : ::alpaca::LogSinkVoidify() && \
               ::alpaca::LogSink(TAS_BASENAME(__FILE__), __LINE__)
 
+#endif  // TAS_ENABLE_BINARY_LOGGING
+
 #define TAS_VLOG_IS_ON(level) (TAS_ENABLED_VLOG_LEVEL >= (level))
 
 #ifdef TAS_LOG_EXPERIMENT_DO_ANNOUNCE_BRANCH
@@ -0,0 +1,122 @@
+#include "utils/memory_usage.h"
+
+#if TAS_ENABLE_MEMORY_USAGE
+
+#include "utils/platform.h"
+
+#ifdef ARDUINO_ARCH_AVR
+
+// Symbols provided by avr-libc and the linker.
+extern "C" {
+extern char __heap_start;
+extern char* __brkval;
+}
+
+namespace {
+
+constexpr uint8_t kPaintValue = 0xC5;
+
+char* HeapEnd() { return __brkval != nullptr ? __brkval : &__heap_start; }
+
+char* StackPointer() { return reinterpret_cast<char*>(SP); }
+
+}  // namespace
+
+// Paints the RAM above the statically allocated variables. This is placed in
+// section .init3, which runs after the stack pointer and __zero_reg__ have been
+// set up (in .init2), but before .data and .bss are initialized and before any
+// function has been called, so the stack is empty. It must be naked because
+// there is no return address to return to; execution falls through to the
+// next init section.
+extern "C" void TasPaintFreeRam()
+    __attribute__((naked, used, section(".init3")));
+
+void TasPaintFreeRam() {
+  // __brkval is in .bss, so isn't yet initialized; the heap is empty, so the
+  // top of the heap is __heap_start.
+  volatile uint8_t* p = reinterpret_cast<uint8_t*>(&__heap_start);
+  while (p <= reinterpret_cast<uint8_t*>(RAMEND)) {
+    *p++ = kPaintValue;
+  }
+}
+
+namespace alpaca {
+
+void ResetMemoryUsage() {
+  // An interrupt handler would push onto the stack below the stack pointer, so
+  // we must not be interrupted while painting there.
+  const uint8_t sreg = SREG;
+  noInterrupts();
+  volatile uint8_t* p = reinterpret_cast<uint8_t*>(HeapEnd());
+  auto* const limit = reinterpret_cast<uint8_t*>(StackPointer());
+  while (p < limit) {
+    *p++ = kPaintValue;
+  }
+  SREG = sreg;
+}
+
+size_t MinFreeRam() {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(HeapEnd());
+  const auto* const limit = reinterpret_cast<const uint8_t*>(StackPointer());
+  size_t count = 0;
+  while (p < limit && *p == kPaintValue) {
+    ++p;
+    ++count;
+  }
+  return count;
+}
+
+size_t MaxStackUsed() {
+  const char* const lowest = HeapEnd() + MinFreeRam();
+  return reinterpret_cast<const char*>(RAMEND) - lowest + 1;
+}
+
+size_t CurrentFreeRam() { return StackPointer() - HeapEnd(); }
+
+size_t HeapSize() { return HeapEnd() - &__heap_start; }
+
+}  // namespace alpaca
+
+#else  // !ARDUINO_ARCH_AVR
+
+namespace alpaca {
+namespace {
+
+const char* stack_base = nullptr;         // NOLINT
+const char* min_stack_address = nullptr;  // NOLINT
+
+}  // namespace
+
+namespace mu_internal {
+
+void NoteStackAddress(const void* address) {
+  auto* const p = static_cast<const char*>(address);
+  if (stack_base == nullptr) {
+    // ResetMemoryUsage hasn't been called, so measure from here.
+    stack_base = p;
+    min_stack_address = p;
+  } else if (p < min_stack_address) {
+    min_stack_address = p;
+  }
+}
+
+}  // namespace mu_internal
+
+void ResetMemoryUsage() {
+  char here;
+  stack_base = &here;
+  min_stack_address = &here;
+}
+
+size_t MaxStackUsed() {
+  if (stack_base == nullptr) {
+    return 0;
+  }
+  return stack_base - min_stack_address;
+}
+
+}  // namespace alpaca
+
+#endif  // ARDUINO_ARCH_AVR
+
+#endif  // TAS_ENABLE_MEMORY_USAGE
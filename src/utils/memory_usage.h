@@ -0,0 +1,94 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_MEMORY_USAGE_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_MEMORY_USAGE_H_
+
+// Measures how close the stack has come to the heap (i.e. how close we've come
+// to running out of RAM), so that changes which save RAM can be judged on real
+// numbers.
+//
+// On AVR, all of the RAM between the end of the statically allocated variables
+// and the top of the stack is "painted" with a known byte value at startup,
+// before the constructors of global variables are run. MinFreeRam later finds
+// how many of the bytes just above the heap still have that value, i.e. the
+// smallest gap there has ever been between the heap and the stack. This covers
+// interrupt handlers too. It may over-estimate by a few bytes if the deepest
+// bytes of the stack happen to have been written with the paint value.
+//
+// On the host, the stack is not painted; instead NoteStackUsage records the
+// deepest stack address seen at the points where it is called (e.g. in
+// RequestDecoder and JsonObjectEncoder), relative to the stack address at the
+// most recent call to ResetMemoryUsage. This gives a lower bound on the stack
+// used, which is useful for comparing changes in host benchmarks and tests.
+// It isn't thread-safe, so should only be used from the thread which serves
+// requests.
+//
+// When TAS_ENABLE_MEMORY_USAGE is zero, these are empty functions, and the
+// values returned are zero.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+#include "utils/utils_config.h"
+
+namespace alpaca {
+
+#if TAS_ENABLE_MEMORY_USAGE
+
+// On AVR, repaints the free RAM below the current stack pointer (with
+// interrupts disabled while doing so), so that MinFreeRam and MaxStackUsed
+// measure from now on. On the host, treats the caller's stack frame as the
+// base from which stack usage is measured.
+void ResetMemoryUsage();
+
+// Maximum number of bytes of stack used: on AVR, from the top of RAM, else
+// from the stack frame which called ResetMemoryUsage.
+size_t MaxStackUsed();
+
+#ifdef ARDUINO_ARCH_AVR
+
+// Smallest number of bytes there has been between the top of the heap and the
+// bottom of the stack.
+size_t MinFreeRam();
+
+// Number of bytes currently between the top of the heap and the bottom of the
+// stack.
+size_t CurrentFreeRam();
+
+// Number of bytes currently allocated to the heap, including any freed blocks
+// below the top of the heap.
+size_t HeapSize();
+
+// Stack usage is measured by painting, so there is no need for the probes.
+inline void NoteStackUsage() {}
+
+#else  // !ARDUINO_ARCH_AVR
+
+inline size_t MinFreeRam() { return 0; }
+inline size_t CurrentFreeRam() { return 0; }
+inline size_t HeapSize() { return 0; }
+
+namespace mu_internal {
+void NoteStackAddress(const void* address);
+}  // namespace mu_internal
+
+// Records the stack depth of the caller, if deeper than previously recorded.
+inline void NoteStackUsage() {
+  char here;
+  mu_internal::NoteStackAddress(&here);
+}
+
+#endif  // ARDUINO_ARCH_AVR
+
+#else  // !TAS_ENABLE_MEMORY_USAGE
+
+inline void ResetMemoryUsage() {}
+inline size_t MaxStackUsed() { return 0; }
+inline size_t MinFreeRam() { return 0; }
+inline size_t CurrentFreeRam() { return 0; }
+inline size_t HeapSize() { return 0; }
+inline void NoteStackUsage() {}
+
+#endif  // TAS_ENABLE_MEMORY_USAGE
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_MEMORY_USAGE_H_
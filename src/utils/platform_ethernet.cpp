@@ -8,6 +8,8 @@ namespace {
 PlatformEthernetInterface* g_platform_ethernet_impl = nullptr;
 }  // namespace
 
+PlatformEthernetInterface::~PlatformEthernetInterface() {}
+
 void PlatformEthernet::SetPlatformEthernetImplementation(
     PlatformEthernetInterface* platform_ethernet_impl) {
   if (g_platform_ethernet_impl != nullptr &&
@@ -16,6 +18,39 @@ void PlatformEthernet::SetPlatformEthernetImplementation(
   }
   g_platform_ethernet_impl = platform_ethernet_impl;
 }
+#else   // !TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+namespace {
+// Bit mask of the sockets for which SendTxBuffer has issued a SEND command that
+// has not yet been confirmed as complete (i.e. SnIR::SEND_OK hasn't been seen).
+uint8_t g_sends_in_progress = 0;
+
+// The number of bytes appended to each socket's TX buffer since the last SEND
+// command. The W5500 only updates Sn_TX_FSR (free size) when a SEND command is
+// issued, so we need to account for those bytes ourselves.
+uint16_t g_unsent_sizes[MAX_SOCK_NUM];
+
+uint16_t UnsentFreeSize(uint8_t sock_num) {
+  const uint16_t free_size = w5500.getTXFreeSize(sock_num);
+  if (free_size <= g_unsent_sizes[sock_num]) {
+    return 0;
+  }
+  return free_size - g_unsent_sizes[sock_num];
+}
+
+bool SendIsInProgress(uint8_t sock_num) {
+  const uint8_t mask = 1 << sock_num;
+  if ((g_sends_in_progress & mask) == 0) {
+    return false;
+  }
+  if ((w5500.readSnIR(sock_num) & SnIR::SEND_OK) == 0 &&
+      w5500.readSnSR(sock_num) != SnSR::CLOSED) {
+    return true;
+  }
+  w5500.writeSnIR(sock_num, SnIR::SEND_OK);
+  g_sends_in_progress &= ~mask;
+  return false;
+}
+}  // namespace
 #endif  // TAS_HAS_PLATFORM_ETHERNET_INTERFACE
 
 uint8_t PlatformEthernet::SocketStatus(uint8_t sock_num) {
@@ -136,6 +171,68 @@ bool PlatformEthernet::CloseSocket(uint8_t sock_num) {
   return g_platform_ethernet_impl->CloseSocket(sock_num);
 #else   // !TAS_HAS_PLATFORM_ETHERNET_INTERFACE
   close(sock_num);
+  g_sends_in_progress &= ~(1 << sock_num);
+  g_unsent_sizes[sock_num] = 0;
+  return true;
+#endif  // TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+}
+
+size_t PlatformEthernet::AppendToTxBuffer(uint8_t sock_num,
+                                          const uint8_t* buf, size_t size) {
+  TAS_DCHECK_LT(sock_num, MAX_SOCK_NUM);
+#if TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+  TAS_CHECK_NE(g_platform_ethernet_impl, nullptr);
+  return g_platform_ethernet_impl->AppendToTxBuffer(sock_num, buf, size);
+#else   // !TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+  if (SendIsInProgress(sock_num)) {
+    // Sn_TX_FSR may not yet reflect the data being sent.
+    return 0;
+  }
+  const uint16_t free_size = UnsentFreeSize(sock_num);
+  if (size > free_size) {
+    size = free_size;
+  }
+  if (size > 0) {
+    // Copies the data into the TX buffer and advances the TX write pointer,
+    // but doesn't issue a SEND command.
+    w5500.send_data_processing(sock_num, buf, size);
+    g_unsent_sizes[sock_num] += size;
+  }
+  return size;
+#endif  // TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+}
+
+size_t PlatformEthernet::TxBufferFreeSize(uint8_t sock_num) {
+  TAS_DCHECK_LT(sock_num, MAX_SOCK_NUM);
+#if TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+  TAS_CHECK_NE(g_platform_ethernet_impl, nullptr);
+  return g_platform_ethernet_impl->TxBufferFreeSize(sock_num);
+#else   // !TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+  if (SendIsInProgress(sock_num)) {
+    return 0;
+  }
+  return UnsentFreeSize(sock_num);
+#endif  // TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+}
+
+bool PlatformEthernet::SendTxBuffer(uint8_t sock_num) {
+  TAS_DCHECK_LT(sock_num, MAX_SOCK_NUM);
+#if TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+  TAS_CHECK_NE(g_platform_ethernet_impl, nullptr);
+  return g_platform_ethernet_impl->SendTxBuffer(sock_num);
+#else   // !TAS_HAS_PLATFORM_ETHERNET_INTERFACE
+  // Issue a SEND command for all of the data between the TX read and write
+  // pointers. The W5500 doesn't support issuing another SEND command until the
+  // previous one is complete, so we wait for that here; callers that must not
+  // block should first check that TxBufferFreeSize is non-zero.
+  while (SendIsInProgress(sock_num)) {
+  }
+  if (w5500.readSnSR(sock_num) == SnSR::CLOSED) {
+    return false;
+  }
+  w5500.execCmdSn(sock_num, Sock_SEND);
+  g_sends_in_progress |= (1 << sock_num);
+  g_unsent_sizes[sock_num] = 0;
   return true;
 #endif  // TAS_HAS_PLATFORM_ETHERNET_INTERFACE
 }
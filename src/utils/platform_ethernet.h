@@ -70,6 +70,19 @@ class PlatformEthernetInterface {
   // Forces a socket to be closed, with no packets sent out.
   virtual bool CloseSocket(uint8_t sock_num) = 0;
 
+  // Copies up to 'size' bytes from 'buf' into the socket's TX buffer, without
+  // sending them. Returns the number of bytes copied, which is limited by the
+  // free space in the TX buffer.
+  virtual size_t AppendToTxBuffer(uint8_t sock_num, const uint8_t* buf,
+                                  size_t size) = 0;
+
+  // Returns the number of bytes that can be appended to the socket's TX buffer.
+  virtual size_t TxBufferFreeSize(uint8_t sock_num) = 0;
+
+  // Starts sending all of the bytes that have been appended to the socket's TX
+  // buffer since the last send. Returns false if the connection is closed.
+  virtual bool SendTxBuffer(uint8_t sock_num) = 0;
+
   // SnSR::CLOSE_WAIT && no data available to read.
   virtual bool IsClientDone(uint8_t sock_num) = 0;
 
@@ -129,6 +142,25 @@ struct PlatformEthernet {
   // Forces a socket to be closed, with no packets sent out.
   static bool CloseSocket(uint8_t sock_num);
 
+  // Copies up to 'size' bytes from 'buf' into the socket's TX buffer, without
+  // sending them. Returns the number of bytes copied, which is limited by the
+  // free space in the TX buffer (see TxBufferFreeSize). This allows a response
+  // to be assembled in the TX buffer from many small writes, and then sent with
+  // a single SEND command (i.e. as few TCP segments as possible).
+  static size_t AppendToTxBuffer(uint8_t sock_num, const uint8_t* buf,
+                                 size_t size);
+
+  // Returns the number of bytes that can be appended to the socket's TX buffer
+  // without waiting. Returns 0 while a send started by SendTxBuffer is still in
+  // progress.
+  static size_t TxBufferFreeSize(uint8_t sock_num);
+
+  // Starts sending all of the bytes that have been appended to the socket's TX
+  // buffer since the last send, without waiting for the send to complete, but
+  // first waiting for any previous send to complete. Returns false if the
+  // connection is closed.
+  static bool SendTxBuffer(uint8_t sock_num);
+
   // SnSR::CLOSE_WAIT && no data available to read.
   static bool IsClientDone(uint8_t sock_num);
 
@@ -1,12 +1,14 @@
 #include "utils/printable_cat.h"
 
 #include "utils/array_view.h"
+#include "utils/memory_usage.h"
 
 namespace alpaca {
 namespace internal {
 
 size_t PrintAnyPrintablesTo(const AnyPrintable* printables,
                             size_t num_printables, Print& out) {
+  NoteStackUsage();
   ArrayView<const AnyPrintable> view(printables, num_printables);
   size_t count = 0;
   for (const auto& elem : view) {
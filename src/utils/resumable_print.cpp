@@ -0,0 +1,53 @@
+#include "utils/resumable_print.h"
+
+#include "utils/platform.h"
+
+namespace alpaca {
+namespace {
+
+// Returns a + b, or the max value of uint32_t if that would overflow, as would
+// be the case if 'limit' is "unlimited".
+uint32_t SaturatingAdd(uint32_t a, uint32_t b) {
+  const uint32_t sum = a + b;
+  if (sum < a) {
+    return ~static_cast<uint32_t>(0);
+  }
+  return sum;
+}
+
+}  // namespace
+
+ResumablePrint::ResumablePrint(Print& out, uint32_t skip, uint32_t limit)
+    : out_(out),
+      skip_(skip),
+      end_(SaturatingAdd(skip, limit)),
+      count_(0),
+      forwarded_(0) {}
+
+size_t ResumablePrint::write(uint8_t value) {
+  if (skip_ <= count_ && count_ < end_) {
+    forwarded_ += out_.write(value);
+  }
+  ++count_;
+  return 1;
+}
+
+size_t ResumablePrint::write(const uint8_t* buffer, size_t size) {
+  uint32_t start = count_;
+  uint32_t stop = count_ + size;
+  count_ = stop;
+  // Clip [start, stop) to [skip_, end_).
+  if (start < skip_) {
+    start = skip_;
+  }
+  if (stop > end_) {
+    stop = end_;
+  }
+  if (start < stop) {
+    const size_t offset = start - (count_ - size);
+    forwarded_ += out_.write(buffer + offset, stop - start);
+  }
+  return size;
+}
+
+}  // namespace alpaca
@@ -0,0 +1,53 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_RESUMABLE_PRINT_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_RESUMABLE_PRINT_H_
+
+// ResumablePrint supports writing a long output in several pieces, without
+// buffering it in RAM. The caller generates the entire output each time, and
+// ResumablePrint forwards to the wrapped Print only those bytes in the range
+// [skip, skip+limit), i.e. skipping the bytes that were written previously, and
+// stopping when the wrapped Print has no more room. All bytes are counted, so
+// that the caller can tell whether the output is complete.
+//
+// This requires that the output be the same each time it is generated.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+
+namespace alpaca {
+
+class ResumablePrint : public Print {
+ public:
+  ResumablePrint(Print& out, uint32_t skip, uint32_t limit);
+
+  // These are the two abstract virtual methods in Arduino's Print class. They
+  // return the number of bytes "written", whether or not they were forwarded
+  // to the wrapped Print.
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+
+  // Pull in the other variants of write; otherwise, only the above two are
+  // visible.
+  using Print::write;
+
+  // The total count of bytes written to this instance.
+  uint32_t count() const { return count_; }
+
+  // The count of bytes forwarded to the wrapped Print.
+  uint32_t forwarded() const { return forwarded_; }
+
+  // Returns true if no bytes have been dropped on the floor due to reaching the
+  // limit.
+  bool is_complete() const { return count_ <= end_; }
+
+ private:
+  Print& out_;
+  const uint32_t skip_;
+  const uint32_t end_;
+  uint32_t count_;
+  uint32_t forwarded_;
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_RESUMABLE_PRINT_H_
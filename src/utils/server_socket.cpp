@@ -19,7 +19,8 @@ class TcpServerConnection : public WriteBufferedWrappedClientConnection {
                                ServerSocket::DisconnectData &disconnect_data)
       : WriteBufferedWrappedClientConnection(write_buffer, write_buffer_limit),
         client_(client),
-        disconnect_data_(disconnect_data) {
+        disconnect_data_(disconnect_data),
+        have_unsent_data_(false) {
     TAS_VLOG(5) << TAS_FLASHSTR("TcpServerConnection@") << this
                 << TAS_FLASHSTR(" ctor");
     disconnect_data_.Reset();
@@ -59,14 +60,60 @@ class TcpServerConnection : public WriteBufferedWrappedClientConnection {
 
   bool connected() const override { return client_.connected(); }
 
+  size_t availableToWrite() override {
+    const size_t free_size = PlatformEthernet::TxBufferFreeSize(sock_num());
+    const size_t buffered = write_buffer_size();
+    return free_size > buffered ? free_size - buffered : 0;
+  }
+
   uint8_t sock_num() const override { return client_.getSocketNumber(); }
 
  protected:
   Client &client() const override { return client_; }
 
+  // Rather than sending each buffer-full of data as a separate packet, we
+  // accumulate the response in the socket's TX buffer, and send it all at once
+  // when SendBufferedData is called (i.e. when the response is complete). If
+  // the TX buffer is full, we have to send what it holds to make room.
+  size_t WriteBufferedData(const uint8_t *buf, size_t size) override {
+    size_t result = 0;
+    while (size > 0) {
+      auto appended = PlatformEthernet::AppendToTxBuffer(sock_num(), buf, size);
+      if (appended > 0) {
+        have_unsent_data_ = true;
+        result += appended;
+        buf += appended;
+        size -= appended;
+      } else if (have_unsent_data_) {
+        if (!SendTxBuffer()) {
+          break;
+        }
+      } else if (!connected()) {
+        break;
+      }
+      // Else we wait for the peer to acknowledge receipt of data that we've
+      // sent, freeing up room in the TX buffer. A caller that must not block
+      // should write no more than availableToWrite() bytes.
+    }
+    return result;
+  }
+
+  void SendBufferedData() override {
+    if (have_unsent_data_ && !SendTxBuffer()) {
+      setWriteError(1);
+    }
+  }
+
  private:
+  bool SendTxBuffer() {
+    TAS_VLOG(4) << TAS_FLASHSTR("TcpServerConnection::SendTxBuffer");
+    have_unsent_data_ = false;
+    return PlatformEthernet::SendTxBuffer(sock_num());
+  }
+
   EthernetClient &client_;
   ServerSocket::DisconnectData &disconnect_data_;
+  bool have_unsent_data_;
 };
 
 MillisT ElapsedMillis(MillisT start_time) { return millis() - start_time; }
@@ -317,7 +364,11 @@ void ServerSocket::AnnounceCanRead() {
   uint8_t write_buffer[kWriteBufferSize];
   TcpServerConnection conn(write_buffer, kWriteBufferSize, client,
                            disconnect_data_);
-  listener_.OnCanRead(conn);
+  if (listener_.HasPendingOutput()) {
+    listener_.OnCanWrite(conn);
+  } else {
+    listener_.OnCanRead(conn);
+  }
   DetectListenerInitiatedDisconnect();
 }
 
@@ -326,7 +377,10 @@ void ServerSocket::HandleCloseWait() {
   uint8_t write_buffer[kWriteBufferSize];
   TcpServerConnection conn(write_buffer, kWriteBufferSize, client,
                            disconnect_data_);
-  if (client.available() > 0) {
+  if (listener_.HasPendingOutput()) {
+    // Finish writing the response before reading any more input.
+    listener_.OnCanWrite(conn);
+  } else if (client.available() > 0) {
     // Still have data that we can read from the client (i.e. buffered up in the
     // network chip).
     // TODO(jamessynge): Determine whether we get the CLOSE_WAIT state before
@@ -17,7 +17,8 @@
 // * If the connection transitions from LISTENING to ESTABLISHED or CLOSE_WAIT,
 //   we call the listeners OnConnect method (via AnnounceConnected).
 //
-// * If the connection is ESTABLISHED, we call the listeners OnCanRead.
+// * If the connection is ESTABLISHED, we call the listeners OnCanWrite if it
+//   has pending output, else OnCanRead.
 //
 // * If the connection is CLOSE_WAIT, we call HandleCloseWait.
 //
@@ -91,6 +92,7 @@ class ServerSocket {
   void AnnounceConnected();
 
   // Give the listener a chance to read from (or write to) the connection.
+  // Calls OnCanWrite instead of OnCanRead if the listener has pending output.
   void AnnounceCanRead();
 
   // Give the listener a chance to write to a half-closed connection, or to read
@@ -0,0 +1,448 @@
+#include "utils/settings_store.h"
+
+#include "utils/eeprom_io.h"
+#include "utils/logging.h"
+#include "utils/utils_config.h"
+
+namespace alpaca {
+namespace {
+
+// A bank starts with a header: the magic number and the generation, each
+// 2 bytes, then a CRC-32 of those 4 bytes.
+constexpr uint16_t kMagic = 0x5354;  // "TS" (little-endian).
+constexpr uint8_t kHeaderSize = 8;
+
+// Each record is the key (2 bytes), the size of the value (1 byte), the value,
+// then a CRC-32 of the generation of the bank and the preceding bytes of the
+// record.
+constexpr uint8_t kRecordOverhead = 7;
+
+// The size recorded for a setting which has been removed.
+constexpr uint8_t kRemovedSize = 0xFF;
+
+// Entry::flags values.
+constexpr uint8_t kDirty = 1;    // The cached value hasn't been recorded.
+constexpr uint8_t kRemoved = 2;  // The setting has been removed.
+
+uint16_t ReadUint16(int address) {
+  return EEPROM.read(address) | (EEPROM.read(address + 1) << 8);
+}
+
+uint32_t ReadUint32(int address) {
+  return static_cast<uint32_t>(ReadUint16(address)) |
+         (static_cast<uint32_t>(ReadUint16(address + 2)) << 16);
+}
+
+void StoreUint16(uint8_t* ptr, uint16_t value) {
+  ptr[0] = value & 0xFF;
+  ptr[1] = value >> 8;
+}
+
+void StoreUint32(uint8_t* ptr, uint32_t value) {
+  StoreUint16(ptr, value & 0xFFFF);
+  StoreUint16(ptr + 2, value >> 16);
+}
+
+void AppendGeneration(uint16_t generation, Crc32& crc) {
+  crc.appendByte(generation & 0xFF);
+  crc.appendByte(generation >> 8);
+}
+
+bool IsValidHeader(int address) {
+  if (ReadUint16(address) != kMagic) {
+    return false;
+  }
+  Crc32 crc;
+  for (uint8_t ndx = 0; ndx < 4; ++ndx) {
+    crc.appendByte(EEPROM.read(address + ndx));
+  }
+  return crc.value() == ReadUint32(address + 4);
+}
+
+uint16_t RecordSize(uint8_t value_size) {
+  return kRecordOverhead + (value_size == kRemovedSize ? 0 : value_size);
+}
+
+}  // namespace
+
+SettingsStoreBase::SettingsStoreBase(Entry* entries, uint8_t max_settings,
+                                     uint8_t* values, uint8_t max_value_size,
+                                     uint8_t* staging, int eeprom_address,
+                                     uint16_t eeprom_size)
+    : entries_(entries),
+      values_(values),
+      staging_(staging),
+      eeprom_address_(eeprom_address),
+      bank_size_(eeprom_size / 2),
+      max_settings_(max_settings),
+      max_value_size_(max_value_size),
+      scheduler_(nullptr),
+      generation_(0),
+      active_bank_(0),
+      append_offset_(kHeaderSize),
+      write_address_(0),
+      staged_size_(0),
+      staged_written_(0),
+      staged_header_(false),
+      compacting_(false),
+      compact_next_entry_(0),
+      compact_offset_(0) {
+  TAS_DCHECK_GE(bank_size_, kHeaderSize + kRecordOverhead + max_value_size);
+}
+
+void SettingsStoreBase::Clear() {
+  for (uint8_t ndx = 0; ndx < max_settings_; ++ndx) {
+    entries_[ndx].key = kInvalidKey;
+    entries_[ndx].flags = 0;
+  }
+  staged_size_ = staged_written_ = 0;
+  compacting_ = false;
+}
+
+int SettingsStoreBase::BankAddress(uint8_t bank) const {
+  return eeprom_address_ + bank * bank_size_;
+}
+
+uint8_t* SettingsStoreBase::ValueOf(const Entry& entry) const {
+  return values_ + (&entry - entries_) * max_value_size_;
+}
+
+SettingsStoreBase::Entry* SettingsStoreBase::Find(uint16_t key) const {
+  for (uint8_t ndx = 0; ndx < max_settings_; ++ndx) {
+    if (entries_[ndx].key == key) {
+      return &entries_[ndx];
+    }
+  }
+  return nullptr;
+}
+
+SettingsStoreBase::Entry* SettingsStoreBase::FindLive(uint16_t key) const {
+  if (key == kInvalidKey) {
+    return nullptr;
+  }
+  Entry* entry = Find(key);
+  if (entry == nullptr || (entry->flags & kRemoved) != 0) {
+    return nullptr;
+  }
+  return entry;
+}
+
+uint16_t SettingsStoreBase::LiveBytes() const {
+  uint16_t result = kHeaderSize;
+  for (uint8_t ndx = 0; ndx < max_settings_; ++ndx) {
+    const Entry& entry = entries_[ndx];
+    if (entry.key != kInvalidKey && (entry.flags & kRemoved) == 0) {
+      result += RecordSize(entry.size);
+    }
+  }
+  return result;
+}
+
+void SettingsStoreBase::Initialize() {
+  Clear();
+  const bool valid0 = IsValidHeader(BankAddress(0));
+  const bool valid1 = IsValidHeader(BankAddress(1));
+  if (!valid0 && !valid1) {
+    TAS_VLOG(2) << TAS_FLASHSTR("SettingsStore: no valid bank, formatting");
+    Format();
+    return;
+  }
+  const uint16_t generation0 = ReadUint16(BankAddress(0) + 2);
+  const uint16_t generation1 = ReadUint16(BankAddress(1) + 2);
+  if (valid0 && valid1) {
+    // The generation wraps around, so compare using the difference.
+    active_bank_ =
+        static_cast<int16_t>(generation1 - generation0) > 0 ? 1 : 0;
+  } else {
+    active_bank_ = valid1 ? 1 : 0;
+  }
+  generation_ = active_bank_ == 0 ? generation0 : generation1;
+  LoadRecords();
+  TAS_VLOG(3) << TAS_FLASHSTR("SettingsStore: loaded bank ") << active_bank_
+              << TAS_FLASHSTR(", generation ") << generation_
+              << TAS_FLASHSTR(", bytes used ") << append_offset_;
+}
+
+void SettingsStoreBase::Format() {
+  // Writing the header takes about 26ms on an AVR, but this happens only
+  // once, during setup.
+  StageHeader(0, 1);
+  WriteSome(kHeaderSize);
+  active_bank_ = 0;
+  generation_ = 1;
+  append_offset_ = kHeaderSize;
+}
+
+void SettingsStoreBase::LoadRecords() {
+  const int bank_address = BankAddress(active_bank_);
+  uint16_t offset = kHeaderSize;
+  while (offset + kRecordOverhead <= bank_size_) {
+    const int address = bank_address + offset;
+    const uint16_t key = ReadUint16(address);
+    const uint8_t size = EEPROM.read(address + 2);
+    const uint16_t record_size = RecordSize(size);
+    if (key == kInvalidKey || offset + record_size > bank_size_) {
+      break;
+    }
+    // Verify the CRC before changing the cache.
+    Crc32 crc;
+    AppendGeneration(generation_, crc);
+    for (uint16_t ndx = 0; ndx < record_size - 4; ++ndx) {
+      crc.appendByte(EEPROM.read(address + ndx));
+    }
+    if (crc.value() != ReadUint32(address + record_size - 4)) {
+      break;
+    }
+    offset += record_size;
+
+    Entry* entry = Find(key);
+    if (size == kRemovedSize) {
+      if (entry != nullptr) {
+        entry->key = kInvalidKey;
+      }
+      continue;
+    } else if (size > max_value_size_) {
+      TAS_VLOG(1) << TAS_FLASHSTR("SettingsStore: value of key ") << key
+                  << TAS_FLASHSTR(" is too long: ") << size;
+      continue;
+    } else if (entry == nullptr) {
+      entry = Find(kInvalidKey);
+      if (entry == nullptr) {
+        TAS_VLOG(1) << TAS_FLASHSTR("SettingsStore: no room for key ") << key;
+        continue;
+      }
+      entry->key = key;
+    }
+    entry->size = size;
+    entry->flags = 0;
+    getBytes(address + 3, size, ValueOf(*entry), nullptr);
+  }
+  append_offset_ = offset;
+}
+
+void SettingsStoreBase::SetTaskScheduler(TaskScheduler& scheduler) {
+  scheduler_ = &scheduler;
+  if (HasPendingWrites()) {
+    ScheduleWrites();
+  }
+}
+
+bool SettingsStoreBase::Contains(uint16_t key) const {
+  return FindLive(key) != nullptr;
+}
+
+StringView SettingsStoreBase::GetString(uint16_t key) const {
+  const Entry* entry = FindLive(key);
+  if (entry == nullptr) {
+    return StringView();
+  }
+  return StringView(reinterpret_cast<const char*>(ValueOf(*entry)),
+                    entry->size);
+}
+
+bool SettingsStoreBase::Get(uint16_t key, void* value, uint8_t size) const {
+  const Entry* entry = FindLive(key);
+  if (entry == nullptr || entry->size != size) {
+    return false;
+  }
+  memcpy(value, ValueOf(*entry), size);
+  return true;
+}
+
+bool SettingsStoreBase::Put(uint16_t key, const void* value, uint8_t size) {
+  if (key == kInvalidKey || size > max_value_size_) {
+    return false;
+  }
+  Entry* entry = Find(key);
+  uint16_t live_bytes = LiveBytes() + RecordSize(size);
+  if (entry != nullptr && (entry->flags & kRemoved) == 0) {
+    if (entry->size == size && memcmp(ValueOf(*entry), value, size) == 0) {
+      // Unchanged, so there is nothing to write.
+      return true;
+    }
+    live_bytes -= RecordSize(entry->size);
+  }
+  // All of the settings must fit in a bank, else compaction would fail.
+  if (live_bytes > bank_size_) {
+    TAS_VLOG(2) << TAS_FLASHSTR("SettingsStore: no room for key ") << key;
+    return false;
+  }
+  if (entry == nullptr) {
+    entry = Find(kInvalidKey);
+    if (entry == nullptr) {
+      TAS_VLOG(2) << TAS_FLASHSTR("SettingsStore: cache is full");
+      return false;
+    }
+    entry->key = key;
+  }
+  memcpy(ValueOf(*entry), value, size);
+  entry->size = size;
+  entry->flags = kDirty;
+  ScheduleWrites();
+  return true;
+}
+
+bool SettingsStoreBase::Remove(uint16_t key) {
+  Entry* entry = FindLive(key);
+  if (entry == nullptr) {
+    return false;
+  }
+  entry->flags = kDirty | kRemoved;
+  ScheduleWrites();
+  return true;
+}
+
+bool SettingsStoreBase::HasPendingWrites() const {
+  if (staged_written_ < staged_size_ || compacting_) {
+    return true;
+  }
+  for (uint8_t ndx = 0; ndx < max_settings_; ++ndx) {
+    if (entries_[ndx].key != kInvalidKey &&
+        (entries_[ndx].flags & kDirty) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SettingsStoreBase::ScheduleWrites() {
+  if (scheduler_ != nullptr && !is_scheduled()) {
+    scheduler_->ScheduleAt(*this, millis());
+  }
+}
+
+void SettingsStoreBase::Flush() {
+  while (WriteSome(255)) {
+  }
+  if (scheduler_ != nullptr) {
+    scheduler_->Cancel(*this);
+  }
+}
+
+uint32_t SettingsStoreBase::RunTask(uint32_t now_millis) {
+  // Run again on the next pass through the loop if there is more to write.
+  return WriteSome(TAS_SETTINGS_STORE_BYTES_PER_STEP) ? 0 : kDontReschedule;
+}
+
+bool SettingsStoreBase::WriteSome(uint8_t max_bytes) {
+  while (true) {
+    if (staged_written_ < staged_size_) {
+      if (max_bytes == 0) {
+        return true;
+      }
+      EEPROM.update(write_address_ + staged_written_,
+                    staging_[staged_written_]);
+      ++staged_written_;
+      --max_bytes;
+      if (staged_written_ == staged_size_ && staged_header_ && compacting_) {
+        // The compacted bank is now complete, so becomes the active bank.
+        compacting_ = false;
+        active_bank_ = 1 - active_bank_;
+        ++generation_;
+        append_offset_ = compact_offset_;
+        TAS_VLOG(3) << TAS_FLASHSTR("SettingsStore: compacted into bank ")
+                    << active_bank_ << TAS_FLASHSTR(", bytes used ")
+                    << append_offset_;
+      }
+    } else if (!StageNext()) {
+      return false;
+    }
+  }
+}
+
+bool SettingsStoreBase::StageNext() {
+  if (compacting_) {
+    while (compact_next_entry_ < max_settings_) {
+      Entry& entry = entries_[compact_next_entry_++];
+      if (entry.key == kInvalidKey) {
+        continue;
+      } else if ((entry.flags & kRemoved) != 0) {
+        // Removed settings aren't copied, so are forgotten.
+        entry.key = kInvalidKey;
+        continue;
+      }
+      const uint16_t record_size = RecordSize(entry.size);
+      if (compact_offset_ + record_size > bank_size_) {
+        // Settings copied earlier have since grown; start over with their
+        // current values, which are known to fit (see Put).
+        StartCompaction();
+        return StageNext();
+      }
+      StageRecord(entry, generation_ + 1,
+                  BankAddress(1 - active_bank_) + compact_offset_);
+      compact_offset_ += record_size;
+      return true;
+    }
+    StageHeader(1 - active_bank_, generation_ + 1);
+    return true;
+  }
+  for (uint8_t ndx = 0; ndx < max_settings_; ++ndx) {
+    Entry& entry = entries_[ndx];
+    if (entry.key == kInvalidKey || (entry.flags & kDirty) == 0) {
+      continue;
+    }
+    const bool removed = (entry.flags & kRemoved) != 0;
+    const uint16_t record_size =
+        RecordSize(removed ? kRemovedSize : entry.size);
+    if (append_offset_ + record_size > bank_size_) {
+      StartCompaction();
+      return StageNext();
+    }
+    StageRecord(entry, generation_,
+                BankAddress(active_bank_) + append_offset_);
+    append_offset_ += record_size;
+    if (removed) {
+      // The staged record will record the removal.
+      entry.key = kInvalidKey;
+    }
+    return true;
+  }
+  return false;
+}
+
+void SettingsStoreBase::StageRecord(Entry& entry, uint16_t generation,
+                                    int address) {
+  const bool removed = (entry.flags & kRemoved) != 0;
+  const uint8_t value_size = removed ? 0 : entry.size;
+  StoreUint16(staging_, entry.key);
+  staging_[2] = removed ? kRemovedSize : entry.size;
+  if (value_size > 0) {
+    memcpy(staging_ + 3, ValueOf(entry), value_size);
+  }
+  Crc32 crc;
+  AppendGeneration(generation, crc);
+  for (uint8_t ndx = 0; ndx < 3 + value_size; ++ndx) {
+    crc.appendByte(staging_[ndx]);
+  }
+  StoreUint32(staging_ + 3 + value_size, crc.value());
+  // The value is now recorded, unless it is changed again.
+  entry.flags &= ~kDirty;
+  write_address_ = address;
+  staged_size_ = kRecordOverhead + value_size;
+  staged_written_ = 0;
+  staged_header_ = false;
+}
+
+void SettingsStoreBase::StageHeader(uint8_t bank, uint16_t generation) {
+  StoreUint16(staging_, kMagic);
+  StoreUint16(staging_ + 2, generation);
+  Crc32 crc;
+  for (uint8_t ndx = 0; ndx < 4; ++ndx) {
+    crc.appendByte(staging_[ndx]);
+  }
+  StoreUint32(staging_ + 4, crc.value());
+  write_address_ = BankAddress(bank);
+  staged_size_ = kHeaderSize;
+  staged_written_ = 0;
+  staged_header_ = true;
+}
+
+void SettingsStoreBase::StartCompaction() {
+  TAS_VLOG(3) << TAS_FLASHSTR("SettingsStore: compacting bank ")
+              << active_bank_;
+  compacting_ = true;
+  compact_next_entry_ = 0;
+  compact_offset_ = kHeaderSize;
+}
+
+}  // namespace alpaca
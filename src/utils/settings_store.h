@@ -0,0 +1,194 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_SETTINGS_STORE_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_SETTINGS_STORE_H_
+
+// SettingsStore is a key-value store of small settings (e.g. switch names, a
+// calibrator's brightness), persisted in a region of the EEPROM.
+//
+// All of the settings are held in an in-RAM cache, from which they're read;
+// Put updates the cache immediately, and the change is written to the EEPROM
+// later, a few bytes (TAS_SETTINGS_STORE_BYTES_PER_STEP) each time the store
+// is run by the TaskScheduler. Writing a byte of EEPROM takes ~3.3ms on an AVR,
+// so writing a name during a request would otherwise stall the server for
+// tens of milliseconds.
+//
+// The region is split into two banks, and the settings are recorded in the
+// active bank as a log: each change appends a record holding the key, the
+// value and a CRC-32 of the record, so the bytes of the EEPROM are written in
+// turn, rather than the same few bytes being rewritten for each change. When
+// the active bank is full, the current values are copied (compacted) into the
+// other bank, and once the header of that bank, holding its generation number,
+// has been written, it becomes the active bank. Hence each byte of the region
+// is written about once per two compactions.
+//
+// The generation number is included in the CRC of each record, so that records
+// left over from an earlier use of a bank aren't mistaken for current records;
+// loading stops at the first record that is invalid, which is also where a
+// record that was being written during a reset or power loss will be found.
+//
+// SettingsStore<kMaxSettings, kMaxValueSize> needs about (kMaxSettings + 1) *
+// (kMaxValueSize + 4) bytes of RAM, plus about 30 bytes. The logic is in the
+// non-template base class so that it is present only once in the program,
+// regardless of the number of sizes used.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+#include "utils/string_view.h"
+#include "utils/task_scheduler.h"
+
+namespace alpaca {
+
+class SettingsStoreBase : public ScheduledTask {
+ public:
+  // Reserved; can not be used as the key of a setting.
+  static constexpr uint16_t kInvalidKey = 0xFFFF;
+
+  // Loads the settings from the EEPROM, replacing any in the cache. If neither
+  // bank holds a valid header (e.g. the first time the store is used), writes
+  // the header of the first bank, so this should be called during setup.
+  void Initialize();
+
+  // Provides the scheduler with which the writing of changes is deferred. If
+  // none is provided, changes are only written by Flush.
+  void SetTaskScheduler(TaskScheduler& scheduler);
+
+  // Returns true if there is a setting with the key.
+  bool Contains(uint16_t key) const;
+
+  // Returns the value of the setting, or an empty view if there is none. The
+  // view is invalidated by the next change to the setting.
+  StringView GetString(uint16_t key) const;
+
+  // Copies the value of the setting to value, if there is a setting whose
+  // value has exactly that size; returns true if copied.
+  bool Get(uint16_t key, void* value, uint8_t size) const;
+  template <typename T>
+  bool GetValue(uint16_t key, T& value) const {
+    return Get(key, &value, sizeof value);
+  }
+
+  // Sets the value of the setting in the cache, and schedules the change to be
+  // written to the EEPROM. Returns false if the key is invalid, if the value
+  // is too long, if the cache is full, or if there isn't room in a bank for
+  // all of the settings.
+  bool Put(uint16_t key, const void* value, uint8_t size);
+  bool PutString(uint16_t key, const StringView& value) {
+    return Put(key, value.data(), value.size());
+  }
+  template <typename T>
+  bool PutValue(uint16_t key, const T& value) {
+    return Put(key, &value, sizeof value);
+  }
+
+  // Removes the setting, if present, returning true if it was.
+  bool Remove(uint16_t key);
+
+  // Returns true if there are changes which have yet to be written.
+  bool HasPendingWrites() const;
+
+  // Writes all pending changes now, without regard to how long that takes.
+  void Flush();
+
+  // For diagnostics: the generation of the active bank (incremented by each
+  // compaction), the active bank (0 or 1), and the number of bytes of the
+  // active bank used by its header and records.
+  uint16_t generation() const { return generation_; }
+  uint8_t active_bank() const { return active_bank_; }
+  uint16_t bytes_used() const { return append_offset_; }
+
+ protected:
+  struct Entry {
+    uint16_t key;  // kInvalidKey if the entry is free.
+    uint8_t size;
+    uint8_t flags;
+  };
+
+  // The region of the EEPROM is eeprom_size bytes starting at eeprom_address.
+  // staging must have room for a record with a value of max_value_size bytes.
+  SettingsStoreBase(Entry* entries, uint8_t max_settings, uint8_t* values,
+                    uint8_t max_value_size, uint8_t* staging,
+                    int eeprom_address, uint16_t eeprom_size);
+
+  // Empties the cache, without changing the EEPROM.
+  void Clear();
+
+  uint32_t RunTask(uint32_t now_millis) override;
+
+ private:
+  int BankAddress(uint8_t bank) const;
+  uint8_t* ValueOf(const Entry& entry) const;
+  Entry* Find(uint16_t key) const;
+  Entry* FindLive(uint16_t key) const;
+
+  // Returns the number of bytes needed to record the live settings.
+  uint16_t LiveBytes() const;
+
+  void Format();
+  void LoadRecords();
+  void ScheduleWrites();
+
+  // Writes up to max_bytes of the pending changes, returning true if there are
+  // more to be written.
+  bool WriteSome(uint8_t max_bytes);
+
+  // Prepares the next record (or bank header) to be written, returning false
+  // if there is nothing more to write.
+  bool StageNext();
+  void StageRecord(Entry& entry, uint16_t generation, int address);
+  void StageHeader(uint8_t bank, uint16_t generation);
+  void StartCompaction();
+
+  Entry* const entries_;
+  uint8_t* const values_;
+  uint8_t* const staging_;
+  const int eeprom_address_;
+  const uint16_t bank_size_;
+  const uint8_t max_settings_;
+  const uint8_t max_value_size_;
+
+  TaskScheduler* scheduler_;
+  uint16_t generation_;
+  uint8_t active_bank_;
+  uint16_t append_offset_;
+
+  // The record or header being written to write_address_.
+  int write_address_;
+  uint8_t staged_size_;
+  uint8_t staged_written_;
+  bool staged_header_;
+
+  // Compaction copies the live settings, starting with entry
+  // compact_next_entry_, into the inactive bank at compact_offset_.
+  bool compacting_;
+  uint8_t compact_next_entry_;
+  uint16_t compact_offset_;
+};
+
+template <uint8_t kMaxSettings, uint8_t kMaxValueSize>
+class SettingsStore : public SettingsStoreBase {
+  static_assert(kMaxSettings >= 1, "Must have room for at least one setting");
+  static_assert(kMaxValueSize >= 1 && kMaxValueSize <= 254,
+                "kMaxValueSize must be in the range [1, 254]");
+
+ public:
+  SettingsStore(int eeprom_address, uint16_t eeprom_size)
+      : SettingsStoreBase(entries_, kMaxSettings, values_, kMaxValueSize,
+                          staging_, eeprom_address, eeprom_size) {
+    Clear();
+  }
+
+  // Copying would leave the copy referring to the original's cache.
+  SettingsStore(const SettingsStore&) = delete;
+  SettingsStore& operator=(const SettingsStore&) = delete;
+
+ private:
+  Entry entries_[kMaxSettings];
+  uint8_t values_[kMaxSettings * kMaxValueSize];
+  // A record has a 3 byte prefix (key and size) and a 4 byte CRC; the header
+  // of a bank is 8 bytes.
+  uint8_t staging_[kMaxValueSize + 7 < 8 ? 8 : kMaxValueSize + 7];
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_SETTINGS_STORE_H_
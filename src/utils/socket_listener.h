@@ -10,12 +10,14 @@
 
 namespace alpaca {
 
-// There is no OnCanWrite because we don't seem to need it (for now) for the
-// purposes of Tiny Alpaca Server, i.e. where we don't have long streams of data
-// to return and don't have the ability to buffer data and resume writing later
-// when there is room for more. Instead, OnHalfClosed is called multiple times
-// if the peer half-closes the socket and the SocketListener doesn't close the
-// connection when OnHalfClosed is called (i.e. on every loop).
+// OnCanWrite allows a listener to write a long response in pieces, as room
+// becomes available in the connection's TX buffer, rather than blocking the
+// loop until the peer has received all of it. It is only called while
+// HasPendingOutput returns true, and in that case OnCanRead is not called, so
+// that no more input is read until the current response has been written.
+// OnHalfClosed is called multiple times if the peer half-closes the socket and
+// the SocketListener doesn't close the connection when OnHalfClosed is called
+// (i.e. on every loop).
 class SocketListener {
  public:
 #if !TAS_EMBEDDED_TARGET
@@ -26,6 +28,15 @@ class SocketListener {
   // also called by ServerSocket for existing connections.
   virtual void OnCanRead(Connection& connection) = 0;
 
+  // Called instead of OnCanRead when HasPendingOutput returns true, i.e. when
+  // the listener has more output to write. Connection::availableToWrite
+  // returns the number of bytes that can be written without blocking.
+  virtual void OnCanWrite(Connection& connection) = 0;
+
+  // Returns true if the listener has output that it hasn't yet been able to
+  // write to the connection.
+  virtual bool HasPendingOutput() = 0;
+
   // Called when there is no more data to come from the client (i.e. it has half
   // closed its socket), but this end of the connection may still write. This
   // may not be called between OnConnect and OnDisconnect. This may be called
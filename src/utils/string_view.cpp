@@ -1,5 +1,9 @@
 #include "utils/string_view.h"
 
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "utils/hex_escape.h"
 #include "utils/traits/print_to_trait.h"
 
@@ -40,47 +44,330 @@ bool StringView::operator!=(const StringView& other) const {
 
 namespace {
 constexpr uint32_t kMaxUInt = 0xFFFFFFFF;
-constexpr uint32_t kMaxUIntDiv10 = kMaxUInt / 10;
 
-bool AddOnesPlace(uint32_t& value, const char c) {
-  if (!('0' <= c && c <= '9')) {
+// Returns the 8 chars at ptr as a uint64_t, with ptr[0] in the low byte.
+uint64_t LoadEightChars(const char* ptr) {
+  uint64_t value;
+  memcpy(&value, ptr, sizeof value);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  return value;
+}
+
+// Returns true if all 8 chars in value are decimal digits. Adding 0x46 to a
+// byte sets its high bit if the byte is greater than '9', and subtracting 0x30
+// sets it (or borrows from it) if the byte is less than '0'.
+bool AreEightDigits(uint64_t value) {
+  return (((value + 0x4646464646464646) | (value - 0x3030303030303030)) &
+          0x8080808080808080) == 0;
+}
+
+// Converts 8 decimal digits to their value, combining adjacent digits, then
+// pairs of digits, then the two halves, with 3 multiplications.
+uint32_t ConvertEightDigits(uint64_t value) {
+  constexpr uint64_t kMask = 0x000000FF000000FF;
+  constexpr uint64_t kMul1 = 100 + (1000000ULL << 32);
+  constexpr uint64_t kMul2 = 1 + (10000ULL << 32);
+  value -= 0x3030303030303030;
+  value = (value * 10) + (value >> 8);
+  value = (((value & kMask) * kMul1) + (((value >> 16) & kMask) * kMul2)) >> 32;
+  return static_cast<uint32_t>(value);
+}
+
+// Sets value to value * multiplier + addend, returning false on overflow. The
+// products are of 16-bit halves, which an AVR computes with a few MUL
+// instructions, rather than the library call needed for a 32-bit product.
+bool MultiplyAdd(uint32_t& value, uint16_t multiplier, uint16_t addend) {
+  const uint32_t low =
+      static_cast<uint32_t>(static_cast<uint16_t>(value)) * multiplier;
+  const uint32_t high =
+      static_cast<uint32_t>(static_cast<uint16_t>(value >> 16)) * multiplier;
+  if (high > 0xFFFF) {
     return false;
   }
-  if (value > kMaxUIntDiv10) {
+  uint32_t result = (high << 16) + low;
+  if (result < low) {
     return false;
   }
-  uint32_t digit = static_cast<uint32_t>(c - '0');
-  value *= 10;
-  if (value > kMaxUInt - digit) {
+  result += addend;
+  if (result < addend) {
     return false;
   }
-  value += digit;
+  value = result;
   return true;
 }
 
-bool AddOnesPlace(double& value, const char c) {
-  if (!('0' <= c && c <= '9')) {
+#if __SIZEOF_DOUBLE__ == 4
+// On AVR double is (by default) a 32-bit float, with a 24-bit significand.
+// 10^10 is the largest power of ten that is exactly representable, and 9
+// significant digits are enough to identify any float, so the mantissa fits in
+// 32 bits.
+using DecimalMantissa = uint32_t;
+constexpr uint8_t kMaxMantissaDigits = 9;
+constexpr DecimalMantissa kMaxExactMantissa = 1UL << 24;
+constexpr double kExactPowersOfTen[] AVR_PROGMEM = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+};
+#else
+using DecimalMantissa = uint64_t;
+constexpr uint8_t kMaxMantissaDigits = 19;
+constexpr DecimalMantissa kMaxExactMantissa = 1ULL << 53;
+constexpr double kExactPowersOfTen[] AVR_PROGMEM = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+#endif
+constexpr int16_t kMaxExactPowerOfTen =
+    sizeof(kExactPowersOfTen) / sizeof(kExactPowersOfTen[0]) - 1;
+
+// Larger explicit exponents are clamped to this, which is enough to overflow
+// or underflow any double.
+constexpr int16_t kMaxExplicitExponent = 9999;
+
+// A decimal number, with value mantissa * 10^exponent. If truncated is true,
+// there were more than kMaxMantissaDigits significant digits, and those beyond
+// that were dropped.
+struct DecimalNumber {
+  DecimalMantissa mantissa;
+  int16_t exponent;
+  uint8_t mantissa_digits;
+  bool truncated;
+};
+
+bool IsDigit(const char c) { return '0' <= c && c <= '9'; }
+
+// Appends the digit c to the mantissa and returns true, unless the mantissa
+// already has kMaxMantissaDigits significant digits, in which case the digit is
+// dropped and false is returned.
+bool AddDigit(DecimalNumber& number, const char c) {
+  if (number.mantissa_digits >= kMaxMantissaDigits) {
+    number.truncated = number.truncated || c != '0';
     return false;
   }
-  value *= 10;
-  value += (c - '0');
+  number.mantissa = number.mantissa * 10 + static_cast<uint8_t>(c - '0');
+  if (number.mantissa != 0) {
+    ++number.mantissa_digits;
+  }
   return true;
 }
 
+// Parses an unsigned decimal number with an optional fraction and exponent,
+// i.e. digits [ '.' digits ] [ ('e'|'E') ['+'|'-'] digits ], where there must
+// be at least one digit before the exponent (if any).
+bool ParseDecimalNumber(StringView view, DecimalNumber& number) {
+  number = DecimalNumber{0, 0, 0, false};
+  bool seen_digit = false;
+  while (!view.empty() && IsDigit(view.front())) {
+    if (!AddDigit(number, view.front())) {
+      // A dropped digit before the decimal point still scales the value.
+      ++number.exponent;
+    }
+    view.remove_prefix(1);
+    seen_digit = true;
+  }
+  if (view.match_and_consume('.')) {
+    while (!view.empty() && IsDigit(view.front())) {
+      if (AddDigit(number, view.front())) {
+        --number.exponent;
+      }
+      view.remove_prefix(1);
+      seen_digit = true;
+    }
+  }
+  if (!seen_digit) {
+    return false;
+  }
+  if (view.match_and_consume('e') || view.match_and_consume('E')) {
+    const bool negative = view.match_and_consume('-');
+    if (!negative) {
+      view.match_and_consume('+');
+    }
+    if (view.empty()) {
+      return false;
+    }
+    int16_t exponent = 0;
+    while (!view.empty() && IsDigit(view.front())) {
+      if (exponent <= kMaxExplicitExponent / 10) {
+        exponent = exponent * 10 + (view.front() - '0');
+      } else {
+        exponent = kMaxExplicitExponent;
+      }
+      view.remove_prefix(1);
+    }
+    number.exponent += negative ? -exponent : exponent;
+  }
+  return view.empty();
+}
+
+double ExactPowerOfTen(int16_t n) {
+  double value;
+  memcpy_P(&value, &kExactPowersOfTen[n], sizeof value);
+  return value;
+}
+
+// Computes the value of number if that can be done exactly, i.e. with the
+// mantissa and the power of ten both exactly representable as doubles, in
+// which case a single multiplication or division produces the correctly
+// rounded result (Clinger's fast path). Returns false otherwise.
+bool FastDecimalToDouble(DecimalNumber number, double& value) {
+  if (number.mantissa == 0) {
+    value = 0;
+    return true;
+  } else if (number.truncated || number.mantissa > kMaxExactMantissa) {
+    return false;
+  }
+  // A large exponent can be partially moved into a small mantissa, e.g. 12e24
+  // can be computed as 12000e21.
+  while (number.exponent > kMaxExactPowerOfTen &&
+         number.mantissa <= kMaxExactMantissa / 10) {
+    number.mantissa *= 10;
+    --number.exponent;
+  }
+  if (number.exponent > kMaxExactPowerOfTen ||
+      number.exponent < -kMaxExactPowerOfTen) {
+    return false;
+  }
+  value = static_cast<double>(number.mantissa);
+  if (number.exponent > 0) {
+    value *= ExactPowerOfTen(number.exponent);
+  } else if (number.exponent < 0) {
+    value /= ExactPowerOfTen(-number.exponent);
+  }
+  return true;
+}
+
+// On host there is plenty of stack for a copy of any StringView; on AVR, only
+// for short numbers.
+constexpr size_t kStrtodBufferSize =
+    TAS_HOST_TARGET ? StringView::kMaxSize + 1 : 32;
+
+// Computes the value of the (unsigned) decimal number in view using strtod,
+// which is correctly rounded (on host), but much slower than
+// FastDecimalToDouble. If view is too long to copy to a NUL terminated buffer
+// on the stack, the digits in number are used instead, which is exact unless
+// number is truncated.
+bool SlowDecimalToDouble(const StringView& view, const DecimalNumber& number,
+                         double& value) {
+  char buffer[kStrtodBufferSize];
+  if (view.size() < sizeof buffer) {
+    memcpy(buffer, view.data(), view.size());
+    buffer[view.size()] = '\0';
+  } else {
+    char* ptr = buffer + kMaxMantissaDigits;
+    auto mantissa = number.mantissa;
+    do {
+      *--ptr = static_cast<char>('0' + mantissa % 10);
+      mantissa /= 10;
+    } while (mantissa != 0);
+    const auto digits = static_cast<uint8_t>(buffer + kMaxMantissaDigits - ptr);
+    memmove(buffer, ptr, digits);
+    ptr = buffer + digits;
+    *ptr++ = 'e';
+    int16_t exponent = number.exponent;
+    if (exponent < 0) {
+      *ptr++ = '-';
+      exponent = -exponent;
+    }
+    char exponent_digits[6];
+    uint8_t count = 0;
+    do {
+      exponent_digits[count++] = static_cast<char>('0' + exponent % 10);
+      exponent /= 10;
+    } while (exponent != 0);
+    while (count > 0) {
+      *ptr++ = exponent_digits[--count];
+    }
+    *ptr = '\0';
+  }
+  value = strtod(buffer, nullptr);
+  // Reject values too large to represent.
+  return isfinite(value);
+}
+
 }  // namespace
 
-bool StringView::to_uint32(uint32_t& out) const {
-  TAS_VLOG(7) << TAS_FLASHSTR("StringView::to_uint32 converting ")
-              << HexEscaped(*this);
-  if (empty()) {
+namespace internal {
+
+bool ParseUInt32Swar(const StringView& view, uint32_t& out) {
+  if (view.empty()) {
+    return false;
+  }
+  const char* ptr = view.data();
+  StringView::size_type remaining = view.size();
+  // value is at most kMaxUInt before each step, so can't overflow 64 bits.
+  uint64_t value = 0;
+  while (remaining >= 8) {
+    const uint64_t chars = LoadEightChars(ptr);
+    if (!AreEightDigits(chars)) {
+      return false;
+    }
+    value = value * 100000000 + ConvertEightDigits(chars);
+    if (value > kMaxUInt) {
+      return false;
+    }
+    ptr += 8;
+    remaining -= 8;
+  }
+  // At most 7 digits remain, so value can't overflow 64 bits.
+  for (; remaining > 0; ++ptr, --remaining) {
+    const uint8_t digit = static_cast<uint8_t>(*ptr - '0');
+    if (digit > 9) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+  if (value > kMaxUInt) {
     return false;
   }
+  out = static_cast<uint32_t>(value);
+  return true;
+}
+
+bool ParseUInt32In16BitHalves(const StringView& view, uint32_t& out) {
+  if (view.empty()) {
+    return false;
+  }
+  // Convert up to 4 digits at a time with 16-bit arithmetic, then add those to
+  // the 32-bit value.
   uint32_t value = 0;
-  for (const char c : *this) {
-    if (!AddOnesPlace(value, c)) {
+  const char* ptr = view.data();
+  StringView::size_type remaining = view.size();
+  while (remaining > 0) {
+    uint16_t chunk = 0;
+    uint16_t scale = 1;
+    for (uint8_t count = 0; count < 4 && remaining > 0;
+         ++count, ++ptr, --remaining) {
+      const uint8_t digit = static_cast<uint8_t>(*ptr - '0');
+      if (digit > 9) {
+        return false;
+      }
+      chunk = chunk * 10 + digit;
+      scale *= 10;
+    }
+    if (!MultiplyAdd(value, scale, chunk)) {
       return false;
     }
   }
+  out = value;
+  return true;
+}
+
+}  // namespace internal
+
+bool StringView::to_uint32(uint32_t& out) const {
+  TAS_VLOG(7) << TAS_FLASHSTR("StringView::to_uint32 converting ")
+              << HexEscaped(*this);
+  uint32_t value;
+#if TAS_HOST_TARGET
+  if (!internal::ParseUInt32Swar(*this, value)) {
+    return false;
+  }
+#else
+  if (!internal::ParseUInt32In16BitHalves(*this, value)) {
+    return false;
+  }
+#endif
   TAS_VLOG(5) << TAS_FLASHSTR("StringView::to_uint32 produced ") << value;
   out = value;
   return true;
@@ -119,35 +406,14 @@ bool StringView::to_double(double& out) const {
               << HexEscaped(*this);
   StringView copy(*this);
   bool negative = copy.match_and_consume('-');
-  if (copy.empty()) {
+  DecimalNumber number;
+  if (!ParseDecimalNumber(copy, number)) {
     return false;
   }
-
-  bool decoding_fraction = false;
-  double value = 0;
-  double divisor = 1;
-
-  for (const char c : copy) {
-    if (c == '.') {
-      if (decoding_fraction) {
-        return false;
-      }
-      if (copy.size() == 1) {
-        return false;
-      }
-      decoding_fraction = true;
-    } else {
-      if (!AddOnesPlace(value, c)) {
-        return false;
-      }
-      if (decoding_fraction) {
-        divisor *= 10;
-      }
-    }
-  }
-
-  if (divisor > 1) {
-    value /= divisor;
+  double value;
+  if (!FastDecimalToDouble(number, value) &&
+      !SlowDecimalToDouble(copy, number, value)) {
+    return false;
   }
   if (negative) {
     value = -value;
@@ -216,8 +216,10 @@ class StringView {
   // out.
   bool to_int32(int32_t& out) const;
 
-  // Parse the string as a signed double, writing the value to out. Returns true
-  // iff successful. If not successful, does not modify out.
+  // Parse the string as a signed decimal number, with an optional fraction and
+  // exponent (e.g. "-12", "0.25", ".5", "1.5e-3"), writing the nearest double
+  // to out. Returns true iff successful. If not successful, does not modify
+  // out.
   bool to_double(double& out) const;
 
   // Print the string to Print by calling Print::write(data(), size()). The
@@ -232,6 +234,16 @@ class StringView {
   size_type size_;
 };
 
+namespace internal {
+// The two implementations of StringView::to_uint32, exposed only for testing
+// and benchmarking. ParseUInt32Swar validates and converts 8 digits at a time
+// using 64-bit arithmetic, and is used on host. ParseUInt32In16BitHalves
+// converts 4 digits at a time with 16-bit arithmetic, and combines them using
+// 16x16 bit multiplications, and is used on AVR.
+bool ParseUInt32Swar(const StringView& view, uint32_t& out);
+bool ParseUInt32In16BitHalves(const StringView& view, uint32_t& out);
+}  // namespace internal
+
 }  // namespace alpaca
 
 #endif  // TINY_ALPACA_SERVER_SRC_UTILS_STRING_VIEW_H_
@@ -0,0 +1,111 @@
+#include "utils/task_scheduler.h"
+
+#include "utils/logging.h"
+
+namespace alpaca {
+
+ScheduledTask::ScheduledTask()
+    : next_(nullptr), deadline_millis_(0), scheduled_(false) {}
+
+ScheduledTask::~ScheduledTask() {}
+
+TaskScheduler::TaskScheduler() : head_(nullptr), due_head_(nullptr) {}
+
+// static
+bool TaskScheduler::IsDue(uint32_t deadline_millis, uint32_t now_millis) {
+  return static_cast<int32_t>(deadline_millis - now_millis) <= 0;
+}
+
+void TaskScheduler::ScheduleAt(ScheduledTask& task, uint32_t deadline_millis) {
+  Cancel(task);
+  task.deadline_millis_ = deadline_millis;
+  Insert(task);
+}
+
+void TaskScheduler::Cancel(ScheduledTask& task) {
+  if (!task.scheduled_) {
+    return;
+  }
+  // The task may be in the list of those being run by RunDueTasks.
+  if (!Unlink(head_, task)) {
+    Unlink(due_head_, task);
+  }
+  task.next_ = nullptr;
+  task.scheduled_ = false;
+}
+
+// static
+bool TaskScheduler::Unlink(ScheduledTask*& list, ScheduledTask& task) {
+  ScheduledTask** link = &list;
+  while (*link != nullptr) {
+    if (*link == &task) {
+      *link = task.next_;
+      return true;
+    }
+    link = &(*link)->next_;
+  }
+  return false;
+}
+
+bool TaskScheduler::HasDueTask(uint32_t now_millis) const {
+  return head_ != nullptr && IsDue(head_->deadline_millis_, now_millis);
+}
+
+uint32_t TaskScheduler::MillisUntilNextTask(uint32_t now_millis) const {
+  if (head_ == nullptr) {
+    return ScheduledTask::kDontReschedule;
+  } else if (IsDue(head_->deadline_millis_, now_millis)) {
+    return 0;
+  }
+  return head_->deadline_millis_ - now_millis;
+}
+
+uint8_t TaskScheduler::RunDueTasks(uint32_t now_millis) {
+  if (!HasDueTask(now_millis)) {
+    return 0;
+  }
+  TAS_DCHECK_EQ(due_head_, nullptr) << TAS_FLASHSTR("RunDueTasks re-entered");
+  // Detach the due tasks from the list before running any of them, so that a
+  // task which is rescheduled (e.g. with a zero delay) isn't run again now.
+  due_head_ = head_;
+  ScheduledTask* last_due = head_;
+  while (last_due->next_ != nullptr &&
+         IsDue(last_due->next_->deadline_millis_, now_millis)) {
+    last_due = last_due->next_;
+  }
+  head_ = last_due->next_;
+  last_due->next_ = nullptr;
+
+  uint8_t count = 0;
+  while (due_head_ != nullptr) {
+    ScheduledTask& task = *due_head_;
+    due_head_ = task.next_;
+    task.next_ = nullptr;
+    task.scheduled_ = false;
+    ++count;
+    const uint32_t delay_millis = task.RunTask(now_millis);
+    // RunTask may have scheduled the task itself, in which case that schedule
+    // takes precedence.
+    if (delay_millis != ScheduledTask::kDontReschedule && !task.scheduled_) {
+      ScheduleAt(task, now_millis + delay_millis);
+    }
+  }
+  return count;
+}
+
+void TaskScheduler::Insert(ScheduledTask& task) {
+  TAS_DCHECK(!task.scheduled_);
+  // Insert after any tasks with the same or an earlier deadline, so that tasks
+  // with the same deadline run in the order in which they were scheduled.
+  ScheduledTask** link = &head_;
+  while (*link != nullptr &&
+         static_cast<int32_t>((*link)->deadline_millis_ -
+                              task.deadline_millis_) <= 0) {
+    link = &(*link)->next_;
+  }
+  task.next_ = *link;
+  *link = &task;
+  task.scheduled_ = true;
+}
+
+}  // namespace alpaca
@@ -0,0 +1,109 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_TASK_SCHEDULER_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_TASK_SCHEDULER_H_
+
+// TaskScheduler runs ScheduledTasks when their deadlines arrive, so that a
+// device which has periodic work to do (e.g. reading a sensor every few
+// seconds) needn't be called on every pass through loop() just to find out
+// that there is nothing to do yet.
+//
+// The scheduled tasks are kept in an intrusive singly linked list, sorted by
+// deadline: scheduling a task takes time proportional to the number of
+// scheduled tasks (there are typically only a handful), and checking whether
+// any task is due takes constant time. No memory is allocated; the tasks are
+// owned by their devices, and must outlive their schedules (i.e. a task must
+// be cancelled before it is deleted, though they're typically never deleted).
+//
+// Time is measured in milliseconds (i.e. from millis()), and may wrap around,
+// but deadlines must be less than 2^31 milliseconds (~24 days) in the future.
+//
+// Tasks run on the same thread as the rest of the server, so a task must not
+// block for long; if it has a long operation to perform, it should perform a
+// step at a time, and schedule itself to run again for the next step.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+
+namespace alpaca {
+
+class TaskScheduler;
+
+class ScheduledTask {
+ public:
+  // Value returned by RunTask when the task shouldn't be run again until it is
+  // next scheduled (i.e. when it is a one-shot task).
+  static constexpr uint32_t kDontReschedule = 0xFFFFFFFF;
+
+  ScheduledTask();
+  virtual ~ScheduledTask();
+
+  // Returns true if the task is waiting for its deadline.
+  bool is_scheduled() const { return scheduled_; }
+
+  // The time at which the task is (or was last) scheduled to run.
+  uint32_t deadline_millis() const { return deadline_millis_; }
+
+ protected:
+  // Called by the scheduler when the deadline has arrived. Returns the number
+  // of milliseconds after now_millis at which the task should be run again, or
+  // kDontReschedule.
+  virtual uint32_t RunTask(uint32_t now_millis) = 0;
+
+ private:
+  friend class TaskScheduler;
+
+  ScheduledTask* next_;
+  uint32_t deadline_millis_;
+  bool scheduled_;
+};
+
+class TaskScheduler {
+ public:
+  TaskScheduler();
+
+  // Schedules the task to run at deadline_millis, replacing any existing
+  // schedule for the task. A task may schedule itself (e.g. from RunTask).
+  void ScheduleAt(ScheduledTask& task, uint32_t deadline_millis);
+
+  // Schedules the task to run delay_millis after now_millis.
+  void ScheduleAfter(ScheduledTask& task, uint32_t delay_millis,
+                     uint32_t now_millis) {
+    ScheduleAt(task, now_millis + delay_millis);
+  }
+
+  // Removes the task from the schedule, if present.
+  void Cancel(ScheduledTask& task);
+
+  // Returns true if any task is due to run at now_millis.
+  bool HasDueTask(uint32_t now_millis) const;
+
+  // Returns the number of milliseconds until the next task is due (0 if one is
+  // already due), or ScheduledTask::kDontReschedule if no task is scheduled.
+  uint32_t MillisUntilNextTask(uint32_t now_millis) const;
+
+  // Runs those tasks which are due at now_millis, in order of their deadlines,
+  // each at most once (i.e. a task which reschedules itself for a time that
+  // has already arrived won't be run again until the next call). Returns the
+  // number of tasks run.
+  uint8_t RunDueTasks(uint32_t now_millis);
+
+ private:
+  // Returns true if deadline_millis is at or before now_millis.
+  static bool IsDue(uint32_t deadline_millis, uint32_t now_millis);
+
+  // Adds the task to the list, which must not already contain it.
+  void Insert(ScheduledTask& task);
+
+  // Removes the task from the list, returning true if it was present.
+  static bool Unlink(ScheduledTask*& list, ScheduledTask& task);
+
+  // The scheduled tasks, in order of their deadlines.
+  ScheduledTask* head_;
+
+  // The due tasks which RunDueTasks has yet to run.
+  ScheduledTask* due_head_;
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_TASK_SCHEDULER_H_
@@ -87,4 +87,42 @@ extern void [[TAS_DO_LOG_EXPERIMENT_is_defined]] UtilsFunc();
 
 #endif  // TAS_DO_LOG_EXPERIMENT
 
+// If non-zero, LogSink writes to an in-RAM ring buffer of size
+// TAS_LOG_RING_BUFFER_SIZE (see log_ring_buffer.h), which is drained to Serial
+// when there is room, so that logging doesn't add the time to transmit each
+// message to the time to handle a request. Messages (or parts of them) are
+// dropped if the buffer is full. Note that with this enabled, messages logged
+// before the first call to TinyAlpacaServer::PerformIO (e.g. during setup) will
+// be delayed, so the buffer must be large enough for them.
+#ifndef TAS_ENABLE_ASYNC_LOG_SINK
+#define TAS_ENABLE_ASYNC_LOG_SINK 0
+#endif  // !TAS_ENABLE_ASYNC_LOG_SINK
+
+#ifndef TAS_LOG_RING_BUFFER_SIZE
+#define TAS_LOG_RING_BUFFER_SIZE 512
+#endif  // !TAS_LOG_RING_BUFFER_SIZE
+
+// If non-zero, TAS_VLOG emits binary records (see binary_log_sink.h) rather
+// than text, which reduces the number of bytes logged per message by several
+// times, mostly because the text of string literals isn't sent. The log must
+// then be decoded with extras/dev_tools/decode_binary_log.py.
+#ifndef TAS_ENABLE_BINARY_LOGGING
+#define TAS_ENABLE_BINARY_LOGGING 0
+#endif  // !TAS_ENABLE_BINARY_LOGGING
+
+// If non-zero, the stack and RAM high-water marks are measured (see
+// memory_usage.h). On AVR this paints the free RAM at startup, which costs no
+// RAM; on the host, stack usage is recorded at a few points on deep paths.
+#ifndef TAS_ENABLE_MEMORY_USAGE
+#define TAS_ENABLE_MEMORY_USAGE 1
+#endif  // !TAS_ENABLE_MEMORY_USAGE
+
+// The maximum number of bytes that SettingsStore writes to EEPROM each time it
+// is run by the TaskScheduler. Writing a byte of EEPROM on an AVR takes about
+// 3.3ms, during which nothing else happens, so this bounds how long a pass
+// through the loop may be delayed by the deferred writing of settings.
+#ifndef TAS_SETTINGS_STORE_BYTES_PER_STEP
+#define TAS_SETTINGS_STORE_BYTES_PER_STEP 2
+#endif  // !TAS_SETTINGS_STORE_BYTES_PER_STEP
+
 #endif  // TINY_ALPACA_SERVER_SRC_UTILS_UTILS_CONFIG_H_
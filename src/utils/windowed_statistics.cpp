@@ -0,0 +1,172 @@
+#include "utils/windowed_statistics.h"
+
+#include "utils/logging.h"
+
+namespace alpaca {
+namespace {
+
+uint32_t ComputeBucketDuration(uint32_t window_duration, uint8_t num_buckets) {
+  const uint32_t bucket_duration = window_duration / num_buckets;
+  return bucket_duration > 0 ? bucket_duration : 1;
+}
+
+}  // namespace
+
+WindowedStatisticsBase::MonotonicDeque::MonotonicDeque(Extremum* entries,
+                                                       uint8_t capacity,
+                                                       bool keep_maximum)
+    : entries_(entries),
+      capacity_(capacity),
+      keep_maximum_(keep_maximum),
+      head_(0),
+      size_(0) {}
+
+void WindowedStatisticsBase::MonotonicDeque::Add(uint16_t bucket_seq,
+                                                 double value) {
+  // Entries which are no more extreme than value will never again be the
+  // extreme value of the window, because value will expire after them.
+  while (size_ > 0 && (keep_maximum_ ? back().value <= value
+                                     : back().value >= value)) {
+    --size_;
+  }
+  if (size_ > 0 && back().bucket_seq == bucket_seq) {
+    // The back entry is more extreme, and expires at the same time.
+    return;
+  }
+  TAS_DCHECK_LT(size_, capacity_);
+  ++size_;
+  Extremum& entry = back();
+  entry.bucket_seq = bucket_seq;
+  entry.value = value;
+}
+
+void WindowedStatisticsBase::MonotonicDeque::RemoveExpired(
+    uint16_t current_bucket_seq, uint8_t num_buckets) {
+  while (size_ > 0) {
+    const uint16_t age = current_bucket_seq - entries_[head_].bucket_seq;
+    if (age < num_buckets) {
+      return;
+    }
+    head_ = (head_ + 1) % capacity_;
+    --size_;
+  }
+}
+
+WindowedStatisticsBase::WindowedStatisticsBase(uint8_t num_buckets,
+                                               Bucket* buckets,
+                                               Extremum* minima,
+                                               Extremum* maxima,
+                                               uint32_t window_duration)
+    : buckets_(buckets),
+      num_buckets_(num_buckets),
+      minima_(minima, num_buckets, /*keep_maximum=*/false),
+      maxima_(maxima, num_buckets, /*keep_maximum=*/true),
+      window_duration_(window_duration),
+      bucket_duration_(ComputeBucketDuration(window_duration, num_buckets)),
+      current_bucket_(0),
+      current_bucket_seq_(0),
+      current_bucket_start_(0),
+      sum_(0),
+      count_(0),
+      last_update_time_(0),
+      started_(false) {
+  // Doesn't call Reset because the buckets are members of the subclass, and
+  // haven't been constructed yet; the subclass calls it instead.
+}
+
+void WindowedStatisticsBase::set_window_duration(uint32_t window_duration) {
+  window_duration_ = window_duration;
+  bucket_duration_ = ComputeBucketDuration(window_duration, num_buckets_);
+  Reset();
+}
+
+void WindowedStatisticsBase::Reset() {
+  for (uint8_t ndx = 0; ndx < num_buckets_; ++ndx) {
+    buckets_[ndx].sum = 0;
+    buckets_[ndx].count = 0;
+  }
+  minima_.Clear();
+  maxima_.Clear();
+  current_bucket_ = 0;
+  current_bucket_seq_ = 0;
+  sum_ = 0;
+  count_ = 0;
+  started_ = false;
+}
+
+void WindowedStatisticsBase::AdvanceTo(uint32_t current_time) {
+  if (!started_) {
+    return;
+  }
+  const uint32_t elapsed = current_time - current_bucket_start_;
+  if (elapsed < bucket_duration_) {
+    return;
+  }
+  const uint32_t steps = elapsed / bucket_duration_;
+  current_bucket_start_ += steps * bucket_duration_;
+  if (steps >= num_buckets_) {
+    // The entire window has expired.
+    for (uint8_t ndx = 0; ndx < num_buckets_; ++ndx) {
+      buckets_[ndx].sum = 0;
+      buckets_[ndx].count = 0;
+    }
+    minima_.Clear();
+    maxima_.Clear();
+    current_bucket_seq_ += static_cast<uint16_t>(steps);
+    sum_ = 0;
+    count_ = 0;
+    return;
+  }
+  for (uint32_t step = 0; step < steps; ++step) {
+    current_bucket_ = (current_bucket_ + 1) % num_buckets_;
+    ++current_bucket_seq_;
+    Bucket& bucket = buckets_[current_bucket_];
+    sum_ -= bucket.sum;
+    count_ -= bucket.count;
+    bucket.sum = 0;
+    bucket.count = 0;
+  }
+  if (count_ == 0) {
+    // Avoid accumulating rounding errors while there are no values.
+    sum_ = 0;
+  }
+  minima_.RemoveExpired(current_bucket_seq_, num_buckets_);
+  maxima_.RemoveExpired(current_bucket_seq_, num_buckets_);
+}
+
+void WindowedStatisticsBase::RecordNewValue(double new_value,
+                                            uint32_t current_time) {
+  if (started_) {
+    AdvanceTo(current_time);
+  } else {
+    started_ = true;
+    current_bucket_start_ = current_time;
+  }
+  Bucket& bucket = buckets_[current_bucket_];
+  TAS_DCHECK_LT(bucket.count, 65535)
+      << TAS_FLASHSTR("Too many values per bucket");
+  bucket.sum += new_value;
+  ++bucket.count;
+  sum_ += new_value;
+  ++count_;
+  minima_.Add(current_bucket_seq_, new_value);
+  maxima_.Add(current_bucket_seq_, new_value);
+  last_update_time_ = current_time;
+}
+
+double WindowedStatisticsBase::average_value() const {
+  TAS_DCHECK(has_value());
+  return sum_ / count_;
+}
+
+double WindowedStatisticsBase::min_value() const {
+  TAS_DCHECK(has_value());
+  return minima_.front_value();
+}
+
+double WindowedStatisticsBase::max_value() const {
+  TAS_DCHECK(has_value());
+  return maxima_.front_value();
+}
+
+}  // namespace alpaca
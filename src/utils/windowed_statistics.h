@@ -0,0 +1,156 @@
+#ifndef TINY_ALPACA_SERVER_SRC_UTILS_WINDOWED_STATISTICS_H_
+#define TINY_ALPACA_SERVER_SRC_UTILS_WINDOWED_STATISTICS_H_
+
+// WindowedStatistics computes the average, minimum and maximum of the values
+// recorded during a sliding window of time (e.g. the ASCOM AveragePeriod, or
+// the 2 minutes over which the WindGust is the peak wind speed). Unlike
+// MovingAverage, values older than the window have no effect on the results.
+//
+// The window is divided into kNumBuckets buckets of equal duration, which are
+// kept in a ring buffer; when a bucket ages out of the window, all of the
+// values recorded in it are discarded together. Thus the window covers between
+// (kNumBuckets-1)/kNumBuckets and all of window_duration, depending upon how
+// far the current time is into the current bucket.
+//
+// The sum and count of the values in the window are maintained incrementally,
+// and the minimum and maximum are maintained using monotonic deques (i.e.
+// holding the minimum of each suffix of the window, one entry per bucket), so
+// recording a value takes amortized O(1) time, and reading the statistics
+// takes O(1) time.
+//
+// As with MovingAverage, there is no implied unit of time, and the time may
+// wrap around to zero, but time must not go backwards.
+//
+// WindowedStatistics<kNumBuckets> needs 3 * 6 bytes per bucket on AVR (where
+// double is a 4 byte float), plus about 30 bytes, so 16 buckets take ~320
+// bytes. The logic is in the non-template base class so that it is present
+// only once in the program, regardless of the number of sizes used.
+//
+// Author: james.synge@gmail.com
+
+#include "utils/platform.h"
+
+namespace alpaca {
+
+class WindowedStatisticsBase {
+ public:
+  // Changes the duration of the window, and discards all recorded values.
+  void set_window_duration(uint32_t window_duration);
+  uint32_t window_duration() const { return window_duration_; }
+
+  // Discards all recorded values.
+  void Reset();
+
+  // Records new_value as having been observed at current_time, after first
+  // discarding the values that are no longer in the window.
+  void RecordNewValue(double new_value, uint32_t current_time);
+
+  // Discards values that are no longer in the window as of current_time;
+  // useful when values are recorded irregularly, such that there may be no
+  // recent values in the window.
+  void AdvanceTo(uint32_t current_time);
+
+  // Returns true if there are values in the window, in which case the
+  // following methods may be called.
+  bool has_value() const { return count_ > 0; }
+  uint32_t count() const { return count_; }
+  double average_value() const;
+  double min_value() const;
+  double max_value() const;
+
+  // Time of the most recent call to RecordNewValue.
+  uint32_t last_update_time() const { return last_update_time_; }
+
+ protected:
+  struct Bucket {
+    double sum;
+    uint16_t count;
+  };
+
+  // An entry in a monotonic deque: the extreme value of those recorded in the
+  // bucket with sequence number bucket_seq and later.
+  struct Extremum {
+    uint16_t bucket_seq;
+    double value;
+  };
+
+  WindowedStatisticsBase(uint8_t num_buckets, Bucket* buckets,
+                         Extremum* minima, Extremum* maxima,
+                         uint32_t window_duration);
+
+ private:
+  // A ring buffer of Extremum entries, with at most one per bucket, in order
+  // of increasing bucket_seq and strictly increasing (for the minima) or
+  // decreasing (for the maxima) value, so that the front holds the extreme
+  // value in the window.
+  class MonotonicDeque {
+   public:
+    MonotonicDeque(Extremum* entries, uint8_t capacity, bool keep_maximum);
+
+    void Clear() { size_ = 0; }
+    bool empty() const { return size_ == 0; }
+    double front_value() const { return entries_[head_].value; }
+
+    void Add(uint16_t bucket_seq, double value);
+
+    // Removes the entries for buckets which are no longer in the window, i.e.
+    // those num_buckets or more before current_bucket_seq.
+    void RemoveExpired(uint16_t current_bucket_seq, uint8_t num_buckets);
+
+   private:
+    Extremum& back() { return entries_[(head_ + size_ - 1) % capacity_]; }
+
+    Extremum* const entries_;
+    const uint8_t capacity_;
+    const bool keep_maximum_;
+    uint8_t head_;
+    uint8_t size_;
+  };
+
+  Bucket* const buckets_;
+  const uint8_t num_buckets_;
+  MonotonicDeque minima_;
+  MonotonicDeque maxima_;
+
+  uint32_t window_duration_;
+  uint32_t bucket_duration_;
+
+  // Index in buckets_ of the current bucket, its sequence number (which is
+  // incremented each time the window advances by one bucket), and the time at
+  // which it started.
+  uint8_t current_bucket_;
+  uint16_t current_bucket_seq_;
+  uint32_t current_bucket_start_;
+
+  // The sum and count of the values in all of the buckets.
+  double sum_;
+  uint32_t count_;
+
+  uint32_t last_update_time_;
+  bool started_;
+};
+
+template <uint8_t kNumBuckets>
+class WindowedStatistics : public WindowedStatisticsBase {
+  static_assert(kNumBuckets >= 1, "Must have at least one bucket");
+
+ public:
+  explicit WindowedStatistics(uint32_t window_duration = 0)
+      : WindowedStatisticsBase(kNumBuckets, buckets_, minima_, maxima_,
+                               window_duration) {
+    Reset();
+  }
+
+  // Copying would leave the copy referring to the original's buckets.
+  WindowedStatistics(const WindowedStatistics&) = delete;
+  WindowedStatistics& operator=(const WindowedStatistics&) = delete;
+
+ private:
+  Bucket buckets_[kNumBuckets];
+  Extremum minima_[kNumBuckets];
+  Extremum maxima_[kNumBuckets];
+};
+
+}  // namespace alpaca
+
+#endif  // TINY_ALPACA_SERVER_SRC_UTILS_WINDOWED_STATISTICS_H_